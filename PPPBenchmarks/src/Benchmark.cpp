@@ -0,0 +1,189 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#undef min
+#undef max
+
+namespace Benchmark
+{
+
+void QuietLog::Debug(const std::string&) {}
+void QuietLog::Debug(const novac::LogContext&, const std::string&) {}
+
+void QuietLog::Information(const std::string&) {}
+void QuietLog::Information(const novac::LogContext&, const std::string&) {}
+
+void QuietLog::Error(const std::string& message)
+{
+    std::cerr << message << std::endl;
+}
+void QuietLog::Error(const novac::LogContext&, const std::string& message)
+{
+    std::cerr << message << std::endl;
+}
+
+static volatile double s_consumedValue = 0.0;
+
+void Consume(double value)
+{
+    s_consumedValue = value;
+}
+
+BenchmarkResult Run(const BenchmarkCase& benchmark, double minimumSeconds, size_t minimumIterations)
+{
+    // Warm up
+    benchmark.run();
+
+    std::vector<double> durations;
+    double totalSeconds = 0.0;
+    while (durations.size() < minimumIterations || totalSeconds < minimumSeconds)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        benchmark.run();
+        const auto stop = std::chrono::steady_clock::now();
+
+        const double nanoseconds = std::chrono::duration<double, std::nano>(stop - start).count();
+        durations.push_back(nanoseconds);
+        totalSeconds += nanoseconds * 1e-9;
+    }
+
+    BenchmarkResult result;
+    result.name = benchmark.name;
+    result.relativeTo = benchmark.relativeTo;
+    result.iterations = durations.size();
+
+    double sum = 0.0;
+    for (double duration : durations)
+    {
+        sum += duration;
+    }
+    result.meanNanoseconds = sum / static_cast<double>(durations.size());
+
+    double sumOfSquares = 0.0;
+    for (double duration : durations)
+    {
+        sumOfSquares += (duration - result.meanNanoseconds) * (duration - result.meanNanoseconds);
+    }
+    result.stdevNanoseconds = (durations.size() > 1) ? std::sqrt(sumOfSquares / static_cast<double>(durations.size() - 1)) : 0.0;
+
+    result.itemsPerSecond = (result.meanNanoseconds > 0.0) ? static_cast<double>(benchmark.itemsPerIteration) * 1e9 / result.meanNanoseconds : 0.0;
+
+    return result;
+}
+
+size_t WriteResults(std::ostream& output, const std::vector<BenchmarkResult>& results, const std::vector<BenchmarkResult>* baseline, double tolerance)
+{
+    size_t numberOfRegressions = 0;
+
+    output << "name,iterations,mean_ns,stdev_ns,items_per_second";
+    if (baseline != nullptr)
+    {
+        output << ",baseline_mean_ns,ratio,status";
+    }
+    output << "\n";
+
+    for (const BenchmarkResult& result : results)
+    {
+        output << result.name << "," << result.iterations << "," << result.meanNanoseconds << "," << result.stdevNanoseconds << "," << result.itemsPerSecond;
+
+        if (baseline != nullptr)
+        {
+            auto baselineResult = std::find_if(begin(*baseline), end(*baseline), [&](const BenchmarkResult& r) { return r.name == result.name; });
+            if (baselineResult == end(*baseline) || baselineResult->meanNanoseconds <= 0.0)
+            {
+                output << ",,,new";
+            }
+            else
+            {
+                const double ratio = result.meanNanoseconds / baselineResult->meanNanoseconds;
+                const char* status = "ok";
+                if (ratio > 1.0 + tolerance)
+                {
+                    status = "regression";
+                    ++numberOfRegressions;
+                }
+                else if (ratio < 1.0 - tolerance)
+                {
+                    status = "improvement";
+                }
+                output << "," << baselineResult->meanNanoseconds << "," << ratio << "," << status;
+            }
+        }
+        output << "\n";
+    }
+
+    output.flush();
+
+    return numberOfRegressions;
+}
+
+void WriteRelativeTimes(std::ostream& output, const std::vector<BenchmarkResult>& results)
+{
+    for (const BenchmarkResult& result : results)
+    {
+        if (result.relativeTo.empty())
+        {
+            continue;
+        }
+
+        auto otherResult = std::find_if(begin(results), end(results), [&](const BenchmarkResult& r) { return r.name == result.relativeTo; });
+        if (otherResult == end(results) || otherResult->meanNanoseconds <= 0.0)
+        {
+            continue;
+        }
+
+        output << result.name << " takes " << result.meanNanoseconds / otherResult->meanNanoseconds << " times as long as " << result.relativeTo << "\n";
+    }
+
+    output.flush();
+}
+
+std::vector<BenchmarkResult> ReadResults(const std::string& fileName)
+{
+    std::ifstream file(fileName);
+    if (!file.is_open())
+    {
+        throw std::invalid_argument("Cannot open benchmark results file: " + fileName);
+    }
+
+    std::vector<BenchmarkResult> results;
+    std::string line;
+    std::getline(file, line); // the header line
+    while (std::getline(file, line))
+    {
+        if (line.empty())
+        {
+            continue;
+        }
+
+        std::stringstream lineStream(line);
+        std::string name, iterations, mean, stdev, itemsPerSecond;
+        if (!std::getline(lineStream, name, ',') ||
+            !std::getline(lineStream, iterations, ',') ||
+            !std::getline(lineStream, mean, ',') ||
+            !std::getline(lineStream, stdev, ',') ||
+            !std::getline(lineStream, itemsPerSecond, ','))
+        {
+            throw std::invalid_argument("Invalid line in benchmark results file: " + line);
+        }
+
+        BenchmarkResult result;
+        result.name = name;
+        result.iterations = std::stoul(iterations);
+        result.meanNanoseconds = std::stod(mean);
+        result.stdevNanoseconds = std::stod(stdev);
+        result.itemsPerSecond = std::stod(itemsPerSecond);
+        results.push_back(result);
+    }
+
+    return results;
+}
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <SpectralEvaluation/Log.h>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Benchmark
+{
+
+/** One benchmarked operation */
+struct BenchmarkCase
+{
+    /** The name of the benchmark, used to match the results against the baseline */
+    std::string name;
+
+    /** The number of items (e.g. scans, spectra or wind fields) processed in each call to run,
+        used to calculate the throughput. */
+    size_t itemsPerIteration = 1;
+
+    /** Performs one iteration of the benchmark */
+    std::function<void()> run;
+
+    /** The name of another benchmark which the time of this benchmark should be reported relative to,
+        e.g. the same stage without an optional part of the calculation. Empty if not compared. */
+    std::string relativeTo;
+};
+
+/** The measured performance of one benchmark */
+struct BenchmarkResult
+{
+    std::string name;
+
+    size_t iterations = 0;
+
+    /** The average and the standard deviation of the time of one iteration, in nanoseconds */
+    double meanNanoseconds = 0.0;
+    double stdevNanoseconds = 0.0;
+
+    /** The number of items processed per second */
+    double itemsPerSecond = 0.0;
+
+    /** A copy of BenchmarkCase::relativeTo */
+    std::string relativeTo;
+};
+
+/** A logger which only writes the errors, to standard error, such that the logging
+    does not dominate the measured times or mix with the results on standard output. */
+class QuietLog : public novac::ILogger
+{
+public:
+    virtual void Debug(const std::string& message) override;
+    virtual void Debug(const novac::LogContext& c, const std::string& message) override;
+
+    virtual void Information(const std::string& message) override;
+    virtual void Information(const novac::LogContext& c, const std::string& message) override;
+
+    virtual void Error(const std::string& message) override;
+    virtual void Error(const novac::LogContext& c, const std::string& message) override;
+};
+
+/** Keeps the compiler from optimizing away the calculation of the given value */
+void Consume(double value);
+
+/** Registers the benchmarks of the different stages of the processing.
+    Each of these reads its input from the given test data directory. */
+void AddEvaluationBenchmarks(const std::string& testDataDirectory, std::vector<BenchmarkCase>& benchmarks);
+void AddFluxBenchmarks(const std::string& testDataDirectory, std::vector<BenchmarkCase>& benchmarks);
+void AddWindBenchmarks(const std::string& testDataDirectory, std::vector<BenchmarkCase>& benchmarks);
+
+/** Runs the benchmark repeatedly, until it has run for at least minimumSeconds and at least minimumIterations times.
+    One iteration is run before the measurement starts, to warm up caches. */
+BenchmarkResult Run(const BenchmarkCase& benchmark, double minimumSeconds, size_t minimumIterations);
+
+/** Writes the results as comma separated values, with one header line.
+    If a baseline is given, then the time of each benchmark is also compared to the time in the baseline
+    and the benchmarks which are more than 'tolerance' (relative) slower are marked as regressions.
+    @return the number of regressions found. */
+size_t WriteResults(std::ostream& output, const std::vector<BenchmarkResult>& results, const std::vector<BenchmarkResult>* baseline, double tolerance);
+
+/** Writes the time of each benchmark with a BenchmarkCase::relativeTo relative to the time of that other benchmark,
+    one line per benchmark. Benchmarks whose other benchmark was not run are skipped. */
+void WriteRelativeTimes(std::ostream& output, const std::vector<BenchmarkResult>& results);
+
+/** Reads results previously written by WriteResults, e.g. to use as a baseline.
+    @throws std::invalid_argument if the file cannot be read. */
+std::vector<BenchmarkResult> ReadResults(const std::string& fileName);
+
+}
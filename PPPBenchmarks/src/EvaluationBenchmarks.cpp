@@ -0,0 +1,138 @@
+#include "Benchmark.h"
+#include <PPPLib/Evaluation/ScanEvaluation.h>
+#include <PPPLib/File/EvaluationLogFileHandler.h>
+#include <PPPLib/PostProcessingUtils.h>
+#include <SpectralEvaluation/Evaluation/FitWindow.h>
+#include <SpectralEvaluation/File/ScanFileHandler.h>
+#include <SpectralEvaluation/Spectra/SpectrometerModel.h>
+
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+namespace Benchmark
+{
+
+/** The number of times the spectra of the scan are repeated in the synthetic evaluation log */
+static const int syntheticScanRepetitions = 20;
+
+static std::shared_ptr<novac::CFitWindow> CreateFitWindow(novac::ILogger& log, const std::string& testDataDirectory)
+{
+    auto window = std::make_shared<novac::CFitWindow>();
+    window->fitLow = 464;
+    window->fitHigh = 630;
+    window->fitType = novac::FIT_TYPE::FIT_HP_DIV;
+
+    for (const char* referenceName : { "2002128M1_SO2_Bogumil_293K.txt", "2002128M1_O3_Voigt_223K.txt", "2002128M1_Ring_HR.txt" })
+    {
+        novac::CReferenceFile reference{ testDataDirectory + "2002128M1/" + referenceName };
+        reference.SetShift(novac::SHIFT_TYPE::SHIFT_FIX, 0.0);
+        reference.SetSqueeze(novac::SHIFT_TYPE::SHIFT_FIX, 1.0);
+        window->reference.push_back(reference);
+    }
+
+    novac::directorySetup directories;
+    directories.executableDirectory = ".";
+    directories.tempDirectory = ".";
+    novac::LogContext context;
+    novac::PrepareFitWindow(log, context, "2002128M1", *window, directories);
+
+    return window;
+}
+
+/** Creates a copy of the given evaluation log where the measured spectra are repeated the given number of times,
+    giving a scan with many more spectra than any real instrument would measure. */
+static void CreateScaledEvaluationLog(const std::string& originalFile, const std::string& scaledFile, int repetitions)
+{
+    std::ifstream input(originalFile);
+    std::ofstream output(scaledFile);
+    if (!input.is_open() || !output.is_open())
+    {
+        throw std::invalid_argument("Cannot create synthetic evaluation log from: " + originalFile);
+    }
+
+    std::vector<std::string> scanLines;
+    bool inSpectralData = false;
+    std::string line;
+    while (std::getline(input, line))
+    {
+        if (line.find("</spectraldata>") != std::string::npos)
+        {
+            for (int repetition = 0; repetition < repetitions; ++repetition)
+            {
+                for (const std::string& scanLine : scanLines)
+                {
+                    output << scanLine << "\n";
+                }
+            }
+            inSpectralData = false;
+        }
+        else if (inSpectralData && line.find("\tscan\t") != std::string::npos)
+        {
+            scanLines.push_back(line);
+            continue;
+        }
+        else if (line.find("<spectraldata>") != std::string::npos)
+        {
+            inSpectralData = true;
+        }
+
+        output << line << "\n";
+    }
+}
+
+void AddEvaluationBenchmarks(const std::string& testDataDirectory, std::vector<BenchmarkCase>& benchmarks)
+{
+    auto log = std::make_shared<QuietLog>();
+    auto userSettings = std::make_shared<Configuration::CUserConfiguration>();
+
+    // CScanEvaluation::EvaluateScan, on a measured scan with a visible plume
+    {
+        const std::string fileName = testDataDirectory + "2002128M1/2002128M1_230120_1907_0.pak";
+        auto scan = std::make_shared<novac::CScanFileHandler>(*log);
+        if (!scan->CheckScanFile(novac::LogContext(), fileName))
+        {
+            throw std::invalid_argument("Cannot read scan file: " + fileName);
+        }
+        auto fitWindow = CreateFitWindow(*log, testDataDirectory);
+        auto spectrometerModel = std::make_shared<novac::SpectrometerModel>(novac::CSpectrometerDatabase::GetInstance().SpectrometerModel_AVASPEC());
+
+        BenchmarkCase benchmark;
+        benchmark.name = "EvaluateScan/2002128M1_230120_1907_0";
+        benchmark.itemsPerIteration = 1;
+        benchmark.run = [=]()
+        {
+            Evaluation::CScanEvaluation evaluation{ *userSettings, *log };
+            auto result = evaluation.EvaluateScan(novac::LogContext(), *scan, *fitWindow, *spectrometerModel);
+            Consume((result != nullptr) ? result->GetColumn(0, 0) : 0.0);
+        };
+        benchmarks.push_back(benchmark);
+    }
+
+    // CEvaluationLogFileHandler::ReadEvaluationLog, on a measured scan and on a synthetic scan with many more spectra
+    const std::string evaluationLog = testDataDirectory + "2002128M1/2002128M1_230120_1907_0.txt";
+    const std::string scaledEvaluationLog = "PPPBenchmarks_ScaledEvaluationLog.txt";
+    CreateScaledEvaluationLog(evaluationLog, scaledEvaluationLog, syntheticScanRepetitions);
+
+    for (const std::string& fileName : { evaluationLog, scaledEvaluationLog })
+    {
+        FileHandler::CEvaluationLogFileHandler reader(*log, fileName, novac::StandardMolecule::SO2);
+        if (RETURN_CODE::SUCCESS != reader.ReadEvaluationLog() || reader.m_scan.empty())
+        {
+            throw std::invalid_argument("Cannot read evaluation log: " + fileName);
+        }
+
+        BenchmarkCase benchmark;
+        benchmark.name = (fileName == evaluationLog) ? "ReadEvaluationLog/2002128M1_230120_1907_0" : "ReadEvaluationLog/synthetic_x" + std::to_string(syntheticScanRepetitions);
+        benchmark.itemsPerIteration = reader.m_scan.front().GetEvaluatedNum();
+        benchmark.run = [=]()
+        {
+            FileHandler::CEvaluationLogFileHandler fileHandler(*log, fileName, novac::StandardMolecule::SO2);
+            fileHandler.ReadEvaluationLog();
+            Consume(static_cast<double>(fileHandler.m_scan.size()));
+        };
+        benchmarks.push_back(benchmark);
+    }
+}
+
+}
@@ -0,0 +1,187 @@
+#include "Benchmark.h"
+#include <PPPLib/Configuration/NovacPPPConfiguration.h>
+#include <PPPLib/Configuration/UserConfiguration.h>
+#include <PPPLib/Evaluation/ExtendedScanResult.h>
+#include <PPPLib/Flux/FluxCalculator.h>
+#include <PPPLib/Geometry/GeometryCalculator.h>
+#include <PPPLib/Geometry/PlumeHeight.h>
+#include <PPPLib/Meteorology/WindDataBase.h>
+#include <SpectralEvaluation/Flux/PlumeInScanProperty.h>
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+namespace Benchmark
+{
+
+/** The number of spectra in the synthetic scan used to benchmark the flux calculation */
+static const size_t syntheticScanLength = 512;
+
+/** The number of samples used when benchmarking the uncertainty of the flux */
+static const int fluxUncertaintySamples = 1000;
+
+/** The number of pairs of scans in the synthetic geometry calculation */
+static const size_t syntheticPlumePairs = 1000;
+
+/** Creates a configuration with the instrument 2002128M1, used by the measured scans in the test data */
+static std::shared_ptr<Configuration::CNovacPPPConfiguration> CreateConfiguration()
+{
+    Configuration::CInstrumentLocation instrumentLocation;
+    instrumentLocation.m_spectrometerModel = "AVASPEC";
+    instrumentLocation.m_compass = 266.0;
+    instrumentLocation.m_coneangle = 60.0;
+    instrumentLocation.m_altitude = 2700;
+    instrumentLocation.m_validFrom = novac::CDateTime(2020, 1, 1, 0, 0, 0);
+    instrumentLocation.m_validTo = novac::CDateTime(9999, 1, 1, 0, 0, 0);
+
+    Configuration::CInstrumentConfiguration instrumentConfiguration;
+    instrumentConfiguration.m_serial = "2002128M1";
+    instrumentConfiguration.m_location.InsertLocation(instrumentLocation);
+
+    auto configuration = std::make_shared<Configuration::CNovacPPPConfiguration>();
+    configuration->m_instrument.push_back(instrumentConfiguration);
+    return configuration;
+}
+
+/** Creates a scan with a gaussian plume, with the given number of evenly spaced scan angles */
+static std::shared_ptr<Flux::FluxScanData> CreateSyntheticScan(const Flux::FluxScanData& measuredScan, size_t length)
+{
+    auto scanData = std::make_shared<Flux::FluxScanData>();
+    scanData->startTime = measuredScan.startTime;
+    scanData->instrument = measuredScan.instrument;
+    scanData->instrumentType = measuredScan.instrumentType;
+    scanData->location = measuredScan.location;
+    scanData->offset = 0.0;
+
+    for (size_t ii = 0; ii < length; ++ii)
+    {
+        const double scanAngle = -90.0 + 180.0 * static_cast<double>(ii) / static_cast<double>(length - 1);
+        const double column = 1e-4 * std::exp(-(scanAngle - 30.0) * (scanAngle - 30.0) / (2.0 * 15.0 * 15.0));
+
+        scanData->scanAngle.push_back(scanAngle);
+        scanData->scanAngle2.push_back(0.0);
+        scanData->column.push_back(column);
+        scanData->columnError.push_back(1e-6);
+    }
+
+    return scanData;
+}
+
+void AddFluxBenchmarks(const std::string& testDataDirectory, std::vector<BenchmarkCase>& benchmarks)
+{
+    auto log = std::make_shared<QuietLog>();
+    auto userSettings = std::make_shared<Configuration::CUserConfiguration>();
+    userSettings->m_completenessLimitFlux = 0.80;
+    auto configuration = CreateConfiguration();
+    auto fluxCalculator = std::make_shared<Flux::CFluxCalculator>(*log, *configuration, *userSettings);
+
+    // CFluxCalculator::CalculateFlux, on a measured scan and on a synthetic scan with many more spectra
+    Evaluation::CExtendedScanResult evaluationResult;
+    evaluationResult.m_evalLogFile.push_back(testDataDirectory + "2002128M1/2002128M1_230120_1907_0_ReEvaluation.txt");
+    evaluationResult.m_instrumentSerial = "2002128M1";
+    evaluationResult.m_startTime = novac::CDateTime(2023, 1, 20, 19, 07, 00);
+
+    auto measuredScan = std::make_shared<Flux::FluxScanData>();
+    if (!fluxCalculator->PrepareFluxScanData(novac::LogContext(), evaluationResult, *measuredScan))
+    {
+        throw std::invalid_argument("Cannot read evaluation log: " + evaluationResult.m_evalLogFile.front());
+    }
+    auto syntheticScan = CreateSyntheticScan(*measuredScan, syntheticScanLength);
+
+    auto source = Meteorology::MeteorologySource::User;
+    auto windField = std::make_shared<Meteorology::WindField>(10.54, source, 262.3, source, novac::CDateTime(2020, 1, 1, 0, 0, 0), novac::CDateTime(9999, 12, 31, 23, 59, 59), -39.281302, 175.564254, 2700.0);
+    auto plumeHeight = std::make_shared<Geometry::PlumeHeight>();
+    plumeHeight->m_plumeAltitude = 800.0;
+
+    for (auto scanData : { measuredScan, syntheticScan })
+    {
+        BenchmarkCase benchmark;
+        benchmark.name = (scanData == measuredScan) ? "CalculateFlux/2002128M1_230120_1907_0_ReEvaluation" : "CalculateFlux/synthetic_" + std::to_string(syntheticScanLength);
+        benchmark.itemsPerIteration = 1;
+        benchmark.run = [=]()
+        {
+            Consume(fluxCalculator->CalculateFlux(novac::LogContext(), *scanData, *windField, *plumeHeight));
+        };
+        benchmarks.push_back(benchmark);
+    }
+
+    // The complete flux stage, including reading the evaluation log, without and with the sampling of the uncertainty of the flux.
+    //  The time of the latter is reported relative to the former.
+    auto windDataBase = std::make_shared<Meteorology::CWindDataBase>();
+    windDataBase->InsertWindField(Meteorology::WindField(10.54, 2.0, source, 262.3, 10.0, source, novac::CDateTime(2020, 1, 1, 0, 0, 0), novac::CDateTime(9999, 12, 31, 23, 59, 59), -39.281302, 175.564254, 2700.0));
+    auto plumeAltitude = std::make_shared<Geometry::PlumeHeight>();
+    plumeAltitude->m_plumeAltitude = 3500.0;
+    plumeAltitude->m_plumeAltitudeError = 100.0;
+
+    const std::string fluxStageName = "CalculateFlux/stage_2002128M1_230120_1907_0_ReEvaluation";
+    for (int numberOfSamples : { 0, fluxUncertaintySamples })
+    {
+        auto stageUserSettings = std::make_shared<Configuration::CUserConfiguration>(*userSettings);
+        stageUserSettings->m_fluxUncertaintySamples = numberOfSamples;
+        auto stageFluxCalculator = std::make_shared<Flux::CFluxCalculator>(*log, *configuration, *stageUserSettings);
+
+        BenchmarkCase benchmark;
+        benchmark.name = (numberOfSamples == 0) ? fluxStageName : fluxStageName + "_uncertainty_" + std::to_string(numberOfSamples);
+        benchmark.relativeTo = (numberOfSamples == 0) ? "" : fluxStageName;
+        benchmark.itemsPerIteration = 1;
+        benchmark.run = [=]()
+        {
+            // the settings are captured to keep them alive for as long as the calculator
+            Flux::FluxResult fluxResult;
+            stageFluxCalculator->CalculateFlux(novac::LogContext(), evaluationResult, *windDataBase, *plumeAltitude, fluxResult);
+            Consume(fluxResult.m_flux + static_cast<double>(stageUserSettings->m_fluxUncertaintySamples));
+        };
+        benchmarks.push_back(benchmark);
+    }
+
+    // CGeometryCalculator::CalculateGeometry, for two instruments at Ruapehu with a range of plume positions
+    auto geometryCalculator = std::make_shared<Geometry::CGeometryCalculator>(*log, *userSettings);
+
+    auto locations = std::make_shared<std::vector<Configuration::CInstrumentLocation>>(2);
+    (*locations)[0].m_latitude = -39.277528;
+    (*locations)[0].m_longitude = 175.608731;
+    (*locations)[0].m_altitude = 1756;
+    (*locations)[0].m_compass = 266.0;
+    (*locations)[0].m_coneangle = 60.0;
+    (*locations)[0].m_volcano = "ruapehu";
+    (*locations)[1].m_latitude = -39.237137;
+    (*locations)[1].m_longitude = 175.556395;
+    (*locations)[1].m_altitude = 1633;
+    (*locations)[1].m_compass = 172.0;
+    (*locations)[1].m_coneangle = 60.0;
+    (*locations)[1].m_volcano = "ruapehu";
+
+    auto plumes = std::make_shared<std::vector<novac::CPlumeInScanProperty>>(2 * syntheticPlumePairs);
+    for (size_t pairIdx = 0; pairIdx < syntheticPlumePairs; ++pairIdx)
+    {
+        (*plumes)[2 * pairIdx].plumeCenter = -10.0 + 20.0 * static_cast<double>(pairIdx) / syntheticPlumePairs;
+        (*plumes)[2 * pairIdx].plumeCenterError = 2.0;
+        (*plumes)[2 * pairIdx + 1].plumeCenter = -85.0 + 20.0 * static_cast<double>(pairIdx) / syntheticPlumePairs;
+        (*plumes)[2 * pairIdx + 1].plumeCenterError = 2.0;
+    }
+
+    {
+        BenchmarkCase benchmark;
+        benchmark.name = "CalculateGeometry/synthetic_" + std::to_string(syntheticPlumePairs);
+        benchmark.itemsPerIteration = syntheticPlumePairs;
+        benchmark.run = [=]()
+        {
+            const novac::CDateTime startTime1(2023, 01, 20, 15, 16, 30);
+            const novac::CDateTime startTime2(2023, 01, 20, 15, 17, 30);
+            double sum = 0.0;
+            for (size_t pairIdx = 0; pairIdx < syntheticPlumePairs; ++pairIdx)
+            {
+                Geometry::CGeometryResult result;
+                if (geometryCalculator->CalculateGeometry((*plumes)[2 * pairIdx], startTime1, (*plumes)[2 * pairIdx + 1], startTime2, locations->data(), result))
+                {
+                    sum += result.m_plumeAltitude.Value();
+                }
+            }
+            Consume(sum);
+        };
+        benchmarks.push_back(benchmark);
+    }
+}
+
+}
@@ -0,0 +1,121 @@
+#include "Benchmark.h"
+#include <PPPLib/Configuration/UserConfiguration.h>
+#include <PPPLib/Meteorology/WindDataBase.h>
+#include <PPPLib/WindMeasurement/WindSpeedCalculator.h>
+
+#include <cmath>
+#include <memory>
+#include <random>
+
+namespace Benchmark
+{
+
+/** The length, in samples, of the synthetic dual-beam time series. These are sampled once every second. */
+static const size_t dualBeamSeriesLength = 1200;
+
+/** The number of hours of wind fields in the synthetic wind database */
+static const int windDataBaseHours = 24 * 31;
+
+/** The number of wind fields retrieved from the wind database in each iteration */
+static const size_t windFieldQueries = 1000;
+
+using WindSpeedMeasurement::CWindSpeedCalculator;
+
+/** Fills in the given series with a varying column, delayed by the given number of seconds */
+static void FillDualBeamSeries(CWindSpeedCalculator::CMeasurementSeries& series, double delay)
+{
+    for (size_t ii = 0; ii < series.length; ++ii)
+    {
+        const double t = static_cast<double>(ii);
+        series.time[ii] = t;
+        series.column[ii] = 100.0 + 40.0 * std::sin((t - delay) / 17.0) + 25.0 * std::sin((t - delay) / 5.3) + 10.0 * std::cos((t - delay) / 41.0);
+    }
+}
+
+void AddWindBenchmarks(const std::string& /*testDataDirectory*/, std::vector<BenchmarkCase>& benchmarks)
+{
+    auto log = std::make_shared<QuietLog>();
+    auto userSettings = std::make_shared<Configuration::CUserConfiguration>();
+
+    // CWindSpeedCalculator::CalculateDelay, the correlation of two dual-beam time series
+    {
+        auto calculator = std::make_shared<CWindSpeedCalculator>(*log, *userSettings);
+        auto upWind = std::make_shared<CWindSpeedCalculator::CMeasurementSeries>(dualBeamSeriesLength);
+        auto downWind = std::make_shared<CWindSpeedCalculator::CMeasurementSeries>(dualBeamSeriesLength);
+        FillDualBeamSeries(*upWind, 0.0);
+        FillDualBeamSeries(*downWind, 20.0);
+
+        BenchmarkCase benchmark;
+        benchmark.name = "CalculateDelay/synthetic_" + std::to_string(dualBeamSeriesLength);
+        benchmark.itemsPerIteration = 1;
+        benchmark.run = [=]()
+        {
+            double delay = 0.0;
+            calculator->CalculateDelay(delay, upWind.get(), downWind.get(), calculator->m_settings);
+            Consume(delay);
+        };
+        benchmarks.push_back(benchmark);
+    }
+
+    // CWindDataBase::GetWindField, in a database with hourly wind fields at four points around the volcano
+    {
+        auto dataBase = std::make_shared<Meteorology::CWindDataBase>();
+        const auto source = Meteorology::MeteorologySource::User;
+        const double latitudes[] = { -39.0, -39.5 };
+        const double longitudes[] = { 175.5, 176.0 };
+
+        novac::CDateTime validFrom(2023, 1, 1, 0, 0, 0);
+        for (int hour = 0; hour < windDataBaseHours; ++hour)
+        {
+            novac::CDateTime validTo = validFrom;
+            validTo.Increment(3599);
+
+            for (double latitude : latitudes)
+            {
+                for (double longitude : longitudes)
+                {
+                    const double windSpeed = 8.0 + 4.0 * std::sin(hour / 11.0);
+                    const double windDirection = std::fmod(250.0 + hour, 360.0);
+                    dataBase->InsertWindField(Meteorology::WindField(windSpeed, source, windDirection, source, validFrom, validTo, latitude, longitude, 3000.0));
+                }
+            }
+
+            validFrom.Increment(3600);
+        }
+
+        // The times and locations to query are drawn once, such that all iterations do the same work
+        auto queryTimes = std::make_shared<std::vector<novac::CDateTime>>();
+        auto queryLocations = std::make_shared<std::vector<novac::CGPSData>>();
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<int> secondOfMonth(0, windDataBaseHours * 3600 - 1);
+        std::uniform_real_distribution<double> latitude(-39.5, -39.0);
+        std::uniform_real_distribution<double> longitude(175.5, 176.0);
+        for (size_t queryIdx = 0; queryIdx < windFieldQueries; ++queryIdx)
+        {
+            novac::CDateTime time(2023, 1, 1, 0, 0, 0);
+            time.Increment(secondOfMonth(generator));
+            queryTimes->push_back(time);
+            queryLocations->push_back(novac::CGPSData(latitude(generator), longitude(generator), 3000.0));
+        }
+
+        BenchmarkCase benchmark;
+        benchmark.name = "GetWindField/synthetic_" + std::to_string(4 * windDataBaseHours);
+        benchmark.itemsPerIteration = windFieldQueries;
+        benchmark.run = [=]()
+        {
+            double sum = 0.0;
+            Meteorology::WindField windField;
+            for (size_t queryIdx = 0; queryIdx < windFieldQueries; ++queryIdx)
+            {
+                if (dataBase->GetWindField((*queryTimes)[queryIdx], (*queryLocations)[queryIdx], Meteorology::InterpolationMethod::NearestNeighbour, windField))
+                {
+                    sum += windField.GetWindSpeed();
+                }
+            }
+            Consume(sum);
+        };
+        benchmarks.push_back(benchmark);
+    }
+}
+
+}
@@ -0,0 +1,134 @@
+#include "Benchmark.h"
+#include <PPPLib/VolcanoInfo.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+novac::CVolcanoInfo g_volcanoes;   // <-- A list of all known volcanoes
+
+static void PrintUsage()
+{
+    std::cerr << "Usage: PPPBenchmarks [options]" << std::endl;
+    std::cerr << "  --filter <text>          Only run the benchmarks whose name contains the given text" << std::endl;
+    std::cerr << "  --min-time <seconds>     The minimum time to run each benchmark (default 1.0)" << std::endl;
+    std::cerr << "  --min-iterations <n>     The minimum number of iterations of each benchmark (default 5)" << std::endl;
+    std::cerr << "  --output <file>          Also write the results to the given file, to be used as a baseline later" << std::endl;
+    std::cerr << "  --baseline <file>        Compare the results against the results in the given file" << std::endl;
+    std::cerr << "  --tolerance <fraction>   The relative slow-down which counts as a regression (default 0.10)" << std::endl;
+    std::cerr << "  --test-data <directory>  The directory containing the test data (default testData/)" << std::endl;
+    std::cerr << "The results are written to standard output as comma separated values." << std::endl;
+    std::cerr << "The exit code is 1 if any benchmark is slower than in the baseline." << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string filter;
+    double minimumSeconds = 1.0;
+    size_t minimumIterations = 5;
+    std::string outputFile;
+    std::string baselineFile;
+    double tolerance = 0.10;
+#ifdef _MSC_VER
+    std::string testDataDirectory = "../testData/";
+#else
+    std::string testDataDirectory = "testData/";
+#endif // _MSC_VER 
+
+    for (int argIdx = 1; argIdx < argc; ++argIdx)
+    {
+        const bool hasValue = argIdx + 1 < argc;
+        if (0 == strcmp(argv[argIdx], "--filter") && hasValue)
+        {
+            filter = argv[++argIdx];
+        }
+        else if (0 == strcmp(argv[argIdx], "--min-time") && hasValue)
+        {
+            minimumSeconds = std::atof(argv[++argIdx]);
+        }
+        else if (0 == strcmp(argv[argIdx], "--min-iterations") && hasValue)
+        {
+            minimumIterations = static_cast<size_t>(std::atol(argv[++argIdx]));
+        }
+        else if (0 == strcmp(argv[argIdx], "--output") && hasValue)
+        {
+            outputFile = argv[++argIdx];
+        }
+        else if (0 == strcmp(argv[argIdx], "--baseline") && hasValue)
+        {
+            baselineFile = argv[++argIdx];
+        }
+        else if (0 == strcmp(argv[argIdx], "--tolerance") && hasValue)
+        {
+            tolerance = std::atof(argv[++argIdx]);
+        }
+        else if (0 == strcmp(argv[argIdx], "--test-data") && hasValue)
+        {
+            testDataDirectory = argv[++argIdx];
+            if (testDataDirectory.back() != '/' && testDataDirectory.back() != '\\')
+            {
+                testDataDirectory += "/";
+            }
+        }
+        else
+        {
+            PrintUsage();
+            return 2;
+        }
+    }
+
+    try
+    {
+        std::vector<Benchmark::BenchmarkResult> baseline;
+        if (!baselineFile.empty())
+        {
+            baseline = Benchmark::ReadResults(baselineFile);
+        }
+
+        std::vector<Benchmark::BenchmarkCase> benchmarks;
+        Benchmark::AddEvaluationBenchmarks(testDataDirectory, benchmarks);
+        Benchmark::AddFluxBenchmarks(testDataDirectory, benchmarks);
+        Benchmark::AddWindBenchmarks(testDataDirectory, benchmarks);
+
+        std::vector<Benchmark::BenchmarkResult> results;
+        for (const Benchmark::BenchmarkCase& benchmark : benchmarks)
+        {
+            if (!filter.empty() && benchmark.name.find(filter) == std::string::npos)
+            {
+                continue;
+            }
+
+            std::cerr << "Running " << benchmark.name << std::endl;
+            results.push_back(Benchmark::Run(benchmark, minimumSeconds, minimumIterations));
+        }
+
+        const size_t numberOfRegressions = Benchmark::WriteResults(std::cout, results, baselineFile.empty() ? nullptr : &baseline, tolerance);
+        Benchmark::WriteRelativeTimes(std::cerr, results);
+
+        if (!outputFile.empty())
+        {
+            std::ofstream output(outputFile);
+            if (!output.is_open())
+            {
+                std::cerr << "Cannot write to " << outputFile << std::endl;
+                return 2;
+            }
+            Benchmark::WriteResults(output, results, nullptr, tolerance);
+        }
+
+        if (numberOfRegressions > 0)
+        {
+            std::cerr << numberOfRegressions << " benchmark(s) are slower than the baseline" << std::endl;
+            return 1;
+        }
+    }
+    catch (std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 2;
+    }
+
+    return 0;
+}
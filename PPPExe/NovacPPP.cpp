@@ -11,9 +11,12 @@
 #include <PPPLib/File/SetupFileReader.h>
 #include <PPPLib/File/EvaluationConfigurationParser.h>
 #include <PPPLib/File/ProcessingFileReader.h>
+#include <PPPLib/ParallelFor.h>
+#include <PPPLib/TraceRecorder.h>
 #include "PostProcessing.h"
 
 #include <algorithm>
+#include <exception>
 #include <iostream>
 #include <sstream>
 #include <thread>
@@ -59,9 +62,10 @@ static void ReadSetupXml(const std::string& workDir, Configuration::CNovacPPPCon
 
 static void ReadEvaluationXmlFile(
     const novac::CString& workDir,
-    FileHandler::CEvaluationConfigurationParser& eval_reader,
     Configuration::CInstrumentConfiguration& instrument)
 {
+    FileHandler::CEvaluationConfigurationParser eval_reader{ g_logger };
+
     novac::CString evalConfPath;
     evalConfPath.Format("%sconfiguration%c%s.exml", (const char*)workDir, Poco::Path::separator(), (const char*)instrument.m_serial);
 
@@ -89,12 +93,13 @@ static void LoadConfigurations(
 
     ReadProcessingXml(workDir, userSettings);
 
-    // Check if there is a configuration file for every spectrometer serial number
-    FileHandler::CEvaluationConfigurationParser eval_reader{ g_logger };
-    for (size_t k = 0; k < configuration.NumberOfInstruments(); ++k)
-    {
-        ReadEvaluationXmlFile(workDir, eval_reader, configuration.m_instrument[k]);
-    }
+    // Check if there is a configuration file for every spectrometer serial number.
+    //  The files are independent of each other and are read in parallel.
+    //  The first error, in the order of the instruments, is reported.
+    novac::ParallelFor(configuration.NumberOfInstruments(), userSettings.m_maxThreadNum, [&](size_t k)
+        {
+            ReadEvaluationXmlFile(workDir, configuration.m_instrument[k]);
+        });
 }
 
 static void ArchiveSettingsFiles(const Configuration::CUserConfiguration& userSettings)
@@ -168,6 +173,10 @@ static void CalculateAllFluxes(CContinuationOfProcessing continuation, Configura
             ShowMessage("Warning: Post processing of stratospheric measurements is not yet fully implemented");
             post.DoPostProcessing_Strat();
         }
+        else if (userSettings.m_processingMode == ProcessingMode::FluxSensitivity)
+        {
+            post.DoPostProcessing_FluxSensitivity();
+        }
         else
         {
             post.DoPostProcessing_Flux();
@@ -210,11 +219,38 @@ static void StartProcessing(Configuration::CUserConfiguration& userSettings)
         }
     }
 
+    // All parallel sections of the processing share the same number of threads.
+    //  Notice that the threads started internally by SpectralEvaluation (e.g. in the wavelength calibration) are not counted here.
+    novac::CThreadBudget::SetMaxThreadNum(userSettings.m_maxThreadNum);
+
     CContinuationOfProcessing continuation(userSettings);
 
+    if (userSettings.m_writeProcessingTrace)
+    {
+        novac::CTraceRecorder::Start();
+    }
+
     // Run
     std::thread postProcessingThread(CalculateAllFluxes, continuation, std::ref(userSettings));
     postProcessingThread.join();
+
+    // Write the timeline of the processing, also if the processing failed.
+    if (userSettings.m_writeProcessingTrace)
+    {
+        novac::CTraceRecorder::Stop();
+
+        novac::CString traceFileName;
+        traceFileName.Format("%s%cProcessingTrace.json", (const char*)userSettings.m_outputDirectory, Poco::Path::separator());
+        Common::ArchiveFile(traceFileName);
+        if (novac::CTraceRecorder::WriteToFile(traceFileName.std_str()))
+        {
+            ShowMessage(novac::CString::FormatString("Wrote timeline of the processing to %s", traceFileName.c_str()));
+        }
+        else
+        {
+            ShowError(novac::CString::FormatString("Failed to write timeline of the processing to %s", traceFileName.c_str()));
+        }
+    }
 }
 
 class NovacPPPApplication : public Poco::Util::Application
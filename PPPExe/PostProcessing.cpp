@@ -4,15 +4,22 @@
 #include <SpectralEvaluation/File/File.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <condition_variable>
 #include <functional>
+#include <limits>
 #include <list>
+#include <map>
+#include <mutex>
 #include <sstream>
 #include <thread>
 
 #include <PPPLib/PostProcessingUtils.h>
+#include <PPPLib/Configuration/ConfigurationWatcher.h>
 
 // the PostEvaluationController takes care of the DOAS evaluations
+#include <PPPLib/Evaluation/FitWindowCache.h>
 #include <PPPLib/Evaluation/PostEvaluationController.h>
 
 // The PostCalibration takes care of the instrument calibrations.
@@ -21,6 +28,8 @@
 
 // The FluxCalculator takes care of calculating the fluxes
 #include <PPPLib/Flux/FluxCalculator.h>
+#include <PPPLib/Flux/FluxResultWriter.h>
+#include <PPPLib/Flux/FluxSensitivity.h>
 
 // The Stratospherecalculator takes care of calculating Stratospheric VCD's
 #include "Stratosphere/StratosphereCalculator.h"
@@ -43,9 +52,13 @@
 
 // we need to be able to download data from the FTP-server
 #include <PPPLib/Communication/FTPServerConnection.h>
+#include <PPPLib/BoundedQueue.h>
+#include <PPPLib/ParallelFor.h>
+#include <PPPLib/TraceRecorder.h>
 
 #include <Poco/DirectoryIterator.h>
 #include <Poco/Exception.h>
+#include <Poco/File.h>
 
 #undef min
 #undef max
@@ -58,10 +71,12 @@ using namespace novac;
 // this is the working-thread that takes care of evaluating a portion of the scans
 void EvaluateScansThread(
     ILogger& log,
-    const Configuration::CNovacPPPConfiguration& setup,
+    const Configuration::CConfigurationWatcher& configuration,
     const Configuration::CUserConfiguration& userSettings,
     const CContinuationOfProcessing& continuation,
-    CPostProcessingStatistics& processingStats);
+    CPostProcessingStatistics& processingStats,
+    Evaluation::CFitWindowCache& fitWindowCache,
+    novac::BoundedQueue<std::string>& scansToEvaluate);
 
 CPostProcessing::CPostProcessing(ILogger& logger, Configuration::CNovacPPPConfiguration setup, Configuration::CUserConfiguration userSettings, const CContinuationOfProcessing& continuation)
     : m_plumeDataBase(userSettings), m_log(logger), m_setup(setup), m_userSettings(userSettings), m_continuation(continuation)
@@ -69,8 +84,14 @@ CPostProcessing::CPostProcessing(ILogger& logger, Configuration::CNovacPPPConfig
     assert(m_setup.m_executableDirectory.size() > 3); // This should be set
 }
 
-static void CheckForSpectraOnFTPServer(novac::ILogger& log, novac::LogContext context, const Configuration::CUserConfiguration& userSettings, std::vector<std::string>& fileList)
+/** Downloads the .pak files from the FTP server. Each downloaded file is reported through 'onFileDownloaded' as soon as it is ready. */
+static void CheckForSpectraOnFTPServer(
+    novac::ILogger& log,
+    novac::LogContext context,
+    const Configuration::CUserConfiguration& userSettings,
+    std::function<void(const std::string&)> onFileDownloaded)
 {
+    novac::CTraceScope trace("stage", "DownloadFromFtp");
     Communication::CFTPServerConnection serverDownload(log, userSettings);
 
     int ret = serverDownload.DownloadDataFromFTP(
@@ -78,7 +99,7 @@ static void CheckForSpectraOnFTPServer(novac::ILogger& log, novac::LogContext co
         userSettings.m_FTPDirectory,
         userSettings.m_FTPUsername,
         userSettings.m_FTPPassword,
-        fileList);
+        onFileDownloaded);
 
     if (ret == 0)
     {
@@ -90,40 +111,81 @@ static void CheckForSpectraOnFTPServer(novac::ILogger& log, novac::LogContext co
     }
 }
 
-static std::vector<std::string> LocatePakFiles(novac::ILogger& log, novac::LogContext context, const Configuration::CUserConfiguration& userSettings)
+/** Searches the local directory for .pak files. The files found are reported through the
+    callback as soon as each directory has been searched, such that they can be processed while the search continues.
+    @return the number of .pak files found. */
+static size_t LocateLocalPakFiles(
+    novac::ILogger& log,
+    novac::LogContext context,
+    const Configuration::CUserConfiguration& userSettings,
+    std::function<void(std::vector<std::string>&)> onFilesFound)
 {
-    std::vector<std::string> pakFileList;
+    if (userSettings.m_LocalDirectory.size() <= 3)
+    {
+        return 0;
+    }
+
+    novac::CTraceScope trace("stage", "LocateLocalPakFiles");
+    novac::LogContext localContext = context.With(novac::LogContext::Directory, userSettings.m_LocalDirectory);
+    log.Information(localContext, "Searching for .pak files");
 
-    if (userSettings.m_LocalDirectory.size() > 3)
+    Filesystem::FileSearchCriterion limits;
+    limits.fileExtension = ".pak";
+    if (userSettings.m_useFilenamePatternMatching_Local)
     {
-        novac::LogContext localContext = context.With(novac::LogContext::Directory, userSettings.m_LocalDirectory);
-        log.Information(localContext, "Searching for .pak files");
+        limits.startTime = userSettings.m_fromDate;
+        limits.endTime = userSettings.m_toDate;
 
-        Filesystem::FileSearchCriterion limits;
-        limits.fileExtension = ".pak";
-        if (userSettings.m_useFilenamePatternMatching_Local)
-        {
-            limits.startTime = userSettings.m_fromDate;
-            limits.endTime = userSettings.m_toDate;
-        }
-        else
+        // Scans outside of the processed interval are rejected anyway, hence there is no need to
+        //  search through directories named after a day outside of the interval.
+        limits.directoryStartTime = userSettings.m_fromDate;
+        limits.directoryEndTime = userSettings.m_toDate;
+    }
+    else
+    {
+        // The names of the files and directories are not trusted, search through all of them.
+        limits.startTime = CDateTime::MinValue();
+        limits.endTime = CDateTime::MinValue();
+    }
+
+    const size_t numberOfFilesFound = Filesystem::SearchDirectoryForFilesInParallel(
+        userSettings.m_LocalDirectory,
+        userSettings.m_includeSubDirectories_Local,
+        &limits,
+        static_cast<unsigned int>(userSettings.m_maxThreadNum),
+        onFilesFound);
+
+    std::stringstream msg;
+    msg << numberOfFilesFound << " .pak files found";
+    log.Information(localContext, msg.str());
+
+    return numberOfFilesFound;
+}
+
+static std::vector<std::string> LocatePakFiles(novac::ILogger& log, novac::LogContext context, const Configuration::CUserConfiguration& userSettings)
+{
+    std::vector<std::string> pakFileList;
+
+    std::mutex pakFileListGuard;
+    LocateLocalPakFiles(log, context, userSettings, [&](std::vector<std::string>& files)
         {
-            limits.startTime = CDateTime::MinValue();
-            limits.endTime = CDateTime::MinValue();
-        }
-        Filesystem::SearchDirectoryForFiles(userSettings.m_LocalDirectory, userSettings.m_includeSubDirectories_Local, pakFileList, &limits);
+            std::lock_guard<std::mutex> lock(pakFileListGuard);
+            pakFileList.insert(pakFileList.end(), files.begin(), files.end());
+        });
 
-        std::stringstream msg;
-        msg << pakFileList.size() << " .pak files found";
-        log.Information(localContext, msg.str());
-    }
+    // The directories are searched in parallel, sort the result to get a reproducible order of the files.
+    std::sort(begin(pakFileList), end(pakFileList));
 
     if (userSettings.m_FTPDirectory.size() > 9)
     {
         novac::LogContext localContext = context.With("ftpDirectory", userSettings.m_FTPDirectory);
         log.Information(localContext, "Searching for .pak files on Ftp server");
 
-        CheckForSpectraOnFTPServer(log, localContext, userSettings, pakFileList);
+        CheckForSpectraOnFTPServer(log, localContext, userSettings, [&](const std::string& fileName)
+            {
+                std::lock_guard<std::mutex> lock(pakFileListGuard);
+                pakFileList.push_back(fileName);
+            });
     }
 
     return pakFileList;
@@ -131,6 +193,7 @@ static std::vector<std::string> LocatePakFiles(novac::ILogger& log, novac::LogCo
 
 void CPostProcessing::DoPostProcessing_Flux()
 {
+    novac::CTraceScope trace("stage", "DoPostProcessing_Flux");
     std::vector<Evaluation::CExtendedScanResult> evaluatedScanResult;
     novac::CString messageToUser, windFileName;
 
@@ -152,23 +215,23 @@ void CPostProcessing::DoPostProcessing_Flux()
 
     if (m_userSettings.m_doEvaluations)
     {
-        // Prepare for the evaluation by reading in the reference files
-        PrepareEvaluation(m_log, m_userSettings.m_tempDirectory.std_str(), m_setup);
+        // The reference files are read by the evaluation threads, the first time each fit window is needed.
+        if (m_setup.m_instrument.size() == 0)
+        {
+            throw std::invalid_argument("No instruments were configured.");
+        }
 
-        // 1. Find all .pak files in the directory.
-        m_log.Information(context, "--- Locating Pak Files --- ");
+        // 1. Find all .pak files in the directory and evaluate the scans as they are found.
+        //  This at the same time generates a list of evaluation-log files with the evaluated results
+        m_log.Information(context, "--- Locating Pak Files and Running Evaluations --- ");
 
-        const std::vector<std::string> pakFileList = LocatePakFiles(m_log, context, m_userSettings);
-        if (pakFileList.size() == 0)
+        const size_t numberOfPakFiles = LocateAndEvaluateScans(context, evaluatedScanResult);
+        if (numberOfPakFiles == 0)
         {
             m_log.Information(context, "No spectrum files found. Exiting");
             return;
         }
 
-        // Evaluate the scans. This at the same time generates a list of evaluation-log
-        // files with the evaluated results
-        m_log.Information(context, "--- Running Evaluations --- ");
-        EvaluateScans(pakFileList, evaluatedScanResult);
         messageToUser.Format("%d evaluation log files accepted", evaluatedScanResult.size());
         m_log.Information(context, messageToUser.std_str());
     }
@@ -181,7 +244,10 @@ void CPostProcessing::DoPostProcessing_Flux()
     // Sort the evaluation-logs in order of increasing start-time, this to make
     // the looking for matching files in 'CalculateGeometries' faster
     m_log.Information("Evaluation done. Sorting the evaluation results");
-    SortEvaluationLogs(evaluatedScanResult);
+    {
+        novac::CTraceScope sortTrace("stage", "SortEvaluationLogs");
+        SortEvaluationLogs(evaluatedScanResult);
+    }
     m_log.Information(context, "Sort done.");
 
     // 3. Loop through list with output text files from evaluation and calculate the geometries
@@ -202,6 +268,7 @@ void CPostProcessing::DoPostProcessing_Flux()
     CalculateFluxes(context, evaluatedScanResult);
 
     // 7. Write the statistics
+    novac::CTraceScope writeTrace("stage", "WriteResults");
     novac::CString statFileName;
     statFileName.Format("%s%cProcessingStatistics.txt", (const char*)m_userSettings.m_outputDirectory, Poco::Path::separator());
     Common::ArchiveFile(statFileName);
@@ -257,8 +324,7 @@ void CPostProcessing::DoPostProcessing_InstrumentCalibration()
     novac::CPostCalibration calibrationController{ standardCrossSections, m_setup, m_userSettings, m_log };
     novac::CPostCalibrationStatistics calibrationStatistics;
 
-    // Unlike other parts of the NovacPPP, this function is intended to be single threaded. The reason for this is that the
-    //  classes which are called upon are strongly threaded themselves and further threading will not help the performance.
+    // The instruments are calibrated in parallel, the calibrations of each instrument are done in order.
     int numberOfCalibrations = calibrationController.RunInstrumentCalibration(pakFileList, calibrationStatistics);
 
     {
@@ -281,8 +347,11 @@ void CPostProcessing::DoPostProcessing_Strat()
     // Checks that the evaluation is ok and that all settings makes sense.
     CheckProcessingSettings();
 
-    // Prepare for the evaluation by reading in the reference files
-    PrepareEvaluation(m_log, m_userSettings.m_tempDirectory.std_str(), m_setup);
+    // The reference files are read by the evaluation threads, the first time each fit window is needed.
+    if (m_setup.m_instrument.size() == 0)
+    {
+        throw std::invalid_argument("No instruments were configured.");
+    }
 
     // --------------- DOING THE PROCESSING -----------
 
@@ -316,66 +385,317 @@ void CPostProcessing::DoPostProcessing_Strat()
     m_processingStats.WriteStatToFile(statFileName);
 }
 
-novac::GuardedList<std::string> s_pakFilesRemaining;
 novac::GuardedList<Evaluation::CExtendedScanResult> s_evalLogs;
 
-volatile size_t s_nFilesToProcess;
+std::atomic<size_t> s_nFilesToProcess;
+
+void CPostProcessing::DoPostProcessing_FluxSensitivity()
+{
+    novac::LogContext context("mode", "fluxSensitivity");
+
+    m_log.Information(context, "--- Prepairing to perform Flux Sensitivity Calculations --- ");
+
+    // Checks that the evaluation is ok and that all settings makes sense.
+    CheckProcessingSettings();
+
+    // The nominal wind-field and plume heights
+    ReadWindField(context);
+    PreparePlumeHeights(context);
+
+    // The fluxes are calculated from the evaluation logs of an earlier run
+    std::vector<Evaluation::CExtendedScanResult> evaluatedScanResult = LocateEvaluationLogFiles(context, m_userSettings.m_outputDirectory.std_str());
+    SortEvaluationLogs(evaluatedScanResult);
+
+    // Calculate the geometries and the dual-beam wind speeds in the same way as in the flux mode,
+    //  such that the fluxes of the nominal wind-field and plume heights are the same as in the flux mode.
+    std::vector<Geometry::CGeometryResult> geometryResults;
+    CalculateGeometries(context, evaluatedScanResult, geometryResults);
+    InsertCalculatedGeometriesIntoDatabase(context, geometryResults);
+    CalculateDualBeamWindSpeeds(context, evaluatedScanResult);
+
+    // Read the alternative wind fields
+    std::vector<Meteorology::CWindDataBase> alternativeWindFields(m_userSettings.m_fluxSensitivityWindFields.size());
+    FileHandler::CXMLWindFileReader reader{ m_log, m_userSettings };
+    for (size_t windFieldIdx = 0; windFieldIdx < m_userSettings.m_fluxSensitivityWindFields.size(); ++windFieldIdx)
+    {
+        const std::string& windFieldPath = m_userSettings.m_fluxSensitivityWindFields[windFieldIdx];
+        auto fileContext = context.With(novac::LogContext::FileName, windFieldPath);
+        m_log.Information(fileContext, "Reading alternative wind field");
+
+        if (Equals(novac::CString(windFieldPath).Right(5), ".wxml"))
+        {
+            reader.ReadWindFile(fileContext, windFieldPath, alternativeWindFields[windFieldIdx]);
+        }
+        else
+        {
+            reader.ReadWindDirectory(fileContext, windFieldPath, alternativeWindFields[windFieldIdx], &m_userSettings.m_fromDate, &m_userSettings.m_toDate);
+        }
+    }
+
+    // The variants are all combinations of the wind fields and plume altitudes
+    std::vector<const Meteorology::CWindDataBase*> windFields{ &m_windDataBase };
+    std::vector<std::string> windFieldNames{ "nominal" };
+    for (size_t windFieldIdx = 0; windFieldIdx < alternativeWindFields.size(); ++windFieldIdx)
+    {
+        windFields.push_back(&alternativeWindFields[windFieldIdx]);
+        windFieldNames.push_back(m_userSettings.m_fluxSensitivityWindFields[windFieldIdx]);
+    }
+    std::vector<double> plumeAltitudes{ std::numeric_limits<double>::quiet_NaN() };
+    plumeAltitudes.insert(plumeAltitudes.end(), m_userSettings.m_fluxSensitivityPlumeAltitudes.begin(), m_userSettings.m_fluxSensitivityPlumeAltitudes.end());
+
+    std::vector<Flux::FluxSensitivityVariant> variants;
+    for (size_t windFieldIdx = 0; windFieldIdx < windFields.size(); ++windFieldIdx)
+    {
+        for (double plumeAltitude : plumeAltitudes)
+        {
+            Flux::FluxSensitivityVariant variant;
+            variant.windFieldName = windFieldNames[windFieldIdx];
+            variant.windField = windFields[windFieldIdx];
+            variant.plumeAltitude = plumeAltitude;
+            variants.push_back(variant);
+        }
+    }
+
+    // Read the evaluation logs once and calculate the fluxes of all variants
+    Flux::CFluxSensitivityCalculator sensitivityCalculator{ m_log, m_setup, m_userSettings };
+
+    m_log.Information(context, "--- Reading Evaluation Logs --- ");
+    const std::vector<Flux::FluxScanData> scans = sensitivityCalculator.PrepareScans(context, evaluatedScanResult);
+
+    {
+        novac::CString messageToUser;
+        messageToUser.Format("Calculating fluxes of %d scans for %d combinations of wind field and plume altitude", static_cast<int>(scans.size()), static_cast<int>(variants.size()));
+        m_log.Information(context, messageToUser.std_str());
+    }
+    const std::vector<double> fluxes = sensitivityCalculator.CalculateFluxes(context, scans, variants, m_plumeDataBase);
+
+    novac::CString fileName;
+    fileName.Format("%s%cFluxSensitivity.txt", (const char*)m_userSettings.m_outputDirectory, Poco::Path::separator());
+    Common::ArchiveFile(fileName);
+    if (!Flux::CFluxSensitivityCalculator::WriteFluxes(fileName.std_str(), scans, variants, fluxes))
+    {
+        m_log.Error(context, "Failed to write the flux sensitivity file: " + fileName.std_str());
+    }
+}
 
 void CPostProcessing::EvaluateScans(
     const std::vector<std::string>& pakFileList,
     std::vector<Evaluation::CExtendedScanResult>& evalLogFiles)
 {
-    s_nFilesToProcess = pakFileList.size();
     novac::CString messageToUser;
 
-    // share the list of pak-files with the other functions around here
-    for (const std::string& file : pakFileList)
+    // Keep the user informed about what we're doing
+    messageToUser.Format("%ld spectrum files found. Begin evaluation using %d threads.", pakFileList.size(), m_userSettings.m_maxThreadNum);
+    m_log.Information(messageToUser.std_str());
+
+    RunEvaluationThreads([&](const std::function<void(const std::string&)>& queueForEvaluation)
+        {
+            for (const std::string& file : pakFileList)
+            {
+                queueForEvaluation(file);
+            }
+        },
+        evalLogFiles);
+}
+
+size_t CPostProcessing::LocateAndEvaluateScans(
+    novac::LogContext context,
+    std::vector<Evaluation::CExtendedScanResult>& evalLogFiles)
+{
+    novac::CString messageToUser;
+    messageToUser.Format("Begin evaluation using %d threads while searching for spectrum files.", m_userSettings.m_maxThreadNum);
+    m_log.Information(messageToUser.std_str());
+
+    RunEvaluationThreads([&](const std::function<void(const std::string&)>& queueForEvaluation)
+        {
+            LocateLocalPakFiles(m_log, context, m_userSettings, [&](std::vector<std::string>& files)
+                {
+                    for (const std::string& file : files)
+                    {
+                        queueForEvaluation(file);
+                    }
+                });
+
+            if (m_userSettings.m_FTPDirectory.size() > 9)
+            {
+                novac::LogContext localContext = context.With("ftpDirectory", m_userSettings.m_FTPDirectory);
+                m_log.Information(localContext, "Searching for .pak files on Ftp server");
+
+                // Each file is evaluated as soon as it has been downloaded.
+                CheckForSpectraOnFTPServer(m_log, localContext, m_userSettings, queueForEvaluation);
+            }
+        },
+        evalLogFiles);
+
+    return s_nFilesToProcess;
+}
+
+/** @return the size of the given file in bytes, or zero if this cannot be determined. */
+static size_t GetFileSize(const std::string& fileName)
+{
+    try
     {
-        s_pakFilesRemaining.AddItem(file);
+        return static_cast<size_t>(Poco::File(fileName).getSize());
     }
+    catch (Poco::Exception&)
+    {
+        return 0;
+    }
+}
 
-    // Keep the user informed about what we're doing
-    messageToUser.Format("%ld spectrum files found. Begin evaluation using %d threads.", s_nFilesToProcess, m_userSettings.m_maxThreadNum);
-    m_log.Information(messageToUser.std_str());
+/** Closes the queue of scans to evaluate and waits for the evaluation threads to finish,
+    at the latest when leaving the scope, such that the threads are also joined if the search for files fails. */
+class CEvaluationThreadsJoiner
+{
+public:
+    CEvaluationThreadsJoiner(novac::BoundedQueue<std::string>& queue, std::vector<std::thread>& threads)
+        : m_queue(queue), m_threads(threads)
+    {
+    }
+
+    ~CEvaluationThreadsJoiner()
+    {
+        Join();
+    }
+
+    CEvaluationThreadsJoiner(const CEvaluationThreadsJoiner&) = delete;
+    CEvaluationThreadsJoiner& operator=(const CEvaluationThreadsJoiner&) = delete;
+
+    /** Closes the queue, the threads finish the scans already queued, and waits for all the threads to finish. */
+    void Join()
+    {
+        m_queue.Close();
+        for (std::thread& t : m_threads)
+        {
+            if (t.joinable())
+            {
+                t.join();
+            }
+        }
+    }
+
+private:
+    novac::BoundedQueue<std::string>& m_queue;
+    std::vector<std::thread>& m_threads;
+};
+
+void CPostProcessing::RunEvaluationThreads(
+    std::function<void(const std::function<void(const std::string&)>&)> locatePakFiles,
+    std::vector<Evaluation::CExtendedScanResult>& evalLogFiles)
+{
+    novac::CTraceScope trace("stage", "EvaluateScans");
+    novac::CString messageToUser;
+    s_nFilesToProcess = 0;
+
+    // The files found are handed to the evaluation threads through a bounded queue, such that the search for
+    //  and download of files pauses while too many scans are waiting for evaluation.
+    const size_t maxBytesInFlight = static_cast<size_t>(m_userSettings.m_maxMegabytesInFlight) * 1048576;
+    novac::BoundedQueue<std::string> scansToEvaluate{ static_cast<size_t>(m_userSettings.m_maxScansInFlight), maxBytesInFlight };
+
+    // The references of the fit windows are read when first needed, and released again when no longer needed.
+    novac::directorySetup directories;
+    directories.tempDirectory = m_userSettings.m_tempDirectory.std_str();
+    directories.executableDirectory = m_setup.m_executableDirectory;
+    Evaluation::CFitWindowCache fitWindowCache{ m_log, directories };
+
+    // The configuration may be corrected while the scans are evaluated, each scan uses the configuration current when its evaluation starts.
+    Configuration::CConfigurationWatcher configuration{ m_log, m_setup.m_executableDirectory + "configuration", m_setup };
+    if (m_userSettings.m_configurationReloadInterval > 0)
+    {
+        configuration.Start(m_userSettings.m_configurationReloadInterval);
+    }
+
+    // The evaluation threads reserve their share of the thread budget. When the spectra of each scan are evaluated in parallel,
+    //  the remaining budget is left to the evaluation of the spectra, otherwise the parallel sections within the evaluation
+    //  of a scan run on the evaluation thread itself instead of starting further threads.
+    const unsigned long evalThreadNum = std::max(1UL, m_userSettings.m_maxThreadNum / std::max(1UL, m_userSettings.m_spectrumThreadNum));
+    novac::CThreadReservation evalThreadsReservation(evalThreadNum);
 
     // start the threads
-    std::vector<std::thread> evalThreads(m_userSettings.m_maxThreadNum);
-    for (unsigned int threadIdx = 0; threadIdx < m_userSettings.m_maxThreadNum; ++threadIdx)
+    std::vector<std::thread> evalThreads(evalThreadNum);
+    CEvaluationThreadsJoiner evalThreadsJoiner{ scansToEvaluate, evalThreads };
+    for (unsigned int threadIdx = 0; threadIdx < evalThreadNum; ++threadIdx)
     {
-        std::thread t(EvaluateScansThread, std::ref(m_log), std::cref(m_setup), std::cref(m_userSettings), std::cref(m_continuation), std::ref(m_processingStats));
+        std::thread t(EvaluateScansThread, std::ref(m_log), std::cref(configuration), std::cref(m_userSettings), std::cref(m_continuation), std::ref(m_processingStats), std::ref(fitWindowCache), std::ref(scansToEvaluate));
         evalThreads[threadIdx] = std::move(t);
     }
 
+    // feed the evaluation threads with files while they are running
+    locatePakFiles([&](const std::string& pakFileName)
+        {
+            ++s_nFilesToProcess;
+            scansToEvaluate.Push(pakFileName, GetFileSize(pakFileName));
+        });
+
     // make sure that all threads have time to finish before we say that we're ready
-    for (unsigned int threadIdx = 0; threadIdx < m_userSettings.m_maxThreadNum; ++threadIdx)
+    evalThreadsJoiner.Join();
+
+    // The following steps (e.g. the flux calculations) use the latest configuration.
+    configuration.Stop();
+    if (m_userSettings.m_configurationReloadInterval > 0)
     {
-        evalThreads[threadIdx].join();
+        m_setup = *configuration.Current();
     }
 
     // copy out the result
     s_evalLogs.CopyTo(evalLogFiles);
 
-    messageToUser.Format("All %ld scans evaluated. Final number of results: %ld", s_nFilesToProcess, evalLogFiles.size());
+    messageToUser.Format("All %ld scans evaluated. Final number of results: %ld", s_nFilesToProcess.load(), evalLogFiles.size());
     m_log.Information(messageToUser.std_str());
 }
 
+/** Releases the place of a scan in the queue of scans to evaluate when the evaluation of it is done, whatever the outcome. */
+class CScanInFlight
+{
+public:
+    CScanInFlight(novac::BoundedQueue<std::string>& queue, size_t bytes)
+        : m_queue(queue), m_bytes(bytes)
+    {
+    }
+
+    ~CScanInFlight()
+    {
+        m_queue.Release(m_bytes);
+    }
+
+    CScanInFlight(const CScanInFlight&) = delete;
+    CScanInFlight& operator=(const CScanInFlight&) = delete;
+
+private:
+    novac::BoundedQueue<std::string>& m_queue;
+    const size_t m_bytes;
+};
+
 void EvaluateScansThread(
     ILogger& log,
-    const Configuration::CNovacPPPConfiguration& setup,
+    const Configuration::CConfigurationWatcher& configuration,
     const Configuration::CUserConfiguration& userSettings,
     const CContinuationOfProcessing& continuation,
-    CPostProcessingStatistics& processingStats)
+    CPostProcessingStatistics& processingStats,
+    Evaluation::CFitWindowCache& fitWindowCache,
+    novac::BoundedQueue<std::string>& scansToEvaluate)
 {
     std::string pakFileName;
+    size_t pakFileSize = 0;
 
-    // create a new CPostEvaluationController
-    Evaluation::CPostEvaluationController eval{ log, setup, userSettings, continuation, processingStats };
+    // The CPostEvaluationController is created again each time the configuration has been reloaded
+    std::shared_ptr<const Configuration::CNovacPPPConfiguration> setup;
+    std::unique_ptr<Evaluation::CPostEvaluationController> eval;
 
     // while there are more .pak-files
-    while (s_pakFilesRemaining.PopFront(pakFileName))
+    while (scansToEvaluate.Pop(pakFileName, pakFileSize))
     {
+        CScanInFlight scanInFlight{ scansToEvaluate, pakFileSize };
+        novac::CTraceScope trace("evaluation", "EvaluateScan", pakFileName);
         novac::LogContext context(novac::LogContext::FileName, novac::GetFileName(pakFileName));
 
+        std::shared_ptr<const Configuration::CNovacPPPConfiguration> currentSetup = configuration.Current();
+        if (currentSetup != setup)
+        {
+            setup = currentSetup;
+            eval.reset(new Evaluation::CPostEvaluationController{ log, *setup, userSettings, continuation, processingStats, &fitWindowCache });
+        }
+
         // Verify that the scan file is readable and that the scan started in the time interval set.
         CScanFileHandler scan(log);
         if (!scan.CheckScanFile(context, pakFileName))
@@ -406,7 +726,7 @@ void EvaluateScansThread(
         {
             for (size_t fitWindowIndex = 0; fitWindowIndex < userSettings.m_nFitWindowsToUse; ++fitWindowIndex)
             {
-                auto result = eval.EvaluateScan(pakFileName, userSettings.m_fitWindowsToUse[fitWindowIndex]);
+                auto result = eval->EvaluateScan(pakFileName, userSettings.m_fitWindowsToUse[fitWindowIndex]);
 
                 if (result == nullptr)
                 {
@@ -560,6 +880,7 @@ void CPostProcessing::CheckProcessingSettings() const
 
 void CPostProcessing::ReadWindField(novac::LogContext context)
 {
+    novac::CTraceScope trace("stage", "ReadWindField");
     if (m_userSettings.m_volcano < 0)
     {
         throw std::invalid_argument("Volcano index has not been set when attempting to read wid field.");
@@ -651,6 +972,7 @@ void CPostProcessing::ReadWindField(novac::LogContext context)
 
 void CPostProcessing::PreparePlumeHeights(novac::LogContext context)
 {
+    novac::CTraceScope trace("stage", "PreparePlumeHeights");
     const unsigned int volcanoIndex = static_cast<unsigned int>(m_userSettings.m_volcano);
 
     // we need to construct a default plume height to use, if there's nothing else...
@@ -698,6 +1020,7 @@ void CPostProcessing::CalculateGeometries(
     std::vector<Evaluation::CExtendedScanResult>& scanResults,
     std::vector<Geometry::CGeometryResult>& geometryResults)
 {
+    novac::CTraceScope trace("stage", "CalculateGeometries");
     novac::CString messageToUser;
     unsigned long nFilesChecked1 = 0; // this is for debugging purposes...
     unsigned long nFilesChecked2 = 0; // this is for debugging purposes...
@@ -792,6 +1115,7 @@ void CPostProcessing::CalculateGeometries(
 
             // count the number of times we calculate a result, for improving the software...
             ++nCalculationsMade;
+            novac::CTraceScope pairTrace("geometry", "CalculateGeometry");
 
             // If the files have passed these tests then make a geometry-calculation
             Geometry::CGeometryResult result;
@@ -872,6 +1196,7 @@ void CPostProcessing::CalculateGeometries(
             }
 
             // Try to calculate the wind-direction
+            novac::CTraceScope windDirectionTrace("geometry", "CalculateWindDirection");
             Geometry::CGeometryResult result;
             Geometry::CGeometryCalculator geometryCalculator(m_log, m_userSettings);
             if (geometryCalculator.CalculateWindDirection(scanResult1.m_scanProperties, scanResult1.m_startTime, plumeHeight, location, result))
@@ -933,34 +1258,58 @@ void CPostProcessing::CalculateGeometries(
 
 void CPostProcessing::CalculateFluxes(novac::LogContext context, const std::vector<Evaluation::CExtendedScanResult>& scanResults)
 {
+    novac::CTraceScope trace("stage", "CalculateFluxes");
     Flux::CFluxStatistics stat;
 
-    // we keep the calculated fluxes in a list
-    std::list<Flux::FluxResult> calculatedFluxes;
+    // The calculated fluxes are written to the flux logs as soon as they have been calculated.
+    //  Archive any flux logs from a previous run first.
+    Flux::FluxResultOutputs outputs;
+    outputs.csv = m_userSettings.m_writeFluxLogCsv;
+    outputs.instrumentLogs = m_userSettings.m_writeInstrumentFluxLogs;
+    outputs.fluxPercentiles = m_userSettings.m_fluxUncertaintySamples > 0;
+    Flux::CFluxResultWriter fluxWriter(m_log, m_userSettings.m_outputDirectory.std_str(), outputs);
+    for (const char* fluxLogName : { "FluxLog.xml", "FluxLog.txt", "FluxLog.csv" })
+    {
+        const novac::CString fluxLogFile = fluxWriter.GetFileName(fluxLogName);
+        if (Filesystem::IsExistingFile(fluxLogFile))
+        {
+            Common::ArchiveFile(fluxLogFile);
+        }
+    }
+
+    CDateTime now;
+    now.SetToNow();
+    m_log.Information(context, "Writing flux log");
+    fluxWriter.Open(context, now);
 
     // Initiate the flux-calculator
     Flux::CFluxCalculator fluxCalc(m_log, m_setup, m_userSettings);
 
-    // Loop through the list of evaluation log files. For each of them, find
-    // the best available wind-speed, wind-direction and plume height and
-    // calculate the flux.
-    for (const auto& scanResult : scanResults)
+    // The wind field and plume heights are not modified while the fluxes are calculated,
+    //  hence these can be shared by all the threads.
+    const Meteorology::CWindDataBase& windDataBase = m_windDataBase;
+    const Geometry::CPlumeDataBase& plumeDataBase = m_plumeDataBase;
+
+    // Calculates the flux of one scan. Find the best available wind-speed,
+    //  wind-direction and plume height and calculate the flux.
+    auto calculateFlux = [&](const Evaluation::CExtendedScanResult& scanResult, Flux::FluxResult& fluxResult) -> bool
     {
         // Get the name of this eval-log
         const novac::CString& evalLog = scanResult.m_evalLogFile[m_userSettings.m_mainFitWindow];
         const CPlumeInScanProperty& plume = scanResult.m_scanProperties;
+        novac::CTraceScope fluxTrace("flux", "CalculateFlux", evalLog.std_str());
 
         const novac::LogContext fileContext = context.With(novac::LogContext::FileName, novac::GetFileName(evalLog.std_str()));
 
         // If this is not a flux-measurement, then there's no point in calculating any flux for it
         if (scanResult.m_measurementMode != MeasurementMode::Flux)
         {
-            continue;
+            return false;
         }
         if (!plume.completeness.HasValue())
         {
             m_log.Information(fileContext, "Scan does not see the plume. Will not calculate any flux.");
-            continue;
+            return false;
         }
 
         // if the completeness is too low then ignore this scan.
@@ -969,312 +1318,112 @@ void CPostProcessing::CalculateFluxes(novac::LogContext context, const std::vect
             std::stringstream msg;
             msg << "Scan has completeness = " << plume.completeness.Value() << " which is less than limit of " << m_userSettings.m_completenessLimitFlux << ". Will not calculate any flux.";
             m_log.Information(fileContext, msg.str());
-            continue;
+            return false;
         }
 
         // Extract a plume height at this time of day
         Geometry::PlumeHeight plumeHeight;
-        if (!m_plumeDataBase.GetPlumeHeight(scanResult.m_startTime, plumeHeight))
+        if (!plumeDataBase.GetPlumeHeight(scanResult.m_startTime, plumeHeight))
         {
             std::stringstream msg;
             msg << "Failed to get plume height at the time of the measurement (" << scanResult.m_startTime << ") no flux calculated for scan.";
             m_log.Information(fileContext, msg.str());
-            continue;
+            return false;
         }
 
-        // Calculate the flux. This also takes care of writing
-        // the results to file
-        Flux::FluxResult fluxResult;
-        if (fluxCalc.CalculateFlux(fileContext, scanResult, m_windDataBase, plumeHeight, fluxResult))
-        {
-            std::stringstream msg;
-            msg << "Calculated flux of " << fluxResult.m_flux << " [kg/s] for scan.";
-            m_log.Information(fileContext, msg.str());
-            calculatedFluxes.push_back(fluxResult);
-        }
-        else
+        // Calculate the flux
+        if (!fluxCalc.CalculateFlux(fileContext, scanResult, windDataBase, plumeHeight, fluxResult))
         {
             m_log.Information(fileContext, "No flux calculated for scan.");
+            return false;
         }
-    }
 
-    // Now we can write the final fluxes to file
-    m_log.Information(context, "Writing flux log");
-    WriteFluxResult_XML(calculatedFluxes);
-    WriteFluxResult_Txt(calculatedFluxes);
-
-    // Also write the statistics for the flux
-    m_log.Information(context, "Writing flux statistics");
-    stat.AttachFluxList(calculatedFluxes);
-
-    novac::CString fluxStatFileName;
-    fluxStatFileName.Format("%s%c%s", m_userSettings.m_outputDirectory.c_str(), Poco::Path::separator(), "FluxStatistics.txt");
-    stat.WriteFluxStat(fluxStatFileName);
-}
-
-void CPostProcessing::WriteFluxResult_XML(const std::list<Flux::FluxResult>& calculatedFluxes)
-{
-    novac::CString fluxLogFile, styleFile, wsSrc, wdSrc, phSrc, typeStr;
-    CDateTime now;
-
-    // get the current time
-    now.SetToNow();
-
-    // the name and path of the final flux-log file
-    fluxLogFile.Format("%s%cFluxLog.xml", (const char*)m_userSettings.m_outputDirectory, Poco::Path::separator());
-
-    // Check if there's already a file like this, then archive it...
-    Common::ArchiveFile(fluxLogFile);
-
-    // Try to open the file
-    FILE* f = fopen(fluxLogFile, "w");
-    if (f == nullptr)
-    {
-        m_log.Information("Could not open flux log file for writing. Writing of results failed. ");
-        return;
-    }
-
-    // Write the header and the starting comments
-    fprintf(f, "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n");
-    fprintf(f, "<?xml-stylesheet type=\"text/xsl\" href=\"fluxresult.xsl\"?>\n");
-    fprintf(f, "<!-- This is result of the flux calculations the NOVAC Post Processing Program -->\n");
-    fprintf(f, "<!-- File generated on %04d.%02d.%02d at %02d:%02d:%02d -->\n\n", now.year, now.month, now.day, now.hour, now.minute, now.second);
-
-    fprintf(f, "<NovacPPPFluxResults>\n");
-
-    for (const Flux::FluxResult& fluxResult : calculatedFluxes)
-    {
-        // extract the sources of information about wind-speed, wind-direction and plume-height
-        fluxResult.m_windField.GetWindSpeedSource(wsSrc);
-        fluxResult.m_windField.GetWindDirectionSource(wdSrc);
-        Meteorology::MetSourceToString(fluxResult.m_plumeHeight.m_plumeAltitudeSource, phSrc);
-
-        // write a <flux> section
-        fprintf(f, "\t<flux>\n");
-
-        fprintf(f, "\t\t<startTime>%04d.%02d.%02dT%02d:%02d:%02d</startTime>\n",
-            fluxResult.m_startTime.year, fluxResult.m_startTime.month, fluxResult.m_startTime.day,
-            fluxResult.m_startTime.hour, fluxResult.m_startTime.minute, fluxResult.m_startTime.second);
-        fprintf(f, "\t\t<stopTime>%04d.%02d.%02dT%02d:%02d:%02d</stopTime>\n",
-            fluxResult.m_stopTime.year, fluxResult.m_stopTime.month, fluxResult.m_stopTime.day,
-            fluxResult.m_stopTime.hour, fluxResult.m_stopTime.minute, fluxResult.m_stopTime.second);
-
-        fprintf(f, "\t\t<serial>%s</serial>\n", fluxResult.m_instrument.c_str());
-
-        // extract the instrument type
-        if (fluxResult.m_instrumentType == NovacInstrumentType::Heidelberg)
-        {
-            typeStr.Format("heidelberg");
-        }
-        else
-        {
-            typeStr.Format("gothenburg");
-        }
-        fprintf(f, "\t\t<instrumentType>%s</instrumentType>\n", (const char*)typeStr);
-
-        fprintf(f, "\t\t<value>%.2lf</value>\n", fluxResult.m_flux);
-
-        // The judged quality of the calculated flux
-        if (fluxResult.m_fluxQualityFlag == FluxQuality::Green)
-        {
-            fprintf(f, "\t\t<Quality>g</Quality>\n");
-        }
-        else if (fluxResult.m_fluxQualityFlag == FluxQuality::Yellow)
-        {
-            fprintf(f, "\t\t<Quality>y</Quality>\n");
-        }
-        else
+        std::stringstream msg;
+        msg << "Calculated flux of " << fluxResult.m_flux << " [kg/s] for scan.";
+        if (!std::isnan(fluxResult.m_fluxPercentile50))
         {
-            fprintf(f, "\t\t<Quality>r</Quality>\n");
+            msg << " 90% interval: [" << fluxResult.m_fluxPercentile05 << ", " << fluxResult.m_fluxPercentile95 << "] [kg/s].";
         }
+        m_log.Information(fileContext, msg.str());
 
-        // the errors
-        fprintf(f, "\t\t<FluxError_Wind_kgs>%.2lf</FluxError_Wind_kgs>\n", fluxResult.m_fluxError_Wind);
-        fprintf(f, "\t\t<FluxError_PlumeHeight_kgs>%.2lf</FluxError_PlumeHeight_kgs>\n", fluxResult.m_fluxError_PlumeHeight);
-
-        // the wind speed
-        fprintf(f, "\t\t<windspeed>%.2lf</windspeed>\n", fluxResult.m_windField.GetWindSpeed());
-        fprintf(f, "\t\t<windspeedError>%.2lf</windspeedError>\n", fluxResult.m_windField.GetWindSpeedError());
-        fprintf(f, "\t\t<windspeedSource>%s</windspeedSource>\n", (const char*)wsSrc);
+        return true;
+    };
 
-        // the wind direction
-        fprintf(f, "\t\t<winddirection>%.2lf</winddirection>\n", fluxResult.m_windField.GetWindDirection());
-        fprintf(f, "\t\t<winddirectionError>%.2lf</winddirectionError>\n", fluxResult.m_windField.GetWindDirectionError());
-        fprintf(f, "\t\t<winddirectionSource>%s</winddirectionSource>\n", (const char*)wdSrc);
-
-        // the plume height
-        fprintf(f, "\t\t<plumeheight>%.2lf</plumeheight>\n", fluxResult.m_plumeHeight.m_plumeAltitude);
-        fprintf(f, "\t\t<plumeheightError>%.2lf</plumeheightError>\n", fluxResult.m_plumeHeight.m_plumeAltitudeError);
-        fprintf(f, "\t\t<plumeheightSource>%s</plumeheightSource>\n", (const char*)phSrc);
-
-        // some additional information about the scan
-        fprintf(f, "\t\t<Compass>%.1lf<Compass>\n", fluxResult.m_compass);
-        fprintf(f, "\t\t<ConeAngle>%.1lf<ConeAngle>\n", fluxResult.m_coneAngle);
-        fprintf(f, "\t\t<Tilt>%.1lf<Tilt>\n", fluxResult.m_tilt);
-        fprintf(f, "\t\t<nSpectra>%d<nSpectra>\n", fluxResult.m_numGoodSpectra);
-        fprintf(f, "\t\t<PlumeCentre_1>%.1lf<PlumeCentre_1>\n", fluxResult.m_plumeCentre[0]);
-        fprintf(f, "\t\t<PlumeCentre_2>%.1lf<PlumeCentre_2>\n", fluxResult.m_plumeCentre[1]);
-        fprintf(f, "\t\t<PlumeCompleteness>%.2lf<PlumeCompleteness>\n", fluxResult.m_completeness);
-        fprintf(f, "\t\t<ScanOffset>%.1e<ScanOffset>\n", fluxResult.m_scanOffset);
-
-        fprintf(f, "\t</flux>\n");
-    }
-
-    fprintf(f, "</NovacPPPFluxResults>\n");
-
-    // remember to close the file
-    fclose(f);
-
-    // ------------- we also need an xslt - file to display the output -----------------
-    styleFile.Format("%s%cfluxresult.xsl", (const char*)m_userSettings.m_outputDirectory, Poco::Path::separator());
-
-    // Try to open the file
-    f = fopen(styleFile, "w");
-    if (f == nullptr)
+    // The scans are processed in parallel, each thread takes the next scan which has not yet been started.
+    //  The fluxes are written to the logs in the order of the scans, as soon as all the scans before have been processed,
+    //  such that the logs are the same regardless of the number of threads used.
+    //  Only the results waiting to be written are kept. A scan is not started until it is within maxPendingScans
+    //  of the next scan to write, which bounds the number of waiting results when one scan takes much longer than the others.
+    struct ProcessedScan
     {
-        return;
-    }
-    fprintf(f, "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n");
-
-    fprintf(f, "<html xsl:version=\"1.0\" xmlns:xsl=\"http://www.w3.org/1999/XSL/Transform\" xmlns=\"http://www.w3.org/1999/xhtml\">\n");
-    fprintf(f, "<body style=\"font-family:Arial;font-size:12pt;background-color:#EEEEEE\">\n");
-    fprintf(f, "\t<div style=\"background-color:white;color:black;padding:4px\">\n");
-    fprintf(f, "\t\t<span style=\"font-weight:bold\">Result of flux calculation</span>\n");
-    fprintf(f, "\t</div>\n");
-
-    fprintf(f, "\t<xsl:for-each select=\"NovacPPPFluxResults/flux\">\n");
-    fprintf(f, "\t<div style=\"background-color:white;color:teal;padding:4px\">\n");
-    fprintf(f, "\t\t<span style=\"font-weight:bold\">Measurement from <xsl:value-of select=\"startTime\"/> to <xsl:value-of select=\"stopTime\"/> </span>\n");
-    fprintf(f, "\t- <xsl:value-of select=\"value\"/> kg/s\n");
-    fprintf(f, "\t</div>\n");
-    fprintf(f, "\t<div style=\"margin-left:20px;margin-bottom:1em;font-size:10pt\">\n");
-
-    fprintf(f, "\t\t<xsl:value-of select=\"description\"/>\n");
-    fprintf(f, "\t\t<span style=\"font-style:italic\">\n");
-    fprintf(f, "\t\t\tMade by <xsl:value-of select=\"serial\"/>\n");
-    fprintf(f, "\t\t</span>\n");
-    fprintf(f, "\t</div>\n");
-    fprintf(f, "\t</xsl:for-each>\n");
-    fprintf(f, "</body>\n");
-    fprintf(f, "</html>\n");
-
-    fclose(f);
-}
-
-void CPostProcessing::WriteFluxResult_Txt(const std::list<Flux::FluxResult>& calculatedFluxes)
-{
-    novac::CString fluxLogFile, wsSrc, wdSrc, phSrc, typeStr;
-    CDateTime now;
-
-    // get the current time
-    now.SetToNow();
-
-    // the name and path of the final flux-log file
-    fluxLogFile.Format("%s%cFluxLog.txt", (const char*)m_userSettings.m_outputDirectory, Poco::Path::separator());
-
-    // Try to open the file
-    if (Filesystem::IsExistingFile(fluxLogFile))
-    {
-        Common::ArchiveFile(fluxLogFile);
-    }
-
-    FILE* f = fopen(fluxLogFile, "w");
-    if (f == nullptr)
-    {
-        m_log.Information("Could not open flux log file for writing. Writing of results failed. ");
-        return;
-    }
-
-    // Write the header and the starting comments
-    fprintf(f, "# This is result of the flux calculations the NOVAC Post Processing Program \n");
-    fprintf(f, "#   File generated on %04d.%02d.%02d at %02d:%02d:%02d \n\n", now.year, now.month, now.day, now.hour, now.minute, now.second);
-
-    fprintf(f, "#StartTime\tStopTime\tSerial\tInstrumentType\tFlux_kgs\tFluxQuality\tFluxError_Wind_kgs\tFluxError_PlumeHeight_kgs\tWindSpeed_ms\tWindSpeedErr_ms\tWindSpeedSrc\tWindDir_deg\tWindDirErr_deg\tWindDirSrc\tPlumeHeight_m\tPlumeHeightErr_m\tPlumeHeightSrc\t");
-    fprintf(f, "Compass\tConeAngle\tTilt\tnSpectra\tPlumeCentre_1\tPlumeCentre_2\tPlumeCompleteness\tScanOffset\n");
-
-    for (const Flux::FluxResult& fluxResult : calculatedFluxes)
-    {
-        // extract the instrument type
-        if (fluxResult.m_instrumentType == NovacInstrumentType::Heidelberg)
-        {
-            typeStr.Format("heidelberg");
-        }
-        else
-        {
-            typeStr.Format("gothenburg");
-        }
-
-        // extract the sources of information about wind-speed, wind-direction and plume-height
-        fluxResult.m_windField.GetWindSpeedSource(wsSrc);
-        fluxResult.m_windField.GetWindDirectionSource(wdSrc);
-        Meteorology::MetSourceToString(fluxResult.m_plumeHeight.m_plumeAltitudeSource, phSrc);
-
-        // write the date and time when the measurement started and ended
-        fprintf(f, "%04d.%02d.%02dT%02d:%02d:%02d\t",
-            fluxResult.m_startTime.year, fluxResult.m_startTime.month, fluxResult.m_startTime.day,
-            fluxResult.m_startTime.hour, fluxResult.m_startTime.minute, fluxResult.m_startTime.second);
-        fprintf(f, "%04d.%02d.%02dT%02d:%02d:%02d\t",
-            fluxResult.m_stopTime.year, fluxResult.m_stopTime.month, fluxResult.m_stopTime.day,
-            fluxResult.m_stopTime.hour, fluxResult.m_stopTime.minute, fluxResult.m_stopTime.second);
-
-        // the type of instrument and the serial-number
-        fprintf(f, "%s\t", fluxResult.m_instrument.c_str());
-        fprintf(f, "%s\t", (const char*)typeStr);
+        bool fluxIsCalculated = false;
+        Flux::FluxResult fluxResult;
+    };
 
-        // The actual flux!!!
-        fprintf(f, "%.2lf\t", fluxResult.m_flux);
+    const size_t scanNum = scanResults.size();
+    const size_t maxPendingScans = 4 * static_cast<size_t>(std::max(1UL, m_userSettings.m_maxThreadNum));
+    std::map<size_t, ProcessedScan> pendingScans;
+    size_t nextScanToWrite = 0;
+    bool processingHasFailed = false;
+    std::mutex fluxWriterGuard;
+    std::condition_variable scanWritten;
 
-        // The judged quality of the calculated flux
-        if (fluxResult.m_fluxQualityFlag == FluxQuality::Green)
-        {
-            fprintf(f, "g\t");
-        }
-        else if (fluxResult.m_fluxQualityFlag == FluxQuality::Yellow)
-        {
-            fprintf(f, "y\t");
-        }
-        else
+    novac::ParallelFor(scanNum, m_userSettings.m_maxThreadNum, [&](size_t scanIdx)
         {
-            fprintf(f, "r\t");
-        }
-
-        // the errors
-        fprintf(f, "%.2lf\t", fluxResult.m_fluxError_Wind);
-        fprintf(f, "%.2lf\t", fluxResult.m_fluxError_PlumeHeight);
-
-        // the wind speed
-        fprintf(f, "%.2lf\t", fluxResult.m_windField.GetWindSpeed());
-        fprintf(f, "%.2lf\t", fluxResult.m_windField.GetWindSpeedError());
-        fprintf(f, "%s\t", (const char*)wsSrc);
+            try
+            {
+                {
+                    std::unique_lock<std::mutex> lock(fluxWriterGuard);
+                    scanWritten.wait(lock, [&]() { return processingHasFailed || scanIdx < nextScanToWrite + maxPendingScans; });
+                    if (processingHasFailed)
+                    {
+                        return;
+                    }
+                }
 
-        // the wind direction
-        fprintf(f, "%.2lf\t", fluxResult.m_windField.GetWindDirection());
-        fprintf(f, "%.2lf\t", fluxResult.m_windField.GetWindDirectionError());
-        fprintf(f, "%s\t", (const char*)wdSrc);
+                ProcessedScan processedScan;
+                processedScan.fluxIsCalculated = calculateFlux(scanResults[scanIdx], processedScan.fluxResult);
 
-        // the plume height
-        fprintf(f, "%.2lf\t", fluxResult.m_plumeHeight.m_plumeAltitude);
-        fprintf(f, "%.2lf\t", fluxResult.m_plumeHeight.m_plumeAltitudeError);
-        fprintf(f, "%s\t", (const char*)phSrc);
+                std::lock_guard<std::mutex> lock(fluxWriterGuard);
+                pendingScans.emplace(scanIdx, std::move(processedScan));
+                for (auto nextScan = pendingScans.find(nextScanToWrite); nextScan != pendingScans.end(); nextScan = pendingScans.find(nextScanToWrite))
+                {
+                    if (nextScan->second.fluxIsCalculated)
+                    {
+                        fluxWriter.Write(nextScan->second.fluxResult);
+                        stat.AttachFlux(nextScan->second.fluxResult);
+                    }
+                    pendingScans.erase(nextScan);
+                    ++nextScanToWrite;
+                }
+                scanWritten.notify_all();
+            }
+            catch (...)
+            {
+                // Wake up the threads waiting for this scan to be written, no further scans will be processed.
+                {
+                    std::lock_guard<std::mutex> lock(fluxWriterGuard);
+                    processingHasFailed = true;
+                }
+                scanWritten.notify_all();
+                throw;
+            }
+        });
 
-        // write additional information about the scan
-        fprintf(f, "%.1lf\t", fluxResult.m_compass);
-        fprintf(f, "%.1lf\t", fluxResult.m_coneAngle);
-        fprintf(f, "%.1lf\t", fluxResult.m_tilt);
-        fprintf(f, "%d\t", fluxResult.m_numGoodSpectra);
-        fprintf(f, "%.1lf\t", fluxResult.m_plumeCentre[0]);
-        fprintf(f, "%.1lf\t", fluxResult.m_plumeCentre[1]);
-        fprintf(f, "%.2lf\t", fluxResult.m_completeness);
-        fprintf(f, "%.1e\n", fluxResult.m_scanOffset);
+    // Finish the flux logs
+    fluxWriter.Close();
 
-    }
+    // Also write the statistics for the flux
+    m_log.Information(context, "Writing flux statistics");
 
-    // remember to close the file
-    fclose(f);
+    novac::CString fluxStatFileName;
+    fluxStatFileName.Format("%s%c%s", m_userSettings.m_outputDirectory.c_str(), Poco::Path::separator(), "FluxStatistics.txt");
+    stat.WriteFluxStat(fluxStatFileName);
 }
 
 void CPostProcessing::WriteCalculatedGeometriesToFile(novac::LogContext context, const std::vector<Geometry::CGeometryResult>& geometryResults)
 {
+    novac::CTraceScope trace("stage", "WriteCalculatedGeometriesToFile");
     if (geometryResults.size() == 0)
     {
         return; // nothing to write...
@@ -1336,6 +1485,7 @@ void CPostProcessing::WriteCalculatedGeometriesToFile(novac::LogContext context,
 
 void CPostProcessing::InsertCalculatedGeometriesIntoDatabase(novac::LogContext context, const std::vector<Geometry::CGeometryResult>& geometryResults)
 {
+    novac::CTraceScope trace("stage", "InsertCalculatedGeometriesIntoDatabase");
     for (const auto& result : geometryResults)
     {
         if (result.m_plumeAltitude.HasValue())
@@ -1370,6 +1520,7 @@ void CPostProcessing::InsertCalculatedGeometriesIntoDatabase(novac::LogContext c
 
 void CPostProcessing::CalculateDualBeamWindSpeeds(novac::LogContext context, const std::vector<Evaluation::CExtendedScanResult>& evalLogs)
 {
+    novac::CTraceScope trace("stage", "CalculateDualBeamWindSpeeds");
     std::vector<std::string> masterList; // list of wind-measurements from the master channel
     std::vector<std::string> slaveList;  // list of wind-measurements from the slave channel
     std::vector<std::string> heidelbergList;  // list of wind-measurements from the Heidelbergensis
@@ -1645,6 +1796,7 @@ void CPostProcessing::SortEvaluationLogs(std::vector<Evaluation::CExtendedScanRe
 
 void CPostProcessing::UploadResultsToFTP(novac::LogContext context)
 {
+    novac::CTraceScope trace("stage", "UploadResultsToFTP");
     Communication::CFTPServerConnection connection(m_log, m_userSettings);
     novac::CString fileName;
 
@@ -1671,6 +1823,7 @@ void CPostProcessing::UploadResultsToFTP(novac::LogContext context)
 
 std::vector<Evaluation::CExtendedScanResult> CPostProcessing::LocateEvaluationLogFiles(novac::LogContext context, const std::string& directory) const
 {
+    novac::CTraceScope trace("stage", "LocateEvaluationLogFiles");
     std::vector<std::string> filenames;
     std::vector<Evaluation::CExtendedScanResult> evaluationLogFiles;
 
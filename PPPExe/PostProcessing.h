@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <SpectralEvaluation/DateTime.h>
 #include <PPPLib/ContinuationOfProcessing.h>
 #include <PPPLib/Geometry/GeometryCalculator.h>
@@ -52,6 +53,11 @@ public:
         good stratospheric data */
     void DoPostProcessing_Strat();
 
+    /** Calculates the fluxes from the already existing evaluation logs for
+        all combinations of the configured wind fields and plume altitudes.
+        The evaluation logs are only read once. */
+    void DoPostProcessing_FluxSensitivity();
+
 private:
 
     // ----------------------------------------------------------------------
@@ -109,6 +115,25 @@ private:
         const std::vector<std::string>& pakFileList,
         std::vector<Evaluation::CExtendedScanResult>& evalLogFiles);
 
+    /** Searches for .pak-files in the local directory (and on the FTP server) and
+        evaluates each one using the setups found in m_setup and m_userSettings.
+        The evaluation of the files starts as soon as they are found, while the search continues.
+        @param evalLogFiles - will on successful return be filled
+            with the path's and filenames of each evaluation log
+            file generated and the properties of each scan.
+        @return the number of .pak-files found. */
+    size_t LocateAndEvaluateScans(
+        novac::LogContext context,
+        std::vector<Evaluation::CExtendedScanResult>& evalLogFiles);
+
+    /** Starts the evaluation threads and calls 'locatePakFiles' while the threads are running.
+        'locatePakFiles' is expected to pass each file to evaluate to the function it is called with, which blocks
+        while m_maxScansInFlight (or m_maxMegabytesInFlight) scans are waiting for evaluation.
+        Returns when all files are evaluated. */
+    void RunEvaluationThreads(
+        std::function<void(const std::function<void(const std::string&)>&)> locatePakFiles,
+        std::vector<Evaluation::CExtendedScanResult>& evalLogFiles);
+
     /** Runs through the supplied list of evaluation - logs and performs
         geometry calculations on the ones which does match. The results
         are returned in the list geometryResults.
@@ -147,6 +172,8 @@ private:
             calculations
         The wind speeds and wind directions will be taken from 'm_windDataBase'
         The plume heigths will be taken from 'm_plumeDataBase'
+        The scans are processed using at most m_maxThreadNum threads, the fluxes
+            are still written in the same order as the scans in evalLogs.
         */
     void CalculateFluxes(novac::LogContext context, const std::vector<Evaluation::CExtendedScanResult>& evalLogs);
 
@@ -155,10 +182,6 @@ private:
         (this is mostly done since this speeds up the geometry calculations enormously) */
     void SortEvaluationLogs(std::vector<Evaluation::CExtendedScanResult>& evalLogs);
 
-    /** Writes the calculated fluxes to the flux result file */
-    void WriteFluxResult_XML(const std::list<Flux::FluxResult>& calculatedFluxes);
-    void WriteFluxResult_Txt(const std::list<Flux::FluxResult>& calculatedFluxes);
-
     /** Takes care of uploading the result files to the FTP server */
     void UploadResultsToFTP(novac::LogContext context);
 
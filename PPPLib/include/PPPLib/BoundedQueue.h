@@ -0,0 +1,140 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace novac
+{
+
+/** BoundedQueue is a thread safe queue between the stages of a processing pipeline
+    (e.g. locating and downloading .pak files and evaluating them), which limits the number
+    of items and bytes which are in flight between the producers and the consumers.
+    An item is in flight from the moment it is pushed until the consumer calls Release for it,
+    such that the limits cover both the queued items and the items which are currently processed.
+    Producers calling Push are blocked while the limits are reached, this keeps a fast producer
+    (e.g. the search for files) from running arbitrarily far ahead of a slow consumer (the evaluation).
+    The consumers should be at least as many as the maximum number of items, otherwise some consumers will be idle. */
+template <class T>
+class BoundedQueue
+{
+public:
+    /** Creates a new queue.
+        @param maxItems the maximum number of items in flight, zero for no limit.
+        @param maxBytes the maximum number of bytes in flight, zero for no limit.
+            One single item is always let through, even if it is larger than this. */
+    BoundedQueue(size_t maxItems, size_t maxBytes)
+        : m_maxItems(maxItems), m_maxBytes(maxBytes)
+    {
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /** Adds an item of the given size to the end of the queue.
+        Blocks until there is room for the item within the limits.
+        @return false if the queue has been closed, in which case the item is not added. */
+    bool Push(T item, size_t bytes)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_spaceAvailable.wait(lock, [&] { return m_closed || HasRoomFor(bytes); });
+
+            if (m_closed)
+            {
+                return false;
+            }
+
+            m_items.push_back(std::make_pair(std::move(item), bytes));
+            ++m_itemsInFlight;
+            m_bytesInFlight += bytes;
+        }
+        m_itemAvailable.notify_one();
+        return true;
+    }
+
+    /** Removes the first item from the queue. Blocks until there is an item available
+        or the queue has been closed. The item is still in flight until Release is called with its size.
+        @return false if the queue is closed and all items have been removed. */
+    bool Pop(T& item, size_t& bytes)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_itemAvailable.wait(lock, [&] { return m_closed || !m_items.empty(); });
+
+        if (m_items.empty())
+        {
+            return false;
+        }
+
+        item = std::move(m_items.front().first);
+        bytes = m_items.front().second;
+        m_items.pop_front();
+        return true;
+    }
+
+    /** Marks one item returned from Pop, with the given size, as processed. */
+    void Release(size_t bytes)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_itemsInFlight;
+            m_bytesInFlight -= bytes;
+        }
+        m_spaceAvailable.notify_all();
+    }
+
+    /** Marks that no more items will be pushed. The items already in the queue can still be popped,
+        after which Pop returns false. Producers waiting for room in the queue are released and their items are not added. */
+    void Close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_itemAvailable.notify_all();
+        m_spaceAvailable.notify_all();
+    }
+
+    /** @return the number of items pushed but not yet released. */
+    size_t ItemsInFlight() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_itemsInFlight;
+    }
+
+    /** @return the number of bytes pushed but not yet released. */
+    size_t BytesInFlight() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_bytesInFlight;
+    }
+
+private:
+    bool HasRoomFor(size_t bytes) const
+    {
+        if (m_maxItems > 0 && m_itemsInFlight >= m_maxItems)
+        {
+            return false;
+        }
+        if (m_maxBytes > 0 && m_itemsInFlight > 0 && m_bytesInFlight + bytes > m_maxBytes)
+        {
+            return false;
+        }
+        return true;
+    }
+
+    const size_t m_maxItems;
+    const size_t m_maxBytes;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_itemAvailable;
+    std::condition_variable m_spaceAvailable;
+
+    std::deque<std::pair<T, size_t>> m_items;
+    size_t m_itemsInFlight = 0;
+    size_t m_bytesInFlight = 0;
+    bool m_closed = false;
+};
+
+}
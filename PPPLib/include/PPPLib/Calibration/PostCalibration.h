@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <SpectralEvaluation/DateTime.h>
@@ -17,6 +18,7 @@ namespace Configuration
 namespace novac
 {
 class CPostCalibrationStatistics;
+class CCrossSectionData;
 
 /** The CPostCalibration class is the helper class for performing instrument calibrations in the
     NovacPostProcessingProgram. This operates on measured .pak files and produces instrument calibrations
@@ -34,8 +36,9 @@ public:
     {
     }
 
-    /** Performs an automatic instrument calibration for the supplied spectrometer using the provided
-        .pak file for measurement data.
+    /** Performs automatic instrument calibrations using the provided .pak files for measurement data.
+        The files are sorted by the instrument which collected them and the different instruments
+            are calibrated in parallel, using at most m_userSettings.m_maxThreadNum threads.
         If the scan is good enough for performing the calibration, an instrument calibration will be created and returned
             as well as a set of
         @return The number of successful calibrations.*/
@@ -51,12 +54,27 @@ private:
 
     ILogger& m_log;
 
+    /** The high resolution cross sections used to create the references of the calibrations.
+        These are read once and shared by all the calibrations. */
+    struct HighResolutionCrossSections
+    {
+        /** The cross sections of StandardCrossSectionSetup, in the same order. */
+        std::vector<std::unique_ptr<novac::CCrossSectionData>> references;
+
+        /** The high resolution Fraunhofer spectrum, nullptr if this is not available. */
+        std::unique_ptr<novac::CCrossSectionData> fraunhoferReference;
+    };
+
+    /** Reads the cross sections of m_standardCrossSections.
+        @throws std::invalid_argument if any of the cross sections cannot be read. */
+    HighResolutionCrossSections ReadHighResolutionCrossSections() const;
+
     /** Performs an automatic instrument calibration for the supplied spectrometer using the provided
         .pak file for measurement data.
         If the scan is good enough for performing the calibration, an instrument calibration will be created and returned
             as well as a set of
         @return true if the calibration succeeded.*/
-    bool RunInstrumentCalibration(const std::string& scanFile, CPostCalibrationStatistics& statistics);
+    bool RunInstrumentCalibration(const std::string& scanFile, const HighResolutionCrossSections& crossSections, CPostCalibrationStatistics& statistics);
 
     struct BasicScanInfo
     {
@@ -66,6 +84,15 @@ private:
         std::string fullPath;
     };
 
+    /** Performs the instrument calibrations for one spectrometer using the provided scans, in order.
+        Scans measured too close in time to the last successful calibration are skipped.
+        @return The number of successful calibrations.*/
+    int RunInstrumentCalibration(const SpectrometerId& spectrometer, const std::vector<BasicScanInfo>& candidateScans, const HighResolutionCrossSections& crossSections, CPostCalibrationStatistics& statistics);
+
+    /** Sorts the provided scans by increasing start time and returns the ones
+        which are measured in the configured time of day for calibrations. */
+    static std::vector<BasicScanInfo> SelectCandidateScans(std::vector<BasicScanInfo> scans, const Configuration::CUserConfiguration& userSettings);
+
     /** Arranges the provided list of scan files by the instrument which performed the measurement */
     static std::map<SpectrometerId, std::vector<BasicScanInfo>> SortScanFilesByInstrument(novac::ILogger& log, const std::vector<std::string>& scanFileList);
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <PPPLib/SpectrometerId.h>
@@ -9,6 +10,8 @@
 
 namespace novac
 {
+/** The CPostCalibrationStatistics keeps track of the instrument calibrations performed.
+    This is safe to use from multiple threads at the same time. */
 class CPostCalibrationStatistics
 {
 public:
@@ -52,5 +55,8 @@ private:
     // Map of instrument serial&channel number vs calibration properties
     std::map<SpectrometerId, InstrumentCalibrationCollection> m_calibrations;
 
+    // Guards m_calibrations
+    mutable std::mutex m_calibrationsMutex;
+
 };
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <vector>
 #include <PPPLib/MFC/CList.h>
 #include <PPPLib/MFC/CString.h>
@@ -38,6 +39,18 @@ public:
         const std::string& password,
         std::vector<std::string>& pakFileList);
 
+    /** Downloads .pak - files from the given FTP-server and reports the local name of each file
+        through 'onFileDownloaded' as soon as it has been downloaded, such that it can be processed while the download continues.
+        The callback is called from the downloading threads, and the next file of that thread is not downloaded until it returns.
+        @return 0 on successful connection and completion of the list
+    */
+    int DownloadDataFromFTP(
+        novac::LogContext context,
+        const std::string& server,
+        const std::string& username,
+        const std::string& password,
+        std::function<void(const std::string&)> onFileDownloaded);
+
     /** Downloads a single file from the given FTP-server
         @return 0 on successful connection and completion of the download
     */
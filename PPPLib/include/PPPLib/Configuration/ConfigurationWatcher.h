@@ -0,0 +1,83 @@
+#pragma once
+
+#include <PPPLib/Configuration/NovacPPPConfiguration.h>
+#include <SpectralEvaluation/Log.h>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Configuration
+{
+/** The class <b>CConfigurationWatcher</b> makes it possible to correct the configuration of the
+    instruments (setup.xml and the .exml files) while a long processing is running, without restarting it.
+
+    The configuration is handed out as immutable snapshots. When any of the configuration files has been
+    modified, a new snapshot is read and replaces the current one as a whole. Only the .exml files which have changed
+    are read again, the evaluation revision of these instruments is increased such that their references are read again.
+    Work which already has retrieved a snapshot continues with that snapshot, the following work uses the new one.
+    If the modified files cannot be read, or the settings in them are not valid, then the current snapshot is kept.
+
+    processing.xml is not read again, since this defines the processing itself, a change to it is only reported. */
+class CConfigurationWatcher
+{
+public:
+    /** @param configurationDirectory the directory containing setup.xml, processing.xml and the .exml files.
+        @param initialConfiguration the configuration read when the processing started. */
+    CConfigurationWatcher(novac::ILogger& log, const std::string& configurationDirectory, const CNovacPPPConfiguration& initialConfiguration);
+
+    ~CConfigurationWatcher();
+
+    CConfigurationWatcher(const CConfigurationWatcher&) = delete;
+    CConfigurationWatcher& operator=(const CConfigurationWatcher&) = delete;
+
+    /** @return the current snapshot of the configuration. This is safe to call from several threads at the same time. */
+    std::shared_ptr<const CNovacPPPConfiguration> Current() const;
+
+    /** Checks if any of the configuration files has been modified since they were last read
+        and, if so, reads a new snapshot of the configuration.
+        @return true if a new snapshot has replaced the current one. */
+    bool ReloadIfModified();
+
+    /** Starts a background thread calling ReloadIfModified every 'intervalSeconds' seconds, until Stop is called. */
+    void Start(unsigned long intervalSeconds);
+
+    /** Stops the background thread, if started. */
+    void Stop();
+
+private:
+    novac::ILogger& m_log;
+
+    const std::string m_configurationDirectory;
+
+    std::shared_ptr<const CNovacPPPConfiguration> m_current;
+
+    /** The time each of the configuration files was last modified, when last read, by file name.
+        Files which do not exist have the modification time zero. */
+    std::map<std::string, std::int64_t> m_modificationTimes;
+
+    /** The modification times of the files when they last failed to be read, such that they are not read again until modified again. */
+    std::map<std::string, std::int64_t> m_rejectedModificationTimes;
+
+    /** The highest evaluation revision given to any instrument */
+    unsigned int m_lastEvaluationRevision = 0;
+
+    /** Serializes the calls to ReloadIfModified */
+    std::mutex m_reloadGuard;
+
+    std::thread m_watcherThread;
+    std::mutex m_stopGuard;
+    std::condition_variable m_stopSignal;
+    bool m_stopRequested = false;
+
+    std::string SetupFile() const;
+    std::string ProcessingFile() const;
+    std::string EvaluationFile(const novac::CString& serial) const;
+
+    /** @return the time the given file was last modified, in microseconds since the epoch, or zero if the file does not exist. */
+    static std::int64_t GetModificationTime(const std::string& fileName);
+};
+}
@@ -50,6 +50,10 @@ public:
         @return 0 if sucessful, otherwise 1 */
     int GetFitWindow(size_t index, novac::CFitWindow& window, novac::CDateTime& validFrom, novac::CDateTime& validTo) const;
 
+    /** Retrieves a fit-window from the configuration for this spectrometer, without copying it.
+        @throws std::out_of_range if the index is not smaller than NumberOfFitWindows() */
+    const FitWindowWithTime& GetFitWindow(size_t index) const { return m_windows.at(index); }
+
     /** Gets the number of fit-windows configured for this spectrometer */
     size_t NumberOfFitWindows() const { return m_windows.size(); }
 
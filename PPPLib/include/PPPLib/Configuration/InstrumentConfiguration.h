@@ -40,5 +40,10 @@ public:
 
     /** The settings for how to calibrate this device */
     CInstrumentCalibrationConfiguration m_instrumentCalibration;
+
+    /** Increased each time the evaluation configuration of this instrument is read again
+        while the processing runs (see CConfigurationWatcher). References read for an earlier
+        revision of the configuration are not used for a later one. */
+    unsigned int m_evaluationRevision = 0;
 };
 }
\ No newline at end of file
@@ -53,6 +53,10 @@ public:
     *   @throws novac::NotFoundException if the instrument could not be found */
     novac::CFitWindow GetFitWindow(const std::string& serial, int channel, const novac::CDateTime& dateAndTime, const novac::CString* fitWindowName = NULL) const;
 
+    /** Retrieves the index, among the fit windows of the instrument, of the CFitWindow that GetFitWindow would return.
+    *   @throws novac::NotFoundException if the instrument or fit window could not be found */
+    size_t GetFitWindowIndex(const std::string& serial, int channel, const novac::CDateTime& dateAndTime, const novac::CString* fitWindowName = NULL) const;
+
     /** Retrieves the CDarkSettings that is valid for the given instrument and for the given time
     *   @throws novac::NotFoundException if the instrument could not be found */
     CDarkSettings GetDarkCorrection(const std::string& serial, const novac::CDateTime& dateAndTime) const;
@@ -17,5 +17,9 @@ enum class ProcessingMode
     Geometry,
 
     // Performing instrument calibrations only, useful for prepairing for a later evaluation run.
-    InstrumentCalibration
+    InstrumentCalibration,
+
+    // Calculation of the fluxes from already existing evaluation logs, using several alternative
+    // wind fields and plume altitudes. Useful for testing the sensitivity of the fluxes to the wind field.
+    FluxSensitivity
 };
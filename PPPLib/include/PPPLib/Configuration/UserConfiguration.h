@@ -9,6 +9,9 @@
 #include <PPPLib/Configuration/ProcessingMode.h>
 #include <PPPLib/MFC/CString.h>
 
+#include <string>
+#include <vector>
+
 
 namespace Configuration
 {
@@ -37,6 +40,44 @@ public:
     unsigned long m_maxThreadNum = 2;
 #define str_maxThreadNum "MaxThreadNum"
 
+    /** The number of threads used to evaluate the spectra within one single scan.
+        If larger than one, then all spectra of a scan are read in and prepared up front
+        and then evaluated in parallel. This is useful when there are few but long scans
+        to evaluate (e.g. wind-speed measurements). The default of one evaluates the spectra one by one.
+        The threads are taken from the m_maxThreadNum threads, hence fewer scans are evaluated at the same time. */
+    unsigned long m_spectrumThreadNum = 1;
+#define str_spectrumThreadNum "SpectrumThreadNum"
+
+    /** The maximum number of scans which have been found (or downloaded) but not yet evaluated.
+        The search for and download of .pak files pauses while this many scans are waiting for, or are in, evaluation.
+        This limits the memory and temporary disk used when processing long time ranges. Zero means no limit.
+        Should be at least m_maxThreadNum, otherwise not all evaluation threads are kept busy. */
+    unsigned long m_maxScansInFlight = 64;
+#define str_maxScansInFlight "MaxScansInFlight"
+
+    /** The maximum total size, in MB, of the .pak files which have been found (or downloaded) but not yet evaluated.
+        Works as m_maxScansInFlight but limits the size of the files instead of their number. Zero means no limit. */
+    unsigned long m_maxMegabytesInFlight = 512;
+#define str_maxMegabytesInFlight "MaxMegabytesInFlight"
+
+    /** If non-zero, then setup.xml and the .exml files are checked for modifications this often (in seconds)
+        while the scans are evaluated. Modified files are read again and used for the scans evaluated after this.
+        This makes it possible to correct e.g. a fit window or an instrument location without restarting a long processing.
+        The default of zero reads the configuration only once. */
+    unsigned long m_configurationReloadInterval = 0;
+#define str_configurationReloadInterval "ConfigurationReloadInterval"
+
+    /** When the optimal shift and squeeze of the references is determined from the scan itself
+        (the 'findOptimalShift' option of the fit window) then the scan is first evaluated with shift and squeeze fixed
+        to zero and one. If the optimal shift (in pixels) and squeeze determined from this differs by less than
+        these tolerances from the values used in the first evaluation, then the result of the first evaluation is used
+        and the scan is not evaluated a second time. The default of zero always evaluates the scan again unless nothing changed. */
+    double m_optimalShiftTolerance = 0.0;
+#define str_optimalShiftTolerance "OptimalShiftTolerance"
+
+    double m_optimalSqueezeTolerance = 0.0;
+#define str_optimalSqueezeTolerance "OptimalSqueezeTolerance"
+
 
     /** The working-directory, used to override the location of the software.
             This can only be overriden in command line arguments, not the config file. */
@@ -153,6 +194,21 @@ public:
     bool m_uploadResults = false;
 #define  str_uploadResults "UploadResults"
 
+    /** This is true if the fluxes should also be written to FluxLog.csv, to be read by other programs. */
+    bool m_writeFluxLogCsv = false;
+#define  str_writeFluxLogCsv "WriteFluxLogCsv"
+
+    /** This is true if the fluxes should also be written to one flux log per instrument and day,
+        in the sub-directory YYYY.MM.DD/serial/ of the output directory. */
+    bool m_writeInstrumentFluxLogs = false;
+#define  str_writeInstrumentFluxLogs "WriteInstrumentFluxLogs"
+
+    /** This is true if the start and duration of each stage of the processing, and of each scan evaluation,
+        file transfer, geometry and flux calculation within them, should be recorded and written to ProcessingTrace.json
+        in the output directory. The file is in the Chrome trace-event format and can be opened in e.g. chrome://tracing */
+    bool m_writeProcessingTrace = false;
+#define  str_writeProcessingTrace "WriteProcessingTrace"
+
     // ------------------------------------------------------------------------
     // -------------------- SETTINGS FOR THE WIND FIELD -----------------------
     // ------------------------------------------------------------------------
@@ -170,6 +226,30 @@ public:
     int m_windFieldFileOption = 0;
 #define   str_windFieldFileOption "WindFileOption"
 
+    // ------------------------------------------------------------------------
+    // ------------- SETTINGS FOR THE FLUX UNCERTAINTY ESTIMATE  --------------
+    // ------------------------------------------------------------------------
+
+    /** The number of Monte-Carlo samples used to estimate the distribution of each calculated flux
+        from the uncertainties in wind speed, wind direction, plume height, offset and columns.
+        Zero disables the estimate. */
+    int m_fluxUncertaintySamples = 0;
+#define   str_fluxUncertaintySamples "FluxUncertaintySamples"
+
+    // ------------------------------------------------------------------------
+    // ------------- SETTINGS FOR THE FLUX SENSITIVITY MODE  ------------------
+    // ------------------------------------------------------------------------
+
+    /** The alternative wind fields to calculate the fluxes with, in addition to m_windFieldFile.
+        Each is either a .wxml file or a directory containing .wxml files. */
+    std::vector<std::string> m_fluxSensitivityWindFields;
+#define   str_fluxSensitivityWindField "WindField"
+
+    /** The alternative plume altitudes to calculate the fluxes with, in meters above sea level,
+        in addition to the plume altitudes from the geometry calculations. */
+    std::vector<double> m_fluxSensitivityPlumeAltitudes;
+#define   str_fluxSensitivityPlumeAltitude "PlumeAltitude"
+
     // ------------------------------------------------------------------------
     // ------------- SETTINGS FOR THE GEOMETRY CALCULATIONS  ------------------
     // ------------------------------------------------------------------------
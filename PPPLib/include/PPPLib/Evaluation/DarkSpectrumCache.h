@@ -0,0 +1,53 @@
+#pragma once
+
+#include <SpectralEvaluation/Spectra/Spectrum.h>
+#include <functional>
+#include <vector>
+
+namespace Evaluation
+{
+/** The class <b>CDarkSpectrumCache</b> keeps the dark spectra used when preparing the spectra of one scan,
+    already divided by the number of co-added spectra. The dark spectrum retrieved for a spectrum only depends
+    on the exposure time and the number of co-added spectra of that spectrum, hence the dark only needs to be
+    retrieved and normalized once for each combination of these in the scan. */
+class CDarkSpectrumCache
+{
+public:
+    /** @param averagedSpectra True if the spectra are averaged, and not summed, by the spectrometer.
+            The dark spectra are then not divided by the number of co-added spectra.
+        @param lastDarkScanIndex The scan index of the dark spectrum retrieved before the cache is used, if any. */
+    CDarkSpectrumCache(bool averagedSpectra, int lastDarkScanIndex);
+
+    /** Returns the dark spectrum, divided by the number of co-added spectra, for the given spectrum.
+        The dark is only retrieved, by calling getDark, if there is no matching dark in the cache already.
+        @return a pointer to the dark spectrum in the cache, valid until the next call,
+            or nullptr if the dark could not be retrieved. */
+    const novac::CSpectrum* GetNormalizedDark(const novac::CSpectrum& spec, const std::function<bool(novac::CSpectrum&)>& getDark);
+
+    /** @return the scan index of the last retrieved dark spectrum. Spectra with this index are not evaluated. */
+    int LastDarkScanIndex() const { return m_lastDarkScanIndex; }
+
+    /** @return the number of dark spectra retrieved */
+    size_t NumberOfDarkSpectra() const { return m_entries.size(); }
+
+private:
+    struct Entry
+    {
+        long exposureTime = 0;
+        long numSpectra = 0;
+        novac::CSpectrum dark;
+    };
+
+    const bool m_averagedSpectra;
+
+    std::vector<Entry> m_entries;
+
+    int m_lastDarkScanIndex = -1;
+};
+
+/** Divides the measured spectrum by its number of co-added spectra, unless the spectra are averaged,
+    and subtracts the dark spectrum from it. Both are done in one pass over the data.
+    @param normalizedDark The dark spectrum, already divided by its number of co-added spectra. */
+void RemoveNormalizedDark(novac::CSpectrum& spectrum, const novac::CSpectrum& normalizedDark, bool averagedSpectra);
+
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <PPPLib/Configuration/NovacPPPConfiguration.h>
+#include <PPPLib/MFC/CString.h>
+#include <PPPLib/PostProcessingUtils.h>
+#include <SpectralEvaluation/DateTime.h>
+#include <SpectralEvaluation/Evaluation/FitWindow.h>
+#include <SpectralEvaluation/Log.h>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+namespace Evaluation
+{
+/** The class <b>CFitWindowCache</b> reads the references of the configured fit windows on demand,
+    the first time a scan is evaluated with each fit window, instead of reading all of them before the evaluation starts.
+    A configuration generated by the instrument calibrations contains one fit window for each calibration,
+    hence only the fit windows valid during the processed period are ever read.
+
+    The references of a fit window are released again once a scan from the same instrument is requested
+    more than releaseDelay seconds after the end of the validity of the fit window.
+    The fit windows are handed out as shared pointers, such that a fit window which is
+    released while still in use is kept alive until the evaluation using it is done.
+
+    The configuration is passed with each request, such that a configuration which is reloaded while the processing runs
+    can be used for the following scans. The references of an instrument are then only read again if the
+    evaluation revision of the instrument has changed. The fit windows of the previous revision are kept for
+    the scans which started before the change, until none of these uses them anymore.
+
+    A fit window whose references could not be read is not read again, instead the same exception is thrown
+    for all the scans using it, until the configuration of the instrument has changed.
+
+    This is safe to use from several threads at the same time. */
+class CFitWindowCache
+{
+public:
+    CFitWindowCache(novac::ILogger& log, const novac::directorySetup& directories);
+
+    /** The time, in seconds, a fit window is kept in memory after the end of its validity.
+        This allows for the scans not being evaluated in strict time order. */
+    static const int releaseDelay = 24 * 3600;
+
+    /** Retrieves the CFitWindow that is valid for the given instrument and for the given time, with its references read.
+    *   The fit window is selected in the same way as by CNovacPPPConfiguration::GetFitWindow.
+    *   @param setup the configuration of the instruments. The references of its fit windows are not read, the fit windows are copied when needed.
+    *   @throws novac::NotFoundException if the instrument or fit window could not be found.
+    *   @throws novac::InvalidReferenceException if any of the references could not be read. */
+    std::shared_ptr<const novac::CFitWindow> GetFitWindow(const Configuration::CNovacPPPConfiguration& setup, const std::string& serial, int channel, const novac::CDateTime& dateAndTime, const novac::CString* fitWindowName = nullptr);
+
+    /** @return the number of fit windows whose references are currently kept in memory */
+    size_t NumberOfLoadedFitWindows() const;
+
+private:
+    novac::ILogger& m_log;
+
+    const novac::directorySetup m_directories;
+
+    typedef std::shared_future<std::shared_ptr<const novac::CFitWindow>> FutureFitWindow;
+
+    /** A fit window with its references read, or being read by the thread which first requested it */
+    struct LoadedFitWindow
+    {
+        novac::CDateTime validTo;
+        FutureFitWindow window;
+    };
+
+    /** The fit windows with their references read, by instrument serial, the index of the fit window in the configuration
+        of the instrument and the evaluation revision of the instrument. */
+    std::map<std::tuple<std::string, size_t, unsigned int>, LoadedFitWindow> m_loadedWindows;
+
+    /** Guards m_loadedWindows. This is only held while looking up or inserting a fit window, never while reading the references.
+        The threads requesting a fit window which is being read wait for the thread reading it, such that the
+        same references are never read twice at the same time. */
+    mutable std::mutex m_guard;
+
+    /** Releases the fit windows of the given instrument whose validity ended more than releaseDelay before the given time,
+        and the fit windows of revisions older than the given one which are no longer used.
+        Must be called with m_guard held. */
+    void ReleaseUnusedFitWindows(const std::string& serial, const novac::CDateTime& dateAndTime, unsigned int evaluationRevision);
+
+    /** Copies the configured fit window and reads its references. */
+    std::shared_ptr<const novac::CFitWindow> ReadFitWindow(const Configuration::FitWindowWithTime& configuredWindow, const std::string& serial) const;
+};
+}
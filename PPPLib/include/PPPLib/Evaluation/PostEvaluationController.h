@@ -7,6 +7,7 @@
 #include <PPPLib/ContinuationOfProcessing.h>
 #include <PPPLib/PostProcessingStatistics.h>
 #include <PPPLib/Evaluation/ExtendedScanResult.h>
+#include <PPPLib/Evaluation/FitWindowCache.h>
 #include <SpectralEvaluation/File/ScanFileHandler.h>
 
 namespace Evaluation
@@ -29,8 +30,9 @@ public:
         const Configuration::CNovacPPPConfiguration& setup,
         const Configuration::CUserConfiguration& userSettings,
         const CContinuationOfProcessing& continuation,
-        CPostProcessingStatistics& processingStats)
-        : m_log(log), m_setup(setup), m_userSettings(userSettings), m_continuation(continuation), m_processingStats(processingStats)
+        CPostProcessingStatistics& processingStats,
+        CFitWindowCache* fitWindowCache = nullptr)
+        : m_log(log), m_setup(setup), m_userSettings(userSettings), m_continuation(continuation), m_processingStats(processingStats), m_fitWindowCache(fitWindowCache)
     {
     }
 
@@ -66,6 +68,10 @@ private:
 
     CPostProcessingStatistics& m_processingStats;
 
+    /** If not null, then the fit windows are retrieved from here with their references read.
+        Otherwise the fit windows of m_setup are used as they are, which requires that their references have been read beforehand. */
+    CFitWindowCache* m_fitWindowCache;
+
     // ----------------------------------------------------------------------
     // --------------------- PRIVATE METHODS --------------------------------
     // ----------------------------------------------------------------------
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <PPPLib/Evaluation/DarkSpectrumCache.h>
 #include <PPPLib/Evaluation/ScanResult.h>
 #include <PPPLib/Configuration/UserConfiguration.h>
 #include <SpectralEvaluation/File/ScanFileHandler.h>
 #include <SpectralEvaluation/Evaluation/ScanEvaluationBase.h>
+#include <SpectralEvaluation/Evaluation/FitWindow.h>
+#include <SpectralEvaluation/Evaluation/EvaluationResult.h>
+#include <SpectralEvaluation/Spectra/Spectrum.h>
 #include <SpectralEvaluation/Log.h>
+#include <vector>
 
 namespace novac
 {
@@ -52,14 +57,106 @@ private:
     // ----------------------- PRIVATE METHODS ---------------------------
 
     /** Performs the evaluation using the supplied evaluator
+        @param evaluatorWindow The fit window which 'eval' was created with. If this is not null
+            and m_userSettings.m_spectrumThreadNum > 1 then additional evaluators are created from this
+            window and the spectra of the scan are evaluated in parallel.
         @return the result of the evaluation, or null if something goes wrong */
     std::unique_ptr<CScanResult> EvaluateOpenedScan(
         novac::LogContext logContext,
         novac::CScanFileHandler& scan,
         std::unique_ptr<novac::CEvaluationBase>& eval,
+        const novac::CFitWindow* evaluatorWindow,
         const novac::SpectrometerModel& spectrometer,
         const Configuration::CDarkSettings* darkSettings = nullptr);
 
+    /** A spectrum which has been read from the scan and prepared for the evaluation. */
+    struct PreparedSpectrum
+    {
+        novac::CSpectrum spectrum;
+
+        /** The index used to identify this spectrum as the most absorbing spectrum in the scan. */
+        int spectrumIndex = -1;
+    };
+
+    /** All the spectra of one scan, read from the file and prepared for the evaluation.
+        This allows for the same scan to be evaluated several times without having to
+        read and dark-correct the spectra again. */
+    struct PreparedScan
+    {
+        /** The sky spectrum, with the dark removed and divided by the number of co-adds. */
+        novac::CSpectrum sky;
+
+        novac::CSpectrumInfo skySpecInfo;
+        novac::CSpectrumInfo darkSpecInfo;
+
+        /** The spectra to evaluate, in the order they are stored in the file. */
+        std::vector<PreparedSpectrum> spectra;
+
+        /** The indices of the spectra in the file which could not be read */
+        std::vector<size_t> corruptedSpectra;
+    };
+
+    /** The result of evaluating one PreparedSpectrum */
+    struct SpectrumEvaluationResult
+    {
+        bool evaluationFailed = false;
+        std::string errorMessage;
+        novac::CEvaluationResult result;
+    };
+
+    enum class SpectrumReadStatus
+    {
+        Ok,         // the spectrum was read and is ready to be evaluated
+        Skipped,    // the spectrum should not be evaluated (sky, dark, corrupt or too dark spectrum)
+        EndOfScan,  // there are no more spectra in the scan
+        Failed      // something went wrong and the scan cannot be evaluated
+    };
+
+    /** Reads the sky spectrum and all the spectra of the scan and prepares them for the evaluation.
+        @return true on success. */
+    bool PrepareScan(
+        novac::LogContext logContext,
+        novac::CScanFileHandler& scan,
+        const novac::SpectrometerModel& spectrometer,
+        const Configuration::CDarkSettings* darkSettings,
+        PreparedScan& preparedScan);
+
+    /** Evaluates the already prepared spectra of a scan using the supplied evaluator.
+        @param evaluatorWindow See EvaluateOpenedScan.
+        @return the result of the evaluation, or null if something goes wrong */
+    std::unique_ptr<CScanResult> EvaluatePreparedScan(
+        novac::LogContext logContext,
+        const PreparedScan& preparedScan,
+        std::unique_ptr<novac::CEvaluationBase>& eval,
+        const novac::CFitWindow* evaluatorWindow,
+        const novac::SpectrometerModel& spectrometer);
+
+    /** Reads the next spectrum from the scan and prepares it for evaluation by removing the dark and
+        dividing by the number of co-added spectra. The spectra must be read in order.
+        @param darkCache The dark spectra already retrieved for this scan, updated by this call.
+        @param curSpectrumIndex The index of the last read spectrum in the file, updated by this call.
+        @param preparedScan Spectra which cannot be read are recorded as corrupted here. */
+    SpectrumReadStatus ReadNextSpectrum(
+        novac::LogContext logContext,
+        novac::CScanFileHandler& scan,
+        const novac::SpectrometerModel& spectrometer,
+        const Configuration::CDarkSettings* darkSettings,
+        const novac::CSpectrum& sky,
+        CDarkSpectrumCache& darkCache,
+        int& curSpectrumIndex,
+        PreparedScan& preparedScan,
+        PreparedSpectrum& current);
+
+    /** Appends the result of evaluating the given spectrum to the result of the scan.
+        This must be called in the order of the spectra in the scan. */
+    void InsertEvaluationResult(
+        novac::LogContext logContext,
+        const novac::SpectrometerModel& spectrometer,
+        const PreparedSpectrum& current,
+        const SpectrumEvaluationResult& evaluationResult,
+        double& highestColumnInScan,
+        CScanResult& result);
+
     /** This returns the sky spectrum that is to be used in the fitting.
         Which spectrum to be used is taken from the given settings.
         @return true on success. */
@@ -77,17 +174,18 @@ private:
             the spectrum with the highest absorption of the evaluated specie
             and evaluate it with shift and squeeze free
         @param fitWindow The old fit-window where we should try to improve the settings.
-        @param index indexOfMostAbsorbingSpectrum The index of the spectrum which has the highest absorption,
-            this is the spectrum to evaluate again.
-        @param scan The scan to improve the evaluation for.
+        @param mostAbsorbingSpectrum The spectrum which has the highest absorption, already prepared for the evaluation.
+            This is the spectrum to evaluate again.
+        @param sky The sky spectrum of the scan, already prepared for the evaluation.
+        @param optimizedFitWindow Will on successful return be set to the fit-window of the returned evaluator.
         @return a new evaluator with the fit-window set to the new optimum values.
         @return nullptr if the evaluation failed. */
     novac::CEvaluationBase* FindOptimumShiftAndSqueeze(
         novac::LogContext logContext,
         const novac::CFitWindow& fitWindow,
-        int indexOfMostAbsorbingSpectrum,
-        novac::CScanFileHandler& scan,
-        const Configuration::CDarkSettings* darkSettings = nullptr);
+        const PreparedSpectrum& mostAbsorbingSpectrum,
+        const novac::CSpectrum& sky,
+        novac::CFitWindow& optimizedFitWindow);
 
     // ------------------------ THE PARAMETERS FOR THE EVALUATION ------------------
 
@@ -95,6 +193,9 @@ private:
         adjust the shift and squeeze with it later */
     int m_indexOfMostAbsorbingSpectrum = -1;
 
+    /** The scan index of the last spectrum read in ReadNextSpectrum */
+    int m_lastReadSpectrumScanIndex = -1;
+
     /** Performs a basic validation on the setup of the given fit window.
         @throws std::exception (or subclass of this) if the window is not ok */
     void ValidateSetup(novac::LogContext context, const novac::CFitWindow& window);
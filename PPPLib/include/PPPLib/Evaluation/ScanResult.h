@@ -25,7 +25,11 @@ namespace Evaluation
     The CScanResult also handles information about the whole set
     of evaluation results such as the offset or the calculated flux of the scan,
     or a judgement wheather each evaluated spectrum is judged to be an ok
-    spectrum or not. */
+    spectrum or not.
+
+    The results of the spectra are stored, one CEvaluationResult and one CSpectrumInfo
+    per spectrum, by novac::BasicScanEvaluationResult. Only the position and serial of the
+    scan are cached here, see ScanMetadata. */
 class CScanResult : public novac::BasicScanEvaluationResult
 {
 public:
@@ -34,6 +38,10 @@ public:
     CScanResult(const CScanResult&);
     CScanResult& operator=(const CScanResult& s2);
 
+    /** Moving a scan result does not copy the evaluation result of each spectrum */
+    CScanResult(CScanResult&&) = default;
+    CScanResult& operator=(CScanResult&&) = default;
+
     // ----------------------------------------------------------------------
     // ---------------------- PUBLIC DATA -----------------------------------
     // ----------------------------------------------------------------------
@@ -282,10 +290,30 @@ public:
 
 private:
 
+    // ----------------------------------------------------------------------
+    // ---------------------- PRIVATE DATA ----------------------------------
+    // ----------------------------------------------------------------------
+
+    /** The properties which are constant throughout the scan, taken from the first
+        spectrum where they are set. These are updated as the spectra are appended,
+        such that the accessors don't have to search through the spectra on each call. */
+    struct ScanMetadata
+    {
+        double latitude = 0.0;
+        double longitude = 0.0;
+        double altitude = 0.0;
+        std::string serial;
+    };
+
+    ScanMetadata m_metadata;
+
     // ----------------------------------------------------------------------
     // -------------------- PRIVATE METHODS ---------------------------------
     // ----------------------------------------------------------------------
 
+    /** Updates m_metadata with the properties of the given spectrum, if these are not already set. */
+    void UpdateMetadata(const novac::CSpectrumInfo& specInfo);
+
     /** makes a sanity check of the parameters and returns fit parameter number 'index'.
         @param specIndex - the zero based into the list of evaluated spectra.
         @param specieIndex - the zero based into the list of species to evaluate for.
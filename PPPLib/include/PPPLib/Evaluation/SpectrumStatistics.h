@@ -0,0 +1,37 @@
+#pragma once
+
+#include <SpectralEvaluation/Spectra/Spectrum.h>
+#include <SpectralEvaluation/Spectra/SpectrometerModel.h>
+
+namespace Evaluation
+{
+
+/** The statistics of one spectrum used to judge if the spectrum is good enough to evaluate. */
+struct SpectrumStatistics
+{
+    /** The maximum intensity of the spectrum, the last two pixels excluded. */
+    double peakIntensity = 0.0;
+
+    /** The maximum intensity of the spectrum in the fit region. */
+    double fitIntensity = 0.0;
+
+    /** The fitIntensity divided by the full dynamic range of the spectrum,
+        a value of 1.0 (or above) means that the spectrum is saturated in the fit region. */
+    double maximumSaturationRatioInFitRegion = 0.0;
+};
+
+/** Calculates the peak intensity, fit intensity and saturation ratio of the given data in one pass.
+    @param data The intensities of the spectrum.
+    @param length The number of values in data.
+    @param fitLow The first pixel of the fit region.
+    @param fitHigh The pixel after the last pixel of the fit region.
+    @param fullDynamicRange The highest intensity which can be measured in this spectrum.
+        If this is not positive then the saturation ratio is left at zero. */
+SpectrumStatistics CalculateSpectrumStatistics(const double* data, int length, int fitLow, int fitHigh, double fullDynamicRange);
+
+/** Calculates the peak intensity, fit intensity and saturation ratio of the given spectrum in one pass.
+    The full dynamic range is taken from the spectrometer model, such that the saturation ratio
+    is the same as given by novac::GetMaximumSaturationRatioOfSpectrum. */
+SpectrumStatistics CalculateSpectrumStatistics(const novac::CSpectrum& spectrum, const novac::SpectrometerModel& model, int fitLow, int fitHigh);
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace FileHandler
+{
+/** The CBufferedFileWriter writes formatted text to a file through an in-memory buffer of fixed size.
+    The text is formatted directly into the buffer, which is only handed to the file system once it is full,
+    such that writing many short fields costs neither a call into the C runtime nor a lock per field. */
+class CBufferedFileWriter
+{
+public:
+    /** The default size of the buffer, in bytes */
+    static const size_t defaultBufferSize = 256 * 1024;
+
+    explicit CBufferedFileWriter(size_t bufferSize = defaultBufferSize);
+    ~CBufferedFileWriter();
+
+    // Non copyable object, since this owns the file handle
+    CBufferedFileWriter(const CBufferedFileWriter&) = delete;
+    CBufferedFileWriter& operator=(const CBufferedFileWriter&) = delete;
+
+    /** Opens the given file for writing, closing any previously opened file.
+        @param append If true then the text is appended to the file if it already exists,
+            otherwise any existing file is overwritten.
+        @return true if the file could be opened. */
+    bool Open(const std::string& fileName, bool append);
+
+    /** @return true if a file is open */
+    bool IsOpen() const { return m_file != nullptr; }
+
+    /** Appends the given text, formatted using the common printf formatting. */
+    void Printf(const char* format, ...);
+
+    /** Appends the given text */
+    void Write(const char* text);
+    void Write(const std::string& text);
+
+    /** Writes the buffered text to the file */
+    void Flush();
+
+    /** Writes the buffered text to the file and closes it. */
+    void Close();
+
+private:
+    FILE* m_file = nullptr;
+
+    std::vector<char> m_buffer;
+
+    /** The number of bytes of m_buffer which are in use */
+    size_t m_length = 0;
+
+    void Write(const char* text, size_t length);
+};
+}
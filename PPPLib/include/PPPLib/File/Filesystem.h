@@ -1,6 +1,7 @@
 #ifndef NOVACPPP_FILESYSTEM_FILESYSTEM_H
 #define NOVACPPP_FILESYSTEM_FILESYSTEM_H
 
+#include <functional>
 #include <string>
 #include <vector>
 #include <PPPLib/MFC/CString.h>
@@ -15,9 +16,19 @@ struct FileSearchCriterion
     {
     }
 
+    /** If endTime > startTime then only files whose name indicates that they
+        were created in the interval [startTime, endTime] are included. */
     novac::CDateTime startTime;
     novac::CDateTime endTime;
+
+    /** If not empty, then only files with this extension are included. */
     std::string fileExtension;
+
+    /** If directoryEndTime > directoryStartTime then sub-directories named after a date (yyyy.mm.dd)
+        which lies completely outside of [directoryStartTime, directoryEndTime] are not searched at all.
+        This should only be set when the directories and files are trusted to follow the Novac naming convention. */
+    novac::CDateTime directoryStartTime;
+    novac::CDateTime directoryEndTime;
 };
 
 /** Scans through the given directory in search for files with the given criteria.
@@ -27,6 +38,32 @@ struct FileSearchCriterion
     @param criteria If not null, then this is used to filter the list of files. */
 void SearchDirectoryForFiles(const std::string& path, bool includeSubdirectories, std::vector<std::string>& fileList, FileSearchCriterion* criteria = nullptr);
 
+/** Scans through the given directory in search for files with the given criteria, using several threads
+    to search the sub-directories concurrently. This is intended for deep directory trees on network storage,
+    where the latency of listing each directory dominates the time it takes to search for the files.
+    The files found in each directory are reported through the callback as soon as that directory has been searched,
+    such that the caller can start processing the files while the search continues.
+    @param path - the directory (on the local computer) where to search for files.
+    @param includeSubdirectories If set to true then sub-directories of the provided path will also be searched.
+    @param criteria If not null, then this is used to filter the list of files and to prune the sub-directories to search.
+    @param threadNum The number of threads to use in the search, at least one thread is always used.
+    @param onFilesFound Called with the files found in each searched directory. Notice that this is called
+        from the searching threads and hence must be thread safe. The order of the calls is not deterministic.
+    @return The total number of files found.
+    @throws Any exception thrown by onFilesFound. The search is then stopped and the exception is passed on
+        once all the searching threads are done. */
+size_t SearchDirectoryForFilesInParallel(
+    const std::string& path,
+    bool includeSubdirectories,
+    const FileSearchCriterion* criteria,
+    unsigned int threadNum,
+    std::function<void(std::vector<std::string>&)> onFilesFound);
+
+/** @return true if the given directory name is a date (yyyy.mm.dd) and this date lies
+    completely outside of the interval [criteria.directoryStartTime, criteria.directoryEndTime].
+    Directories for which this returns true does not need to be searched. */
+bool IsDateDirectoryOutsideOfInterval(const std::string& directoryName, const FileSearchCriterion& criteria);
+
 /** A simple function to find out whether a given file exists or not.
     @param - The filename (including path) to the file.
     @return 0 if the file does not exist.
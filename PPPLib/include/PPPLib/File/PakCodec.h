@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace FileHandler
+{
+
+/** The compression of the spectra in the Novac .pak files.
+
+    The spectrum is stored as the differences between consecutive pixels, the first pixel being
+    stored as its difference from zero. The differences are divided into segments of at most 127
+    values, each of which is stored as a 12 bit header followed by the values of the segment, each
+    written with the same number of bits (in two's complement). The header holds the number of
+    values in the segment (7 bits) followed by the number of bits of each value (5 bits).
+    All bits are written with the most significant bit first and the last byte is padded with zeros.
+
+    The compression does not keep any state between calls, hence it can be called from several threads at once.
+    The .pak files are read by the SpectralEvaluation library, hence there is no decompression here. */
+
+/** The largest magnitude of the difference between two consecutive values which can be compressed */
+const std::int32_t pakMaximumDifference = (1 << 30) - 1;
+
+/** Compresses the given spectrum.
+    @param values The pixel values of the spectrum.
+    @param length The number of values.
+    @param compressed Will on return be filled with the compressed data (and nothing else).
+    @throws std::invalid_argument if the difference between two consecutive values (or the first value)
+        does not lie in the range [-pakMaximumDifference - 1, pakMaximumDifference]. */
+void CompressSpectrumData(const std::int32_t* values, size_t length, std::vector<std::uint8_t>& compressed);
+
+}
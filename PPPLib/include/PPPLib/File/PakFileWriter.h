@@ -0,0 +1,109 @@
+#pragma once
+
+#include <SpectralEvaluation/DateTime.h>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace FileHandler
+{
+
+/** The header of one spectrum in a .pak file, version 5 of the 'MKZY' header.
+    The members are stored in the file in the same order and with the same units as here. */
+struct PakSpectrumHeader
+{
+    /** The name of the spectrum, e.g. 'sky', 'dark' or 'scan'. At most 11 characters are stored. */
+    std::string name;
+
+    /** The serial number of the spectrometer. At most 15 characters are stored. */
+    std::string instrumentName;
+
+    std::uint16_t startChannel = 0;
+
+    /** The viewing angle of the spectrum, in degrees. 180 is used for the dark spectra. */
+    std::int16_t viewAngle = 0;
+
+    /** The number of co-added spectra */
+    std::uint16_t scans = 15;
+
+    /** The exposure time of each spectrum, in milliseconds */
+    std::int16_t exposureTime = 0;
+
+    /** The channel of the spectrometer, 0 for the master and 1 for the slave */
+    std::uint8_t channel = 0;
+
+    std::uint8_t flag = 0;
+
+    /** The date when the spectrum was collected, stored as DDMMYY */
+    std::uint32_t date = 0;
+
+    /** The start and stop time of the spectrum, stored as hhmmsscc (cc being hundredths of a second) */
+    std::uint32_t startTime = 0;
+    std::uint32_t stopTime = 0;
+
+    double latitude = 0.0;
+    double longitude = 0.0;
+    std::int16_t altitude = 0;
+
+    /** The index of this spectrum in the measurement and the number of spectra in the measurement */
+    std::int8_t measurementIndex = 0;
+    std::int8_t measurementCount = 0;
+
+    /** The second viewing angle, in degrees, for instruments which can scan in two directions */
+    std::int16_t viewAngle2 = 0;
+
+    /** The compass direction of the instrument, in tenths of a degree */
+    std::int16_t compassDirection = 0;
+
+    std::int16_t tiltX = 0;
+    std::int16_t tiltY = 0;
+    float temperature = 0.0f;
+
+    /** The cone angle of the scanner, in degrees */
+    std::int8_t coneAngle = 90;
+
+    std::uint16_t adc[8] = {};
+
+    /** Sets the date, startTime and stopTime from the given times. */
+    void SetTime(const novac::CDateTime& start, const novac::CDateTime& stop);
+};
+
+/** The class <b>CPakFileWriter</b> writes spectra to a .pak file, each spectrum as a 'MKZY' header
+    followed by the compressed spectrum data. */
+class CPakFileWriter
+{
+public:
+    /** The size of the written headers, in bytes */
+    static const std::uint16_t headerSize = 114;
+
+    CPakFileWriter() = default;
+    ~CPakFileWriter();
+
+    // Non copyable object, since this owns the open file
+    CPakFileWriter(const CPakFileWriter&) = delete;
+    CPakFileWriter& operator=(const CPakFileWriter&) = delete;
+
+    /** Creates the given file, overwriting any existing file with the same name.
+        @return true if the file could be created. */
+    bool Open(const std::string& fileName);
+
+    /** Appends one spectrum to the file.
+        @param header The header of the spectrum. The number of pixels and the size of the data are filled in here.
+        @param values The pixel values of the spectrum, as the sum of all co-added spectra.
+        @param length The number of pixels in the spectrum.
+        @return true if the spectrum could be written.
+        @throws std::invalid_argument if the spectrum cannot be compressed, see CompressSpectrumData. */
+    bool Write(const PakSpectrumHeader& header, const std::int32_t* values, size_t length);
+
+    /** Closes the file. This is also done when the writer is destroyed. */
+    void Close();
+
+private:
+    FILE* m_file = nullptr;
+
+    /** The compressed data of the last written spectrum, kept here such that the memory can be reused. */
+    std::vector<std::uint8_t> m_compressed;
+};
+
+}
@@ -48,6 +48,9 @@ private:
     /** Parses an individual quality-judgement section */
     void Parse_DiscardSettings(Configuration::CUserConfiguration& settings);
 
+    /** Parses the 'FluxSensitivity' section, with the alternative wind fields and plume altitudes */
+    void Parse_FluxSensitivity(Configuration::CUserConfiguration& settings);
+
     void PrintParameter(FILE* f, int nTabs, const novac::CString& tag, const novac::CString& value);
     void PrintParameter(FILE* f, int nTabs, const novac::CString& tag, const int& value);
     void PrintParameter(FILE* f, int nTabs, const novac::CString& tag, const unsigned int& value);
@@ -2,18 +2,22 @@
 
 #include <SpectralEvaluation/DateTime.h>
 #include <PPPLib/MFC/CString.h>
-#include <PPPLib/MFC/CStdioFile.h>
 #include <PPPLib/Logging.h>
+#include <string>
+#include <vector>
 
 namespace FileHandler
 {
+/** The CXMLFileReader is the base class for the readers of the xml-based configuration files.
+    The file is read into memory when opened and is then tokenized in place, one line at a time,
+    without using any global state. Hence different instances may be used in different threads at the same time. */
 class CXMLFileReader
 {
 public:
     CXMLFileReader(novac::ILogger& log);
     virtual ~CXMLFileReader();
 
-    // Non copyable object, since we are managing a file pointer
+    // Non copyable object, since the tokens are pointers into the buffer
     CXMLFileReader(const CXMLFileReader&) = delete;
     CXMLFileReader& operator=(const CXMLFileReader&) = delete;
 
@@ -63,28 +67,38 @@ protected:
     /** The name of the currently opened file. For debugging reasons */
     std::string m_filename = "";
 
-    /** Opens the provided file for reading.
+    /** Opens the provided file for reading, the entire file is read into memory.
         @return true if successful */
     bool Open(const novac::CString& fileName);
 
-    /** Closes m_File */
+    /** Releases the contents of the last opened file */
     void Close();
 
     /** Returns true if the provided token equals the closing xml tag */
     static bool IsClosingTag(const novac::CString& endTag, const char* token);
 
 private:
-    /** Pointer to the next token. Should only be modified by 'NextToken()' */
-    char* m_tokenPt = nullptr;
+    /** The contents of the opened file, with a terminating null character.
+        The tokens are null-terminated in place in this buffer. */
+    std::vector<char> m_buffer;
 
-    /** A handle to the file to read from. */
-    novac::CStdioFile* m_File = nullptr;
+    /** The position in m_buffer of the beginning of the next line to read. */
+    size_t m_nextLinePosition = 0;
 
-    /** The string that was read from the file */
-    char szLine[4096];
+    /** The position in the current line where to search for the next token,
+        nullptr if all tokens in the current line have been read. */
+    char* m_linePosition = nullptr;
+
+    /** Makes the next line in m_buffer the current line.
+        @return false if there are no more lines. */
+    bool ReadNextLine();
+
+    /** Retrieves the next token from the current line, in the same way as strtok would.
+        @return nullptr if there are no more tokens in the current line. */
+    char* NextTokenInCurrentLine();
 
     /** String representing the value of the last retrieved attribute */
-    char attributeValue[4096];
+    std::string m_attributeValue;
 
     /** The number of lines that has been read from the file */
     long nLinesRead = 0;
@@ -11,6 +11,7 @@
 
 #include <PPPLib/MFC/CString.h>
 #include <SpectralEvaluation/Log.h>
+#include <vector>
 
 namespace Configuration
 {
@@ -20,6 +21,34 @@ class CUserConfiguration;
 
 namespace Flux
 {
+/** The data points of one scan which are used to calculate its flux.
+    These are extracted once from the evaluation log, such that the flux of the
+    scan can then be calculated again and again for different wind fields and plume heights. */
+struct FluxScanData
+{
+    /** The start time of the scan, as given in the evaluation result */
+    novac::CDateTime startTime;
+
+    /** The serial of the instrument that collected the scan */
+    std::string instrument;
+
+    novac::NovacInstrumentType instrumentType = novac::NovacInstrumentType::Gothenburg;
+
+    /** The configured location of the instrument at the time of the scan */
+    Configuration::CInstrumentLocation location;
+
+    /** The scan angles, the second scan angles and the columns (in kg/m2) of the good spectra of the scan */
+    std::vector<double> scanAngle;
+    std::vector<double> scanAngle2;
+    std::vector<double> column;
+
+    /** The fitted errors of the columns, in kg/m2 */
+    std::vector<double> columnError;
+
+    /** The offset of the scan, in kg/m2 */
+    double offset = 0.0;
+};
+
 /** The class <b>CFluxCalculator</b> s used to to perform the
     flux calculation of the scans.
 
@@ -110,6 +139,62 @@ public:
         double coneAngle = 90.0,
         double tilt = 0.0);
 
+    /** Calculates the flux of one scan for a batch of combinations of wind speed, wind direction and plume height.
+    *   The flux is proportional to both the wind speed and the height of the plume, hence the geometry of
+    *    the scan is only evaluated once for each distinct wind direction and the fluxes of all the combinations
+    *    are then scaled from these. The results are the same as from CalculateFlux, to within rounding errors.
+    *   Each distinct wind direction is a call to the scalar flux kernel of SpectralEvaluation,
+    *    the geometry is not shared between the wind directions and the kernel is not vectorized.
+    *   The angles here must be in degrees and the columns, and the offset, in the same unit as in CalculateFlux.
+    *   @param windSpeed - the wind speeds, in m/s, nCombinations values.
+    *   @param windDirection - the wind directions, in degrees, nCombinations values.
+    *   @param relativePlumeHeight - the heights of the plume above the instrument, in meters, nCombinations values.
+    *   @param flux - will on return be filled with the nCombinations calculated fluxes, in kg/s. */
+    void CalculateFluxBatch(
+        novac::LogContext context,
+        const double* scanAngle,
+        const double* scanAngle2,
+        const double* column,
+        double offset,
+        size_t nDataPoints,
+        const double* windSpeed,
+        const double* windDirection,
+        const double* relativePlumeHeight,
+        size_t nCombinations,
+        double compass,
+        novac::NovacInstrumentType type,
+        double coneAngle,
+        double tilt,
+        double* flux);
+
+    /** Reads the scan of the given evaluation result and extracts the data needed to calculate its flux.
+        The same checks of the scan are made as in CalculateFlux, except for the wind field and plume height.
+        @return true if the flux of the scan can be calculated. */
+    bool PrepareFluxScanData(
+        novac::LogContext context,
+        const Evaluation::CExtendedScanResult& evaluationResult,
+        FluxScanData& scanData);
+
+    /** Calculates the flux of a scan prepared with PrepareFluxScanData.
+        @param relativePlumeHeight - the height of the plume, in meters above the instrument.
+        @return the calculated flux in kg/s, or NaN if the flux could not be calculated. */
+    double CalculateFlux(
+        novac::LogContext context,
+        const FluxScanData& scanData,
+        const Meteorology::WindField& wind,
+        const Geometry::PlumeHeight& relativePlumeHeight);
+
+    /** Calculates the flux of a scan prepared with PrepareFluxScanData for a batch of
+        combinations of wind speed, wind direction and plume height, see CalculateFluxBatch above. */
+    void CalculateFluxBatch(
+        novac::LogContext context,
+        const FluxScanData& scanData,
+        const double* windSpeed,
+        const double* windDirection,
+        const double* relativePlumeHeight,
+        size_t nCombinations,
+        double* flux);
+
 private:
     // ----------------------------------------------------------------------
     // ---------------------- PRIVATE DATA ----------------------------------
@@ -136,14 +221,47 @@ private:
         const novac::CDateTime& startTime,
         Configuration::CInstrumentLocation& instrLocation);
 
-    /** Appends the evaluated flux to the appropriate log file.
-        @param scan - the scan itself, also containing information about the evaluation and the flux.
-        @return SUCCESS if operation completed sucessfully. */
-    RETURN_CODE WriteFluxResult(
+    /** Verifies that the evaluation result refers to an existing evaluation log and
+        retrieves the location of the instrument at the time of the scan.
+        @return true if the flux of the scan can be calculated. */
+    bool ValidateEvaluationResult(
         novac::LogContext context,
-        const Flux::FluxResult& fluxResult,
-        const Evaluation::CScanResult* result);
+        const Evaluation::CExtendedScanResult& evaluationResult,
+        Configuration::CInstrumentLocation& instrLocation);
+
+    /** Reads the (first) scan in the evaluation log of the given evaluation result and calculates
+        the properties of the plume in the scan.
+        @return true if the scan sees the plume with a completeness above the limit. */
+    bool ReadScan(
+        novac::LogContext context,
+        const Evaluation::CExtendedScanResult& evaluationResult,
+        Evaluation::CScanResult& result);
 
+    /** Extracts the scan angles, columns and column errors (converted to kg/m2) of the spectra in the scan
+        which can be used to calculate the flux.
+        @return the number of extracted data points. */
+    static size_t ExtractGoodDataPoints(
+        const Evaluation::CScanResult& result,
+        const novac::Molecule& specie,
+        int specieIndex,
+        FluxScanData& scanData);
+
+    /** Calculates the flux using the supplied data, this is the common implementation
+        of CalculateFlux and CalculateFluxBatch. */
+    double CalculateFluxWithParameters(
+        novac::LogContext context,
+        const double* scanAngle,
+        const double* scanAngle2,
+        const double* column,
+        double offset,
+        size_t nDataPoints,
+        double windSpeed,
+        double windDirection,
+        double relativePlumeHeight,
+        double compass,
+        novac::NovacInstrumentType type,
+        double coneAngle,
+        double tilt);
 
     static FluxQuality CompletessFluxQuality(const Flux::FluxResult& fluxResult);
 
@@ -5,6 +5,7 @@
 #include <PPPLib/Meteorology/MeteorologySource.h>
 #include <PPPLib/Meteorology/WindField.h>
 #include <PPPLib/Geometry/PlumeHeight.h>
+#include <limits>
 
 enum class FluxQuality
 {
@@ -36,6 +37,13 @@ public:
         plume height */
     double m_fluxError_PlumeHeight = 0.0;
 
+    /** The 5th, 50th and 95th percentiles of the distribution of the flux, in kg/s,
+        as estimated by Monte-Carlo sampling of the uncertainties in wind field, plume height, offset and columns.
+        These are NaN if the distribution has not been estimated. */
+    double m_fluxPercentile05 = std::numeric_limits<double>::quiet_NaN();
+    double m_fluxPercentile50 = std::numeric_limits<double>::quiet_NaN();
+    double m_fluxPercentile95 = std::numeric_limits<double>::quiet_NaN();
+
     /** The wind field that was used to calculate this flux */
     Meteorology::WindField m_windField;
 
@@ -77,5 +85,14 @@ public:
     /** The calculated plume centre position */
     double m_plumeCentre[2] = { 0.0, 0.0 };
 
+    /** The temperature of the instrument during the scan */
+    double m_temperature = 0.0;
+
+    /** The battery voltage of the instrument during the scan */
+    double m_batteryVoltage = 0.0;
+
+    /** The exposure time of the sky spectrum of the scan, in milliseconds */
+    long m_exposureTime = 0;
+
 };
 }
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <PPPLib/File/BufferedFileWriter.h>
+#include <PPPLib/Flux/FluxResult.h>
+#include <SpectralEvaluation/DateTime.h>
+#include <SpectralEvaluation/Log.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace Flux
+{
+
+/** The outputs which the calculated fluxes are written to by a CFluxResultWriter */
+struct FluxResultOutputs
+{
+    /** FluxLog.xml (and the fluxresult.xsl used to display it) in the output directory */
+    bool xml = true;
+
+    /** FluxLog.txt, tab separated, in the output directory */
+    bool txt = true;
+
+    /** FluxLog.csv, comma separated with one column per value and empty fields for missing values,
+        in the output directory. This is intended to be read by other programs. */
+    bool csv = false;
+
+    /** One flux log for each instrument and day, in the sub-directory YYYY.MM.DD/serial/ of the output directory. */
+    bool instrumentLogs = false;
+
+    /** The 5th, 50th and 95th percentiles of the flux are written as columns of FluxLog.txt.
+        These are only estimated if FluxUncertaintySamples is larger than zero. */
+    bool fluxPercentiles = false;
+};
+
+/** The class <b>CFluxResultWriter</b> writes the calculated fluxes to all the
+    configured outputs, one flux at a time as they are calculated.
+    The text is kept in a fixed size buffer for each output and hence the memory
+    used does not depend on the number of fluxes written. */
+class CFluxResultWriter
+{
+public:
+    CFluxResultWriter(novac::ILogger& log, const std::string& outputDirectory, const FluxResultOutputs& outputs);
+    ~CFluxResultWriter();
+
+    // Non copyable object, since this owns the open files
+    CFluxResultWriter(const CFluxResultWriter&) = delete;
+    CFluxResultWriter& operator=(const CFluxResultWriter&) = delete;
+
+    /** Creates the flux logs in the output directory and writes their headers.
+        Any existing FluxLog.xml, FluxLog.txt and FluxLog.csv are overwritten, hence
+        these should be archived before this is called.
+        @param now The time to write as the creation time of the logs. */
+    void Open(novac::LogContext context, const novac::CDateTime& now);
+
+    /** Writes the given flux to all the configured outputs */
+    void Write(const FluxResult& fluxResult);
+
+    /** Finishes and closes all the outputs. This is also done when the writer is destroyed. */
+    void Close();
+
+    /** @return the full path to the given flux log (e.g. "FluxLog.xml") in the output directory */
+    std::string GetFileName(const std::string& name) const;
+
+private:
+
+    novac::ILogger& m_log;
+
+    const std::string m_outputDirectory;
+
+    const FluxResultOutputs m_outputs;
+
+    FileHandler::CBufferedFileWriter m_xml;
+
+    FileHandler::CBufferedFileWriter m_txt;
+
+    FileHandler::CBufferedFileWriter m_csv;
+
+    /** The flux log of one instrument, for the day of the last flux written from it. */
+    struct InstrumentLog
+    {
+        int day = 0;
+        std::unique_ptr<FileHandler::CBufferedFileWriter> file;
+    };
+
+    /** The open flux logs of the instruments, by serial.
+        Only the log of the latest day is kept open for each instrument. */
+    std::unordered_map<std::string, InstrumentLog> m_instrumentLogs;
+
+    novac::LogContext m_context;
+
+    void WriteXml(const FluxResult& fluxResult);
+    void WriteTxt(const FluxResult& fluxResult);
+    void WriteCsv(const FluxResult& fluxResult);
+    void WriteInstrumentLog(const FluxResult& fluxResult);
+
+    /** Writes the xslt file used to display FluxLog.xml */
+    void WriteXmlStyleSheet();
+};
+
+}
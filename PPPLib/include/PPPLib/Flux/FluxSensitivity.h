@@ -0,0 +1,87 @@
+#pragma once
+
+#include <PPPLib/Flux/FluxCalculator.h>
+#include <PPPLib/Evaluation/ExtendedScanResult.h>
+#include <PPPLib/Geometry/PlumeDataBase.h>
+#include <PPPLib/Meteorology/WindDataBase.h>
+#include <SpectralEvaluation/Log.h>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace Configuration
+{
+class CNovacPPPConfiguration;
+class CUserConfiguration;
+}
+
+namespace Flux
+{
+
+/** One combination of wind field and plume altitude for which the
+    fluxes of all scans are calculated in a flux sensitivity study. */
+struct FluxSensitivityVariant
+{
+    /** A short description of the wind field, used in the output */
+    std::string windFieldName;
+
+    /** The wind field to use. This is not owned by the variant. */
+    const Meteorology::CWindDataBase* windField = nullptr;
+
+    /** The altitude of the plume to use, in meters above sea level.
+        If this is NaN then the plume altitude is taken from the plume height database instead. */
+    double plumeAltitude = std::numeric_limits<double>::quiet_NaN();
+};
+
+/** The class <b>CFluxSensitivityCalculator</b> is used to calculate the fluxes
+    of a set of scans for many different wind fields and plume altitudes,
+    e.g. to compare different sources of the wind field.
+
+    The evaluation logs are only read once, in PrepareScans, after which the
+    fluxes of all the variants are calculated from the extracted data points. */
+class CFluxSensitivityCalculator
+{
+public:
+    CFluxSensitivityCalculator(
+        novac::ILogger& log,
+        const Configuration::CNovacPPPConfiguration& setup,
+        const Configuration::CUserConfiguration& userSettings);
+
+    /** Reads the evaluation logs of the given scans and extracts the data needed to calculate their fluxes.
+        Scans which are not flux measurements, or whose flux cannot be calculated, are left out of the result.
+        The logs are read in parallel, using at most m_maxThreadNum threads.
+        @return the prepared scans, in the same order as in scanResults. */
+    std::vector<FluxScanData> PrepareScans(
+        novac::LogContext context,
+        const std::vector<Evaluation::CExtendedScanResult>& scanResults);
+
+    /** Calculates the flux of each of the scans for each of the variants.
+        The scans are processed in parallel, using at most m_maxThreadNum threads.
+        @param plumeDataBase The plume altitudes to use for the variants which don't specify a plume altitude.
+        @return the fluxes in kg/s, stored scan by scan with one value for each variant.
+            Fluxes which could not be calculated are NaN. */
+    std::vector<double> CalculateFluxes(
+        novac::LogContext context,
+        const std::vector<FluxScanData>& scans,
+        const std::vector<FluxSensitivityVariant>& variants,
+        const Geometry::CPlumeDataBase& plumeDataBase);
+
+    /** Writes the fluxes calculated by CalculateFluxes to a tab separated text file,
+        with one line for each scan and one column for each variant.
+        @return true on success. */
+    static bool WriteFluxes(
+        const std::string& fileName,
+        const std::vector<FluxScanData>& scans,
+        const std::vector<FluxSensitivityVariant>& variants,
+        const std::vector<double>& fluxes);
+
+private:
+
+    novac::ILogger& m_log;
+
+    const Configuration::CUserConfiguration& m_userSettings;
+
+    CFluxCalculator m_fluxCalculator;
+};
+
+}
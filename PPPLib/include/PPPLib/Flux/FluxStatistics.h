@@ -4,8 +4,11 @@
 #define FLUXSTATISTICS_H
 
 #include <PPPLib/MFC/CString.h>
-#include <PPPLib/MFC/CList.h>
 #include <PPPLib/Flux/FluxResult.h>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace Flux
 {
@@ -32,7 +35,7 @@ public:
     void AttachFluxList(const std::list<FluxResult>& calculatedFluxes);
 
     /** Attaches the given flux result to the current set of
-        measured data */
+        measured data. Only the flux, the day and the instrument are kept. */
     void AttachFlux(const FluxResult& result);
 
     /** Calculates statistics on the statistics we have here and writes
@@ -44,23 +47,38 @@ private:
     // ---------------------- PRIVATE DATA ----------------------------------
     // ----------------------------------------------------------------------
 
-    class CMeasurementDay
+    /** The fluxes measured during one day */
+    struct MeasurementDay
     {
-    public:
-        novac::CDateTime day; // the date of the measurement
-        novac::CList <FluxResult> fluxList;
-        static void GetHeaderLine(novac::CString& str, novac::CList <novac::CString, novac::CString&>& instruments);
-        void GetStatistics(novac::CString& str, novac::CList <novac::CString, novac::CString&>& instruments);
-        CMeasurementDay& operator=(const CMeasurementDay& m);
+        /** The date of the measurement */
+        novac::CDateTime day;
+
+        /** The fluxes measured this day, in the order they were attached */
+        std::vector<double> fluxes;
+
+        /** The number of fluxes measured by each of the instruments this day.
+            measurementsPerInstrument[i] is the number of fluxes from m_instruments[i] */
+        std::vector<int> measurementsPerInstrument;
     };
 
-    /** The list of measurement results.
-        This is sorted by the 'day' in increasing order */
-    novac::CList <CMeasurementDay, CMeasurementDay&> m_measurements;
+    /** The measurement days, in the order they were first seen.
+        These are sorted by the day when the statistics are written. */
+    std::vector<MeasurementDay> m_measurements;
+
+    /** Looks up the index in m_measurements of a day, from the date formatted as YYYYMMDD. */
+    std::unordered_map<int, size_t> m_dayIndex;
+
+    /** The instruments used, in the order they were first seen. */
+    std::vector<std::string> m_instruments;
+
+    /** Looks up the index in m_instruments of an instrument, from its serial in lower case. */
+    std::unordered_map<std::string, size_t> m_instrumentIndex;
+
+    /** @return the header line of the statistics file. */
+    std::string GetHeaderLine() const;
 
-    /** The list of instruments used. This is updated together with
-        'm_measurements' when calling 'AttachFlux' */
-    novac::CList <novac::CString, novac::CString&> m_instruments;
+    /** @return the line of the statistics file with the statistics of the given day. */
+    std::string GetStatistics(const MeasurementDay& measurementDay) const;
 
 };
 }
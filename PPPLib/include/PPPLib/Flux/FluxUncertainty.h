@@ -0,0 +1,59 @@
+#pragma once
+
+#include <PPPLib/Flux/FluxCalculator.h>
+#include <PPPLib/Flux/FluxResult.h>
+#include <SpectralEvaluation/Log.h>
+#include <cstdint>
+#include <vector>
+
+namespace Flux
+{
+
+/** The class <b>CFluxUncertaintyCalculator</b> estimates the distribution of the flux of a scan
+    by Monte-Carlo sampling of the uncertainties in wind speed, wind direction, plume height,
+    plume offset and the columns of the scan.
+
+    The flux kernel is only called a fixed number of times for each scan, independently of the number of samples:
+    the flux is proportional to the wind speed and the plume height, the flux of the sampled wind directions is
+    interpolated quadratically from the fluxes at the nominal wind direction and one standard deviation on either
+    side of it, and the flux is linear in the columns and the offset, hence their uncertainty is sampled as a normally
+    distributed relative deviation whose size is estimated from columnRealizations realizations of the columns.
+
+    The random numbers are seeded from the scan itself, such that the result does not depend
+    on which thread calculates it. The memory of the sampled values is kept for each thread and reused
+    for the following scans on that thread, hence an instance is cheap to create for each scan. */
+class CFluxUncertaintyCalculator
+{
+public:
+    CFluxUncertaintyCalculator(CFluxCalculator& fluxCalculator, size_t numberOfSamples);
+
+    /** The number of realizations of the offset and columns of a scan used to estimate their effect on the flux */
+    static const size_t columnRealizations = 4;
+
+    /** Estimates the distribution of the flux of the given scan and fills in
+        m_fluxPercentile05, m_fluxPercentile50 and m_fluxPercentile95 of the fluxResult.
+        @param relativePlumeHeight - the height of the plume above the instrument, and its uncertainty.
+        @return true if the percentiles could be calculated. */
+    bool CalculatePercentiles(
+        novac::LogContext context,
+        const FluxScanData& scanData,
+        const Meteorology::WindField& wind,
+        const Geometry::PlumeHeight& relativePlumeHeight,
+        FluxResult& fluxResult);
+
+    /** Calculates the given percentile (in the range [0, 1]) of the values, using the nearest rank.
+        The values are reordered in the process. NaN values are ignored.
+        @return the percentile, or NaN if there are no valid values. */
+    static double Percentile(std::vector<double>& values, double percentile);
+
+    /** @return a seed for the random numbers used to sample the given scan. */
+    static std::uint64_t GetSeed(const FluxScanData& scanData);
+
+private:
+
+    CFluxCalculator& m_fluxCalculator;
+
+    const size_t m_numberOfSamples;
+};
+
+}
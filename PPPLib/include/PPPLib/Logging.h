@@ -4,7 +4,7 @@
 #include <SpectralEvaluation/Log.h>
 
 /** Appends an information / warning message to the logs.
-    Implementations are in Common.cpp (using Poco) */
+    Implementations are in Common.cpp (using Poco) and in ConsoleLogging.cpp (writing to the console) */
 void ShowMessage(const novac::CString& message);
 void ShowMessage(const char message[]);
 void ShowMessage(const novac::CString& message, novac::CString connectionID);
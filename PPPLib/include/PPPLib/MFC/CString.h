@@ -1,6 +1,7 @@
 #ifndef NOVAC_PPPLIB_CSTRING_H
 #define NOVAC_PPPLIB_CSTRING_H
 
+#include <cstdarg>
 #include <string>
 
 namespace novac
@@ -41,13 +42,17 @@ public:
     // --------------------- Formatting -----------------------
 
 
+    // The formatted strings are never truncated, regardless of their length.
+    //  If the format is invalid, then nothing is written.
+
     /** Constructs a new string using the common printf formatting. */
     static CString FormatString(const char* format, ...);
 
     /** Constructs the contents of this string using the common printf formatting. */
     void Format(const char* format, ...);
 
-    /** Appends the contents of this string using the common printf formatting. */
+    /** Appends the contents of this string using the common printf formatting.
+        The formatted text is appended in place, without copying the existing contents. */
     CString& AppendFormat(const char* format, ...);
 
     /** Appends the contents of the other string to this. */
@@ -119,6 +124,9 @@ public:
 
 private:
     std::string m_data;
+
+    /** Appends the printf formatted arguments to the end of the destination. */
+    static void AppendFormatV(std::string& destination, const char* format, va_list args);
 };
 
 // Appending CStrings
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <list>
+#include <string>
 #include <vector>
 #include <SpectralEvaluation/DateTime.h>
 #include <SpectralEvaluation/Definitions.h>
@@ -80,10 +82,34 @@ public:
             The altitude in 'location ' will be ignored. */
     void InsertWindSpeed(const novac::CDateTime& validFrom, const novac::CDateTime& validTo, double windSpeed, double windSpeed_err, MeteorologySource wd_src, const novac::CGPSData* location);
 
+    /** Inserts all the wind fields of the other database into this database.
+        The result is the same as if all the wind fields inserted into 'other'
+        had been inserted into this database instead, in the same order.
+        The name of this database is set to the name of 'other', unless that is empty. */
+    void Merge(const CWindDataBase& other);
+
     /** Writes the contents of this database to file.
         @return 0 on success. */
     int WriteToFile(const novac::CString& fileName) const;
 
+    /** Writes the contents of this database to a binary file, which can be read back
+        much faster than the xml file the database was read from.
+        The format is only intended to be used as a cache on the same computer,
+        the values are written with the byte order of this computer.
+        @param sourceHash - an identifier of the source files the database was read from,
+            stored in the file and verified when reading it back.
+        @return true on success. */
+    bool WriteToBinaryFile(const std::string& fileName, std::uint64_t sourceHash) const;
+
+    /** Reads the contents of this database from a binary file created by WriteToBinaryFile,
+        replacing the current contents of the database.
+        @param sourceHash - the identifier of the source files, this must be the same as
+            the one given when writing the file.
+        @return true on success. If the file does not exist, has another version of the format,
+            was created from other source files or is corrupt then false is returned
+            and this database is left unchanged. */
+    bool ReadFromBinaryFile(const std::string& fileName, std::uint64_t sourceHash);
+
     /** Retrieves the size of the database */
     int GetDataBaseSize() const;
 
@@ -34,7 +34,11 @@ public:
     void ReadWindFile(novac::LogContext context, const novac::CString& fileName, Meteorology::CWindDataBase& dataBase);
 
     /** Reads in all the wind-field files that are found in a given directory
-        The directory can be on the local computer or on the FTP-server
+        The directory can be on the local computer or on the FTP-server.
+        Files named as XXXX_YYYYMMDD.wxml are only read if the date is in the requested interval.
+        The files are read in parallel, using at most m_maxThreadNum threads.
+        If a temp directory is configured, then the resulting wind field is cached there in a binary file,
+        which is read instead of the wind field files the next time exactly the same files are to be read.
         @param directory - the full path to the directory where the files are
         @param dataBase - this will on successfull return be filled with the wind
             information found in the wind field files
@@ -42,13 +46,17 @@ public:
             the date 'dateFrom' will be read in.
         @param dateTo - if not null then only file which contain a wind field before (and including)
             the date 'dateTo' will be read in.
-        @return 0 on success */
+        @throws std::invalid_argument if no wind field file could be read. */
     void ReadWindDirectory(novac::LogContext context, const novac::CString& directory, Meteorology::CWindDataBase& dataBase, const novac::CDateTime* dateFrom = NULL, const novac::CDateTime* dateTo = NULL);
 
     /** Writes an wind-field file in the NPPP-format
         @return 0 on success */
     int WriteWindFile(const novac::CString& fileName, const Meteorology::CWindDataBase& dataBase);
 
+    /** @return true if the given wind file name is formatted as XXXX_YYYYMMDD.wxml and the date
+        is before the day of dateFrom or after the day of dateTo. Null dates are not checked. */
+    static bool IsWindFileOutsideOfInterval(const std::string& fileName, const novac::CDateTime* dateFrom, const novac::CDateTime* dateTo);
+
 private:
 
     /** Reads a 'windfield' section */
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace novac
+{
+
+/** CThreadBudget limits the total number of threads used by the parallel sections of the processing.
+    Each parallel section reserves the threads it starts from the budget and gives them back when done.
+    A parallel section started while the budget is used up (e.g. from within the evaluation threads)
+    runs on the calling thread only, this keeps nested parallel sections from using up to MaxThreadNum² threads.
+    The budget is unlimited until SetMaxThreadNum is called. This is safe to use from multiple threads at the same time. */
+class CThreadBudget
+{
+public:
+    /** Sets the total number of threads which may be used, including the main thread.
+        Zero removes the limit. */
+    static void SetMaxThreadNum(unsigned long maxThreadNum);
+
+    /** Reserves up to 'threadNum' threads, in addition to the calling thread.
+        @return the number of threads reserved, which may be less than requested, or zero.
+        The reserved threads must be given back using Release. */
+    static size_t Reserve(size_t threadNum);
+
+    /** Gives back threads reserved using Reserve. */
+    static void Release(size_t threadNum);
+};
+
+/** CThreadReservation reserves threads from the CThreadBudget for as long as it exists. */
+class CThreadReservation
+{
+public:
+    /** Reserves up to 'threadNum' threads, in addition to the calling thread. */
+    explicit CThreadReservation(size_t threadNum)
+        : m_threadNum(CThreadBudget::Reserve(threadNum))
+    {
+    }
+
+    ~CThreadReservation()
+    {
+        CThreadBudget::Release(m_threadNum);
+    }
+
+    CThreadReservation(const CThreadReservation&) = delete;
+    CThreadReservation& operator=(const CThreadReservation&) = delete;
+
+    /** @return the number of threads actually reserved. */
+    size_t ThreadNum() const { return m_threadNum; }
+
+private:
+    const size_t m_threadNum;
+};
+
+/** Calls function(idx) for all idx in [0, count), using at most maxThreadNum threads including the calling one,
+    as far as the CThreadBudget allows. Each thread takes the next index which has not yet been started,
+    hence the order in which the indices are processed is not defined.
+    If the function throws then no further indices are started and, once all threads are done,
+    the exception of the lowest failing index is rethrown on the calling thread.
+    All indices below the lowest failing index have then been processed. */
+template<class Function>
+void ParallelFor(size_t count, unsigned long maxThreadNum, Function function)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    struct Failure
+    {
+        size_t index = 0;
+        std::exception_ptr error;
+    };
+
+    CThreadReservation reservation(std::min(count, static_cast<size_t>(std::max(maxThreadNum, 1UL))) - 1);
+    std::vector<Failure> failures(reservation.ThreadNum() + 1);
+
+    // The indices are taken in increasing order and each thread processes every index it has taken,
+    //  hence when a failure occurs all the lower indices are, or will be, processed.
+    std::atomic<size_t> nextIdx{ 0 };
+    std::atomic<bool> hasFailed{ false };
+    auto worker = [&](size_t threadIdx)
+    {
+        while (!hasFailed)
+        {
+            const size_t idx = nextIdx++;
+            if (idx >= count)
+            {
+                return;
+            }
+
+            try
+            {
+                function(idx);
+            }
+            catch (...)
+            {
+                failures[threadIdx].index = idx;
+                failures[threadIdx].error = std::current_exception();
+                hasFailed = true;
+                return;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    try
+    {
+        for (size_t threadIdx = 1; threadIdx <= reservation.ThreadNum(); ++threadIdx)
+        {
+            threads.push_back(std::thread(worker, threadIdx));
+        }
+    }
+    catch (const std::system_error&)
+    {
+        // Could not start more threads, continue with the ones which did start.
+    }
+
+    // This thread also takes part in the work
+    worker(0);
+
+    for (std::thread& t : threads)
+    {
+        t.join();
+    }
+
+    // Report the failure of the lowest index.
+    const Failure* firstFailure = nullptr;
+    for (const Failure& failure : failures)
+    {
+        if (failure.error != nullptr && (firstFailure == nullptr || failure.index < firstFailure->index))
+        {
+            firstFailure = &failure;
+        }
+    }
+    if (firstFailure != nullptr)
+    {
+        std::rethrow_exception(firstFailure->error);
+    }
+}
+
+}
@@ -1,6 +1,10 @@
 #pragma once
 
-#include <list>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include <PPPLib/MFC/CString.h>
 
 /// <summary>
@@ -18,10 +22,19 @@ enum class ReasonForScanRejection
 /** The class <b>CPostProcessingStatistics</b> is used to keep
     track of the statistics of the processing. E.g. how many
     scans from a certain instrument are rejected due to different
-    problems or how many scans have been processed... */
+    problems or how many scans have been processed...
+
+    The statistics are inserted from all the evaluation threads. To avoid making these
+    wait for each other, each thread inserts into a statistics shard of its own and the
+    shards are only merged when the statistics are read out. */
 class CPostProcessingStatistics
 {
 public:
+    CPostProcessingStatistics();
+    ~CPostProcessingStatistics();
+
+    CPostProcessingStatistics(const CPostProcessingStatistics&) = delete;
+    CPostProcessingStatistics& operator=(const CPostProcessingStatistics&) = delete;
 
     // ----------------------------------------------------------------------
     // ---------------------- PUBLIC DATA -----------------------------------
@@ -63,20 +76,37 @@ private:
         unsigned long darkSkySpecNum = 0;
         unsigned long saturatedSkySpecNum = 0;
         unsigned long tooLongExpTime = 0;
+
+        /** The order in which the instruments were first inserted, the instruments are written in this order. */
+        std::uint64_t insertionOrder = 0;
     };
 
+    /** The statistics inserted by one thread, defined in the .cpp file. */
+    class CStatisticsShard;
 
     // ----------------------------------------------------------------------
     // ---------------------- PRIVATE DATA ----------------------------------
     // ----------------------------------------------------------------------
 
-    /** The statistics for each of the instrument */
-    std::list <CInstrumentStats> m_instrumentStats;
+    /** Identifies this instance, such that each thread can find its own shard again. */
+    const std::uint64_t m_instanceId;
+
+    /** The shards of all threads which have inserted statistics, keyed by the id of the thread.
+        Only locked when a thread inserts its first statistics and when the shards are merged. */
+    std::mutex m_shardsGuard;
+    std::unordered_map<std::uint64_t, std::unique_ptr<CStatisticsShard>> m_shards;
+
+    // ----------------------------------------------------------------------
+    // --------------------- PRIVATE METHODS --------------------------------
+    // ----------------------------------------------------------------------
 
-    /** The number of spectra evaluated */
-    unsigned long nSpectraEvaluated = 0;
+    /** @return the shard of the calling thread, creating it if necessary. */
+    CStatisticsShard& GetShardOfThisThread();
 
-    /** The total amount of time spent in the DOAS evaluations */
-    double timeSpentOnEvaluations = 0;
+    /** @return the record of the given instrument in the shard of the calling thread, creating it if necessary. */
+    CInstrumentStats& GetInstrumentOfThisThread(const novac::CString& serial);
 
+    /** @return the statistics of all threads merged together, one record per instrument in the order
+        the instruments were first inserted. */
+    std::vector<CInstrumentStats> MergeInstrumentStats();
 };
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+namespace novac
+{
+
+/** CTraceRecorder records when each stage of the processing (and each scan, file transfer etc. within the stages)
+    started and how long it took, together with the thread it ran on. This makes it possible to see afterwards
+    where the time of a processing run was spent, e.g. serial bottlenecks or load imbalance between the evaluation threads.
+    The events are written as Chrome trace-event JSON, which can be opened in e.g. chrome://tracing or ui.perfetto.dev.
+
+    Recording is disabled by default, in which case recording an event costs the check of one flag.
+    Each thread records into a buffer of its own, such that recording an event takes no lock. */
+class CTraceRecorder
+{
+public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    /** Enables the recording and clears all events recorded earlier.
+        Must be called when no other thread is recording events. */
+    static void Start();
+
+    /** Disables the recording. The events recorded so far are kept until the next call to Start. */
+    static void Stop();
+
+    /** @return true if the events are recorded. */
+    static bool IsEnabled();
+
+    /** Records one event, which started and ended at the given times, as run by the calling thread.
+        Does nothing if the recording is not enabled.
+        @param category the type of event (e.g. 'evaluation'), must be a string literal.
+        @param name the name of the event (e.g. 'EvaluateScan'), must be a string literal.
+        @param detail optional description of the event (e.g. the name of the evaluated file). */
+    static void Record(const char* category, const char* name, const std::string& detail, TimePoint start, TimePoint stop);
+
+    /** @return the number of events recorded since the last call to Start.
+        Must be called when no other thread is recording events. */
+    static size_t EventCount();
+
+    /** Writes all events recorded since the last call to Start to the given file, as Chrome trace-event JSON.
+        Must be called when no other thread is recording events.
+        @return false if the file could not be written. */
+    static bool WriteToFile(const std::string& fileName);
+};
+
+/** CTraceScope records one event with the CTraceRecorder, lasting from the creation of the
+    CTraceScope until it goes out of scope. */
+class CTraceScope
+{
+public:
+    /** @param category the type of event, must be a string literal.
+        @param name the name of the event, must be a string literal. */
+    CTraceScope(const char* category, const char* name);
+
+    /** @param category the type of event, must be a string literal.
+        @param name the name of the event, must be a string literal.
+        @param detail description of the event, only copied if the recording is enabled. */
+    CTraceScope(const char* category, const char* name, const std::string& detail);
+
+    ~CTraceScope();
+
+    CTraceScope(const CTraceScope&) = delete;
+    CTraceScope& operator=(const CTraceScope&) = delete;
+
+private:
+    const char* m_category;
+    const char* m_name;
+    std::string m_detail;
+    bool m_enabled;
+    CTraceRecorder::TimePoint m_start;
+};
+
+}
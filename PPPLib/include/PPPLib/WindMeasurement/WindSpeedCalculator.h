@@ -89,6 +89,19 @@ public:
         const Geometry::PlumeHeight& plumeHeight,
         Meteorology::WindField& windField);
 
+    /** Calculate the time delay between the two provided time series
+        @param delay - The return value of the function. Will be set to the time
+            delay between the two data series, in seconds. Will be positive if the
+            'upWindColumns' comes temporally before the 'downWindColumns', otherwise negative.
+        @param upWindSerie - the measurement for the more upwind time series
+        @param downWindSerie - the measurement for the more downwind time series
+        @param settings - The settings for how the calculation should be done
+    */
+    RETURN_CODE CalculateDelay(double& delay,
+        const CMeasurementSeries* upWindSerie,
+        const CMeasurementSeries* downWindSerie,
+        const CWindSpeedMeasSettings& settings);
+
 private:
     // ----------------------------------------------------------------------
     // ---------------------- PRIVATE DATA ----------------------------------
@@ -135,19 +148,6 @@ private:
     RETURN_CODE CalculateCorrelation_Heidelberg(const novac::CString& evalLog);
 
 
-    /** Calculate the time delay between the two provided time series
-        @param delay - The return value of the function. Will be set to the time
-            delay between the two data series, in seconds. Will be positive if the
-            'upWindColumns' comes temporally before the 'downWindColumns', otherwise negative.
-        @param upWindSerie - the measurement for the more upwind time series
-        @param downWindSerie - the measurement for the more downwind time series
-        @param settings - The settings for how the calculation should be done
-    */
-    RETURN_CODE CalculateDelay(double& delay,
-        const CMeasurementSeries* upWindSerie,
-        const CMeasurementSeries* downWindSerie,
-        const CWindSpeedMeasSettings& settings);
-
     /** Intializes the arrays 'shift', 'corr', 'used' and 'delays' before they are used*/
     void InitializeArrays();
 
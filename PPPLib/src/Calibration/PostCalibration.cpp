@@ -3,8 +3,11 @@
 #include <PPPLib/PPPLib.h>
 #include <PPPLib/Logging.h>
 #include <PPPLib/File/Filesystem.h>
+#include <PPPLib/ParallelFor.h>
 #include <SpectralEvaluation/DialogControllers/NovacProgramWavelengthCalibrationController.h>
-#include <SpectralEvaluation/DialogControllers/ReferenceCreationController.h>
+#include <SpectralEvaluation/Calibration/InstrumentCalibration.h>
+#include <SpectralEvaluation/Calibration/ReferenceSpectrumConvolution.h>
+#include <SpectralEvaluation/Evaluation/CrossSectionData.h>
 #include <SpectralEvaluation/File/File.h>
 #include <SpectralEvaluation/Calibration/StandardCrossSectionSetup.h>
 #include <SpectralEvaluation/File/ScanFileHandler.h>
@@ -13,6 +16,7 @@
 #include <PPPLib/File/EvaluationConfigurationParser.h>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
 #include <PPPLib/MFC/CFileUtils.h>
 
 using namespace novac;
@@ -86,56 +90,65 @@ void RunCalibration(
     calibrationController.RunCalibration();
 }
 
+/** Convolves the given high resolution cross section with the instrument line shape of the calibration
+    and samples it on the pixel-to-wavelength mapping of the calibration.
+    @throws std::invalid_argument if the convolution fails. */
+std::unique_ptr<novac::CCrossSectionData> ConvolveCrossSection(
+    const novac::InstrumentCalibration& calibration,
+    const novac::CCrossSectionData& highResolutionCrossSection,
+    bool convertToAir)
+{
+    std::vector<double> convolutionResult;
+    const auto conversion = convertToAir ? novac::WavelengthConversion::VacuumToAir : novac::WavelengthConversion::None;
+    if (!novac::ConvolveReference(calibration.pixelToWavelengthMapping, *calibration.instrumentLineShape, highResolutionCrossSection, convolutionResult, conversion))
+    {
+        throw std::invalid_argument("Failed to convolve the high resolution cross section with the instrument line shape.");
+    }
+
+    return std::make_unique<novac::CCrossSectionData>(calibration.pixelToWavelengthMapping, convolutionResult);
+}
+
+/** Creates the references of the calibration from the high resolution cross sections, which are read once
+    and shared by all calibrations. In the NovacPPP the references are never filtered on disk (but may be filtered
+    after having been read in) and are in molecules/cm2, hence the convolved cross sections are saved as they are. */
 std::vector<novac::CReferenceFile> CreateStandardReferences(
     const novac::CSpectrumInfo& spectrumInformation,
     const std::unique_ptr<novac::InstrumentCalibration>& calibration,
-    const novac::StandardCrossSectionSetup standardCrossSections,
+    const novac::StandardCrossSectionSetup& standardCrossSections,
+    const std::vector<std::unique_ptr<novac::CCrossSectionData>>& highResolutionReferences,
+    const novac::CCrossSectionData* highResolutionFraunhoferReference,
     const std::string& directoryName)
 {
-    ReferenceCreationController referenceController;
     std::vector<novac::CReferenceFile> referencesCreated;
 
-    referenceController.m_highPassFilter = false; // In the NovacPPP the references are never filtered on disk (but may be filtered after having been read in)
-    referenceController.m_unitSelection = 1; // Default to molecules/cm2 in NovacPPP
-
     // First the ordinary references
     for (size_t ii = 0; ii < standardCrossSections.NumberOfReferences(); ++ii)
     {
-        referenceController.m_convertToAir = standardCrossSections.IsReferenceInVacuum(ii);
-        referenceController.m_highResolutionCrossSection = standardCrossSections.ReferenceFileName(ii);
-        referenceController.m_isPseudoAbsorber = standardCrossSections.IsAdditionalAbsorber(ii);
-        referenceController.ConvolveReference(*calibration);
+        const auto resultingCrossSection = ConvolveCrossSection(*calibration, *highResolutionReferences[ii], standardCrossSections.IsReferenceInVacuum(ii));
 
         // Save the result
-        const std::string filteringStr = (referenceController.m_highPassFilter) ?
-            "_HP500_PPMM" :
-            "";
         const std::string dstFileName =
             directoryName +
             spectrumInformation.m_device +
             "_" +
             standardCrossSections.ReferenceSpecieName(ii) +
-            filteringStr +
             "_" +
             FormatDateAndTimeOfSpectrum(spectrumInformation) +
             ".txt";
-        novac::SaveCrossSectionFile(dstFileName, *(referenceController.m_resultingCrossSection));
+        novac::SaveCrossSectionFile(dstFileName, *resultingCrossSection);
 
         novac::CReferenceFile newReference;
         newReference.m_specieName = standardCrossSections.ReferenceSpecieName(ii);
         newReference.m_path = dstFileName;
-        newReference.m_isFiltered = referenceController.m_highPassFilter;
+        newReference.m_isFiltered = false;
         referencesCreated.push_back(newReference);
     }
 
     // Save the Fraunhofer reference as well
-    if (IsExistingFile(standardCrossSections.FraunhoferReferenceFileName()))
+    if (highResolutionFraunhoferReference != nullptr)
     {
         // Do the convolution
-        referenceController.m_convertToAir = false;
-        referenceController.m_highResolutionCrossSection = standardCrossSections.FraunhoferReferenceFileName();
-        referenceController.m_isPseudoAbsorber = true;
-        referenceController.ConvolveReference(*calibration);
+        const auto resultingCrossSection = ConvolveCrossSection(*calibration, *highResolutionFraunhoferReference, false);
 
         // Save the result
         const std::string dstFileName =
@@ -145,12 +158,12 @@ std::vector<novac::CReferenceFile> CreateStandardReferences(
             FormatDateAndTimeOfSpectrum(spectrumInformation) +
             ".txt";
 
-        novac::SaveCrossSectionFile(dstFileName, *(referenceController.m_resultingCrossSection));
+        novac::SaveCrossSectionFile(dstFileName, *resultingCrossSection);
 
         novac::CReferenceFile newReference;
         newReference.m_specieName = "Fraunhofer";
         newReference.m_path = dstFileName;
-        newReference.m_isFiltered = referenceController.m_highPassFilter;
+        newReference.m_isFiltered = false;
         referencesCreated.push_back(newReference);
     }
 
@@ -263,73 +276,138 @@ int CPostCalibration::RunInstrumentCalibration(const std::vector<std::string>& s
         ShowMessage(message.str());
     }
 
+    // Select the scans which may be used for calibration up front, such that the 
+    //  instruments can be processed independently of each other.
+    std::vector<std::pair<SpectrometerId, std::vector<BasicScanInfo>>> candidateScans;
+    for (auto& scanFileInfo : sortedScanFileList)
+    {
+        candidateScans.push_back(std::make_pair(scanFileInfo.first, SelectCandidateScans(scanFileInfo.second, m_userSettings)));
+    }
+
+    // The high resolution cross sections are the same for all calibrations, read them once.
+    HighResolutionCrossSections crossSections;
+    try
+    {
+        crossSections = ReadHighResolutionCrossSections();
+    }
+    catch (std::exception& e)
+    {
+        ShowError(e.what());
+        return 0;
+    }
+
+    // The instruments are calibrated in parallel, each thread takes the next instrument which has not yet been started.
+    std::atomic<int> numberOfCalibrations{ 0 };
+    novac::ParallelFor(candidateScans.size(), m_userSettings.m_maxThreadNum, [&](size_t instrumentIdx)
+        {
+            numberOfCalibrations += RunInstrumentCalibration(candidateScans[instrumentIdx].first, candidateScans[instrumentIdx].second, crossSections, statistics);
+        });
+
+    return numberOfCalibrations;
+}
+
+CPostCalibration::HighResolutionCrossSections CPostCalibration::ReadHighResolutionCrossSections() const
+{
+    HighResolutionCrossSections crossSections;
+
+    for (size_t ii = 0; ii < m_standardCrossSections.NumberOfReferences(); ++ii)
+    {
+        auto reference = std::make_unique<novac::CCrossSectionData>();
+        if (!novac::ReadCrossSectionFile(m_standardCrossSections.ReferenceFileName(ii), *reference))
+        {
+            throw std::invalid_argument("Could not read the high resolution cross section: " + m_standardCrossSections.ReferenceFileName(ii));
+        }
+        crossSections.references.push_back(std::move(reference));
+    }
+
+    if (IsExistingFile(m_standardCrossSections.FraunhoferReferenceFileName()))
+    {
+        crossSections.fraunhoferReference = std::make_unique<novac::CCrossSectionData>();
+        if (!novac::ReadCrossSectionFile(m_standardCrossSections.FraunhoferReferenceFileName(), *crossSections.fraunhoferReference))
+        {
+            throw std::invalid_argument("Could not read the high resolution Fraunhofer spectrum: " + m_standardCrossSections.FraunhoferReferenceFileName());
+        }
+    }
+
+    return crossSections;
+}
+
+std::vector<CPostCalibration::BasicScanInfo> CPostCalibration::SelectCandidateScans(std::vector<BasicScanInfo> scans, const Configuration::CUserConfiguration& userSettings)
+{
+    // Sort the files by increasing start time.
+    std::sort(
+        begin(scans),
+        end(scans),
+        [](const BasicScanInfo& first, const BasicScanInfo& second)
+        {
+            return first.startTime < second.startTime;
+        });
+
+    std::vector<BasicScanInfo> result;
+    for (const auto& basicFileInfo : scans)
+    {
+        if (ScanIsMeasuredInConfiguredTimeOfDayForCalibration(basicFileInfo.startTime, userSettings))
+        {
+            result.push_back(basicFileInfo);
+        }
+    }
+
+    return result;
+}
+
+int CPostCalibration::RunInstrumentCalibration(const SpectrometerId& spectrometer, const std::vector<BasicScanInfo>& candidateScans, const HighResolutionCrossSections& crossSections, CPostCalibrationStatistics& statistics)
+{
     int numberOfCalibrations = 0;
 
-    for (auto& scanFileInfo : sortedScanFileList)
+    try
     {
-        try
+        {
+            std::stringstream message;
+            message << "Performing calibrations for " << spectrometer.serial << " (channel: " << spectrometer.channel << ")";
+            ShowMessage(message.str());
+        }
+
+        novac::CDateTime timeOfLastCalibration;
+        for (const auto& basicFileInfo : candidateScans)
         {
             {
                 std::stringstream message;
-                message << "Performing calibrations for " << scanFileInfo.first.serial << " (channel: " << scanFileInfo.first.channel << ")";
+                message << "Checking pak file: " << basicFileInfo.fullPath;
                 ShowMessage(message.str());
             }
 
-            // Sort the files by increasing start time.
-            std::sort(
-                begin(scanFileInfo.second),
-                end(scanFileInfo.second),
-                [](const BasicScanInfo& first, const BasicScanInfo& second)
-                {
-                    return first.startTime < second.startTime;
-                });
-
-            novac::CDateTime timeOfLastCalibration;
-            for (const auto& basicFileInfo : scanFileInfo.second)
+            // The interval is counted from the last successful calibration and hence cannot be checked up front.
+            const double secondsSinceLastCalibration = timeOfLastCalibration.year > 0 ? novac::CDateTime::Difference(basicFileInfo.startTime, timeOfLastCalibration) : 1e99;
+            if (secondsSinceLastCalibration < 3600.0 * m_userSettings.m_calibrationIntervalHours)
             {
-                {
-                    std::stringstream message;
-                    message << "Checking pak file: " << basicFileInfo.fullPath;
-                    ShowMessage(message.str());
-                }
-
-                if (!ScanIsMeasuredInConfiguredTimeOfDayForCalibration(basicFileInfo.startTime, m_userSettings))
-                {
-                    continue;
-                }
-
-                const double secondsSinceLastCalibration = timeOfLastCalibration.year > 0 ? novac::CDateTime::Difference(basicFileInfo.startTime, timeOfLastCalibration) : 1e99;
-                if (secondsSinceLastCalibration < 3600.0 * m_userSettings.m_calibrationIntervalHours)
-                {
-                    std::stringstream message;
-                    message << "Interval since last performed calibration ( " << (secondsSinceLastCalibration / 3600.0) << " hours) is too small. Skipping scan.";
-                    ShowMessage(message.str());
-                    continue;
-                }
-
-                if (RunInstrumentCalibration(basicFileInfo.fullPath, statistics))
-                {
-                    ++numberOfCalibrations;
-                    timeOfLastCalibration = basicFileInfo.startTime;
-                }
+                std::stringstream message;
+                message << "Interval since last performed calibration ( " << (secondsSinceLastCalibration / 3600.0) << " hours) is too small. Skipping scan.";
+                ShowMessage(message.str());
+                continue;
             }
 
-            // All calibrations for this particular spectrometer are now done.
-            CreateEvaluationSettings(scanFileInfo.first, statistics);
-        }
-        catch (std::exception& e)
-        {
-            std::stringstream message;
-            message << "Failed to create evaluation data for " << scanFileInfo.first.serial << " (channel: " << scanFileInfo.first.channel << "). ";
-            message << "Exception: " << e.what();
-            ShowMessage(message.str());
+            if (RunInstrumentCalibration(basicFileInfo.fullPath, crossSections, statistics))
+            {
+                ++numberOfCalibrations;
+                timeOfLastCalibration = basicFileInfo.startTime;
+            }
         }
+
+        // All calibrations for this particular spectrometer are now done.
+        CreateEvaluationSettings(spectrometer, statistics);
+    }
+    catch (std::exception& e)
+    {
+        std::stringstream message;
+        message << "Failed to create evaluation data for " << spectrometer.serial << " (channel: " << spectrometer.channel << "). ";
+        message << "Exception: " << e.what();
+        ShowMessage(message.str());
     }
 
     return numberOfCalibrations;
 }
 
-bool CPostCalibration::RunInstrumentCalibration(const std::string& scanFile, CPostCalibrationStatistics& statistics)
+bool CPostCalibration::RunInstrumentCalibration(const std::string& scanFile, const HighResolutionCrossSections& crossSections, CPostCalibrationStatistics& statistics)
 {
     try
     {
@@ -381,6 +459,8 @@ bool CPostCalibration::RunInstrumentCalibration(const std::string& scanFile, CPo
             calibrationController.m_calibrationDebug.spectrumInfo,
             finalCalibration,
             m_standardCrossSections,
+            crossSections.references,
+            crossSections.fraunhoferReference.get(),
             directoryName);
 
         statistics.RememberCalibrationPerformed(
@@ -16,6 +16,7 @@ void CPostCalibrationStatistics::RememberCalibrationPerformed(
     newCalibration.calibrationTimeStamp = gpsTimeOfScan;
     newCalibration.referenceFiles = referencesCreated;
 
+    std::lock_guard<std::mutex> lock{ m_calibrationsMutex };
     auto pos = m_calibrations.find(instrument);
 
     if (pos == m_calibrations.end())
@@ -42,6 +43,7 @@ void CPostCalibrationStatistics::RememberCalibrationPerformed(
 
 int CPostCalibrationStatistics::GetNumberOfCalibrationsPerformedFor(const SpectrometerId& instrument) const
 {
+    std::lock_guard<std::mutex> lock{ m_calibrationsMutex };
     auto pos = m_calibrations.find(instrument);
     if (pos == m_calibrations.end())
     {
@@ -58,6 +60,7 @@ void CPostCalibrationStatistics::GetCalibration(
     novac::CDateTime& validTo,
     std::vector<novac::CReferenceFile>& referencesCreated) const
 {
+    std::lock_guard<std::mutex> lock{ m_calibrationsMutex };
     auto pos = m_calibrations.find(instrument);
     if (pos == m_calibrations.end())
     {
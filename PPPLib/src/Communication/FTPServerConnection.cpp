@@ -2,6 +2,7 @@
 #include <PPPLib/MFC/CFileUtils.h>
 #include <PPPLib/File/Filesystem.h>
 #include <PPPLib/Logging.h>
+#include <PPPLib/TraceRecorder.h>
 
 // This is the global list of volcanoes
 #include <PPPLib/VolcanoInfo.h>
@@ -43,36 +44,35 @@ void LoginAndDownloadDataFromDir(
     const Configuration::CUserConfiguration& userSettings,
     ftpLogin login,
     std::string directory,
-    novac::GuardedList<std::string>& downloadedFiles);
+    const std::function<void(const std::string&)>& onFileDownloaded);
 
 /** Downloads .pak files from the provided list of files on the already opened connection.
-    Items are consumed from the downloadedQueue one at a time and appended to the 'downladedFiles' when ready.
-    The files which have been downloaded are appended to the list 'downloadedFiles' */
+    Items are consumed from the downloadedQueue one at a time and each downloaded file is reported through 'onFileDownloaded' when ready. */
 void DownloadData(
     novac::ILogger& log,
     novac::LogContext context,
     const Configuration::CUserConfiguration& userSettings,
     Poco::Net::FTPClientSession& ftp,
     novac::GuardedList<novac::CFileInfo>& downloadedQueue,
-    novac::GuardedList<std::string>& downloadedFiles);
+    const std::function<void(const std::string&)>& onFileDownloaded);
 
-/** Downloads a specific file from the ftp session. The file is appended to the list of downloaded files upon success. */
+/** Downloads a specific file from the ftp session. The file is reported through 'onFileDownloaded' upon success. */
 void DownloadFile(novac::ILogger& log,
     novac::LogContext context,
     const Configuration::CUserConfiguration& userSettings,
     Poco::Net::FTPClientSession& ftp,
     const novac::CFileInfo& fileInfo,
-    novac::GuardedList<std::string>& downloadedFiles);
+    const std::function<void(const std::string&)>& onFileDownloaded);
 
 /** Downloads .pak files from the provided directory on the already opened connection.
-    The files which have been downloaded are appended to the list 'downloadedFiles' */
+    Each file which has been downloaded is reported through 'onFileDownloaded' */
 void DownloadDataFromDir(
     novac::ILogger& log,
     novac::LogContext context,
     const Configuration::CUserConfiguration& userSettings,
     Poco::Net::FTPClientSession& ftp,
     std::string directory,
-    novac::GuardedList<std::string>& downloadedFiles);
+    const std::function<void(const std::string&)>& onFileDownloaded);
 
 volatile double nMbytesDownloaded = 0.0;
 double nSecondsPassed = 0.0;
@@ -87,6 +87,27 @@ int CFTPServerConnection::DownloadDataFromFTP(
     const std::string& username,
     const std::string& password,
     std::vector<std::string>& pakFileList)
+{
+    // This is (a thread safe) list of files which have been downloaded so far.
+    novac::GuardedList<std::string> downloadedFiles;
+
+    int result = DownloadDataFromFTP(context, serverDir, username, password, [&](const std::string& fileName)
+        {
+            downloadedFiles.AddItem(fileName);
+        });
+
+    // copy the data to the output list
+    downloadedFiles.CopyTo(pakFileList);
+
+    return result;
+}
+
+int CFTPServerConnection::DownloadDataFromFTP(
+    novac::LogContext context,
+    const std::string& serverDir,
+    const std::string& username,
+    const std::string& password,
+    std::function<void(const std::string&)> onFileDownloaded)
 {
     if (m_userSettings.m_volcano < 0)
     {
@@ -116,12 +137,9 @@ int CFTPServerConnection::DownloadDataFromFTP(
         return 1;
     }
 
-    // This is (a thread safe) list of files which have been downloaded so far.
-    novac::GuardedList<std::string> downloadedFiles;
-
     // download the data in this directory
     nFTPThreadsRunning.IncrementValue();
-    std::thread downloadThread{ LoginAndDownloadDataFromDir, std::ref(m_log), context, std::cref(m_userSettings), login, directory, std::ref(downloadedFiles) };
+    std::thread downloadThread{ LoginAndDownloadDataFromDir, std::ref(m_log), context, std::cref(m_userSettings), login, directory, std::cref(onFileDownloaded) };
 
     // wait for all threads to terminate
     std::this_thread::sleep_for(std::chrono::milliseconds{ 500 });
@@ -149,9 +167,6 @@ int CFTPServerConnection::DownloadDataFromFTP(
     }
     downloadThread.join();
 
-    // copy the data to the output list
-    downloadedFiles.CopyTo(pakFileList);
-
     return 0;
 }
 
@@ -164,6 +179,7 @@ static bool DownloadAFile(
     const std::string& localFileName)
 {
     context = context.With(novac::LogContext::FileName, fullRemoteFileName);
+    novac::CTraceScope trace("ftp", "DownloadFile", fullRemoteFileName);
 
     try
     {
@@ -210,6 +226,7 @@ static bool DownloadFileList(
     }
 
     novac::CFtpUtils ftpHelper{ g_volcanoes, static_cast<unsigned int>(userSettings.m_volcano) };
+    novac::CTraceScope trace("ftp", "DownloadFileList", directory);
 
     try
     {
@@ -248,6 +265,7 @@ static bool DownloadFileList(
 {
     novac::CFtpUtils ftpHelper{ g_volcanoes, static_cast<unsigned int>(userSettings.m_volcano) };
     context = context.With("dir", directory);
+    novac::CTraceScope trace("ftp", "DownloadFileList", directory);
 
     try
     {
@@ -314,7 +332,7 @@ void LoginAndDownloadDataFromDir(
     const Configuration::CUserConfiguration& userSettings,
     ftpLogin login,
     std::string directory,
-    novac::GuardedList<std::string>& downloadedFiles)
+    const std::function<void(const std::string&)>& onFileDownloaded)
 {
 
     try
@@ -352,7 +370,7 @@ void LoginAndDownloadDataFromDir(
                 connections[threadIdx]->open(login.server, (Poco::UInt16)login.port, login.userName, login.password);
                 connections[threadIdx]->setTimeout(Poco::Timespan(60, 0)); // 60 seconds timeout
 
-                auto t = std::make_shared<std::thread>(DownloadData, std::ref(log), context, std::cref(userSettings), std::ref(*connections[threadIdx]), std::ref(downloadQueue), std::ref(downloadedFiles));
+                auto t = std::make_shared<std::thread>(DownloadData, std::ref(log), context, std::cref(userSettings), std::ref(*connections[threadIdx]), std::ref(downloadQueue), std::cref(onFileDownloaded));
 
                 downloadThreads.push_back(t);
             }
@@ -412,7 +430,7 @@ void DownloadData(
     const Configuration::CUserConfiguration& userSettings,
     Poco::Net::FTPClientSession& ftp,
     novac::GuardedList<novac::CFileInfo>& downloadedQueue,
-    novac::GuardedList<std::string>& downloadedFiles)
+    const std::function<void(const std::string&)>& onFileDownloaded)
 {
     novac::CFileInfo nextDownloadItem;
     while (downloadedQueue.PopFront(nextDownloadItem))
@@ -424,7 +442,7 @@ void DownloadData(
             {
                 if (date <= userSettings.m_toDate && userSettings.m_fromDate <= date)
                 {
-                    DownloadDataFromDir(log, context, userSettings, ftp, nextDownloadItem.path + nextDownloadItem.fileName, downloadedFiles);
+                    DownloadDataFromDir(log, context, userSettings, ftp, nextDownloadItem.path + nextDownloadItem.fileName, onFileDownloaded);
                 }
                 else
                 {
@@ -433,12 +451,12 @@ void DownloadData(
             }
             else
             {
-                DownloadDataFromDir(log, context, userSettings, ftp, nextDownloadItem.path + nextDownloadItem.fileName, downloadedFiles);
+                DownloadDataFromDir(log, context, userSettings, ftp, nextDownloadItem.path + nextDownloadItem.fileName, onFileDownloaded);
             }
         }
         else if (IsPakFile(nextDownloadItem))
         {
-            DownloadFile(log, context, userSettings, ftp, nextDownloadItem, downloadedFiles);
+            DownloadFile(log, context, userSettings, ftp, nextDownloadItem, onFileDownloaded);
         }
     }
 }
@@ -449,7 +467,7 @@ void DownloadFile(
     const Configuration::CUserConfiguration& userSettings,
     Poco::Net::FTPClientSession& ftp,
     const novac::CFileInfo& fileInfo,
-    novac::GuardedList<std::string>& downloadedFiles)
+    const std::function<void(const std::string&)>& onFileDownloaded)
 {
     novac::CString localFileName, serial;
     novac::CString userMessage;
@@ -468,7 +486,7 @@ void DownloadFile(
             {
                 userMessage.Format("File %s is already downloaded", (const char*)localFileName);
                 log.Information(context, userMessage.std_str());
-                downloadedFiles.AddItem(localFileName.std_str());
+                onFileDownloaded(localFileName.std_str());
             }
             else
             {
@@ -476,7 +494,7 @@ void DownloadFile(
                 if (DownloadAFile(log, context, ftp, fileInfo.path + "/" + fileInfo.fileName, localFileName.std_str()))
                 {
                     nMbytesDownloaded += fileInfo.fileSize / 1048576.0;
-                    downloadedFiles.AddItem(localFileName.std_str());
+                    onFileDownloaded(localFileName.std_str());
                 }
             }
         }
@@ -489,7 +507,7 @@ void DownloadDataFromDir(
     const Configuration::CUserConfiguration& userSettings,
     Poco::Net::FTPClientSession& ftp,
     std::string directory,
-    novac::GuardedList<std::string>& downloadedFiles)
+    const std::function<void(const std::string&)>& onFileDownloaded)
 {
 
     std::vector<novac::CFileInfo> filesFound;
@@ -505,7 +523,7 @@ void DownloadDataFromDir(
     {
         if (IsPakFile(fileInfo))
         {
-            DownloadFile(log, context, userSettings, ftp, fileInfo, downloadedFiles);
+            DownloadFile(log, context, userSettings, ftp, fileInfo, onFileDownloaded);
         }
         else if (userSettings.m_includeSubDirectories_FTP && fileInfo.isDirectory)
         {
@@ -520,7 +538,7 @@ void DownloadDataFromDir(
 
             // start downloading using the same thread as we're running in
             novac::CString subDir = directory + fileInfo.fileName + "/";
-            DownloadDataFromDir(log, context, userSettings, ftp, subDir.std_str(), downloadedFiles);
+            DownloadDataFromDir(log, context, userSettings, ftp, subDir.std_str(), onFileDownloaded);
         }
     }
 
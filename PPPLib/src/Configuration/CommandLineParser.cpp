@@ -124,6 +124,49 @@ void CommandLineParser::ParseCommandLineOptions(
             continue;
         }
 
+        // the number of threads to use within each scan
+        if (novac::Equals(currentToken, FLAG(str_spectrumThreadNum), strlen(FLAG(str_spectrumThreadNum))))
+        {
+            if (1 == sscanf(currentToken.c_str() + strlen(FLAG(str_spectrumThreadNum)), "%ld", &userSettings.m_spectrumThreadNum))
+            {
+                log.Information(context.With("cmd", str_spectrumThreadNum), "Set number of threads per scan");
+                userSettings.m_spectrumThreadNum = std::max(userSettings.m_spectrumThreadNum, (unsigned long)1);
+            }
+            token = tokenizer.NextToken();
+            continue;
+        }
+
+        // the limits of the number of scans waiting for evaluation
+        if (novac::Equals(currentToken, FLAG(str_maxScansInFlight), strlen(FLAG(str_maxScansInFlight))))
+        {
+            if (1 == sscanf(currentToken.c_str() + strlen(FLAG(str_maxScansInFlight)), "%lu", &userSettings.m_maxScansInFlight))
+            {
+                log.Information(context.With("cmd", str_maxScansInFlight), "Set max number of scans waiting for evaluation");
+            }
+            token = tokenizer.NextToken();
+            continue;
+        }
+        if (novac::Equals(currentToken, FLAG(str_maxMegabytesInFlight), strlen(FLAG(str_maxMegabytesInFlight))))
+        {
+            if (1 == sscanf(currentToken.c_str() + strlen(FLAG(str_maxMegabytesInFlight)), "%lu", &userSettings.m_maxMegabytesInFlight))
+            {
+                log.Information(context.With("cmd", str_maxMegabytesInFlight), "Set max size of scans waiting for evaluation");
+            }
+            token = tokenizer.NextToken();
+            continue;
+        }
+
+        // how often the configuration is checked for modifications
+        if (novac::Equals(currentToken, FLAG(str_configurationReloadInterval), strlen(FLAG(str_configurationReloadInterval))))
+        {
+            if (1 == sscanf(currentToken.c_str() + strlen(FLAG(str_configurationReloadInterval)), "%lu", &userSettings.m_configurationReloadInterval))
+            {
+                log.Information(context.With("cmd", str_configurationReloadInterval), "Set interval for reloading modified configuration files");
+            }
+            token = tokenizer.NextToken();
+            continue;
+        }
+
         // The options for the local directory
         if (novac::Equals(currentToken, FLAG(str_includeSubDirectories_Local), strlen(FLAG(str_includeSubDirectories_Local))))
         {
@@ -226,6 +269,19 @@ void CommandLineParser::ParseCommandLineOptions(
             continue;
         }
 
+        // If we should record the timeline of the processing
+        if (novac::Equals(currentToken, FLAG(str_writeProcessingTrace), strlen(FLAG(str_writeProcessingTrace))))
+        {
+            int parsedValue = 0;
+            if (1 == sscanf(currentToken.c_str() + strlen(FLAG(str_writeProcessingTrace)), "%d", &parsedValue))
+            {
+                userSettings.m_writeProcessingTrace = (parsedValue != 0);
+                log.Information(context.With("cmd", str_writeProcessingTrace), "Updated write processing trace");
+            }
+            token = tokenizer.NextToken();
+            continue;
+        }
+
         // The output directory
         if (novac::Equals(currentToken, FLAG(str_outputDirectory), strlen(FLAG(str_outputDirectory))))
         {
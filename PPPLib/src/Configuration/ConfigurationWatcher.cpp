@@ -0,0 +1,233 @@
+#include <PPPLib/Configuration/ConfigurationWatcher.h>
+#include <PPPLib/File/SetupFileReader.h>
+#include <PPPLib/File/EvaluationConfigurationParser.h>
+#include <PPPLib/File/Filesystem.h>
+#include <PPPLib/PPPLib.h>
+#include <Poco/Exception.h>
+#include <Poco/File.h>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace Configuration
+{
+
+/** Reads the evaluation configuration of the given instrument from the given file.
+    @throws std::exception if the file could not be read. */
+static void ReadEvaluationFile(novac::ILogger& log, const std::string& fileName, CInstrumentConfiguration& instrument)
+{
+    if (!Filesystem::IsExistingFile(fileName))
+    {
+        throw std::invalid_argument("Could not find configuration file: " + fileName);
+    }
+
+    FileHandler::CEvaluationConfigurationParser reader{ log };
+    if (RETURN_CODE::SUCCESS != reader.ReadConfigurationFile(fileName, instrument.m_eval, instrument.m_darkCurrentCorrection, instrument.m_instrumentCalibration))
+    {
+        throw std::invalid_argument("Failed to read configuration file: " + fileName);
+    }
+}
+
+/** Performs the same checks of the instruments as done before the processing starts.
+    @throws std::invalid_argument if the configuration is not valid. */
+static void CheckConfiguration(const CNovacPPPConfiguration& configuration)
+{
+    for (size_t j = 0; j < configuration.NumberOfInstruments(); ++j)
+    {
+        const CInstrumentConfiguration& instrument = configuration.m_instrument[j];
+
+        for (size_t k = j + 1; k < configuration.NumberOfInstruments(); ++k)
+        {
+            if (Equals(instrument.m_serial, configuration.m_instrument[k].m_serial))
+            {
+                throw std::invalid_argument("The instrument " + instrument.m_serial.std_str() + " is defined twice in setup.xml.");
+            }
+        }
+
+        if (instrument.m_eval.NumberOfFitWindows() > 1)
+        {
+            instrument.m_eval.CheckSettings();
+        }
+        if (instrument.m_location.GetLocationNum() > 1)
+        {
+            instrument.m_location.CheckSettings();
+        }
+    }
+}
+
+CConfigurationWatcher::CConfigurationWatcher(novac::ILogger& log, const std::string& configurationDirectory, const CNovacPPPConfiguration& initialConfiguration)
+    : m_log(log), m_configurationDirectory(Filesystem::AppendPathSeparator(configurationDirectory))
+{
+    m_current = std::make_shared<const CNovacPPPConfiguration>(initialConfiguration);
+
+    m_modificationTimes[SetupFile()] = GetModificationTime(SetupFile());
+    m_modificationTimes[ProcessingFile()] = GetModificationTime(ProcessingFile());
+    for (const CInstrumentConfiguration& instrument : initialConfiguration.m_instrument)
+    {
+        m_modificationTimes[EvaluationFile(instrument.m_serial)] = GetModificationTime(EvaluationFile(instrument.m_serial));
+        m_lastEvaluationRevision = std::max(m_lastEvaluationRevision, instrument.m_evaluationRevision);
+    }
+}
+
+CConfigurationWatcher::~CConfigurationWatcher()
+{
+    Stop();
+}
+
+std::shared_ptr<const CNovacPPPConfiguration> CConfigurationWatcher::Current() const
+{
+    return std::atomic_load(&m_current);
+}
+
+bool CConfigurationWatcher::ReloadIfModified()
+{
+    std::lock_guard<std::mutex> lock(m_reloadGuard);
+
+    const std::shared_ptr<const CNovacPPPConfiguration> current = Current();
+
+    // The modification times of the files of the current configuration.
+    std::map<std::string, std::int64_t> modificationTimes;
+    for (const auto& file : m_modificationTimes)
+    {
+        modificationTimes[file.first] = GetModificationTime(file.first);
+    }
+    if (modificationTimes == m_modificationTimes || modificationTimes == m_rejectedModificationTimes)
+    {
+        return false;
+    }
+    const std::map<std::string, std::int64_t> polledModificationTimes = modificationTimes;
+
+    if (modificationTimes[ProcessingFile()] != m_modificationTimes[ProcessingFile()])
+    {
+        m_log.Information("processing.xml has been modified. Changes to processing.xml are not applied until the processing is restarted.");
+        m_modificationTimes[ProcessingFile()] = modificationTimes[ProcessingFile()];
+        if (modificationTimes == m_modificationTimes)
+        {
+            return false;
+        }
+    }
+
+    try
+    {
+        std::shared_ptr<CNovacPPPConfiguration> newConfiguration = std::make_shared<CNovacPPPConfiguration>();
+        newConfiguration->m_executableDirectory = current->m_executableDirectory;
+
+        if (modificationTimes[SetupFile()] != m_modificationTimes[SetupFile()])
+        {
+            FileHandler::CSetupFileReader reader{ m_log };
+            reader.ReadSetupFile(SetupFile(), *newConfiguration);
+        }
+        else
+        {
+            newConfiguration->m_instrument = current->m_instrument;
+        }
+
+        // Read the evaluation configuration of the instruments which are new, or whose .exml file has changed.
+        //  The other instruments keep the evaluation configuration (and revision) they had.
+        unsigned int lastEvaluationRevision = m_lastEvaluationRevision;
+        size_t nInstrumentsRead = 0;
+        for (CInstrumentConfiguration& instrument : newConfiguration->m_instrument)
+        {
+            const std::string evaluationFile = EvaluationFile(instrument.m_serial);
+            const CInstrumentConfiguration* currentInstrument = current->GetInstrument(instrument.m_serial.std_str());
+
+            auto previousTime = m_modificationTimes.find(evaluationFile);
+            if (currentInstrument != nullptr && previousTime != m_modificationTimes.end() && modificationTimes[evaluationFile] == previousTime->second)
+            {
+                instrument.m_eval = currentInstrument->m_eval;
+                instrument.m_darkCurrentCorrection = currentInstrument->m_darkCurrentCorrection;
+                instrument.m_instrumentCalibration = currentInstrument->m_instrumentCalibration;
+                instrument.m_evaluationRevision = currentInstrument->m_evaluationRevision;
+                continue;
+            }
+
+            modificationTimes[evaluationFile] = GetModificationTime(evaluationFile);
+            ReadEvaluationFile(m_log, evaluationFile, instrument);
+            instrument.m_evaluationRevision = ++lastEvaluationRevision;
+            ++nInstrumentsRead;
+        }
+
+        CheckConfiguration(*newConfiguration);
+
+        std::atomic_store(&m_current, std::shared_ptr<const CNovacPPPConfiguration>(newConfiguration));
+        m_modificationTimes = modificationTimes;
+        m_lastEvaluationRevision = lastEvaluationRevision;
+
+        m_log.Information(novac::CString::FormatString("Reloaded the configuration, %d instruments configured. The evaluation configuration of %d instruments was read again.",
+            static_cast<int>(newConfiguration->NumberOfInstruments()), static_cast<int>(nInstrumentsRead)).std_str());
+        return true;
+    }
+    catch (const std::exception& ex)
+    {
+        // Don't try again until any of the files has been modified again.
+        m_rejectedModificationTimes = polledModificationTimes;
+
+        m_log.Error(std::string("Failed to reload the modified configuration, the processing continues with the previous configuration. ") + ex.what());
+        return false;
+    }
+}
+
+void CConfigurationWatcher::Start(unsigned long intervalSeconds)
+{
+    Stop();
+
+    m_stopRequested = false;
+    m_watcherThread = std::thread([this, intervalSeconds]()
+        {
+            std::unique_lock<std::mutex> lock(m_stopGuard);
+            while (!m_stopSignal.wait_for(lock, std::chrono::seconds(intervalSeconds), [this]() { return m_stopRequested; }))
+            {
+                lock.unlock();
+                ReloadIfModified();
+                lock.lock();
+            }
+        });
+}
+
+void CConfigurationWatcher::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_stopGuard);
+        m_stopRequested = true;
+    }
+    m_stopSignal.notify_all();
+
+    if (m_watcherThread.joinable())
+    {
+        m_watcherThread.join();
+    }
+}
+
+std::string CConfigurationWatcher::SetupFile() const
+{
+    return m_configurationDirectory + "setup.xml";
+}
+
+std::string CConfigurationWatcher::ProcessingFile() const
+{
+    return m_configurationDirectory + "processing.xml";
+}
+
+std::string CConfigurationWatcher::EvaluationFile(const novac::CString& serial) const
+{
+    return m_configurationDirectory + serial.std_str() + ".exml";
+}
+
+std::int64_t CConfigurationWatcher::GetModificationTime(const std::string& fileName)
+{
+    try
+    {
+        Poco::File file(fileName);
+        if (!file.exists())
+        {
+            return 0;
+        }
+        return static_cast<std::int64_t>(file.getLastModified().epochMicroseconds());
+    }
+    catch (const Poco::Exception&)
+    {
+        return 0;
+    }
+}
+
+}
@@ -60,6 +60,17 @@ novac::CFitWindow CNovacPPPConfiguration::GetFitWindow(
     int channel,
     const CDateTime& dateAndTime,
     const novac::CString* fitWindowName) const
+{
+    const size_t index = GetFitWindowIndex(serial, channel, dateAndTime, fitWindowName);
+
+    return GetInstrument(serial)->m_eval.GetFitWindow(index).window;
+}
+
+size_t CNovacPPPConfiguration::GetFitWindowIndex(
+    const std::string& serial,
+    int channel,
+    const CDateTime& dateAndTime,
+    const novac::CString* fitWindowName) const
 {
     novac::CString windowName;
     if (fitWindowName != nullptr)
@@ -84,26 +95,26 @@ novac::CFitWindow CNovacPPPConfiguration::GetFitWindow(
     const Configuration::CEvaluationConfiguration& evalConf = instrumentConf->m_eval;
     for (size_t k = 0; k < evalConf.NumberOfFitWindows(); ++k)
     {
-        novac::CFitWindow window;
-        CDateTime evalValidFrom, evalValidTo;
-        evalConf.GetFitWindow(k, window, evalValidFrom, evalValidTo);
+        const FitWindowWithTime& windowWithTime = evalConf.GetFitWindow(k);
+        const CDateTime& evalValidFrom = windowWithTime.validFrom;
+        const CDateTime& evalValidTo = windowWithTime.validTo;
 
-        if (evalValidFrom < dateAndTime && (dateAndTime < evalValidTo || dateAndTime == evalValidTo) && ((channel % 16) == window.channel))
+        if (evalValidFrom < dateAndTime && (dateAndTime < evalValidTo || dateAndTime == evalValidTo) && ((channel % 16) == windowWithTime.window.channel))
         {
             if (windowName.GetLength() >= 1)
             {
-                if (Equals(windowName, window.name))
+                if (Equals(windowName, windowWithTime.window.name))
                 {
                     // if we're searching for a specific name of fit-windows
                     //	then the name must also match
-                    return window;
+                    return k;
                 }
             }
             else
             {
                 // if we're not searching for any specific name, then anything
                 //	which is valid within the given time-range will do.
-                return window;
+                return k;
             }
         }
     }
@@ -66,6 +66,16 @@ bool CUserConfiguration::operator==(const CUserConfiguration& settings2)
     if (settings2.m_uploadResults != m_uploadResults)
         return false;
 
+    // the additional outputs of the fluxes
+    if (settings2.m_writeFluxLogCsv != m_writeFluxLogCsv)
+        return false;
+    if (settings2.m_writeInstrumentFluxLogs != m_writeInstrumentFluxLogs)
+        return false;
+
+    // the timeline of the processing
+    if (settings2.m_writeProcessingTrace != m_writeProcessingTrace)
+        return false;
+
     // the settings for the fit-windows to use
     if (settings2.m_nFitWindowsToUse != m_nFitWindowsToUse)
         return false;
@@ -92,6 +102,16 @@ bool CUserConfiguration::operator==(const CUserConfiguration& settings2)
     if (m_windFieldFileOption != settings2.m_windFieldFileOption)
         return false;
 
+    // the flux uncertainty
+    if (m_fluxUncertaintySamples != settings2.m_fluxUncertaintySamples)
+        return false;
+
+    // the flux sensitivity
+    if (m_fluxSensitivityWindFields != settings2.m_fluxSensitivityWindFields)
+        return false;
+    if (m_fluxSensitivityPlumeAltitudes != settings2.m_fluxSensitivityPlumeAltitudes)
+        return false;
+
     // The geometry calculations
     if (std::abs(settings2.m_calcGeometry_CompletenessLimit - m_calcGeometry_CompletenessLimit) > 0.01)
         return false;
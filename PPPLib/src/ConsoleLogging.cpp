@@ -0,0 +1,32 @@
+#include <PPPLib/Logging.h>
+#include <iostream>
+
+// Implementations of the logging functions which write all messages to the console.
+//  Used by the tools which do not set up the logging of the NovacPPP itself.
+
+void ShowMessage(const novac::CString& message)
+{
+    std::cerr << message.std_str() << std::endl;
+}
+void ShowMessage(const char message[])
+{
+    std::cerr << message << std::endl;
+}
+void ShowMessage(const novac::CString& message, novac::CString /* connectionID */)
+{
+    std::cerr << message << std::endl;
+}
+void ShowMessage(const std::string& message)
+{
+    std::cerr << message << std::endl;
+}
+
+/** Appends an error message to the logs */
+void ShowError(const novac::CString& message)
+{
+    std::cerr << message.std_str() << std::endl;
+}
+void ShowError(const char message[])
+{
+    std::cerr << message << std::endl;
+}
@@ -0,0 +1,63 @@
+#include <PPPLib/Evaluation/DarkSpectrumCache.h>
+
+using namespace novac;
+
+namespace Evaluation
+{
+
+CDarkSpectrumCache::CDarkSpectrumCache(bool averagedSpectra, int lastDarkScanIndex)
+    : m_averagedSpectra(averagedSpectra), m_lastDarkScanIndex(lastDarkScanIndex)
+{
+}
+
+const CSpectrum* CDarkSpectrumCache::GetNormalizedDark(const CSpectrum& spec, const std::function<bool(CSpectrum&)>& getDark)
+{
+    const long exposureTime = static_cast<long>(spec.m_info.m_exposureTime);
+    const long numSpectra = static_cast<long>(spec.NumSpectra());
+
+    for (const Entry& entry : m_entries)
+    {
+        if (entry.exposureTime == exposureTime && entry.numSpectra == numSpectra)
+        {
+            m_lastDarkScanIndex = entry.dark.ScanIndex();
+            return &entry.dark;
+        }
+    }
+
+    Entry newEntry;
+    newEntry.exposureTime = exposureTime;
+    newEntry.numSpectra = numSpectra;
+    if (!getDark(newEntry.dark))
+    {
+        return nullptr;
+    }
+
+    if (newEntry.dark.NumSpectra() > 0 && !m_averagedSpectra)
+    {
+        newEntry.dark.Div(newEntry.dark.NumSpectra());
+    }
+
+    m_lastDarkScanIndex = newEntry.dark.ScanIndex();
+    m_entries.push_back(std::move(newEntry));
+
+    return &m_entries.back().dark;
+}
+
+void RemoveNormalizedDark(CSpectrum& spectrum, const CSpectrum& normalizedDark, bool averagedSpectra)
+{
+    const double divisor = (spectrum.NumSpectra() > 0 && !averagedSpectra) ? spectrum.NumSpectra() : 1.0;
+    if (spectrum.m_length == normalizedDark.m_length)
+    {
+        for (int pixelIdx = 0; pixelIdx < spectrum.m_length; ++pixelIdx)
+        {
+            spectrum.m_data[pixelIdx] = spectrum.m_data[pixelIdx] / divisor - normalizedDark.m_data[pixelIdx];
+        }
+    }
+    else
+    {
+        spectrum.Div(divisor);
+        spectrum.Sub(normalizedDark);
+    }
+}
+
+}
@@ -34,7 +34,7 @@ bool Evaluation::IsGoodEnoughToEvaluate(
         return false;
     }
 
-        const double dynamicRange = skySpectrum.NumSpectra() * model.maximumIntensityForSingleReadout;
+    const double dynamicRange = skySpectrum.NumSpectra() * model.maximumIntensityForSingleReadout;
 
     if (skySpectrum.MaxValue(fitWindow.fitLow, fitWindow.fitHigh) >= dynamicRange)
     {
@@ -0,0 +1,121 @@
+#include <PPPLib/Evaluation/FitWindowCache.h>
+#include <chrono>
+
+namespace Evaluation
+{
+
+CFitWindowCache::CFitWindowCache(novac::ILogger& log, const novac::directorySetup& directories)
+    : m_log(log), m_directories(directories)
+{
+}
+
+std::shared_ptr<const novac::CFitWindow> CFitWindowCache::GetFitWindow(
+    const Configuration::CNovacPPPConfiguration& setup,
+    const std::string& serial,
+    int channel,
+    const novac::CDateTime& dateAndTime,
+    const novac::CString* fitWindowName)
+{
+    // Notice that this throws NotFoundException if the instrument, or its configuration could not be found.
+    const size_t index = setup.GetFitWindowIndex(serial, channel, dateAndTime, fitWindowName);
+    const Configuration::CInstrumentConfiguration* instrument = setup.GetInstrument(serial);
+    const Configuration::FitWindowWithTime& configuredWindow = instrument->m_eval.GetFitWindow(index);
+
+    const auto key = std::make_tuple(serial, index, instrument->m_evaluationRevision);
+    std::promise<std::shared_ptr<const novac::CFitWindow>> readWindow;
+    FutureFitWindow window;
+    bool readByThisThread = false;
+    {
+        std::lock_guard<std::mutex> lock(m_guard);
+
+        ReleaseUnusedFitWindows(serial, dateAndTime, instrument->m_evaluationRevision);
+
+        auto loadedWindow = m_loadedWindows.find(key);
+        if (loadedWindow != m_loadedWindows.end())
+        {
+            window = loadedWindow->second.window;
+        }
+        else
+        {
+            // This fit window has not yet been used, or the configuration of the instrument has changed.
+            //  Insert it before reading its references, such that other threads requesting it wait for this one.
+            LoadedFitWindow newWindow;
+            newWindow.validTo = configuredWindow.validTo;
+            newWindow.window = readWindow.get_future().share();
+            m_loadedWindows[key] = newWindow;
+
+            window = newWindow.window;
+            readByThisThread = true;
+        }
+    }
+
+    if (readByThisThread)
+    {
+        try
+        {
+            readWindow.set_value(ReadFitWindow(configuredWindow, serial));
+        }
+        catch (...)
+        {
+            // Passed on to all threads waiting for this fit window
+            readWindow.set_exception(std::current_exception());
+        }
+    }
+
+    // Notice that this throws InvalidReferenceException if the references could not be read.
+    return window.get();
+}
+
+std::shared_ptr<const novac::CFitWindow> CFitWindowCache::ReadFitWindow(const Configuration::FitWindowWithTime& configuredWindow, const std::string& serial) const
+{
+    std::shared_ptr<novac::CFitWindow> window = std::make_shared<novac::CFitWindow>(configuredWindow.window);
+
+    novac::LogContext instrumentContext = novac::LogContext().With(novac::LogContext::Device, serial);
+    m_log.Information(instrumentContext.With(novac::LogContext::FitWindow, window->name), "Reading the references of the fit window");
+    novac::PrepareFitWindow(m_log, instrumentContext, serial, *window, m_directories);
+
+    return window;
+}
+
+size_t CFitWindowCache::NumberOfLoadedFitWindows() const
+{
+    std::lock_guard<std::mutex> lock(m_guard);
+    return m_loadedWindows.size();
+}
+
+/** @return true if the fit window has been read and is not used by any scan, i.e. only the cache refers to it. */
+static bool IsUnused(const std::shared_future<std::shared_ptr<const novac::CFitWindow>>& window)
+{
+    if (window.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        return false; // still being read
+    }
+
+    try
+    {
+        return window.get().use_count() == 1;
+    }
+    catch (...)
+    {
+        return true; // the references could not be read
+    }
+}
+
+void CFitWindowCache::ReleaseUnusedFitWindows(const std::string& serial, const novac::CDateTime& dateAndTime, unsigned int evaluationRevision)
+{
+    auto it = m_loadedWindows.lower_bound(std::make_tuple(serial, size_t(0), 0U));
+    while (it != m_loadedWindows.end() && std::get<0>(it->first) == serial)
+    {
+        if (novac::CDateTime::Difference(dateAndTime, it->second.validTo) > releaseDelay ||
+            (std::get<2>(it->first) < evaluationRevision && IsUnused(it->second.window)))
+        {
+            it = m_loadedWindows.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+}
@@ -51,7 +51,10 @@ std::unique_ptr<CExtendedScanResult> CPostEvaluationController::EvaluateScan(
     // Find the information in the configuration about this instrument.
     // Notice that these throws NotFoundException if the instrument, or its configuration could not be found.
     auto instrLocation = m_setup.GetInstrumentLocation(scan.GetDeviceSerial(), scan.GetScanStartTime());
-    auto fitWindow = m_setup.GetFitWindow(scan.GetDeviceSerial(), scan.m_channel, scan.GetScanStartTime(), &fitWindowName);
+    std::shared_ptr<const novac::CFitWindow> loadedFitWindow = (m_fitWindowCache != nullptr) ?
+        m_fitWindowCache->GetFitWindow(m_setup, scan.GetDeviceSerial(), scan.m_channel, scan.GetScanStartTime(), &fitWindowName) :
+        std::make_shared<novac::CFitWindow>(m_setup.GetFitWindow(scan.GetDeviceSerial(), scan.m_channel, scan.GetScanStartTime(), &fitWindowName));
+    const novac::CFitWindow& fitWindow = *loadedFitWindow;
     auto darkSettings = m_setup.GetDarkCorrection(scan.m_device, scan.m_startTime);
 
     // TODO: Should the model name be required?
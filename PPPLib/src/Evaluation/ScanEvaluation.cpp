@@ -6,11 +6,15 @@
 #include <SpectralEvaluation/File/File.h>
 #include <SpectralEvaluation/File/STDFile.h>
 #include <SpectralEvaluation/File/TXTFile.h>
+#include <PPPLib/Evaluation/SpectrumStatistics.h>
 #include <PPPLib/Logging.h>
+#include <PPPLib/ParallelFor.h>
 
 // we want to make some statistics on the processing
 #include <PPPLib/PostProcessingStatistics.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <sstream>
 
@@ -24,6 +28,33 @@ CScanEvaluation::CScanEvaluation(const Configuration::CUserConfiguration& userSe
 CScanEvaluation::~CScanEvaluation()
 {}
 
+// Returns true if all references in the two fit windows have fixed shift and squeeze and the values agree within the given tolerances.
+static bool IsSameShiftAndSqueeze(const CFitWindow& window1, const CFitWindow& window2, double shiftTolerance, double squeezeTolerance)
+{
+    if (window1.NumberOfReferences() != window2.NumberOfReferences())
+    {
+        return false;
+    }
+
+    for (size_t k = 0; k < window1.NumberOfReferences(); ++k)
+    {
+        const auto& ref1 = window1.reference[k];
+        const auto& ref2 = window2.reference[k];
+        if (ref1.m_shiftOption != SHIFT_TYPE::SHIFT_FIX || ref2.m_shiftOption != SHIFT_TYPE::SHIFT_FIX ||
+            ref1.m_squeezeOption != SHIFT_TYPE::SHIFT_FIX || ref2.m_squeezeOption != SHIFT_TYPE::SHIFT_FIX)
+        {
+            return false;
+        }
+        if (std::abs(ref1.m_shiftValue - ref2.m_shiftValue) > shiftTolerance ||
+            std::abs(ref1.m_squeezeValue - ref2.m_squeezeValue) > squeezeTolerance)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 std::unique_ptr<CScanResult> CScanEvaluation::EvaluateScan(
     novac::LogContext context,
     novac::CScanFileHandler& scan,
@@ -35,6 +66,8 @@ std::unique_ptr<CScanResult> CScanEvaluation::EvaluateScan(
 
     std::unique_ptr<CEvaluationBase> eval; // the evaluator
     CFitWindow adjustedFitWindow = fitWindow; // we may need to make some small adjustments to the fit-window. This is a modified copy
+    CFitWindow optimizedFitWindow; // the fit-window with optimized shift and squeeze, if this is determined.
+    const CFitWindow* evaluatorWindow = nullptr; // the fit-window which 'eval' was created with, if this is known.
 
     // Adjust the fit-low and fit-high parameters according to the spectra
     m_fitLow = adjustedFitWindow.fitLow;
@@ -88,8 +121,15 @@ std::unique_ptr<CScanResult> CScanEvaluation::EvaluateScan(
         }
         eval.reset(new CEvaluationBase(window2, m_log));
 
+        // Read in the spectra once, these are used in both evaluations of the scan
+        PreparedScan preparedScan;
+        if (!PrepareScan(context, scan, spectrometerModel, darkSettings, preparedScan))
+        {
+            return 0;
+        }
+
         // evaluate the scan one time
-        std::unique_ptr<CScanResult> result = EvaluateOpenedScan(context, scan, eval, spectrometerModel, darkSettings);
+        std::unique_ptr<CScanResult> result = EvaluatePreparedScan(context, preparedScan, eval, &window2, spectrometerModel);
         if (result == nullptr)
         {
             return 0;
@@ -113,21 +153,47 @@ std::unique_ptr<CScanResult> CScanEvaluation::EvaluateScan(
             return 0;
         }
 
-        novac::CEvaluationBase* newEval = FindOptimumShiftAndSqueeze(context, adjustedFitWindow, m_indexOfMostAbsorbingSpectrum, scan, darkSettings);
-        if (newEval != nullptr)
+        // The most absorbing spectrum has already been read and prepared, use it again
+        auto mostAbsorbingSpectrum = std::find_if(
+            begin(preparedScan.spectra),
+            end(preparedScan.spectra),
+            [&](const PreparedSpectrum& spectrum) { return spectrum.spectrumIndex == m_indexOfMostAbsorbingSpectrum; });
+        if (mostAbsorbingSpectrum == end(preparedScan.spectra))
         {
-            eval.reset(newEval);
+            m_log.Information(context, "Could not determine optimal shift & squeeze. The most absorbing spectrum was not found in scan");
+            return result;
+        }
+
+        novac::CEvaluationBase* newEval = FindOptimumShiftAndSqueeze(context, adjustedFitWindow, *mostAbsorbingSpectrum, preparedScan.sky, optimizedFitWindow);
+        if (newEval == nullptr)
+        {
+            // The scan would be evaluated again with the same settings, which gives the same result.
+            return result;
+        }
+        else if (IsSameShiftAndSqueeze(window2, optimizedFitWindow, m_userSettings.m_optimalShiftTolerance, m_userSettings.m_optimalSqueezeTolerance))
+        {
+            // The shift and squeeze of every reference changes the fit of every spectrum in the scan,
+            //  hence the scan is either kept as a whole or evaluated again as a whole.
+            delete newEval;
+            m_log.Information(context, "Optimum shift and squeeze are within tolerance of the first evaluation, scan is not evaluated again.");
+            return result;
         }
+
+        eval.reset(newEval);
+
+        // Make the real evaluation of the scan, using the spectra already read in.
+        return EvaluatePreparedScan(context, preparedScan, eval, &optimizedFitWindow, spectrometerModel);
     }
 
     if (eval == nullptr)
     {
         // The options above didn't apply, use the default.
         eval.reset(new CEvaluationBase(adjustedFitWindow, m_log));
+        evaluatorWindow = &adjustedFitWindow;
     }
 
     // Make the real evaluation of the scan
-    auto result = EvaluateOpenedScan(context, scan, eval, spectrometerModel, darkSettings);
+    auto result = EvaluateOpenedScan(context, scan, eval, evaluatorWindow, spectrometerModel, darkSettings);
 
     return result;
 }
@@ -136,23 +202,39 @@ std::unique_ptr<CScanResult> CScanEvaluation::EvaluateOpenedScan(
     novac::LogContext logContext,
     novac::CScanFileHandler& scan,
     std::unique_ptr<novac::CEvaluationBase>& eval,
+    const novac::CFitWindow* evaluatorWindow,
     const novac::SpectrometerModel& spectrometer,
     const Configuration::CDarkSettings* darkSettings)
+{
+    PreparedScan preparedScan;
+    if (!PrepareScan(logContext, scan, spectrometer, darkSettings, preparedScan))
+    {
+        return nullptr;
+    }
+
+    return EvaluatePreparedScan(logContext, preparedScan, eval, evaluatorWindow, spectrometer);
+}
+
+bool CScanEvaluation::PrepareScan(
+    novac::LogContext logContext,
+    novac::CScanFileHandler& scan,
+    const novac::SpectrometerModel& spectrometer,
+    const Configuration::CDarkSettings* darkSettings,
+    PreparedScan& preparedScan)
 {
     novac::CString message; // used for ShowMessage messages
     int curSpectrumIndex = 0;  // keeping track of the index of the current spectrum into the .pak-file
-    double highestColumnInScan = 0.0; // the highest column-value in the evaluation
 
-    CSpectrum dark, current;
+    CSpectrum dark;
 
     // ----------- Get the sky spectrum --------------
     // Get the sky and dark spectra and divide them by the number of 
     //     co-added spectra in it
-    CSpectrum sky;
+    CSpectrum& sky = preparedScan.sky;
     if (!GetSky(scan, m_userSettings.sky, sky))
     {
         m_log.Error(logContext, "Failed to get the sky spectrum. Scan evaluation failed.");
-        return nullptr;
+        return false;
     }
     CSpectrum skySpecBeforeDarkCorrection = sky;
 
@@ -162,25 +244,26 @@ std::unique_ptr<CScanResult> CScanEvaluation::EvaluateOpenedScan(
         if (!GetDark(scan, sky, dark, darkSettings))
         {
             m_log.Error(logContext, "Failed to get the dark spectrum. Scan evaluation failed.");
-            return nullptr;
+            return false;
         }
         sky.Sub(dark);
     }
 
-    const double skyMaximumSaturationRatioInFitRegion = novac::GetMaximumSaturationRatioOfSpectrum(sky, spectrometer, m_fitLow, m_fitHigh);
+    const SpectrumStatistics skyStatistics = CalculateSpectrumStatistics(sky, spectrometer, m_fitLow, m_fitHigh);
+    const double skyMaximumSaturationRatioInFitRegion = skyStatistics.maximumSaturationRatioInFitRegion;
     if (skyMaximumSaturationRatioInFitRegion < m_userSettings.m_minimumSaturationInFitRegion)
     {
-        const double fitIntensity = sky.MaxValue(m_fitLow, m_fitHigh);
+        const double fitIntensity = skyStatistics.fitIntensity;
         message.Format("Sky spectrum has maximum saturation %.3lf (%.0lf counts) in fit region (at least %.3lf required). Skipping scan.", skyMaximumSaturationRatioInFitRegion, fitIntensity, m_userSettings.m_minimumSaturationInFitRegion);
         m_log.Information(logContext, message.std_str());
-        return nullptr;
+        return false;
     }
     if (skyMaximumSaturationRatioInFitRegion > 0.95)
     {
-        const double fitIntensity = sky.MaxValue(m_fitLow, m_fitHigh);
+        const double fitIntensity = skyStatistics.fitIntensity;
         message.Format("Sky spectrum has maximum saturation %.3lf (%.0lf counts) in fit region and judged to be saturated. Skipping scan.", skyMaximumSaturationRatioInFitRegion, fitIntensity, m_userSettings.m_minimumSaturationInFitRegion);
         m_log.Information(logContext, message.std_str());
-        return nullptr;
+        return false;
     }
 
     if (sky.NumSpectra() > 0 && !m_averagedSpectra)
@@ -189,141 +272,244 @@ std::unique_ptr<CScanResult> CScanEvaluation::EvaluateOpenedScan(
         skySpecBeforeDarkCorrection.Div(skySpecBeforeDarkCorrection.NumSpectra());
     }
 
-    // tell the evaluator which sky-spectrum to use
-    eval->SetSkySpectrum(sky);
-
     // Adjust the fit-low and fit-high parameters according to the spectra
     m_fitLow -= sky.m_info.m_startChannel;
     m_fitHigh -= sky.m_info.m_startChannel;
 
+    m_lastReadSpectrumScanIndex = CSpectrum().ScanIndex();
+
     curSpectrumIndex = -1; // we're at spectrum number 0 in the .pak-file
-    m_indexOfMostAbsorbingSpectrum = -1; // as far as we know, there's no absorption in any spectrum...
 
-    // the data structure to keep track of the evaluation results
-    std::unique_ptr<CScanResult> result = std::make_unique<CScanResult>();
-    result->SetSkySpecInfo(skySpecBeforeDarkCorrection.m_info);
-    result->SetDarkSpecInfo(dark.m_info);
+    preparedScan.skySpecInfo = skySpecBeforeDarkCorrection.m_info;
+    preparedScan.darkSpecInfo = dark.m_info;
 
     // Make sure that we'll start with the first spectrum in the scan
     scan.ResetCounter();
 
-    // Evaluate all the spectra in the scan.
+    CDarkSpectrumCache darkCache{ m_averagedSpectra, dark.ScanIndex() };
+
+    // Read in and prepare all the spectra, this must be done in order since the spectra are read from the file.
     while (1)
     {
-        // remember which spectrum we're at
-        const int spectrumIndex = current.ScanIndex();
+        PreparedSpectrum next;
+        const SpectrumReadStatus status = ReadNextSpectrum(logContext, scan, spectrometer, darkSettings, sky, darkCache, curSpectrumIndex, preparedScan, next);
+        if (status == SpectrumReadStatus::EndOfScan)
+        {
+            break;
+        }
+        else if (status == SpectrumReadStatus::Failed)
+        {
+            return false;
+        }
+        else if (status == SpectrumReadStatus::Ok)
+        {
+            preparedScan.spectra.push_back(std::move(next));
+        }
+    }
+
+    return true;
+}
+
+std::unique_ptr<CScanResult> CScanEvaluation::EvaluatePreparedScan(
+    novac::LogContext logContext,
+    const PreparedScan& preparedScan,
+    std::unique_ptr<novac::CEvaluationBase>& eval,
+    const novac::CFitWindow* evaluatorWindow,
+    const novac::SpectrometerModel& spectrometer)
+{
+    double highestColumnInScan = 0.0; // the highest column-value in the evaluation
+    const std::vector<PreparedSpectrum>& spectra = preparedScan.spectra;
 
-        // a. Read the next spectrum from the file
-        const int spectrumRead = scan.GetNextSpectrum(logContext, current);
+    // tell the evaluator which sky-spectrum to use
+    eval->SetSkySpectrum(preparedScan.sky);
 
-        if (spectrumRead == 0)
+    m_indexOfMostAbsorbingSpectrum = -1; // as far as we know, there's no absorption in any spectrum...
+
+    // the data structure to keep track of the evaluation results
+    std::unique_ptr<CScanResult> result = std::make_unique<CScanResult>();
+    result->SetSkySpecInfo(preparedScan.skySpecInfo);
+    result->SetDarkSpecInfo(preparedScan.darkSpecInfo);
+    for (size_t corruptedSpectrum : preparedScan.corruptedSpectra)
+    {
+        result->MarkAsCorrupted(corruptedSpectrum);
+    }
+
+    // Evaluate the spectra, in parallel if so requested. Each thread uses its own evaluator.
+    std::vector<SpectrumEvaluationResult> evaluationResults(spectra.size());
+    std::atomic<size_t> nextSpectrumToEvaluate{ 0 };
+    auto evaluateSpectra = [&](CEvaluationBase& evaluator)
+    {
+        for (size_t spectrumIdx = nextSpectrumToEvaluate++; spectrumIdx < spectra.size(); spectrumIdx = nextSpectrumToEvaluate++)
         {
-            // if something went wrong when reading the spectrum
-            if (scan.m_lastError == novac::FileError::SpectrumNotFound || scan.m_lastError == novac::FileError::EndOfFile)
+            SpectrumEvaluationResult& spectrumResult = evaluationResults[spectrumIdx];
+            spectrumResult.evaluationFailed = (0 != evaluator.Evaluate(spectra[spectrumIdx].spectrum));
+            if (spectrumResult.evaluationFailed)
             {
-                // at the end of the file, quit the 'while' loop
-                break;
+                spectrumResult.errorMessage = evaluator.m_lastError;
             }
             else
             {
-                novac::CString errMsg = "Faulty spectrum found in pak file.";
-                switch (scan.m_lastError)
-                {
-                case novac::FileError::ChecksumMismatch:
-                    errMsg.Append(", Checksum mismatch. Spectrum ignored");
-                    break;
-                case novac::FileError::DecompressionError:
-                    errMsg.Append(", Decompression error. Spectrum ignored");
-                    break;
-                default:
-                    errMsg.Append(", Unknown error. Spectrum ignored");
-                }
-                m_log.Error(logContext, errMsg.std_str());
-                // remember that this spectrum is corrupted
-                result->MarkAsCorrupted(static_cast<size_t>(curSpectrumIndex));
-                continue;
+                spectrumResult.result = evaluator.GetEvaluationResult();
             }
         }
+    };
 
-        ++curSpectrumIndex; // we'have just read the next spectrum in the .pak-file
-
-        // If the read spectrum is the sky or the dark spectrum, 
-        // then don't evaluate it...
-        if (current.ScanIndex() == sky.ScanIndex() || current.ScanIndex() == dark.ScanIndex())
+    // Each worker takes the next spectrum which has not yet been evaluated. The first worker uses the given evaluator,
+    //  the other workers create their own evaluator when there is still something left to evaluate.
+    const size_t workerNum = (evaluatorWindow == nullptr) ? 1 : std::min(static_cast<size_t>(std::max(m_userSettings.m_spectrumThreadNum, 1UL)), spectra.size());
+    novac::ParallelFor(workerNum, static_cast<unsigned long>(workerNum), [&](size_t workerIdx)
         {
-            continue;
-        }
+            if (workerIdx == 0)
+            {
+                evaluateSpectra(*eval);
+            }
+            else if (nextSpectrumToEvaluate < spectra.size())
+            {
+                CEvaluationBase evaluator{ *evaluatorWindow, m_log };
+                evaluator.SetSkySpectrum(preparedScan.sky);
+                evaluateSpectra(evaluator);
+            }
+        });
 
-        // If the spectrum is read out in an interlaced way then interpolate it back to it's original state
-        if (current.m_info.m_interlaceStep > 1)
-        {
-            current.InterpolateSpectrum();
-        }
+    // Collect the results in the order of the scan, such that the result does not depend on the number of threads.
+    for (size_t spectrumIdx = 0; spectrumIdx < spectra.size(); ++spectrumIdx)
+    {
+        InsertEvaluationResult(logContext, spectrometer, spectra[spectrumIdx], evaluationResults[spectrumIdx], highestColumnInScan, *result);
+    }
 
-        // b. Get the dark spectrum for this measured spectrum
-        if (!GetDark(scan, current, dark, darkSettings))
-        {
-            m_log.Error(logContext, "Failed to get the dark spectrum for spectrum in scan. Scan evaluation failed.");
-            return nullptr;
-        }
+    return result;
+}
 
-        // b. Calculate the intensities, before we divide by the number of spectra
-        //  and before we subtract the dark
-        current.m_info.m_peakIntensity = (float)current.MaxValue(0, current.m_length - 2);
-        current.m_info.m_fitIntensity = (float)current.MaxValue(m_fitLow, m_fitHigh);
+CScanEvaluation::SpectrumReadStatus CScanEvaluation::ReadNextSpectrum(
+    novac::LogContext logContext,
+    novac::CScanFileHandler& scan,
+    const novac::SpectrometerModel& spectrometer,
+    const Configuration::CDarkSettings* darkSettings,
+    const novac::CSpectrum& sky,
+    CDarkSpectrumCache& darkCache,
+    int& curSpectrumIndex,
+    PreparedScan& preparedScan,
+    PreparedSpectrum& current)
+{
+    novac::CString message; // used for ShowMessage messages
 
-        // Check if this spectrum is worth evaluating
-        const double spectrumMaximumSaturationRatioInFitRegion = novac::GetMaximumSaturationRatioOfSpectrum(current, spectrometer, m_fitLow, m_fitHigh);
-        if (spectrumMaximumSaturationRatioInFitRegion < m_userSettings.m_minimumSaturationInFitRegion)
-        {
-            message.Format("ignoring spectrum %d with maximum saturation %.3lf (%.0lf counts) in fit region (at least %.3lf required)", curSpectrumIndex, spectrumMaximumSaturationRatioInFitRegion, current.m_info.m_fitIntensity, m_userSettings.m_minimumSaturationInFitRegion);
-            m_log.Information(logContext, message.std_str());
-            continue;
-        }
+    // remember which spectrum we're at
+    current.spectrumIndex = m_lastReadSpectrumScanIndex;
 
-        // c. Divide the measured spectrum with the number of co-added spectra
-        //     The sky and dark spectra should already be divided before this loop.
-        if (current.NumSpectra() > 0 && !m_averagedSpectra)
+    // a. Read the next spectrum from the file
+    const int spectrumRead = scan.GetNextSpectrum(logContext, current.spectrum);
+    m_lastReadSpectrumScanIndex = current.spectrum.ScanIndex();
+
+    if (spectrumRead == 0)
+    {
+        // if something went wrong when reading the spectrum
+        if (scan.m_lastError == novac::FileError::SpectrumNotFound || scan.m_lastError == novac::FileError::EndOfFile)
         {
-            current.Div(current.NumSpectra());
+            // at the end of the file, quit the 'while' loop
+            return SpectrumReadStatus::EndOfScan;
         }
-
-        if (dark.NumSpectra() > 0 && !m_averagedSpectra)
+        else
         {
-            dark.Div(dark.NumSpectra());
+            novac::CString errMsg = "Faulty spectrum found in pak file.";
+            switch (scan.m_lastError)
+            {
+            case novac::FileError::ChecksumMismatch:
+                errMsg.Append(", Checksum mismatch. Spectrum ignored");
+                break;
+            case novac::FileError::DecompressionError:
+                errMsg.Append(", Decompression error. Spectrum ignored");
+                break;
+            default:
+                errMsg.Append(", Unknown error. Spectrum ignored");
+            }
+            m_log.Error(logContext, errMsg.std_str());
+            // remember that this spectrum is corrupted
+            preparedScan.corruptedSpectra.push_back(static_cast<size_t>(curSpectrumIndex));
+            return SpectrumReadStatus::Skipped;
         }
+    }
 
-        // Remove the dark current spectrum
-        current.Sub(dark);
+    ++curSpectrumIndex; // we'have just read the next spectrum in the .pak-file
 
-        // e. Evaluate the spectrum
-        if (eval->Evaluate(current))
+    // If the read spectrum is the sky or the dark spectrum, 
+    // then don't evaluate it...
+    if (current.spectrum.ScanIndex() == sky.ScanIndex() || current.spectrum.ScanIndex() == darkCache.LastDarkScanIndex())
+    {
+        return SpectrumReadStatus::Skipped;
+    }
+
+    // If the spectrum is read out in an interlaced way then interpolate it back to it's original state
+    if (current.spectrum.m_info.m_interlaceStep > 1)
+    {
+        current.spectrum.InterpolateSpectrum();
+    }
+
+    // b. Get the dark spectrum for this measured spectrum
+    const CSpectrum* dark = darkCache.GetNormalizedDark(current.spectrum, [&](CSpectrum& retrievedDark)
         {
-            message.Format("Failed to evaluate spectrum %d out of %d in scan.", current.ScanIndex(), current.SpectraPerScan());
-            if (eval->m_lastError.size() > 0)
-            {
-                message.AppendFormat("(%s)", eval->m_lastError.c_str());
-            }
+            return GetDark(scan, current.spectrum, retrievedDark, darkSettings);
+        });
+    if (dark == nullptr)
+    {
+        m_log.Error(logContext, "Failed to get the dark spectrum for spectrum in scan. Scan evaluation failed.");
+        return SpectrumReadStatus::Failed;
+    }
 
-            m_log.Information(logContext, message.std_str());
-            continue;
-        }
+    // b. Calculate the intensities, before we divide by the number of spectra
+    //  and before we subtract the dark
+    const SpectrumStatistics statistics = CalculateSpectrumStatistics(current.spectrum, spectrometer, m_fitLow, m_fitHigh);
+    current.spectrum.m_info.m_peakIntensity = (float)statistics.peakIntensity;
+    current.spectrum.m_info.m_fitIntensity = (float)statistics.fitIntensity;
 
-        // e. Save the evaluation result
-        result->AppendResult(eval->GetEvaluationResult(), current.m_info);
+    // Check if this spectrum is worth evaluating
+    const double spectrumMaximumSaturationRatioInFitRegion = statistics.maximumSaturationRatioInFitRegion;
+    if (spectrumMaximumSaturationRatioInFitRegion < m_userSettings.m_minimumSaturationInFitRegion)
+    {
+        message.Format("ignoring spectrum %d with maximum saturation %.3lf (%.0lf counts) in fit region (at least %.3lf required)", curSpectrumIndex, spectrumMaximumSaturationRatioInFitRegion, current.spectrum.m_info.m_fitIntensity, m_userSettings.m_minimumSaturationInFitRegion);
+        m_log.Information(logContext, message.std_str());
+        return SpectrumReadStatus::Skipped;
+    }
 
-        // f. Check if this was an ok data point (CScanResult)
-        result->CheckGoodnessOfFit(current.m_info, &spectrometer);
+    // c. Divide the measured spectrum with the number of co-added spectra and remove the dark current spectrum.
+    //     The sky and dark spectra should already be divided before this loop.
+    RemoveNormalizedDark(current.spectrum, *dark, m_averagedSpectra);
+
+    return SpectrumReadStatus::Ok;
+}
 
-        // g. If it is ok, then check if the value is higher than any of the previous ones
-        if (result->IsOk(result->GetEvaluatedNum() - 1) && std::abs(result->GetColumn(result->GetEvaluatedNum() - 1, 0)) > highestColumnInScan)
+void CScanEvaluation::InsertEvaluationResult(
+    novac::LogContext logContext,
+    const novac::SpectrometerModel& spectrometer,
+    const PreparedSpectrum& current,
+    const SpectrumEvaluationResult& evaluationResult,
+    double& highestColumnInScan,
+    CScanResult& result)
+{
+    if (evaluationResult.evaluationFailed)
+    {
+        novac::CString message;
+        message.Format("Failed to evaluate spectrum %d out of %d in scan.", current.spectrum.ScanIndex(), current.spectrum.SpectraPerScan());
+        if (evaluationResult.errorMessage.size() > 0)
         {
-            highestColumnInScan = std::abs(result->GetColumn(result->GetEvaluatedNum() - 1, 0));
-            m_indexOfMostAbsorbingSpectrum = spectrumIndex;
+            message.AppendFormat("(%s)", evaluationResult.errorMessage.c_str());
         }
-    } // end while(1)
 
-    return result;
+        m_log.Information(logContext, message.std_str());
+        return;
+    }
+
+    // e. Save the evaluation result
+    result.AppendResult(evaluationResult.result, current.spectrum.m_info);
+
+    // f. Check if this was an ok data point (CScanResult)
+    result.CheckGoodnessOfFit(current.spectrum.m_info, &spectrometer);
+
+    // g. If it is ok, then check if the value is higher than any of the previous ones
+    if (result.IsOk(result.GetEvaluatedNum() - 1) && std::abs(result.GetColumn(result.GetEvaluatedNum() - 1, 0)) > highestColumnInScan)
+    {
+        highestColumnInScan = std::abs(result.GetColumn(result.GetEvaluatedNum() - 1, 0));
+        m_indexOfMostAbsorbingSpectrum = current.spectrumIndex;
+    }
 }
 
 bool CScanEvaluation::GetDark(novac::CScanFileHandler& scan, const CSpectrum& spec, CSpectrum& dark, const Configuration::CDarkSettings* darkSettings)
@@ -373,75 +559,23 @@ static void SetupFitWindowFitShiftDetermination(CFitWindow& window)
     }
 }
 
-CEvaluationBase* CScanEvaluation::FindOptimumShiftAndSqueeze(novac::LogContext context, const CFitWindow& fitWindow, int indexOfMostAbsorbingSpectrum, novac::CScanFileHandler& scan, const Configuration::CDarkSettings* darkSettings)
+CEvaluationBase* CScanEvaluation::FindOptimumShiftAndSqueeze(novac::LogContext context, const CFitWindow& fitWindow, const PreparedSpectrum& mostAbsorbingSpectrum, const CSpectrum& sky, CFitWindow& optimizedFitWindow)
 {
     novac::CString message;
-    CSpectrum spec, dark;
+    const CSpectrum& spec = mostAbsorbingSpectrum.spectrum;
 
     // Evaluate this spectrum again with free (and linked) shift
     CFitWindow fitWindow2 = fitWindow;
     SetupFitWindowFitShiftDetermination(fitWindow2);
 
-    // Get the sky-spectrum
-    CSpectrum sky;
-    if (!GetSky(scan, m_userSettings.sky, sky))
-    {
-        m_log.Error(context, "Failed to get the sky spectrum. Finding optimium shift and squeeze failed.");
-        return nullptr;
-    }
-
-    if (m_userSettings.sky.skyOption != Configuration::SKY_OPTION::USER_SUPPLIED)
-    {
-        // Get the dark-spectrum and remove it from the sky
-        if (!GetDark(scan, sky, dark, darkSettings))
-        {
-            m_log.Error(context, "Failed to get the dark spectrum. Finding optimium shift and squeeze failed.");
-            return nullptr;
-        }
-        sky.Sub(dark);
-    }
-
-    if (sky.NumSpectra() > 0 && !m_averagedSpectra)
-    {
-        sky.Div(sky.NumSpectra());
-    }
-
     // create the new evaluator
     std::unique_ptr<CEvaluationBase> intermediateEvaluator = std::make_unique<CEvaluationBase>(fitWindow2, m_log);
     intermediateEvaluator->SetSkySpectrum(sky);
 
-    // Get the measured spectrum
-    int ret = scan.GetSpectrum(context, spec, 2 + indexOfMostAbsorbingSpectrum); // The two comes from the sky and the dark spectra in the beginning
-    if (ret != 1)
-    {
-        message.Format("Failed to read spectrum %d in file. Finding optimium shift and squeeze failed.", indexOfMostAbsorbingSpectrum);
-        m_log.Error(context, message.std_str());
-        return nullptr;
-    }
-
     // Tell the user
-    message.Format("Re-evaluating spectrum number %d (scan angle %.1lf, started at %2d:%2d:%2d) to determine optimum shift and squeeze", indexOfMostAbsorbingSpectrum, spec.ScanAngle(), spec.m_info.m_startTime.hour, spec.m_info.m_startTime.minute, spec.m_info.m_startTime.second);
+    message.Format("Re-evaluating spectrum number %d (scan angle %.1lf, started at %2d:%2d:%2d) to determine optimum shift and squeeze", mostAbsorbingSpectrum.spectrumIndex, spec.ScanAngle(), spec.m_info.m_startTime.hour, spec.m_info.m_startTime.minute, spec.m_info.m_startTime.second);
     m_log.Information(context, message.std_str());
 
-    if (spec.m_info.m_interlaceStep > 1)
-    {
-        spec.InterpolateSpectrum();
-    }
-
-    // Get the dark-spectrum and remove it
-    if (!GetDark(scan, spec, dark, darkSettings))
-    {
-        m_log.Error(context, "Failed to get the dark spectrum for spectrum in scan. Finding optimium shift and squeeze failed.");
-        return nullptr;
-    }
-
-    if (spec.NumSpectra() > 0 && !m_averagedSpectra)
-    {
-        spec.Div(spec.NumSpectra());
-    }
-
-    spec.Sub(dark);
-
     // Evaluate
     if (intermediateEvaluator->Evaluate(spec, 5000))
     {
@@ -476,6 +610,7 @@ CEvaluationBase* CScanEvaluation::FindOptimumShiftAndSqueeze(novac::LogContext c
 
     CEvaluationBase* newEvaluator = new CEvaluationBase(fitWindow2, m_log);
     newEvaluator->SetSkySpectrum(sky);
+    optimizedFitWindow = fitWindow2;
 
     // 6. We're done!
     message.Format("Optimum shift set to : %.2lf. Optimum squeeze set to: %.2lf ", optimumShift, optimumSqueeze);
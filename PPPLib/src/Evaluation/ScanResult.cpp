@@ -14,7 +14,7 @@ using namespace novac;
 extern novac::CVolcanoInfo g_volcanoes; // <-- A list of all known volcanoes
 
 CScanResult::CScanResult(const CScanResult& s2) :
-    m_flux(s2.m_flux)
+    m_flux(s2.m_flux), m_metadata(s2.m_metadata)
 {
     this->m_specNum = s2.m_specNum;
     this->m_spec = s2.m_spec;
@@ -35,6 +35,7 @@ CScanResult& CScanResult::operator=(const CScanResult& s2)
 {
     // The calculated flux and offset
     this->m_flux = s2.m_flux;
+    this->m_metadata = s2.m_metadata;
 
     this->m_plumeProperties = s2.m_plumeProperties;
 
@@ -67,11 +68,33 @@ void CScanResult::InitializeArrays(size_t specNum)
 
 void CScanResult::AppendResult(const CEvaluationResult& evalRes, const CSpectrumInfo& specInfo)
 {
-    m_spec.push_back(CEvaluationResult(evalRes));
-    m_specInfo.push_back(CSpectrumInfo(specInfo));
+    m_spec.push_back(evalRes);
+    m_specInfo.push_back(specInfo);
 
     // Increase the number of spectra in this result-set.
     ++m_specNum;
+
+    UpdateMetadata(specInfo);
+}
+
+void CScanResult::UpdateMetadata(const CSpectrumInfo& specInfo)
+{
+    if (std::abs(m_metadata.latitude) <= 1e-2 && std::abs(specInfo.m_gps.m_latitude) > 1e-2)
+    {
+        m_metadata.latitude = specInfo.m_gps.m_latitude;
+    }
+    if (std::abs(m_metadata.longitude) <= 1e-2 && std::abs(specInfo.m_gps.m_longitude) > 1e-2)
+    {
+        m_metadata.longitude = specInfo.m_gps.m_longitude;
+    }
+    if (std::abs(m_metadata.altitude) <= 1e-2 && std::abs(specInfo.m_gps.m_altitude) > 1e-2)
+    {
+        m_metadata.altitude = specInfo.m_gps.m_altitude;
+    }
+    if (m_metadata.serial.empty() && specInfo.m_device.size() > 0)
+    {
+        m_metadata.serial = specInfo.m_device;
+    }
 }
 
 void CScanResult::MarkAsCorrupted(size_t specIndex)
@@ -102,6 +125,13 @@ int CScanResult::RemoveResult(size_t specIndex)
     // Decrease the number of values in the list
     m_specNum -= 1;
 
+    // The removed spectrum may have been the one the metadata was taken from
+    m_metadata = ScanMetadata();
+    for (const CSpectrumInfo& info : m_specInfo)
+    {
+        UpdateMetadata(info);
+    }
+
     return 0;
 }
 
@@ -256,36 +286,19 @@ bool CScanResult::RemoveMark(size_t index, int MARK_FLAG)
 /** Returns the latitude of the system */
 double CScanResult::GetLatitude() const
 {
-    for (unsigned int k = 0; k < m_specNum; ++k)
-    {
-        const CSpectrumInfo& info = m_specInfo[k];
-        if (fabs(info.m_gps.m_latitude) > 1e-2)
-            return info.m_gps.m_latitude;
-    }
-    return 0.0;
+    return m_metadata.latitude;
 }
 
 /** Returns the longitude of the system */
 double CScanResult::GetLongitude() const
 {
-    for (unsigned int k = 0; k < m_specNum; ++k)
-    {
-        const CSpectrumInfo& info = m_specInfo[k];
-        if (fabs(info.m_gps.m_longitude) > 1e-2)
-            return info.m_gps.m_longitude;
-    }
-    return 0.0;
+    return m_metadata.longitude;
 }
+
 /** Returns the altitude of the system */
 double CScanResult::GetAltitude() const
 {
-    for (unsigned int k = 0; k < m_specNum; ++k)
-    {
-        const CSpectrumInfo& info = m_specInfo[k];
-        if (fabs(info.m_gps.m_altitude) > 1e-2)
-            return info.m_gps.m_altitude;
-    }
-    return 0.0;
+    return m_metadata.altitude;
 }
 
 /** Returns the compass-direction of the system */
@@ -340,15 +353,7 @@ double CScanResult::GetRoll() const
 
 std::string CScanResult::GetSerial() const
 {
-    for (unsigned int k = 0; k < m_specNum; ++k)
-    {
-        const CSpectrumInfo& info = m_specInfo[k];
-        if (info.m_device.size() > 0)
-        {
-            return info.m_device;
-        }
-    }
-    return "";
+    return m_metadata.serial;
 }
 
 
@@ -0,0 +1,65 @@
+#include <PPPLib/Evaluation/SpectrumStatistics.h>
+#include <algorithm>
+#include <limits>
+
+namespace Evaluation
+{
+
+// Returns the maximum value in data[begin, end), or 'initialValue' if the range is empty.
+// Written without branches in the loop such that it can be vectorized by the compiler.
+static double MaxValueInRange(const double* data, int begin, int end, double initialValue)
+{
+    double maxValue = initialValue;
+    for (int pixelIdx = begin; pixelIdx < end; ++pixelIdx)
+    {
+        maxValue = (data[pixelIdx] > maxValue) ? data[pixelIdx] : maxValue;
+    }
+    return maxValue;
+}
+
+SpectrumStatistics CalculateSpectrumStatistics(const double* data, int length, int fitLow, int fitHigh, double fullDynamicRange)
+{
+    SpectrumStatistics result;
+    if (data == nullptr || length <= 0)
+    {
+        return result;
+    }
+
+    const double lowest = std::numeric_limits<double>::lowest();
+
+    const int peakEnd = std::max(0, length - 2);
+    const int fitBegin = std::min(std::max(0, fitLow), length);
+    const int fitEnd = std::min(std::max(fitBegin, fitHigh), length);
+
+    // The fit region normally lies completely within the region of the peak intensity.
+    //  The maximum in the overlap is shared by both and every pixel is only visited once.
+    const int overlapBegin = std::min(fitBegin, peakEnd);
+    const int overlapEnd = std::min(fitEnd, peakEnd);
+    const double overlapMax = MaxValueInRange(data, overlapBegin, overlapEnd, lowest);
+
+    double peakMax = MaxValueInRange(data, 0, overlapBegin, overlapMax);
+    peakMax = MaxValueInRange(data, overlapEnd, peakEnd, peakMax);
+
+    const double fitMax = MaxValueInRange(data, std::max(fitBegin, peakEnd), fitEnd, overlapMax);
+
+    result.peakIntensity = (peakEnd > 0) ? peakMax : 0.0;
+    result.fitIntensity = (fitEnd > fitBegin) ? fitMax : 0.0;
+
+    if (fullDynamicRange > 0.0)
+    {
+        result.maximumSaturationRatioInFitRegion = result.fitIntensity / fullDynamicRange;
+    }
+
+    return result;
+}
+
+SpectrumStatistics CalculateSpectrumStatistics(const novac::CSpectrum& spectrum, const novac::SpectrometerModel& model, int fitLow, int fitHigh)
+{
+    // The same dynamic range as used by novac::GetMaximumSaturationRatioOfSpectrum,
+    //  which differs between spectrometers which add and which average the readouts.
+    const double fullDynamicRange = model.FullDynamicRangeForSpectrum(spectrum.m_info);
+
+    return CalculateSpectrumStatistics(&spectrum.m_data[0], spectrum.m_length, fitLow, fitHigh, fullDynamicRange);
+}
+
+}
@@ -0,0 +1,125 @@
+#include <PPPLib/File/BufferedFileWriter.h>
+#include <cstdarg>
+#include <algorithm>
+#include <cstring>
+
+#undef min
+#undef max
+
+namespace FileHandler
+{
+
+CBufferedFileWriter::CBufferedFileWriter(size_t bufferSize)
+    : m_buffer(bufferSize > 0 ? bufferSize : 1)
+{
+}
+
+CBufferedFileWriter::~CBufferedFileWriter()
+{
+    Close();
+}
+
+bool CBufferedFileWriter::Open(const std::string& fileName, bool append)
+{
+    Close();
+
+    m_file = fopen(fileName.c_str(), append ? "a" : "w");
+    return (m_file != nullptr);
+}
+
+void CBufferedFileWriter::Printf(const char* format, ...)
+{
+    if (m_file == nullptr)
+    {
+        return;
+    }
+
+    // Format directly into the free part of the buffer
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(m_buffer.data() + m_length, m_buffer.size() - m_length, format, args);
+    va_end(args);
+
+    if (length < 0)
+    {
+        return;
+    }
+    if (static_cast<size_t>(length) < m_buffer.size() - m_length)
+    {
+        m_length += static_cast<size_t>(length);
+        return;
+    }
+
+    // The text did not fit in what remains of the buffer, flush it and try again
+    Flush();
+    if (static_cast<size_t>(length) < m_buffer.size())
+    {
+        va_start(args, format);
+        length = vsnprintf(m_buffer.data(), m_buffer.size(), format, args);
+        va_end(args);
+        m_length = static_cast<size_t>(std::max(0, length));
+    }
+    else
+    {
+        // Longer than the whole buffer, this goes straight to the file
+        std::vector<char> text(static_cast<size_t>(length) + 1);
+        va_start(args, format);
+        vsnprintf(text.data(), text.size(), format, args);
+        va_end(args);
+        fwrite(text.data(), 1, static_cast<size_t>(length), m_file);
+    }
+}
+
+void CBufferedFileWriter::Write(const char* text)
+{
+    Write(text, strlen(text));
+}
+
+void CBufferedFileWriter::Write(const std::string& text)
+{
+    Write(text.c_str(), text.size());
+}
+
+void CBufferedFileWriter::Write(const char* text, size_t length)
+{
+    if (m_file == nullptr)
+    {
+        return;
+    }
+
+    if (length > m_buffer.size() - m_length)
+    {
+        Flush();
+        if (length >= m_buffer.size())
+        {
+            fwrite(text, 1, length, m_file);
+            return;
+        }
+    }
+
+    memcpy(m_buffer.data() + m_length, text, length);
+    m_length += length;
+}
+
+void CBufferedFileWriter::Flush()
+{
+    if (m_file != nullptr && m_length > 0)
+    {
+        fwrite(m_buffer.data(), 1, m_length, m_file);
+    }
+    m_length = 0;
+}
+
+void CBufferedFileWriter::Close()
+{
+    if (m_file == nullptr)
+    {
+        return;
+    }
+
+    Flush();
+    fclose(m_file);
+    m_file = nullptr;
+}
+
+}
@@ -1,6 +1,7 @@
 #include <PPPLib/File/EvaluationLogFileHandler.h>
 #include <PPPLib/File/Filesystem.h>
 #include <PPPLib/MFC/CSingleLock.h>
+#include <PPPLib/TraceRecorder.h>
 
 #include <SpectralEvaluation/Spectra/SpectrometerModel.h>
 #include <SpectralEvaluation/StringUtils.h>
@@ -15,6 +16,17 @@ novac::CCriticalSection g_evalLogCritSect; // synchronization access to evaluati
 
 using namespace FileHandler;
 
+/** Retrieves the next token from the string, in the same way as strtok would, but with the state
+    of the tokenizing kept in 'context' such that several strings can be tokenized at the same time. */
+static char* NextToken(char* str, const char* delimiters, char** context)
+{
+#ifdef _MSC_VER
+    return strtok_s(str, delimiters, context);
+#else
+    return strtok_r(str, delimiters, context);
+#endif
+}
+
 CEvaluationLogFileHandler::CEvaluationLogFileHandler(
     novac::ILogger& log,
     std::string evaluationLog,
@@ -72,6 +84,7 @@ void CEvaluationLogFileHandler::ParseScanHeader(const char szLine[8192])
         strncpy(str, szLine, 8192 * sizeof(char));
 
     char* szToken = str;
+    char* tokenContext = nullptr;
     int curCol = -1;
     char elevation[] = "elevation";
     char scanAngle[] = "scanangle";
@@ -97,7 +110,7 @@ void CEvaluationLogFileHandler::ParseScanHeader(const char szLine[8192])
     char stoptime[] = "stoptime";
     char nameStr[] = "name";
 
-    while (nullptr != (szToken = strtok(szToken, "\t")))
+    while (nullptr != (szToken = NextToken(szToken, "\t", &tokenContext)))
     {
         ++curCol;
 
@@ -309,6 +322,7 @@ RETURN_CODE CEvaluationLogFileHandler::ReadEvaluationLog()
     double fValue;
     bool fReadingScan = false;
     double flux = 0.0;
+    novac::CTraceScope trace("file", "ReadEvaluationLog", m_evaluationLog);
 
     // If no evaluation log selected, quit
     if (m_evaluationLog.size() <= 1)
@@ -439,8 +453,9 @@ RETURN_CODE CEvaluationLogFileHandler::ReadEvaluationLog()
 
             // Split the scan information up into tokens and parse them.
             char* szToken = (char*)szLine;
+            char* tokenContext = nullptr;
             int curCol = -1;
-            while (nullptr != (szToken = strtok(szToken, " \t")))
+            while (nullptr != (szToken = NextToken(szToken, " \t", &tokenContext)))
             {
                 ++curCol;
 
@@ -667,7 +682,7 @@ RETURN_CODE CEvaluationLogFileHandler::ReadEvaluationLog()
     }
 
     // Insert the new scan
-    m_scan.push_back(newResult);
+    m_scan.push_back(std::move(newResult));
 
     newResult = Evaluation::CScanResult();
 
@@ -3,12 +3,102 @@
 #include <PPPLib/MFC/CFileUtils.h>
 #include <Poco/DirectoryIterator.h>
 #include <Poco/Exception.h>
+#include <Poco/File.h>
+
+#ifdef _MSC_VER
+#include <Windows.h>
+#undef min
+#undef max
+#else
+#include <dirent.h>
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
 
 void ShowMessage(const char message[]);
 
 namespace Filesystem
 {
 
+/** @return true if the file with the given name (excluding path) fulfills the given criteria. */
+static bool IsMatchingFile(const std::string& filename, const FileSearchCriterion& criteria)
+{
+    // check that this file is in the time-interval that we should evaluate spectra.
+    if (criteria.endTime > criteria.startTime)
+    {
+        int channel;
+        novac::CDateTime startTime;
+        novac::MeasurementMode mode;
+        novac::CString serial;
+        novac::CFileUtils::GetInfoFromFileName(filename, startTime, serial, channel, mode);
+
+        if (startTime < criteria.startTime || criteria.endTime < startTime)
+        {
+            return false;
+        }
+    }
+
+    if (criteria.fileExtension.size() > 0)
+    {
+        if (filename.size() <= criteria.fileExtension.size())
+        {
+            return false;
+        }
+        const std::string currentFileExtension = novac::GetFileExtension(filename);
+        if (!novac::EqualsIgnoringCase(currentFileExtension, criteria.fileExtension))
+        {
+            return false;
+        }
+        if (novac::EqualsIgnoringCase(criteria.fileExtension, ".pak"))
+        {
+            if (novac::CFileUtils::IsIncompleteFile(filename))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool IsDateDirectoryOutsideOfInterval(const std::string& directoryName, const FileSearchCriterion& criteria)
+{
+    if (!(criteria.directoryEndTime > criteria.directoryStartTime))
+    {
+        return false;
+    }
+
+    // The directory name must be exactly on the form 'yyyy.mm.dd'
+    if (directoryName.size() != 10 || directoryName[4] != '.' || directoryName[7] != '.')
+    {
+        return false;
+    }
+
+    int year = 0;
+    int month = 0;
+    int day = 0;
+    if (3 != sscanf(directoryName.c_str(), "%4d.%2d.%2d", &year, &month, &day))
+    {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31)
+    {
+        return false;
+    }
+
+    const novac::CDateTime firstSecondOfDay(year, month, day, 0, 0, 0);
+    const novac::CDateTime lastSecondOfDay(year, month, day, 23, 59, 59);
+
+    return (lastSecondOfDay < criteria.directoryStartTime || criteria.directoryEndTime < firstSecondOfDay);
+}
+
 void SearchDirectoryForFiles(const std::string& path, bool includeSubdirectories, std::vector<std::string>& fileList, FileSearchCriterion* criteria)
 {
     try
@@ -24,7 +114,7 @@ void SearchDirectoryForFiles(const std::string& path, bool includeSubdirectories
 
             ++dir; // go to next file in the directory
 
-            if (novac::EqualsIgnoringCase(dir.name(), ".") || novac::EqualsIgnoringCase(dir.name(), ".."))
+            if (novac::EqualsIgnoringCase(filename, ".") || novac::EqualsIgnoringCase(filename, ".."))
             {
                 continue;
             }
@@ -32,45 +122,20 @@ void SearchDirectoryForFiles(const std::string& path, bool includeSubdirectories
             // if this is a directory...
             if (isDirectory && includeSubdirectories)
             {
+                if (nullptr != criteria && IsDateDirectoryOutsideOfInterval(filename, *criteria))
+                {
+                    continue;
+                }
+
                 SearchDirectoryForFiles(filenameIncludingPath, includeSubdirectories, fileList, criteria);
                 continue;
             }
 
-            // check that this file is in the time-interval that we should evaluate spectra.
             if (nullptr != criteria)
             {
-                if (criteria->endTime > criteria->startTime)
+                if (!IsMatchingFile(filename, *criteria))
                 {
-                    int channel;
-                    novac::CDateTime startTime;
-                    novac::MeasurementMode mode;
-                    novac::CString serial;
-                    novac::CFileUtils::GetInfoFromFileName(filename, startTime, serial, channel, mode);
-
-                    if (startTime < criteria->startTime || criteria->endTime < startTime)
-                    {
-                        continue;
-                    }
-                }
-
-                if (criteria->fileExtension.size() > 0)
-                {
-                    if (filename.size() <= criteria->fileExtension.size())
-                    {
-                        continue;
-                    }
-                    const std::string currentFileExtension = novac::GetFileExtension(filename);
-                    if (!novac::EqualsIgnoringCase(currentFileExtension, criteria->fileExtension))
-                    {
-                        continue;
-                    }
-                    if (novac::EqualsIgnoringCase(criteria->fileExtension, ".pak"))
-                    {
-                        if (novac::CFileUtils::IsIncompleteFile(filename))
-                        {
-                            continue;
-                        }
-                    }
+                    continue;
                 }
 
                 // We've passed all the tests for the .pak-file.
@@ -85,6 +150,280 @@ void SearchDirectoryForFiles(const std::string& path, bool includeSubdirectories
     }
 }
 
+namespace
+{
+/** DirectorySearchQueue keeps track of the directories which remains to be searched
+    in SearchDirectoryForFilesInParallel. This also counts the directories which are currently
+    being searched, since these may add more directories to the queue, such that the
+    searching threads know when the whole directory tree has been covered. */
+class DirectorySearchQueue
+{
+public:
+    explicit DirectorySearchQueue(const std::string& rootDirectory)
+    {
+        m_directories.push_back(rootDirectory);
+    }
+
+    /** Retrieves the next directory to search. Blocks until there is a directory available
+        or until all directories have been searched.
+        @return false if there are no more directories to search. */
+    bool PopFront(std::string& directory)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this] { return m_aborted || !m_directories.empty() || m_directoriesInProgress == 0; });
+
+        if (m_aborted || m_directories.empty())
+        {
+            return false;
+        }
+
+        directory = std::move(m_directories.front());
+        m_directories.pop_front();
+        ++m_directoriesInProgress;
+        return true;
+    }
+
+    /** Marks one directory returned from PopFront as searched and adds the
+        sub-directories found in it to the queue. */
+    void DirectoryDone(std::vector<std::string>& subDirectories)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (std::string& directory : subDirectories)
+            {
+                m_directories.push_back(std::move(directory));
+            }
+            --m_directoriesInProgress;
+        }
+        m_condition.notify_all();
+    }
+
+    /** Stops the search, all following calls to PopFront return false. */
+    void Abort()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_aborted = true;
+            m_directories.clear();
+        }
+        m_condition.notify_all();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<std::string> m_directories;
+    size_t m_directoriesInProgress = 0;
+    bool m_aborted = false;
+};
+}
+
+/** The type of an entry in a directory, as far as it is known without querying the file-system for the entry itself */
+enum class DirectoryEntryType
+{
+    File,
+    Directory,
+    Unknown
+};
+
+struct DirectoryEntry
+{
+    std::string name;
+    DirectoryEntryType type = DirectoryEntryType::Unknown;
+};
+
+/** Lists the names in the given directory, with the type of each entry when the directory listing includes it.
+    Symbolic links and other special entries are listed with an unknown type.
+    @return false if the directory could not be read. */
+static bool ListDirectory(const std::string& path, std::vector<DirectoryEntry>& entries)
+{
+#ifdef _MSC_VER
+    WIN32_FIND_DATAA findData;
+    HANDLE handle = FindFirstFileA((path + "/*").c_str(), &findData);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    do
+    {
+        DirectoryEntry entry;
+        entry.name = findData.cFileName;
+        if (findData.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)
+        {
+            entry.type = DirectoryEntryType::Unknown;
+        }
+        else if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        {
+            entry.type = DirectoryEntryType::Directory;
+        }
+        else
+        {
+            entry.type = DirectoryEntryType::File;
+        }
+        entries.push_back(entry);
+    } while (FindNextFileA(handle, &findData));
+    FindClose(handle);
+#else
+    DIR* directory = opendir(path.c_str());
+    if (directory == nullptr)
+    {
+        return false;
+    }
+    while (const struct dirent* directoryEntry = readdir(directory))
+    {
+        DirectoryEntry entry;
+        entry.name = directoryEntry->d_name;
+        if (directoryEntry->d_type == DT_REG)
+        {
+            entry.type = DirectoryEntryType::File;
+        }
+        else if (directoryEntry->d_type == DT_DIR)
+        {
+            entry.type = DirectoryEntryType::Directory;
+        }
+        entries.push_back(entry);
+    }
+    closedir(directory);
+#endif
+    return true;
+}
+
+/** Lists the contents of one directory and sorts out the files matching the criteria and the sub-directories to search.
+    All entries in the directory are read first and then classified. Entries which can neither be a matching file
+    nor a directory to search are discarded by their name alone. The file-system is only queried for the type of the remaining
+    entries when the directory listing does not tell whether the entry is a file or a directory, e.g. for symbolic links
+    or on file-systems which do not report the type. */
+static void SearchSingleDirectory(
+    const std::string& path,
+    bool includeSubdirectories,
+    const FileSearchCriterion* criteria,
+    std::vector<std::string>& files,
+    std::vector<std::string>& subDirectories)
+{
+    std::vector<DirectoryEntry> entries;
+    if (!ListDirectory(path, entries))
+    {
+        ShowMessage(("Could not read the directory: " + path).c_str());
+        return;
+    }
+
+    for (const DirectoryEntry& entry : entries)
+    {
+        if (entry.name == "." || entry.name == "..")
+        {
+            continue;
+        }
+
+        const bool canBeMatchingFile = (nullptr == criteria) || IsMatchingFile(entry.name, *criteria);
+        const bool canBeDirectoryToSearch = includeSubdirectories && (nullptr == criteria || !IsDateDirectoryOutsideOfInterval(entry.name, *criteria));
+        if (!canBeMatchingFile && !canBeDirectoryToSearch)
+        {
+            continue; // this is neither a matching file nor a directory which we need to search.
+        }
+
+        const std::string nameIncludingPath = path + "/" + entry.name;
+        bool isDirectory = (entry.type == DirectoryEntryType::Directory);
+        if (entry.type == DirectoryEntryType::Unknown)
+        {
+            try
+            {
+                isDirectory = Poco::File(nameIncludingPath).isDirectory();
+            }
+            catch (Poco::Exception&)
+            {
+                continue; // the entry disappeared or is not accessible, ignore it.
+            }
+        }
+
+        if (isDirectory)
+        {
+            if (canBeDirectoryToSearch)
+            {
+                subDirectories.push_back(nameIncludingPath);
+            }
+        }
+        else if (canBeMatchingFile)
+        {
+            files.push_back(nameIncludingPath);
+        }
+    }
+}
+
+size_t SearchDirectoryForFilesInParallel(
+    const std::string& path,
+    bool includeSubdirectories,
+    const FileSearchCriterion* criteria,
+    unsigned int threadNum,
+    std::function<void(std::vector<std::string>&)> onFilesFound)
+{
+    DirectorySearchQueue directoriesToSearch{ path };
+    std::atomic<size_t> numberOfFilesFound{ 0 };
+
+    // The first failure in any of the threads, this stops the search and is passed on once all threads are done.
+    std::mutex failureGuard;
+    std::exception_ptr failure;
+
+    auto searchDirectories = [&]()
+    {
+        try
+        {
+            std::string directory;
+            while (directoriesToSearch.PopFront(directory))
+            {
+                std::vector<std::string> files;
+                std::vector<std::string> subDirectories;
+                SearchSingleDirectory(directory, includeSubdirectories, criteria, files, subDirectories);
+
+                // Let the other threads continue with the sub-directories before the files are reported.
+                directoriesToSearch.DirectoryDone(subDirectories);
+
+                if (files.size() > 0)
+                {
+                    numberOfFilesFound += files.size();
+                    onFilesFound(files);
+                }
+            }
+        }
+        catch (...)
+        {
+            {
+                std::lock_guard<std::mutex> lock(failureGuard);
+                if (failure == nullptr)
+                {
+                    failure = std::current_exception();
+                }
+            }
+            directoriesToSearch.Abort();
+        }
+    };
+
+    // The calling thread also takes part in the search.
+    std::vector<std::thread> searchThreads;
+    try
+    {
+        for (unsigned int threadIdx = 1; threadIdx < threadNum; ++threadIdx)
+        {
+            searchThreads.push_back(std::thread(searchDirectories));
+        }
+    }
+    catch (const std::system_error&)
+    {
+        // Could not start more threads, continue with the ones which did start.
+    }
+    searchDirectories();
+
+    for (std::thread& t : searchThreads)
+    {
+        t.join();
+    }
+
+    if (failure != nullptr)
+    {
+        std::rethrow_exception(failure);
+    }
+
+    return numberOfFilesFound;
+}
 
 bool IsExistingFile(const novac::CString& fileName)
 {
@@ -0,0 +1,191 @@
+#include <PPPLib/File/PakCodec.h>
+#include <stdexcept>
+#include <string>
+
+namespace FileHandler
+{
+
+/** The number of bits in the header of each segment */
+static const int headerBits = 12;
+
+/** The largest number of values in one segment, limited by the 7 bits used to store it */
+static const int maximumSegmentLength = 127;
+
+/** Collects the written bits into a 64-bit word and appends them to the output four bytes at a time. */
+class CPakBitWriter
+{
+public:
+    explicit CPakBitWriter(std::vector<std::uint8_t>& output)
+        : m_output(output)
+    {
+    }
+
+    /** Writes the lowest 'count' bits of the value, most significant bit first. 'count' must not exceed 32. */
+    void Write(std::uint32_t value, int count)
+    {
+        const std::uint64_t mask = (std::uint64_t(1) << count) - 1;
+        m_buffer = (m_buffer << count) | (value & mask);
+        m_bitsInBuffer += count;
+
+        if (m_bitsInBuffer >= 32)
+        {
+            m_bitsInBuffer -= 32;
+            const std::uint32_t word = static_cast<std::uint32_t>(m_buffer >> m_bitsInBuffer);
+            m_output.push_back(static_cast<std::uint8_t>(word >> 24));
+            m_output.push_back(static_cast<std::uint8_t>(word >> 16));
+            m_output.push_back(static_cast<std::uint8_t>(word >> 8));
+            m_output.push_back(static_cast<std::uint8_t>(word));
+            m_buffer &= (std::uint64_t(1) << m_bitsInBuffer) - 1;
+        }
+    }
+
+    /** Writes the remaining bits, padding the last byte with zeros. */
+    void Flush()
+    {
+        while (m_bitsInBuffer > 0)
+        {
+            if (m_bitsInBuffer >= 8)
+            {
+                m_bitsInBuffer -= 8;
+                m_output.push_back(static_cast<std::uint8_t>(m_buffer >> m_bitsInBuffer));
+            }
+            else
+            {
+                m_output.push_back(static_cast<std::uint8_t>(m_buffer << (8 - m_bitsInBuffer)));
+                m_bitsInBuffer = 0;
+            }
+        }
+        m_buffer = 0;
+    }
+
+private:
+    std::vector<std::uint8_t>& m_output;
+
+    /** The bits not yet written to the output, in the lowest m_bitsInBuffer bits. This is always less than 32 between calls. */
+    std::uint64_t m_buffer = 0;
+    int m_bitsInBuffer = 0;
+};
+
+/** @return the number of bits needed to store the given value in two's complement. Zero needs no bits at all. */
+static int BitsNeeded(std::int32_t value)
+{
+    if (value == 0)
+    {
+        return 0;
+    }
+
+    // Count the bits which differ from the sign bit, plus one for the sign itself.
+    std::uint32_t magnitude = static_cast<std::uint32_t>(value < 0 ? ~value : value);
+    int bits = 1;
+    while (magnitude != 0)
+    {
+        ++bits;
+        magnitude >>= 1;
+    }
+    return bits;
+}
+
+/** Decides the length and the number of bits of the next segment.
+    This makes exactly the same choices as the original compression, such that the compressed data is identical.
+    @param bitsNeeded The number of bits needed by each of the remaining values. This must be followed by one extra zero.
+    @param remaining The number of remaining values.
+    @param segmentBits Will on return be set to the number of bits of each value in the segment.
+    @return the number of values in the segment. */
+static int NextSegment(const int* bitsNeeded, size_t remaining, int& segmentBits)
+{
+    // runLength[j] is the number of values at the end of the segment which would fit in j bits
+    int runLength[33] = {};
+
+    int bits = *bitsNeeded++;
+    int currentBits = bits;
+    int count = 0;
+
+    do
+    {
+        ++count;
+        for (int j = 0; j < currentBits; ++j)
+        {
+            if (bits > j)
+            {
+                runLength[j] = 0;
+            }
+            else
+            {
+                ++runLength[j];
+
+                // Better to end the segment before these values and store them with fewer bits in a new segment.
+                if (runLength[j] * (currentBits - j) > 2 * headerBits)
+                {
+                    segmentBits = currentBits;
+                    return count - runLength[j];
+                }
+            }
+        }
+
+        bits = *bitsNeeded++;
+        if (bits > currentBits)
+        {
+            // Better to start a new segment than to widen all the values of this one.
+            if (count * (bits - currentBits) > headerBits)
+            {
+                break;
+            }
+
+            while (currentBits != bits)
+            {
+                runLength[currentBits] = count;
+                ++currentBits;
+            }
+        }
+    } while (static_cast<size_t>(count) < remaining && count < maximumSegmentLength);
+
+    segmentBits = currentBits;
+    return count;
+}
+
+void CompressSpectrumData(const std::int32_t* values, size_t length, std::vector<std::uint8_t>& compressed)
+{
+    compressed.clear();
+    if (length == 0)
+    {
+        return;
+    }
+
+    // The differences between consecutive values and the number of bits needed to store each of them.
+    std::vector<std::int32_t> differences(length);
+    std::vector<int> bitsNeeded(length + 1, 0);
+    std::int64_t previousValue = 0;
+    for (size_t ii = 0; ii < length; ++ii)
+    {
+        const std::int64_t difference = static_cast<std::int64_t>(values[ii]) - previousValue;
+        if (difference > pakMaximumDifference || difference < -static_cast<std::int64_t>(pakMaximumDifference) - 1)
+        {
+            throw std::invalid_argument("Cannot compress spectrum, the difference between the values at index " + std::to_string(ii) + " is too large.");
+        }
+        differences[ii] = static_cast<std::int32_t>(difference);
+        bitsNeeded[ii] = BitsNeeded(differences[ii]);
+        previousValue = values[ii];
+    }
+
+    compressed.reserve(length * 2 + 4);
+    CPakBitWriter writer{ compressed };
+
+    size_t position = 0;
+    while (position < length)
+    {
+        int segmentBits = 0;
+        const int count = NextSegment(bitsNeeded.data() + position, length - position, segmentBits);
+
+        writer.Write(static_cast<std::uint32_t>((count << 5) | segmentBits), headerBits);
+        for (int ii = 0; ii < count; ++ii)
+        {
+            writer.Write(static_cast<std::uint32_t>(differences[position + static_cast<size_t>(ii)]), segmentBits);
+        }
+
+        position += static_cast<size_t>(count);
+    }
+
+    writer.Flush();
+}
+
+}
@@ -0,0 +1,184 @@
+#include <PPPLib/File/PakFileWriter.h>
+#include <PPPLib/File/PakCodec.h>
+#include <cstring>
+#include <stdexcept>
+
+namespace FileHandler
+{
+
+const std::uint16_t CPakFileWriter::headerSize;
+
+/** Serializes the values of a header in little endian byte order */
+class CPakHeaderBuffer
+{
+public:
+    explicit CPakHeaderBuffer(size_t size)
+        : m_data(size, 0)
+    {
+    }
+
+    void Put8(std::uint8_t value)
+    {
+        m_data[m_position++] = value;
+    }
+
+    void Put16(std::uint16_t value)
+    {
+        Put8(static_cast<std::uint8_t>(value));
+        Put8(static_cast<std::uint8_t>(value >> 8));
+    }
+
+    void Put32(std::uint32_t value)
+    {
+        Put16(static_cast<std::uint16_t>(value));
+        Put16(static_cast<std::uint16_t>(value >> 16));
+    }
+
+    void Put64(std::uint64_t value)
+    {
+        Put32(static_cast<std::uint32_t>(value));
+        Put32(static_cast<std::uint32_t>(value >> 32));
+    }
+
+    void PutFloat(float value)
+    {
+        std::uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        Put32(bits);
+    }
+
+    void PutDouble(double value)
+    {
+        std::uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        Put64(bits);
+    }
+
+    /** Writes the string into a field of the given size, padded with zeros. The last byte is always zero. */
+    void PutString(const std::string& value, size_t fieldSize)
+    {
+        for (size_t ii = 0; ii < fieldSize; ++ii)
+        {
+            Put8((ii + 1 < fieldSize && ii < value.size()) ? static_cast<std::uint8_t>(value[ii]) : 0);
+        }
+    }
+
+    void Skip(size_t bytes)
+    {
+        m_position += bytes;
+    }
+
+    const std::vector<std::uint8_t>& Data() const { return m_data; }
+
+private:
+    std::vector<std::uint8_t> m_data;
+    size_t m_position = 0;
+};
+
+void PakSpectrumHeader::SetTime(const novac::CDateTime& start, const novac::CDateTime& stop)
+{
+    date = static_cast<std::uint32_t>(start.day * 10000 + start.month * 100 + (start.year % 100));
+    startTime = static_cast<std::uint32_t>(((start.hour * 100 + start.minute) * 100 + start.second) * 100);
+    stopTime = static_cast<std::uint32_t>(((stop.hour * 100 + stop.minute) * 100 + stop.second) * 100);
+}
+
+CPakFileWriter::~CPakFileWriter()
+{
+    Close();
+}
+
+bool CPakFileWriter::Open(const std::string& fileName)
+{
+    Close();
+
+    m_file = fopen(fileName.c_str(), "wb");
+    return (m_file != nullptr);
+}
+
+void CPakFileWriter::Close()
+{
+    if (m_file != nullptr)
+    {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+bool CPakFileWriter::Write(const PakSpectrumHeader& header, const std::int32_t* values, size_t length)
+{
+    if (m_file == nullptr)
+    {
+        return false;
+    }
+    if (length > 0xFFFF)
+    {
+        throw std::invalid_argument("Cannot write spectrum with more than 65535 pixels to .pak file.");
+    }
+
+    CompressSpectrumData(values, length, m_compressed);
+    if (m_compressed.size() > 0xFFFF)
+    {
+        throw std::invalid_argument("Cannot write spectrum to .pak file, the compressed spectrum is too large.");
+    }
+
+    // The checksum is the sum of the pixel values, with the upper and the lower 16 bits of the sum added together.
+    //  This is what the instruments write and what the readers of the .pak files verify.
+    std::uint32_t sum = 0;
+    for (size_t ii = 0; ii < length; ++ii)
+    {
+        sum += static_cast<std::uint32_t>(values[ii]);
+    }
+    const std::uint16_t checksum = static_cast<std::uint16_t>((sum & 0xFFFF) + (sum >> 16));
+
+    CPakHeaderBuffer buffer{ headerSize };
+    for (char c : { 'M', 'K', 'Z', 'Y' })
+    {
+        buffer.Put8(static_cast<std::uint8_t>(c));
+    }
+    buffer.Put16(headerSize);
+    buffer.Put16(5); // the version of the header
+    buffer.Put16(static_cast<std::uint16_t>(m_compressed.size()));
+    buffer.Put16(checksum);
+    buffer.PutString(header.name, 12);
+    buffer.PutString(header.instrumentName, 16);
+    buffer.Put16(header.startChannel);
+    buffer.Put16(static_cast<std::uint16_t>(length));
+    buffer.Put16(static_cast<std::uint16_t>(header.viewAngle));
+    buffer.Put16(header.scans);
+    buffer.Put16(static_cast<std::uint16_t>(header.exposureTime));
+    buffer.Put8(header.channel);
+    buffer.Put8(header.flag);
+    buffer.Put32(header.date);
+    buffer.Put32(header.startTime);
+    buffer.Put32(header.stopTime);
+    buffer.PutDouble(header.latitude);
+    buffer.PutDouble(header.longitude);
+    buffer.Put16(static_cast<std::uint16_t>(header.altitude));
+    buffer.Put8(static_cast<std::uint8_t>(header.measurementIndex));
+    buffer.Put8(static_cast<std::uint8_t>(header.measurementCount));
+    buffer.Put16(static_cast<std::uint16_t>(header.viewAngle2));
+    buffer.Put16(static_cast<std::uint16_t>(header.compassDirection));
+    buffer.Put16(static_cast<std::uint16_t>(header.tiltX));
+    buffer.Put16(static_cast<std::uint16_t>(header.tiltY));
+    buffer.PutFloat(header.temperature);
+    buffer.Put8(static_cast<std::uint8_t>(header.coneAngle));
+    buffer.Skip(1); // padding
+    for (std::uint16_t adcValue : header.adc)
+    {
+        buffer.Put16(adcValue);
+    }
+
+    const std::vector<std::uint8_t>& headerData = buffer.Data();
+    if (fwrite(headerData.data(), 1, headerData.size(), m_file) != headerData.size())
+    {
+        return false;
+    }
+    if (!m_compressed.empty() && fwrite(m_compressed.data(), 1, m_compressed.size(), m_file) != m_compressed.size())
+    {
+        return false;
+    }
+
+    return true;
+}
+
+}
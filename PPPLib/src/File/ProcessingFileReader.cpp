@@ -61,6 +61,61 @@ void CProcessingFileReader::ReadProcessingFile(const novac::CString& filename, C
             continue;
         }
 
+        // If we've found the number of threads to use within each scan
+        if (Equals(szToken, str_spectrumThreadNum, strlen(str_spectrumThreadNum)))
+        {
+            int number = 1;
+            Parse_IntItem(ENDTAG(str_spectrumThreadNum), number);
+            settings.m_spectrumThreadNum = (unsigned long)std::max(1, number);
+            continue;
+        }
+
+        // If we've found the limits of the number of scans waiting for evaluation
+        if (Equals(szToken, str_maxScansInFlight, strlen(str_maxScansInFlight)))
+        {
+            int number = 0;
+            Parse_IntItem(ENDTAG(str_maxScansInFlight), number);
+            settings.m_maxScansInFlight = (unsigned long)std::max(0, number);
+            continue;
+        }
+        if (Equals(szToken, str_maxMegabytesInFlight, strlen(str_maxMegabytesInFlight)))
+        {
+            int number = 0;
+            Parse_IntItem(ENDTAG(str_maxMegabytesInFlight), number);
+            settings.m_maxMegabytesInFlight = (unsigned long)std::max(0, number);
+            continue;
+        }
+
+        // If we've found how often the configuration should be checked for modifications
+        if (Equals(szToken, str_configurationReloadInterval, strlen(str_configurationReloadInterval)))
+        {
+            int number = 0;
+            Parse_IntItem(ENDTAG(str_configurationReloadInterval), number);
+            settings.m_configurationReloadInterval = (unsigned long)std::max(0, number);
+            continue;
+        }
+
+        // If we've found the number of samples to use when estimating the uncertainty of the fluxes
+        if (Equals(szToken, str_fluxUncertaintySamples, strlen(str_fluxUncertaintySamples)))
+        {
+            int number = 0;
+            Parse_IntItem(ENDTAG(str_fluxUncertaintySamples), number);
+            settings.m_fluxUncertaintySamples = std::max(0, number);
+            continue;
+        }
+
+        // If we've found the tolerances for re-evaluating scans with optimal shift & squeeze
+        if (Equals(szToken, str_optimalShiftTolerance, strlen(str_optimalShiftTolerance)))
+        {
+            Parse_FloatItem(ENDTAG(str_optimalShiftTolerance), settings.m_optimalShiftTolerance);
+            continue;
+        }
+        if (Equals(szToken, str_optimalSqueezeTolerance, strlen(str_optimalSqueezeTolerance)))
+        {
+            Parse_FloatItem(ENDTAG(str_optimalSqueezeTolerance), settings.m_optimalSqueezeTolerance);
+            continue;
+        }
+
         // If we've found the beginning date
         if (Equals(szToken, str_fromDate, strlen(str_fromDate)))
         {
@@ -118,6 +173,10 @@ void CProcessingFileReader::ReadProcessingFile(const novac::CString& filename, C
             {
                 settings.m_processingMode = ProcessingMode::InstrumentCalibration;
             }
+            else if (Equals(modeStr, "fluxsensitivity"))
+            {
+                settings.m_processingMode = ProcessingMode::FluxSensitivity;
+            }
             else
             {
                 settings.m_processingMode = ProcessingMode::Flux;
@@ -222,6 +281,25 @@ void CProcessingFileReader::ReadProcessingFile(const novac::CString& filename, C
             continue;
         }
 
+        // If we should write the fluxes also to other formats
+        if (Equals(szToken, str_writeFluxLogCsv, strlen(str_writeFluxLogCsv)))
+        {
+            Parse_BoolItem(ENDTAG(str_writeFluxLogCsv), settings.m_writeFluxLogCsv);
+            continue;
+        }
+        if (Equals(szToken, str_writeInstrumentFluxLogs, strlen(str_writeInstrumentFluxLogs)))
+        {
+            Parse_BoolItem(ENDTAG(str_writeInstrumentFluxLogs), settings.m_writeInstrumentFluxLogs);
+            continue;
+        }
+
+        // If we should record the timeline of the processing
+        if (Equals(szToken, str_writeProcessingTrace, strlen(str_writeProcessingTrace)))
+        {
+            Parse_BoolItem(ENDTAG(str_writeProcessingTrace), settings.m_writeProcessingTrace);
+            continue;
+        }
+
         // If we've found the settings for the geometry calculations
         if (Equals(szToken, "GeometryCalc", 12))
         {
@@ -249,6 +327,13 @@ void CProcessingFileReader::ReadProcessingFile(const novac::CString& filename, C
             continue;
         }
 
+        // If we've found the alternative wind fields and plume altitudes to calculate fluxes with
+        if (Equals(szToken, "FluxSensitivity", 15))
+        {
+            this->Parse_FluxSensitivity(settings);
+            continue;
+        }
+
     }//end while
     Close();
 }
@@ -568,6 +653,47 @@ void CProcessingFileReader::Parse_DualBeam(Configuration::CUserConfiguration& se
     }
 }
 
+void CProcessingFileReader::Parse_FluxSensitivity(Configuration::CUserConfiguration& settings)
+{
+    // parse the file, one line at a time.
+    szToken = &start;
+    while (szToken != nullptr)
+    {
+        szToken = NextToken();
+
+        // no use to parse empty lines
+        if (szToken == nullptr || strlen(szToken) < 3)
+            continue;
+
+        if (Equals(szToken, "/FluxSensitivity", 16))
+        {
+            return;
+        }
+
+        // we've found an alternative wind field
+        if (Equals(szToken, str_fluxSensitivityWindField, strlen(str_fluxSensitivityWindField)))
+        {
+            std::string windField;
+            if (this->Parse_PathItem(ENDTAG(str_fluxSensitivityWindField), windField))
+            {
+                settings.m_fluxSensitivityWindFields.push_back(windField);
+            }
+            continue;
+        }
+
+        // we've found an alternative plume altitude
+        if (Equals(szToken, str_fluxSensitivityPlumeAltitude, strlen(str_fluxSensitivityPlumeAltitude)))
+        {
+            double plumeAltitude = 0.0;
+            if (this->Parse_FloatItem(ENDTAG(str_fluxSensitivityPlumeAltitude), plumeAltitude))
+            {
+                settings.m_fluxSensitivityPlumeAltitudes.push_back(plumeAltitude);
+            }
+            continue;
+        }
+    }
+}
+
 void CProcessingFileReader::Parse_DiscardSettings(Configuration::CUserConfiguration& settings)
 {
     // parse the file, one line at a time.
@@ -630,6 +756,12 @@ RETURN_CODE CProcessingFileReader::WriteProcessingFile(const novac::CString& fil
     fprintf(f, "<NovacPostProcessing>\n");
 
     PrintParameter(f, 1, str_maxThreadNum, settings.m_maxThreadNum);
+    PrintParameter(f, 1, str_spectrumThreadNum, settings.m_spectrumThreadNum);
+    PrintParameter(f, 1, str_maxScansInFlight, settings.m_maxScansInFlight);
+    PrintParameter(f, 1, str_maxMegabytesInFlight, settings.m_maxMegabytesInFlight);
+    PrintParameter(f, 1, str_configurationReloadInterval, settings.m_configurationReloadInterval);
+    PrintParameter(f, 1, str_optimalShiftTolerance, settings.m_optimalShiftTolerance);
+    PrintParameter(f, 1, str_optimalSqueezeTolerance, settings.m_optimalSqueezeTolerance);
 
     // the output and temp directories
     PrintParameter(f, 1, str_outputDirectory, settings.m_outputDirectory);
@@ -642,6 +774,7 @@ RETURN_CODE CProcessingFileReader::WriteProcessingFile(const novac::CString& fil
     case ProcessingMode::Composition:	PrintParameter(f, 1, str_processingMode, "Composition"); break;
     case ProcessingMode::Stratosphere:	PrintParameter(f, 1, str_processingMode, "Stratosphere"); break;
     case ProcessingMode::InstrumentCalibration:	PrintParameter(f, 1, str_processingMode, "Calibration"); break;
+    case ProcessingMode::FluxSensitivity:	PrintParameter(f, 1, str_processingMode, "FluxSensitivity"); break;
     default:							PrintParameter(f, 1, str_processingMode, "Unknown"); break;
     }
 
@@ -667,10 +800,32 @@ RETURN_CODE CProcessingFileReader::WriteProcessingFile(const novac::CString& fil
     // Uploading of the results?
     PrintParameter(f, 1, str_uploadResults, settings.m_uploadResults ? 1 : 0);
 
+    // The additional outputs of the fluxes
+    PrintParameter(f, 1, str_writeFluxLogCsv, settings.m_writeFluxLogCsv ? 1 : 0);
+    PrintParameter(f, 1, str_writeInstrumentFluxLogs, settings.m_writeInstrumentFluxLogs ? 1 : 0);
+
+    // The timeline of the processing
+    PrintParameter(f, 1, str_writeProcessingTrace, settings.m_writeProcessingTrace ? 1 : 0);
+
     // the wind-field file
     PrintParameter(f, 1, str_windFieldFile, settings.m_windFieldFile);
     PrintParameter(f, 1, str_windFieldFileOption, settings.m_windFieldFileOption);
 
+    // the estimate of the uncertainty of the fluxes
+    PrintParameter(f, 1, str_fluxUncertaintySamples, settings.m_fluxUncertaintySamples);
+
+    // the alternative wind fields and plume altitudes for the flux sensitivity mode
+    fprintf(f, "\t<FluxSensitivity>\n");
+    for (const std::string& windField : settings.m_fluxSensitivityWindFields)
+    {
+        PrintParameter(f, 2, str_fluxSensitivityWindField, novac::CString(windField));
+    }
+    for (double plumeAltitude : settings.m_fluxSensitivityPlumeAltitudes)
+    {
+        PrintParameter(f, 2, str_fluxSensitivityPlumeAltitude, plumeAltitude);
+    }
+    fprintf(f, "\t</FluxSensitivity>\n");
+
     // the settings for the geometry calculations
     fprintf(f, "\t<GeometryCalc>\n");
     PrintParameter(f, 2, str_calcGeometry_CompletenessLimit, settings.m_calcGeometry_CompletenessLimit);
@@ -3,6 +3,8 @@
 #include <cstdlib>
 #include <cstring>
 #include <algorithm>
+#include <fstream>
+#include <iterator>
 #include <Poco/Path.h>
 
 #include <iostream> // for debugging
@@ -18,7 +20,6 @@ CXMLFileReader::CXMLFileReader(novac::ILogger& logger)
 
 CXMLFileReader::~CXMLFileReader()
 {
-    m_tokenPt = nullptr;
     Close();
 }
 
@@ -39,17 +40,17 @@ bool CXMLFileReader::IsClosingTag(const novac::CString& endTag, const char* toke
 
 bool CXMLFileReader::Open(const novac::CString& fileName)
 {
-    novac::CFileException exceFile;
-
-    m_File = new novac::CStdioFile();
+    Close();
 
-    if (!m_File->Open(fileName, novac::CStdioFile::modeRead | novac::CStdioFile::typeText, &exceFile))
+    std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+    if (!file.is_open())
     {
-        delete m_File;
-        m_File = nullptr;
         return false;
     }
 
+    m_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    m_buffer.push_back('\0');
+
     m_filename = fileName.std_str();
     this->nLinesRead = 0;
 
@@ -58,62 +59,126 @@ bool CXMLFileReader::Open(const novac::CString& fileName)
 
 void CXMLFileReader::Close()
 {
-    if (nullptr != m_File)
+    m_buffer.clear();
+    m_nextLinePosition = 0;
+    m_linePosition = nullptr;
+    szToken = nullptr;
+    nLinesRead = 0;
+
+    m_filename = "";
+}
+
+bool CXMLFileReader::ReadNextLine()
+{
+    if (m_nextLinePosition >= m_buffer.size())
     {
-        m_File->Close();
-        m_File = nullptr;
+        return false;
     }
 
-    m_filename = "";
+    char* lineStart = m_buffer.data() + m_nextLinePosition;
+    const size_t remainingLength = m_buffer.size() - 1 - m_nextLinePosition; // not counting the terminating null
+    char* lineEnd = static_cast<char*>(memchr(lineStart, '\n', remainingLength));
+    if (lineEnd == nullptr)
+    {
+        lineEnd = lineStart + remainingLength;
+    }
+
+    m_nextLinePosition = static_cast<size_t>(lineEnd - m_buffer.data()) + 1;
+
+    // Lines ending with '\r\n' are read in the same way as lines ending with '\n'
+    if (lineEnd > lineStart && *(lineEnd - 1) == '\r')
+    {
+        --lineEnd;
+    }
+    *lineEnd = '\0';
+
+    m_linePosition = lineStart;
+    ++nLinesRead;
+
+    return true;
 }
 
+static bool IsTokenSeparator(char c)
+{
+    return c == '<' || c == '>' || c == '\t';
+}
+
+char* CXMLFileReader::NextTokenInCurrentLine()
+{
+    if (m_linePosition == nullptr)
+    {
+        return nullptr;
+    }
+
+    char* pt = m_linePosition;
+    while (*pt != '\0' && IsTokenSeparator(*pt))
+    {
+        ++pt;
+    }
+
+    if (*pt == '\0')
+    {
+        m_linePosition = nullptr;
+        return nullptr;
+    }
+
+    char* tokenStart = pt;
+    while (*pt != '\0' && !IsTokenSeparator(*pt))
+    {
+        ++pt;
+    }
+
+    if (*pt == '\0')
+    {
+        m_linePosition = nullptr;
+    }
+    else
+    {
+        *pt = '\0';
+        m_linePosition = pt + 1;
+    }
+
+    return tokenStart;
+}
 
 char* CXMLFileReader::NextToken()
 {
-    char separators[] = "<>\t";
     szToken = nullptr;
 
     if (nLinesRead == 0)
     {
         // if this is the first call to this function
-        m_File->ReadString(szLine, 4095);
-        szToken = (char*)szLine;
-
-        m_tokenPt = strtok(szToken, separators);
-        ++nLinesRead;
-        return m_tokenPt;
+        if (!ReadNextLine())
+        {
+            return nullptr;
+        }
+        return NextTokenInCurrentLine();
     }
-    else
+
+    while (true)
     {
         // this is not the first call to this function
-        m_tokenPt = strtok(szToken, separators);
-        if (nullptr != m_tokenPt)
+        char* token = NextTokenInCurrentLine();
+        if (nullptr != token)
         {
-            return m_tokenPt;
+            return token;
         }
 
-        szLine[0] = 0;
-        while (0 == strlen(szLine))
+        // read the next non-empty line
+        do
         {
-            if (!m_File->ReadString(szLine, 4095))
+            if (!ReadNextLine())
             {
                 return nullptr;
             }
-        }
-
-        szToken = (char*)szLine;
-
-        m_tokenPt = strtok(szToken, separators);
-        ++nLinesRead;
-    }
+        } while (*m_linePosition == '\0');
 
-    if (nullptr == m_tokenPt || strlen(m_tokenPt) < 2)
-    {
-        return NextToken();
-    }
-    else
-    {
-        return m_tokenPt;
+        // the first token of a new line is ignored if it is too short
+        token = NextTokenInCurrentLine();
+        if (nullptr != token && strlen(token) >= 2)
+        {
+            return token;
+        }
     }
 }
 
@@ -126,13 +191,9 @@ const char* CXMLFileReader::GetAttributeValue(const novac::CString& label)
         return nullptr; // we haven't started reading the file yet...
     }
 
-    // make a copy of szToken, so that we can make changes to it...
-    char copyOfToken[4096];
-    sprintf(copyOfToken, "%s", szToken);
-
     // search for the attribute in szToken
     toSearchFor.Format("%s=\"", (const char*)label);
-    char* pt_start = strstr(copyOfToken, toSearchFor);
+    const char* pt_start = strstr(szToken, toSearchFor);
     if (pt_start == nullptr)
     {
         return nullptr;
@@ -140,17 +201,16 @@ const char* CXMLFileReader::GetAttributeValue(const novac::CString& label)
     pt_start += toSearchFor.GetLength(); // point to the character after the double-quote
 
     // search for the ending double-quote
-    char* pt_end = strstr(pt_start, "\"");
+    const char* pt_end = strstr(pt_start, "\"");
     if (pt_end == nullptr)
     {
         return nullptr;
     }
-    *pt_end = '\0'; // make the string end at the position of the double-quote
 
     // now we have the value of the attribute
-    sprintf(attributeValue, "%s", pt_start);
+    m_attributeValue.assign(pt_start, pt_end);
 
-    return attributeValue;
+    return m_attributeValue.c_str();
 }
 
 int CXMLFileReader::Parse_StringItem(const novac::CString& label, novac::CString& string)
@@ -1,4 +1,5 @@
 #include <PPPLib/Flux/FluxCalculator.h>
+#include <PPPLib/Flux/FluxUncertainty.h>
 
 #include <SpectralEvaluation/File/File.h>
 #include <SpectralEvaluation/Flux/Flux.h>
@@ -7,7 +8,7 @@
 #include <PPPLib/File/Filesystem.h>
 #include <PPPLib/MFC/CFileUtils.h>
 
-#include <Poco/Path.h>
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <assert.h>
@@ -33,8 +34,143 @@ bool CFluxCalculator::CalculateFlux(
     const Geometry::PlumeHeight& plumeAltitude,
     FluxResult& fluxResult)
 {
-    novac::CString errorMessage;
+    Configuration::CInstrumentLocation instrLocation;
+    if (!ValidateEvaluationResult(context, evaluationResult, instrLocation))
+    {
+        return false;
+    }
+
+    context = context.With(novac::LogContext::Device, evaluationResult.m_instrumentSerial).WithTimestamp(evaluationResult.m_startTime);
+
+    // Get the wind field at the time of the collection of this scan
+    Meteorology::WindField windField;
+    if (!windDataBase.GetWindField(evaluationResult.m_startTime, novac::CGPSData(instrLocation.m_latitude, instrLocation.m_longitude, plumeAltitude.m_plumeAltitude), Meteorology::InterpolationMethod::NearestNeighbour, windField))
+    {
+        m_log.Information(context, "Failed to retrieve a wind field at the time of the measurement. Could not calculate flux.");
+        return false;
+    }
+
+    // 4b. Adjust the altitude of the plume so that it is relative to the altitude of the instrument...
+    Geometry::PlumeHeight relativePlumeHeight = plumeAltitude;
+    relativePlumeHeight.m_plumeAltitude -= instrLocation.m_altitude;
+    if (relativePlumeHeight.m_plumeAltitude <= 0)
+    {
+        m_log.Error(context, "Negative plume height obtained when calculating flux. No flux can be calculated.");
+        return false;
+    }
+
+    // Read in the evaluation log file 
+    Evaluation::CScanResult result;
+    if (!ReadScan(context, evaluationResult, result))
+    {
+        return false;
+    }
+
+    // Calculate the flux
+    if (!CalculateFlux(context, result, m_userSettings.m_molecule, windField, relativePlumeHeight, instrLocation.m_compass, instrLocation.m_coneangle, instrLocation.m_tilt))
+    {
+        m_log.Information(context, "Flux calculation failed. No flux generated");
+        return false;
+    }
+    fluxResult = result.GetFluxResult();
+
+    // Make a simple estimate of the quality of the flux measurement
+    FluxQuality windFieldQuality = WindFieldFluxQuality(windField);
+    FluxQuality plumeHeightQuality = PlumeHeightFluxQuality(relativePlumeHeight);
+    FluxQuality completenessQuality = CompletessFluxQuality(fluxResult);
+
+    // If any of the parameters has a low quality, then the result is judged to have a low quality...
+    if (windFieldQuality == FluxQuality::Red || plumeHeightQuality == FluxQuality::Red || completenessQuality == FluxQuality::Red)
+    {
+        fluxResult.m_fluxQualityFlag = FluxQuality::Red;
+    }
+    else if (windFieldQuality == FluxQuality::Yellow || plumeHeightQuality == FluxQuality::Yellow || completenessQuality == FluxQuality::Yellow)
+    {
+        fluxResult.m_fluxQualityFlag = FluxQuality::Yellow;
+    }
+    else
+    {
+        fluxResult.m_fluxQualityFlag = FluxQuality::Green;
+    }
+
+    // ok
+    return true;
+}
 
+bool CFluxCalculator::PrepareFluxScanData(
+    novac::LogContext context,
+    const Evaluation::CExtendedScanResult& evaluationResult,
+    FluxScanData& scanData)
+{
+    if (!ValidateEvaluationResult(context, evaluationResult, scanData.location))
+    {
+        return false;
+    }
+
+    context = context.With(novac::LogContext::Device, evaluationResult.m_instrumentSerial).WithTimestamp(evaluationResult.m_startTime);
+
+    Evaluation::CScanResult result;
+    if (!ReadScan(context, evaluationResult, result))
+    {
+        return false;
+    }
+
+    if (result.m_measurementMode != novac::MeasurementMode::Flux)
+    {
+        m_log.Information(context, "Measurement is not a flux measurement, cannot calculate flux.");
+        return false;
+    }
+
+    const novac::Molecule specie(m_userSettings.m_molecule);
+    const int specieIndex = result.GetSpecieIndex(specie.name);
+    if (specieIndex == -1)
+    {
+        novac::CString message;
+        message.Format("Failed to retrieve specie with name '%s' from measurement, cannot calculate flux.", specie.name.c_str());
+        m_log.Information(context, message.std_str());
+        return false;
+    }
+
+    if (ExtractGoodDataPoints(result, specie, specieIndex, scanData) < 10)
+    {
+        m_log.Information(context, "Could not calculate flux, too few good datapoints in measurement");
+        return false;
+    }
+
+    scanData.startTime = evaluationResult.m_startTime;
+    scanData.instrument = result.GetSerial();
+    scanData.instrumentType = result.m_instrumentType;
+    scanData.offset = specie.Convert_MolecCm2_to_kgM2(result.m_plumeProperties.offset.Value());
+
+    return true;
+}
+
+double CFluxCalculator::CalculateFlux(
+    novac::LogContext context,
+    const FluxScanData& scanData,
+    const Meteorology::WindField& wind,
+    const Geometry::PlumeHeight& relativePlumeHeight)
+{
+    return CalculateFlux(
+        context,
+        scanData.scanAngle.data(),
+        scanData.scanAngle2.data(),
+        scanData.column.data(),
+        scanData.offset,
+        scanData.column.size(),
+        wind,
+        relativePlumeHeight,
+        scanData.location.m_compass,
+        scanData.instrumentType,
+        scanData.location.m_coneangle,
+        scanData.location.m_tilt);
+}
+
+bool CFluxCalculator::ValidateEvaluationResult(
+    novac::LogContext context,
+    const Evaluation::CExtendedScanResult& evaluationResult,
+    Configuration::CInstrumentLocation& instrLocation)
+{
     if (evaluationResult.m_evalLogFile.empty())
     {
         m_log.Error(context, "Recieved evaluation result which does not have a evaluation log file name set. Could not calculate flux.");
@@ -54,7 +190,6 @@ bool CFluxCalculator::CalculateFlux(
     context = context.With(novac::LogContext::Device, evaluationResult.m_instrumentSerial).WithTimestamp(evaluationResult.m_startTime);
 
     // Find the location of this instrument
-    Configuration::CInstrumentLocation instrLocation;
     if (GetLocation(context, evaluationResult.m_instrumentSerial, evaluationResult.m_startTime, instrLocation))
     {
         m_log.Information(context, "Failed to retrieve the location of the instrument at the time of the measurement.");
@@ -66,24 +201,16 @@ bool CFluxCalculator::CalculateFlux(
         return false;
     }
 
-    // Get the wind field at the time of the collection of this scan
-    Meteorology::WindField windField;
-    if (!windDataBase.GetWindField(evaluationResult.m_startTime, novac::CGPSData(instrLocation.m_latitude, instrLocation.m_longitude, plumeAltitude.m_plumeAltitude), Meteorology::InterpolationMethod::NearestNeighbour, windField))
-    {
-        m_log.Information(context, "Failed to retrieve a wind field at the time of the measurement. Could not calculate flux.");
-        return false;
-    }
+    return true;
+}
 
-    // 4b. Adjust the altitude of the plume so that it is relative to the altitude of the instrument...
-    Geometry::PlumeHeight relativePlumeHeight = plumeAltitude;
-    relativePlumeHeight.m_plumeAltitude -= instrLocation.m_altitude;
-    if (relativePlumeHeight.m_plumeAltitude <= 0)
-    {
-        m_log.Error(context, "Negative plume height obtained when calculating flux. No flux can be calculated.");
-        return false;
-    }
+bool CFluxCalculator::ReadScan(
+    novac::LogContext context,
+    const Evaluation::CExtendedScanResult& evaluationResult,
+    Evaluation::CScanResult& result)
+{
+    novac::CString errorMessage;
 
-    // Read in the evaluation log file 
     FileHandler::CEvaluationLogFileHandler reader(m_log, evaluationResult.m_evalLogFile.front(), m_userSettings.m_molecule);
     if (RETURN_CODE::SUCCESS != reader.ReadEvaluationLog())
     {
@@ -101,7 +228,7 @@ bool CFluxCalculator::CalculateFlux(
     }
 
     // Extract the scan
-    Evaluation::CScanResult& result = reader.m_scan[0];
+    result = reader.m_scan[0];
 
     // Get the measurement mode
     result.m_measurementMode = novac::CheckMeasurementMode(result);
@@ -116,7 +243,6 @@ bool CFluxCalculator::CalculateFlux(
     }
     result.m_plumeProperties = *plumeProperties;
 
-
     // Check that the completeness is higher than our limit...
     if (result.m_plumeProperties.completeness.Value() < m_userSettings.m_completenessLimitFlux + 0.01)
     {
@@ -125,35 +251,43 @@ bool CFluxCalculator::CalculateFlux(
         return false;
     }
 
-    // Calculate the flux
-    if (!CalculateFlux(context, result, m_userSettings.m_molecule, windField, relativePlumeHeight, instrLocation.m_compass, instrLocation.m_coneangle, instrLocation.m_tilt))
-    {
-        m_log.Information(context, "Flux calculation failed. No flux generated");
-        return false;
-    }
-    fluxResult = result.GetFluxResult();
+    return true;
+}
 
-    // Make a simple estimate of the quality of the flux measurement
-    FluxQuality windFieldQuality = WindFieldFluxQuality(windField);
-    FluxQuality plumeHeightQuality = PlumeHeightFluxQuality(relativePlumeHeight);
-    FluxQuality completenessQuality = CompletessFluxQuality(fluxResult);
+size_t CFluxCalculator::ExtractGoodDataPoints(
+    const Evaluation::CScanResult& result,
+    const novac::Molecule& specie,
+    int specieIndex,
+    FluxScanData& scanData)
+{
+    scanData.scanAngle.clear();
+    scanData.scanAngle2.clear();
+    scanData.column.clear();
+    scanData.columnError.clear();
+    scanData.scanAngle.reserve(result.GetEvaluatedNum());
+    scanData.scanAngle2.reserve(result.GetEvaluatedNum());
+    scanData.column.reserve(result.GetEvaluatedNum());
+    scanData.columnError.reserve(result.GetEvaluatedNum());
 
-    // If any of the parameters has a low quality, then the result is judged to have a low quality...
-    if (windFieldQuality == FluxQuality::Red || plumeHeightQuality == FluxQuality::Red || completenessQuality == FluxQuality::Red)
-    {
-        fluxResult.m_fluxQualityFlag = FluxQuality::Red;
-    }
-    else if (windFieldQuality == FluxQuality::Yellow || plumeHeightQuality == FluxQuality::Yellow || completenessQuality == FluxQuality::Yellow)
-    {
-        fluxResult.m_fluxQualityFlag = FluxQuality::Yellow;
-    }
-    else
+    for (size_t i = 0; i < result.GetEvaluatedNum(); ++i)
     {
-        fluxResult.m_fluxQualityFlag = FluxQuality::Green;
+        if (result.IsBad(i) || result.IsDeleted(i))
+        {
+            continue; // this is a bad measurement
+        }
+        if (result.m_specInfo[i].m_flag >= 64)
+        {
+            continue; // this is a direct-sun measurement, don't use it to calculate the flux...
+        }
+
+        const novac::CReferenceFitResult& fitResult = result.m_spec[i].m_referenceResult[static_cast<size_t>(specieIndex)];
+        scanData.scanAngle.push_back(result.m_specInfo[i].m_scanAngle);
+        scanData.scanAngle2.push_back(result.m_specInfo[i].m_scanAngle2);
+        scanData.column.push_back(specie.Convert_MolecCm2_to_kgM2(fitResult.m_column));
+        scanData.columnError.push_back(specie.Convert_MolecCm2_to_kgM2(fitResult.m_columnError));
     }
 
-    // ok
-    return true;
+    return scanData.column.size();
 }
 
 FluxQuality CFluxCalculator::CompletessFluxQuality(const Flux::FluxResult& fluxResult)
@@ -246,142 +380,6 @@ int CFluxCalculator::GetLocation(
     return 0;
 }
 
-RETURN_CODE CFluxCalculator::WriteFluxResult(
-    novac::LogContext context,
-    const Flux::FluxResult& fluxResult,
-    const Evaluation::CScanResult* result)
-{
-    novac::CString string, dateStr, dateStr2, serialNumber;
-    novac::CString fluxLogFile, directory;
-    novac::CString wdSrc, wsSrc, phSrc;
-    novac::CString errorMessage;
-    novac::CDateTime dateTime;
-
-    // 0. Get the sources for the wind-field
-    fluxResult.m_windField.GetWindSpeedSource(wsSrc);
-    fluxResult.m_windField.GetWindDirectionSource(wdSrc);
-    Meteorology::MetSourceToString(fluxResult.m_plumeHeight.m_plumeAltitudeSource, phSrc);
-
-    // 1. Output the day and time the scan that generated this measurement started
-    result->GetSkyStartTime(dateTime);
-    dateStr.Format("%04d-%02d-%02d", dateTime.year, dateTime.month, dateTime.day);
-    dateStr2.Format("%04d.%02d.%02d", dateTime.year, dateTime.month, dateTime.day);
-    string.Format("%s\t", (const char*)dateStr);
-    string.AppendFormat("%02d:%02d:%02d\t", dateTime.hour, dateTime.minute, dateTime.second);
-
-    // 2. Output the time the scan stopped
-    result->GetStopTime(result->GetEvaluatedNum() - 1, dateTime);
-    string.AppendFormat("%02d:%02d:%02d\t", dateTime.hour, dateTime.minute, dateTime.second);
-
-    // 3. Output the flux result
-    string.AppendFormat("%.2lf\t", fluxResult.m_flux);
-
-    // 4. Output the wind speed (and the estimated error in the wind-speed)
-    //	that was used for calculating this flux
-    string.AppendFormat("%.3lf\t", fluxResult.m_windField.GetWindSpeed());
-    string.AppendFormat("%.3lf\t", fluxResult.m_windField.GetWindSpeedError());
-
-    // 5. Output the wind direction (and it's estimated error) 
-    //	that was used for calculating this flux
-    string.AppendFormat("%.3lf\t", fluxResult.m_windField.GetWindDirection());
-    string.AppendFormat("%.3lf\t", fluxResult.m_windField.GetWindDirectionError());
-
-    // 6. Output where we got the wind speed from
-    string.AppendFormat("%s\t", (const char*)wsSrc);
-
-    // 7. Output where we got the wind direction from
-    string.AppendFormat("%s\t", (const char*)wdSrc);
-
-    // 8. Output the plume height that was used for calculating this flux
-    string.AppendFormat("%.1lf\t", fluxResult.m_plumeHeight.m_plumeAltitude);
-    string.AppendFormat("%.1lf\t", fluxResult.m_plumeHeight.m_plumeAltitudeError);
-
-    // 9. Output where we got the plume height from 
-    string.AppendFormat("%s\t", (const char*)phSrc);
-
-    // 10. Output the compass direction
-    string.AppendFormat("%.2lf\t", fluxResult.m_compass);
-
-    // 11. Output where we got the compass direction from
-    //if(fabs(spectrometer.m_scanner.compass) > 360)
-    //	string.AppendFormat("compassreading\t");
-    //else
-    //	string.AppendFormat("user\t");
-
-    // 12. Output the plume centre
-    string.AppendFormat("%.1lf\t", result->m_plumeProperties.plumeCenter.ValueOrDefault(NOT_A_NUMBER));
-
-    // 13. Output the plume completeness
-    string.AppendFormat("%.2lf\t", result->m_plumeProperties.completeness.ValueOrDefault(NOT_A_NUMBER));
-
-    // 14. Output the cone-angle of the scanner
-    string.AppendFormat("%.1lf\t", fluxResult.m_coneAngle);
-
-    // 15. Output the tilt of the scanner
-    string.AppendFormat("%.1lf\t", fluxResult.m_tilt);
-
-    // 16. Output whether we think this is a good measurement or not
-    if (result->IsFluxOk())
-        string.AppendFormat("1\t");
-    else
-        string.AppendFormat("0\t");
-
-    // 17. Output the instrument temperature
-    string.AppendFormat("%.1lf\t", result->GetTemperature());
-
-    // 18. Output the instrument battery voltage
-    string.AppendFormat("%.1lf\t", result->GetBatteryVoltage());
-
-    // 19. Output the exposure-time
-    string.AppendFormat("%.1ld\t", result->GetSkySpectrumInfo().m_exposureTime);
-
-    // 20. Find the name of the flux-log file to write to
-
-    // 20a. Make the directory
-    serialNumber.Format("%s", result->GetSerial().c_str());
-    directory.Format("%s%s%c%s%c", (const char*)m_userSettings.m_outputDirectory, (const char*)dateStr2,
-        Poco::Path::separator(), (const char*)serialNumber, Poco::Path::separator());
-    if (Filesystem::CreateDirectoryStructure(directory))
-    {
-        m_log.Error(context, "Could not create storage directory for flux-data. Please check settings and restart.");
-        return RETURN_CODE::FAIL;
-    }
-
-    // 20b. Get the file-name
-    fluxLogFile.Format("%sFluxLog_%s_%s.txt", (const char*)directory, (const char*)serialNumber, (const char*)dateStr2);
-
-    // 20c. Check if the file exists
-    if (!Filesystem::IsExistingFile(fluxLogFile))
-    {
-        // write the header
-        FILE* f = fopen(fluxLogFile, "w");
-        if (f != nullptr)
-        {
-            fprintf(f, "serial=%s\n", (const char*)serialNumber);
-            fprintf(f, "volcano=x\n");//,		m_common.SimplifyString(spectrometer.m_scanner.volcano));
-            fprintf(f, "site=x\n");//,				m_common.SimplifyString(spectrometer.m_scanner.site));
-            fprintf(f, "#scandate\tscanstarttime\tscanstoptime\t");
-            fprintf(f, "flux_[kg/s]\t");
-            fprintf(f, "windspeed_[m/s]\twinddirection_[deg]\twindspeedsource\twinddirectionsource\t");
-            fprintf(f, "plumeheight_[m]\tplumeheightsource\t");
-            fprintf(f, "compassdirection_[deg]\tcompasssource\t");
-            fprintf(f, "plumecentre_[deg]\tplumecompleteness_[%%]\t");
-            fprintf(f, "coneangle\ttilt\tokflux\ttemperature\tbatteryvoltage\texposuretime\n");
-            fclose(f);
-        }
-    }
-
-    // 20d. Write the flux-result to the file
-    FILE* f = fopen(fluxLogFile, "a+");
-    if (f != nullptr)
-    {
-        fprintf(f, "%s\n", (const char*)string);
-        fclose(f);
-    }
-
-    return RETURN_CODE::SUCCESS;
-}
-
 // region The actual flux calculations
 
 // Moved from CScanResult::CalculateFlux
@@ -398,8 +396,6 @@ bool CFluxCalculator::CalculateFlux(
     assert(result.m_plumeProperties.offset.HasValue()); // assumption here that the offset and plume center has already been checked
     assert(result.m_measurementMode != novac::MeasurementMode::Unknown); // assumption here that the mode has already been checked
 
-    Meteorology::WindField modifiedWind;
-
     // If this is a not a flux measurement, then don't calculate any flux
     if (result.m_measurementMode != novac::MeasurementMode::Flux)
     {
@@ -419,30 +415,8 @@ bool CFluxCalculator::CalculateFlux(
 
     // pull out the good data points out of the measurement and ignore the bad points
     // at the same time convert to mg/m2
-    std::vector<double> scanAngle;
-    std::vector<double> scanAngle2;
-    std::vector<double> column;
-    scanAngle.reserve(result.GetEvaluatedNum());
-    scanAngle2.reserve(result.GetEvaluatedNum());
-    column.reserve(result.GetEvaluatedNum());
-    unsigned int numberOfGoodDataPoints = 0;
-    for (size_t i = 0; i < result.GetEvaluatedNum(); ++i)
-    {
-        if (result.IsBad(i) || result.IsDeleted(i))
-        {
-            continue; // this is a bad measurement
-        }
-        if (result.m_specInfo[i].m_flag >= 64)
-        {
-            continue; // this is a direct-sun measurement, don't use it to calculate the flux...
-        }
-
-        scanAngle.push_back(result.m_specInfo[i].m_scanAngle);
-        scanAngle2.push_back(result.m_specInfo[i].m_scanAngle2);
-        column.push_back(specie.Convert_MolecCm2_to_kgM2(result.m_spec[i].m_referenceResult[static_cast<size_t>(specieIndex)].m_column));
-
-        ++numberOfGoodDataPoints;
-    }
+    FluxScanData scanData;
+    const unsigned int numberOfGoodDataPoints = static_cast<unsigned int>(ExtractGoodDataPoints(result, specie, specieIndex, scanData));
 
     Flux::FluxResult fluxResult;
 
@@ -480,8 +454,22 @@ bool CFluxCalculator::CalculateFlux(
     // and the serial number of the instrument
     fluxResult.m_instrument = result.GetSerial();
 
-    // Calculate the flux
-    fluxResult.m_flux = Flux::CFluxCalculator::CalculateFlux(context, scanAngle.data(), scanAngle2.data(), column.data(), specie.Convert_MolecCm2_to_kgM2(result.m_plumeProperties.offset.Value()), numberOfGoodDataPoints, wind, relativePlumeHeight, compass, result.m_instrumentType, coneAngle, tilt);
+    scanData.startTime = fluxResult.m_startTime;
+    scanData.instrument = fluxResult.m_instrument;
+    scanData.instrumentType = result.m_instrumentType;
+    scanData.location.m_compass = compass;
+    scanData.location.m_coneangle = coneAngle;
+    scanData.location.m_tilt = tilt;
+    scanData.offset = specie.Convert_MolecCm2_to_kgM2(result.m_plumeProperties.offset.Value());
+
+    // Calculate the flux, together with the fluxes used to estimate the error due to the wind direction
+    const double windSpeeds[3] = { wind.GetWindSpeed(), wind.GetWindSpeed(), wind.GetWindSpeed() };
+    const double windDirections[3] = { wind.GetWindDirection(), wind.GetWindDirection() - wind.GetWindDirectionError(), wind.GetWindDirection() + wind.GetWindDirectionError() };
+    const double plumeHeights[3] = { relativePlumeHeight.m_plumeAltitude, relativePlumeHeight.m_plumeAltitude, relativePlumeHeight.m_plumeAltitude };
+    double fluxes[3];
+    CalculateFluxBatch(context, scanData, windSpeeds, windDirections, plumeHeights, 3, fluxes);
+
+    fluxResult.m_flux = fluxes[0];
     fluxResult.m_windField = wind;
     fluxResult.m_plumeHeight = relativePlumeHeight;
     fluxResult.m_compass = compass;
@@ -499,17 +487,16 @@ bool CFluxCalculator::CalculateFlux(
     fluxResult.m_plumeCentre[0] = result.m_plumeProperties.plumeCenter.ValueOrDefault(NOT_A_NUMBER);
     fluxResult.m_plumeCentre[1] = result.m_plumeProperties.plumeCenter2.ValueOrDefault(NOT_A_NUMBER);
     fluxResult.m_instrumentType = result.m_instrumentType;
+    fluxResult.m_temperature = result.GetTemperature();
+    fluxResult.m_batteryVoltage = result.GetBatteryVoltage();
+    fluxResult.m_exposureTime = result.GetSkySpectrumInfo().m_exposureTime;
 
     // Try to make an estimation of the error in flux from the
     //  wind field used and from the plume height used
 
     // 1. the wind field
-    modifiedWind = wind;
-    modifiedWind.SetWindDirection(wind.GetWindDirection() - wind.GetWindDirectionError(), wind.GetWindDirectionSource());
-    double flux1 = Flux::CFluxCalculator::CalculateFlux(context, scanAngle.data(), scanAngle2.data(), column.data(), specie.Convert_MolecCm2_to_kgM2(result.m_plumeProperties.offset.Value()), numberOfGoodDataPoints, modifiedWind, relativePlumeHeight, compass, result.m_instrumentType, coneAngle, tilt);
-
-    modifiedWind.SetWindDirection(wind.GetWindDirection() + wind.GetWindDirectionError(), wind.GetWindDirectionSource());
-    double flux2 = Flux::CFluxCalculator::CalculateFlux(context, scanAngle.data(), scanAngle2.data(), column.data(), specie.Convert_MolecCm2_to_kgM2(result.m_plumeProperties.offset.Value()), numberOfGoodDataPoints, modifiedWind, relativePlumeHeight, compass, result.m_instrumentType, coneAngle, tilt);
+    const double flux1 = fluxes[1];
+    const double flux2 = fluxes[2];
 
     double fluxErrorDueToWindDirection = std::max(std::abs(flux2 - fluxResult.m_flux), std::abs(flux1 - fluxResult.m_flux));
 
@@ -520,6 +507,13 @@ bool CFluxCalculator::CalculateFlux(
     // 2. the plume height
     fluxResult.m_fluxError_PlumeHeight = fluxResult.m_flux * relativePlumeHeight.m_plumeAltitudeError / relativePlumeHeight.m_plumeAltitude;
 
+    // 3. the distribution of the flux, from all the uncertainties together
+    if (m_userSettings.m_fluxUncertaintySamples > 0)
+    {
+        CFluxUncertaintyCalculator uncertaintyCalculator(*this, static_cast<size_t>(m_userSettings.m_fluxUncertaintySamples));
+        uncertaintyCalculator.CalculatePercentiles(context, scanData, wind, relativePlumeHeight, fluxResult);
+    }
+
     result.m_flux = fluxResult;
 
     return true;
@@ -539,10 +533,104 @@ double CFluxCalculator::CalculateFlux(
     double coneAngle,
     double tilt)
 {
-    const double windSpeed = wind.GetWindSpeed();
-    const double windDirection = wind.GetWindDirection();
-    const double plumeHeight = relativePlumeHeight.m_plumeAltitude;
+    return CalculateFluxWithParameters(context, scanAngle, scanAngle2, column, offset, nDataPoints, wind.GetWindSpeed(), wind.GetWindDirection(), relativePlumeHeight.m_plumeAltitude, compass, type, coneAngle, tilt);
+}
 
+void CFluxCalculator::CalculateFluxBatch(
+    novac::LogContext context,
+    const double* scanAngle,
+    const double* scanAngle2,
+    const double* column,
+    double offset,
+    size_t nDataPoints,
+    const double* windSpeed,
+    const double* windDirection,
+    const double* relativePlumeHeight,
+    size_t nCombinations,
+    double compass,
+    novac::NovacInstrumentType type,
+    double coneAngle,
+    double tilt,
+    double* flux)
+{
+    if (nCombinations == 0)
+    {
+        return;
+    }
+
+    // The distinct wind directions, the geometry of the scan only needs to be evaluated once for each of these.
+    std::vector<double> distinctWindDirections(windDirection, windDirection + nCombinations);
+    distinctWindDirections.erase(std::remove_if(begin(distinctWindDirections), end(distinctWindDirections), [](double direction) { return std::isnan(direction); }), end(distinctWindDirections));
+    std::sort(begin(distinctWindDirections), end(distinctWindDirections));
+    distinctWindDirections.erase(std::unique(begin(distinctWindDirections), end(distinctWindDirections)), end(distinctWindDirections));
+
+    // The flux for a unit wind speed and a unit plume height, for each of the distinct wind directions.
+    std::vector<double> unitFlux(distinctWindDirections.size());
+    for (size_t directionIdx = 0; directionIdx < distinctWindDirections.size(); ++directionIdx)
+    {
+        unitFlux[directionIdx] = CalculateFluxWithParameters(context, scanAngle, scanAngle2, column, offset, nDataPoints, 1.0, distinctWindDirections[directionIdx], 1.0, compass, type, coneAngle, tilt);
+    }
+
+    for (size_t combinationIdx = 0; combinationIdx < nCombinations; ++combinationIdx)
+    {
+        if (std::isnan(windDirection[combinationIdx]))
+        {
+            flux[combinationIdx] = std::numeric_limits<double>::quiet_NaN();
+            continue;
+        }
+        const auto directionPosition = std::lower_bound(begin(distinctWindDirections), end(distinctWindDirections), windDirection[combinationIdx]);
+        flux[combinationIdx] = unitFlux[static_cast<size_t>(directionPosition - begin(distinctWindDirections))];
+    }
+
+    // The flux is proportional to both the wind speed and the plume height.
+    for (size_t combinationIdx = 0; combinationIdx < nCombinations; ++combinationIdx)
+    {
+        flux[combinationIdx] *= windSpeed[combinationIdx] * relativePlumeHeight[combinationIdx];
+    }
+}
+
+void CFluxCalculator::CalculateFluxBatch(
+    novac::LogContext context,
+    const FluxScanData& scanData,
+    const double* windSpeed,
+    const double* windDirection,
+    const double* relativePlumeHeight,
+    size_t nCombinations,
+    double* flux)
+{
+    CalculateFluxBatch(
+        context,
+        scanData.scanAngle.data(),
+        scanData.scanAngle2.data(),
+        scanData.column.data(),
+        scanData.offset,
+        scanData.column.size(),
+        windSpeed,
+        windDirection,
+        relativePlumeHeight,
+        nCombinations,
+        scanData.location.m_compass,
+        scanData.instrumentType,
+        scanData.location.m_coneangle,
+        scanData.location.m_tilt,
+        flux);
+}
+
+double CFluxCalculator::CalculateFluxWithParameters(
+    novac::LogContext context,
+    const double* scanAngle,
+    const double* scanAngle2,
+    const double* column,
+    double offset,
+    size_t nDataPoints,
+    double windSpeed,
+    double windDirection,
+    double plumeHeight,
+    double compass,
+    novac::NovacInstrumentType type,
+    double coneAngle,
+    double tilt)
+{
     assert(!std::isnan(windSpeed));
     assert(!std::isnan(windDirection));
     assert(!std::isnan(plumeHeight));
@@ -0,0 +1,418 @@
+#include <PPPLib/Flux/FluxResultWriter.h>
+#include <PPPLib/File/Filesystem.h>
+#include <PPPLib/MFC/CString.h>
+
+#include <Poco/Path.h>
+#include <cmath>
+
+#undef min
+#undef max
+
+using namespace novac;
+
+namespace Flux
+{
+
+/** The size of the buffer of each of the flux logs of the instruments.
+    This is smaller than for the main logs, since one is kept open for each instrument. */
+static const size_t instrumentLogBufferSize = 16 * 1024;
+
+static const char* InstrumentTypeToString(NovacInstrumentType type)
+{
+    return (type == NovacInstrumentType::Heidelberg) ? "heidelberg" : "gothenburg";
+}
+
+static const char* FluxQualityToString(FluxQuality quality)
+{
+    if (quality == FluxQuality::Green)
+    {
+        return "g";
+    }
+    else if (quality == FluxQuality::Yellow)
+    {
+        return "y";
+    }
+    return "r";
+}
+
+/** Writes a number to a csv file, missing values are written as empty fields. */
+static void WriteCsvNumber(FileHandler::CBufferedFileWriter& file, double value)
+{
+    if (std::isfinite(value))
+    {
+        file.Printf(",%.9g", value);
+    }
+    else
+    {
+        file.Write(",");
+    }
+}
+
+CFluxResultWriter::CFluxResultWriter(novac::ILogger& log, const std::string& outputDirectory, const FluxResultOutputs& outputs)
+    : m_log(log), m_outputDirectory(outputDirectory), m_outputs(outputs)
+{
+}
+
+CFluxResultWriter::~CFluxResultWriter()
+{
+    Close();
+}
+
+std::string CFluxResultWriter::GetFileName(const std::string& name) const
+{
+    novac::CString fileName;
+    fileName.Format("%s%c%s", m_outputDirectory.c_str(), Poco::Path::separator(), name.c_str());
+    return fileName.std_str();
+}
+
+void CFluxResultWriter::Open(novac::LogContext context, const novac::CDateTime& now)
+{
+    Close();
+    m_context = context;
+
+    if (m_outputs.xml)
+    {
+        if (!m_xml.Open(GetFileName("FluxLog.xml"), false))
+        {
+            m_log.Information(context, "Could not open flux log file for writing. Writing of results failed. ");
+        }
+
+        // Write the header and the starting comments
+        m_xml.Printf("<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n");
+        m_xml.Printf("<?xml-stylesheet type=\"text/xsl\" href=\"fluxresult.xsl\"?>\n");
+        m_xml.Printf("<!-- This is result of the flux calculations the NOVAC Post Processing Program -->\n");
+        m_xml.Printf("<!-- File generated on %04d.%02d.%02d at %02d:%02d:%02d -->\n\n", now.year, now.month, now.day, now.hour, now.minute, now.second);
+
+        m_xml.Printf("<NovacPPPFluxResults>\n");
+    }
+
+    if (m_outputs.txt)
+    {
+        if (!m_txt.Open(GetFileName("FluxLog.txt"), false))
+        {
+            m_log.Information(context, "Could not open flux log file for writing. Writing of results failed. ");
+        }
+
+        // Write the header and the starting comments
+        m_txt.Printf("# This is result of the flux calculations the NOVAC Post Processing Program \n");
+        m_txt.Printf("#   File generated on %04d.%02d.%02d at %02d:%02d:%02d \n\n", now.year, now.month, now.day, now.hour, now.minute, now.second);
+
+        m_txt.Printf("#StartTime\tStopTime\tSerial\tInstrumentType\tFlux_kgs\tFluxQuality\tFluxError_Wind_kgs\tFluxError_PlumeHeight_kgs\tWindSpeed_ms\tWindSpeedErr_ms\tWindSpeedSrc\tWindDir_deg\tWindDirErr_deg\tWindDirSrc\tPlumeHeight_m\tPlumeHeightErr_m\tPlumeHeightSrc\t");
+        m_txt.Printf("Compass\tConeAngle\tTilt\tnSpectra\tPlumeCentre_1\tPlumeCentre_2\tPlumeCompleteness\tScanOffset");
+        if (m_outputs.fluxPercentiles)
+        {
+            m_txt.Printf("\tFluxP05_kgs\tFluxP50_kgs\tFluxP95_kgs");
+        }
+        m_txt.Printf("\n");
+    }
+
+    if (m_outputs.csv)
+    {
+        if (!m_csv.Open(GetFileName("FluxLog.csv"), false))
+        {
+            m_log.Information(context, "Could not open csv flux log file for writing. Writing of results failed. ");
+        }
+
+        m_csv.Write("StartTime,StopTime,Serial,InstrumentType,Flux_kgs,FluxQuality,FluxError_Wind_kgs,FluxError_PlumeHeight_kgs,");
+        m_csv.Write("FluxP05_kgs,FluxP50_kgs,FluxP95_kgs,");
+        m_csv.Write("WindSpeed_ms,WindSpeedErr_ms,WindSpeedSrc,WindDir_deg,WindDirErr_deg,WindDirSrc,PlumeHeight_m,PlumeHeightErr_m,PlumeHeightSrc,");
+        m_csv.Write("Compass,ConeAngle,Tilt,nSpectra,PlumeCentre_1,PlumeCentre_2,PlumeCompleteness,ScanOffset\n");
+    }
+}
+
+void CFluxResultWriter::Write(const FluxResult& fluxResult)
+{
+    if (m_xml.IsOpen())
+    {
+        WriteXml(fluxResult);
+    }
+    if (m_txt.IsOpen())
+    {
+        WriteTxt(fluxResult);
+    }
+    if (m_csv.IsOpen())
+    {
+        WriteCsv(fluxResult);
+    }
+    if (m_outputs.instrumentLogs)
+    {
+        WriteInstrumentLog(fluxResult);
+    }
+}
+
+void CFluxResultWriter::Close()
+{
+    if (m_xml.IsOpen())
+    {
+        m_xml.Printf("</NovacPPPFluxResults>\n");
+        m_xml.Close();
+
+        WriteXmlStyleSheet();
+    }
+
+    m_txt.Close();
+    m_csv.Close();
+    m_instrumentLogs.clear();
+}
+
+void CFluxResultWriter::WriteXml(const FluxResult& fluxResult)
+{
+    novac::CString wsSrc, wdSrc, phSrc;
+
+    // extract the sources of information about wind-speed, wind-direction and plume-height
+    fluxResult.m_windField.GetWindSpeedSource(wsSrc);
+    fluxResult.m_windField.GetWindDirectionSource(wdSrc);
+    Meteorology::MetSourceToString(fluxResult.m_plumeHeight.m_plumeAltitudeSource, phSrc);
+
+    // write a <flux> section
+    m_xml.Printf("\t<flux>\n");
+
+    m_xml.Printf("\t\t<startTime>%04d.%02d.%02dT%02d:%02d:%02d</startTime>\n",
+        fluxResult.m_startTime.year, fluxResult.m_startTime.month, fluxResult.m_startTime.day,
+        fluxResult.m_startTime.hour, fluxResult.m_startTime.minute, fluxResult.m_startTime.second);
+    m_xml.Printf("\t\t<stopTime>%04d.%02d.%02dT%02d:%02d:%02d</stopTime>\n",
+        fluxResult.m_stopTime.year, fluxResult.m_stopTime.month, fluxResult.m_stopTime.day,
+        fluxResult.m_stopTime.hour, fluxResult.m_stopTime.minute, fluxResult.m_stopTime.second);
+
+    m_xml.Printf("\t\t<serial>%s</serial>\n", fluxResult.m_instrument.c_str());
+    m_xml.Printf("\t\t<instrumentType>%s</instrumentType>\n", InstrumentTypeToString(fluxResult.m_instrumentType));
+
+    m_xml.Printf("\t\t<value>%.2lf</value>\n", fluxResult.m_flux);
+
+    // The judged quality of the calculated flux
+    m_xml.Printf("\t\t<Quality>%s</Quality>\n", FluxQualityToString(fluxResult.m_fluxQualityFlag));
+
+    // the errors
+    m_xml.Printf("\t\t<FluxError_Wind_kgs>%.2lf</FluxError_Wind_kgs>\n", fluxResult.m_fluxError_Wind);
+    m_xml.Printf("\t\t<FluxError_PlumeHeight_kgs>%.2lf</FluxError_PlumeHeight_kgs>\n", fluxResult.m_fluxError_PlumeHeight);
+
+    // the estimated distribution of the flux
+    if (!std::isnan(fluxResult.m_fluxPercentile50))
+    {
+        m_xml.Printf("\t\t<FluxPercentile05_kgs>%.2lf</FluxPercentile05_kgs>\n", fluxResult.m_fluxPercentile05);
+        m_xml.Printf("\t\t<FluxPercentile50_kgs>%.2lf</FluxPercentile50_kgs>\n", fluxResult.m_fluxPercentile50);
+        m_xml.Printf("\t\t<FluxPercentile95_kgs>%.2lf</FluxPercentile95_kgs>\n", fluxResult.m_fluxPercentile95);
+    }
+
+    // the wind speed
+    m_xml.Printf("\t\t<windspeed>%.2lf</windspeed>\n", fluxResult.m_windField.GetWindSpeed());
+    m_xml.Printf("\t\t<windspeedError>%.2lf</windspeedError>\n", fluxResult.m_windField.GetWindSpeedError());
+    m_xml.Printf("\t\t<windspeedSource>%s</windspeedSource>\n", (const char*)wsSrc);
+
+    // the wind direction
+    m_xml.Printf("\t\t<winddirection>%.2lf</winddirection>\n", fluxResult.m_windField.GetWindDirection());
+    m_xml.Printf("\t\t<winddirectionError>%.2lf</winddirectionError>\n", fluxResult.m_windField.GetWindDirectionError());
+    m_xml.Printf("\t\t<winddirectionSource>%s</winddirectionSource>\n", (const char*)wdSrc);
+
+    // the plume height
+    m_xml.Printf("\t\t<plumeheight>%.2lf</plumeheight>\n", fluxResult.m_plumeHeight.m_plumeAltitude);
+    m_xml.Printf("\t\t<plumeheightError>%.2lf</plumeheightError>\n", fluxResult.m_plumeHeight.m_plumeAltitudeError);
+    m_xml.Printf("\t\t<plumeheightSource>%s</plumeheightSource>\n", (const char*)phSrc);
+
+    // some additional information about the scan
+    m_xml.Printf("\t\t<Compass>%.1lf<Compass>\n", fluxResult.m_compass);
+    m_xml.Printf("\t\t<ConeAngle>%.1lf<ConeAngle>\n", fluxResult.m_coneAngle);
+    m_xml.Printf("\t\t<Tilt>%.1lf<Tilt>\n", fluxResult.m_tilt);
+    m_xml.Printf("\t\t<nSpectra>%d<nSpectra>\n", fluxResult.m_numGoodSpectra);
+    m_xml.Printf("\t\t<PlumeCentre_1>%.1lf<PlumeCentre_1>\n", fluxResult.m_plumeCentre[0]);
+    m_xml.Printf("\t\t<PlumeCentre_2>%.1lf<PlumeCentre_2>\n", fluxResult.m_plumeCentre[1]);
+    m_xml.Printf("\t\t<PlumeCompleteness>%.2lf<PlumeCompleteness>\n", fluxResult.m_completeness);
+    m_xml.Printf("\t\t<ScanOffset>%.1e<ScanOffset>\n", fluxResult.m_scanOffset);
+
+    m_xml.Printf("\t</flux>\n");
+}
+
+void CFluxResultWriter::WriteTxt(const FluxResult& fluxResult)
+{
+    novac::CString wsSrc, wdSrc, phSrc;
+
+    // extract the sources of information about wind-speed, wind-direction and plume-height
+    fluxResult.m_windField.GetWindSpeedSource(wsSrc);
+    fluxResult.m_windField.GetWindDirectionSource(wdSrc);
+    Meteorology::MetSourceToString(fluxResult.m_plumeHeight.m_plumeAltitudeSource, phSrc);
+
+    // write the date and time when the measurement started and ended
+    m_txt.Printf("%04d.%02d.%02dT%02d:%02d:%02d\t%04d.%02d.%02dT%02d:%02d:%02d\t",
+        fluxResult.m_startTime.year, fluxResult.m_startTime.month, fluxResult.m_startTime.day,
+        fluxResult.m_startTime.hour, fluxResult.m_startTime.minute, fluxResult.m_startTime.second,
+        fluxResult.m_stopTime.year, fluxResult.m_stopTime.month, fluxResult.m_stopTime.day,
+        fluxResult.m_stopTime.hour, fluxResult.m_stopTime.minute, fluxResult.m_stopTime.second);
+
+    // the serial-number and type of instrument, the flux and its judged quality
+    m_txt.Printf("%s\t%s\t%.2lf\t%s\t",
+        fluxResult.m_instrument.c_str(), InstrumentTypeToString(fluxResult.m_instrumentType),
+        fluxResult.m_flux, FluxQualityToString(fluxResult.m_fluxQualityFlag));
+
+    // the errors
+    m_txt.Printf("%.2lf\t%.2lf\t", fluxResult.m_fluxError_Wind, fluxResult.m_fluxError_PlumeHeight);
+
+    // the wind speed, wind direction and plume height
+    m_txt.Printf("%.2lf\t%.2lf\t%s\t", fluxResult.m_windField.GetWindSpeed(), fluxResult.m_windField.GetWindSpeedError(), (const char*)wsSrc);
+    m_txt.Printf("%.2lf\t%.2lf\t%s\t", fluxResult.m_windField.GetWindDirection(), fluxResult.m_windField.GetWindDirectionError(), (const char*)wdSrc);
+    m_txt.Printf("%.2lf\t%.2lf\t%s\t", fluxResult.m_plumeHeight.m_plumeAltitude, fluxResult.m_plumeHeight.m_plumeAltitudeError, (const char*)phSrc);
+
+    // write additional information about the scan
+    m_txt.Printf("%.1lf\t%.1lf\t%.1lf\t%d\t", fluxResult.m_compass, fluxResult.m_coneAngle, fluxResult.m_tilt, fluxResult.m_numGoodSpectra);
+    m_txt.Printf("%.1lf\t%.1lf\t%.2lf\t%.1e", fluxResult.m_plumeCentre[0], fluxResult.m_plumeCentre[1], fluxResult.m_completeness, fluxResult.m_scanOffset);
+
+    // the estimated distribution of the flux
+    if (m_outputs.fluxPercentiles)
+    {
+        m_txt.Printf("\t%.2lf\t%.2lf\t%.2lf", fluxResult.m_fluxPercentile05, fluxResult.m_fluxPercentile50, fluxResult.m_fluxPercentile95);
+    }
+    m_txt.Printf("\n");
+}
+
+void CFluxResultWriter::WriteCsv(const FluxResult& fluxResult)
+{
+    novac::CString wsSrc, wdSrc, phSrc;
+    fluxResult.m_windField.GetWindSpeedSource(wsSrc);
+    fluxResult.m_windField.GetWindDirectionSource(wdSrc);
+    Meteorology::MetSourceToString(fluxResult.m_plumeHeight.m_plumeAltitudeSource, phSrc);
+
+    m_csv.Printf("%04d-%02d-%02dT%02d:%02d:%02dZ,%04d-%02d-%02dT%02d:%02d:%02dZ,%s,%s",
+        fluxResult.m_startTime.year, fluxResult.m_startTime.month, fluxResult.m_startTime.day,
+        fluxResult.m_startTime.hour, fluxResult.m_startTime.minute, fluxResult.m_startTime.second,
+        fluxResult.m_stopTime.year, fluxResult.m_stopTime.month, fluxResult.m_stopTime.day,
+        fluxResult.m_stopTime.hour, fluxResult.m_stopTime.minute, fluxResult.m_stopTime.second,
+        fluxResult.m_instrument.c_str(), InstrumentTypeToString(fluxResult.m_instrumentType));
+
+    WriteCsvNumber(m_csv, fluxResult.m_flux);
+    m_csv.Printf(",%s", FluxQualityToString(fluxResult.m_fluxQualityFlag));
+    WriteCsvNumber(m_csv, fluxResult.m_fluxError_Wind);
+    WriteCsvNumber(m_csv, fluxResult.m_fluxError_PlumeHeight);
+    WriteCsvNumber(m_csv, fluxResult.m_fluxPercentile05);
+    WriteCsvNumber(m_csv, fluxResult.m_fluxPercentile50);
+    WriteCsvNumber(m_csv, fluxResult.m_fluxPercentile95);
+
+    WriteCsvNumber(m_csv, fluxResult.m_windField.GetWindSpeed());
+    WriteCsvNumber(m_csv, fluxResult.m_windField.GetWindSpeedError());
+    m_csv.Printf(",%s", (const char*)wsSrc);
+    WriteCsvNumber(m_csv, fluxResult.m_windField.GetWindDirection());
+    WriteCsvNumber(m_csv, fluxResult.m_windField.GetWindDirectionError());
+    m_csv.Printf(",%s", (const char*)wdSrc);
+    WriteCsvNumber(m_csv, fluxResult.m_plumeHeight.m_plumeAltitude);
+    WriteCsvNumber(m_csv, fluxResult.m_plumeHeight.m_plumeAltitudeError);
+    m_csv.Printf(",%s", (const char*)phSrc);
+
+    WriteCsvNumber(m_csv, fluxResult.m_compass);
+    WriteCsvNumber(m_csv, fluxResult.m_coneAngle);
+    WriteCsvNumber(m_csv, fluxResult.m_tilt);
+    m_csv.Printf(",%u", fluxResult.m_numGoodSpectra);
+    WriteCsvNumber(m_csv, fluxResult.m_plumeCentre[0]);
+    WriteCsvNumber(m_csv, fluxResult.m_plumeCentre[1]);
+    WriteCsvNumber(m_csv, fluxResult.m_completeness);
+    WriteCsvNumber(m_csv, fluxResult.m_scanOffset);
+    m_csv.Write("\n");
+}
+
+void CFluxResultWriter::WriteInstrumentLog(const FluxResult& fluxResult)
+{
+    const CDateTime& startTime = fluxResult.m_startTime;
+    const int day = startTime.year * 10000 + startTime.month * 100 + startTime.day;
+
+    InstrumentLog& instrumentLog = m_instrumentLogs[fluxResult.m_instrument];
+    if (instrumentLog.file == nullptr || instrumentLog.day != day)
+    {
+        instrumentLog.file.reset();
+        instrumentLog.day = day;
+
+        // The directory and name of the flux log of this instrument and day
+        novac::CString dateStr, directory, fluxLogFile;
+        dateStr.Format("%04d.%02d.%02d", startTime.year, startTime.month, startTime.day);
+        directory.Format("%s%c%s%c%s%c", m_outputDirectory.c_str(), Poco::Path::separator(), (const char*)dateStr,
+            Poco::Path::separator(), fluxResult.m_instrument.c_str(), Poco::Path::separator());
+        if (Filesystem::CreateDirectoryStructure(directory))
+        {
+            m_log.Error(m_context, "Could not create storage directory for flux-data. Please check settings and restart.");
+            return;
+        }
+        fluxLogFile.Format("%sFluxLog_%s_%s.txt", (const char*)directory, fluxResult.m_instrument.c_str(), (const char*)dateStr);
+
+        const bool isNewFile = !Filesystem::IsExistingFile(fluxLogFile);
+        instrumentLog.file.reset(new FileHandler::CBufferedFileWriter(instrumentLogBufferSize));
+        if (!instrumentLog.file->Open(fluxLogFile.std_str(), true))
+        {
+            instrumentLog.file.reset();
+            return;
+        }
+
+        if (isNewFile)
+        {
+            instrumentLog.file->Printf("serial=%s\n", fluxResult.m_instrument.c_str());
+            instrumentLog.file->Printf("volcano=x\n");
+            instrumentLog.file->Printf("site=x\n");
+            instrumentLog.file->Printf("#scandate\tscanstarttime\tscanstoptime\t");
+            instrumentLog.file->Printf("flux_[kg/s]\t");
+            instrumentLog.file->Printf("windspeed_[m/s]\twinddirection_[deg]\twindspeedsource\twinddirectionsource\t");
+            instrumentLog.file->Printf("plumeheight_[m]\tplumeheightsource\t");
+            instrumentLog.file->Printf("compassdirection_[deg]\tcompasssource\t");
+            instrumentLog.file->Printf("plumecentre_[deg]\tplumecompleteness_[%%]\t");
+            instrumentLog.file->Printf("coneangle\ttilt\tokflux\ttemperature\tbatteryvoltage\texposuretime\n");
+        }
+    }
+
+    novac::CString wsSrc, wdSrc, phSrc;
+    fluxResult.m_windField.GetWindSpeedSource(wsSrc);
+    fluxResult.m_windField.GetWindDirectionSource(wdSrc);
+    Meteorology::MetSourceToString(fluxResult.m_plumeHeight.m_plumeAltitudeSource, phSrc);
+
+    FileHandler::CBufferedFileWriter& file = *instrumentLog.file;
+
+    // the day and time the scan started and stopped, and the flux
+    file.Printf("%04d-%02d-%02d\t%02d:%02d:%02d\t%02d:%02d:%02d\t%.2lf\t",
+        startTime.year, startTime.month, startTime.day, startTime.hour, startTime.minute, startTime.second,
+        fluxResult.m_stopTime.hour, fluxResult.m_stopTime.minute, fluxResult.m_stopTime.second,
+        fluxResult.m_flux);
+
+    // the wind field and the plume height used to calculate the flux, with their sources
+    file.Printf("%.3lf\t%.3lf\t%.3lf\t%.3lf\t%s\t%s\t",
+        fluxResult.m_windField.GetWindSpeed(), fluxResult.m_windField.GetWindSpeedError(),
+        fluxResult.m_windField.GetWindDirection(), fluxResult.m_windField.GetWindDirectionError(),
+        (const char*)wsSrc, (const char*)wdSrc);
+    file.Printf("%.1lf\t%.1lf\t%s\t", fluxResult.m_plumeHeight.m_plumeAltitude, fluxResult.m_plumeHeight.m_plumeAltitudeError, (const char*)phSrc);
+
+    // the geometry of the scan and the plume
+    file.Printf("%.2lf\t%.1lf\t%.2lf\t%.1lf\t%.1lf\t",
+        fluxResult.m_compass, fluxResult.m_plumeCentre[0], fluxResult.m_completeness, fluxResult.m_coneAngle, fluxResult.m_tilt);
+
+    // whether we think this is a good measurement or not, and the state of the instrument
+    file.Printf("%d\t%.1lf\t%.1lf\t%.1ld\t\n",
+        (fluxResult.m_fluxQualityFlag != FluxQuality::Red) ? 1 : 0,
+        fluxResult.m_temperature, fluxResult.m_batteryVoltage, fluxResult.m_exposureTime);
+}
+
+void CFluxResultWriter::WriteXmlStyleSheet()
+{
+    FileHandler::CBufferedFileWriter file(4096);
+    if (!file.Open(GetFileName("fluxresult.xsl"), false))
+    {
+        return;
+    }
+
+    file.Write("<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n");
+
+    file.Write("<html xsl:version=\"1.0\" xmlns:xsl=\"http://www.w3.org/1999/XSL/Transform\" xmlns=\"http://www.w3.org/1999/xhtml\">\n");
+    file.Write("<body style=\"font-family:Arial;font-size:12pt;background-color:#EEEEEE\">\n");
+    file.Write("\t<div style=\"background-color:white;color:black;padding:4px\">\n");
+    file.Write("\t\t<span style=\"font-weight:bold\">Result of flux calculation</span>\n");
+    file.Write("\t</div>\n");
+
+    file.Write("\t<xsl:for-each select=\"NovacPPPFluxResults/flux\">\n");
+    file.Write("\t<div style=\"background-color:white;color:teal;padding:4px\">\n");
+    file.Write("\t\t<span style=\"font-weight:bold\">Measurement from <xsl:value-of select=\"startTime\"/> to <xsl:value-of select=\"stopTime\"/> </span>\n");
+    file.Write("\t- <xsl:value-of select=\"value\"/> kg/s\n");
+    file.Write("\t</div>\n");
+    file.Write("\t<div style=\"margin-left:20px;margin-bottom:1em;font-size:10pt\">\n");
+
+    file.Write("\t\t<xsl:value-of select=\"description\"/>\n");
+    file.Write("\t\t<span style=\"font-style:italic\">\n");
+    file.Write("\t\t\tMade by <xsl:value-of select=\"serial\"/>\n");
+    file.Write("\t\t</span>\n");
+    file.Write("\t</div>\n");
+    file.Write("\t</xsl:for-each>\n");
+    file.Write("</body>\n");
+    file.Write("</html>\n");
+}
+
+}
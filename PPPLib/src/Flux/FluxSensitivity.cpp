@@ -0,0 +1,206 @@
+#include <PPPLib/Flux/FluxSensitivity.h>
+#include <PPPLib/Configuration/NovacPPPConfiguration.h>
+#include <PPPLib/Configuration/UserConfiguration.h>
+#include <PPPLib/ParallelFor.h>
+#include <SpectralEvaluation/File/File.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#undef min
+#undef max
+
+namespace Flux
+{
+
+/** The wind and plume height of the variants of one scan, and their fluxes */
+struct VariantBatchBuffers
+{
+    std::vector<size_t> variantIndices;
+    std::vector<double> windSpeeds;
+    std::vector<double> windDirections;
+    std::vector<double> relativePlumeHeights;
+    std::vector<double> fluxes;
+};
+
+/** @return the buffers of the calling thread. These are kept for as long as the thread lives,
+    such that the memory is reused for all scans calculated on the thread. */
+static VariantBatchBuffers& GetVariantBatchBuffers()
+{
+    thread_local VariantBatchBuffers buffers;
+    return buffers;
+}
+
+CFluxSensitivityCalculator::CFluxSensitivityCalculator(
+    novac::ILogger& log,
+    const Configuration::CNovacPPPConfiguration& setup,
+    const Configuration::CUserConfiguration& userSettings)
+    : m_log(log), m_userSettings(userSettings), m_fluxCalculator(log, setup, userSettings)
+{
+}
+
+std::vector<FluxScanData> CFluxSensitivityCalculator::PrepareScans(
+    novac::LogContext context,
+    const std::vector<Evaluation::CExtendedScanResult>& scanResults)
+{
+    std::vector<FluxScanData> preparedScans(scanResults.size());
+    std::vector<char> scanIsPrepared(scanResults.size(), 0);
+
+    novac::ParallelFor(scanResults.size(), m_userSettings.m_maxThreadNum, [&](size_t scanIdx)
+        {
+            const Evaluation::CExtendedScanResult& scanResult = scanResults[scanIdx];
+
+            // The same checks as when calculating the fluxes, these don't require reading the evaluation log
+            if (scanResult.m_measurementMode != novac::MeasurementMode::Flux ||
+                !scanResult.m_scanProperties.completeness.HasValue() ||
+                scanResult.m_scanProperties.completeness.Value() < (m_userSettings.m_completenessLimitFlux + 0.01))
+            {
+                return;
+            }
+
+            const novac::LogContext fileContext = context.With(novac::LogContext::FileName, novac::GetFileName(scanResult.m_evalLogFile[m_userSettings.m_mainFitWindow]));
+            if (m_fluxCalculator.PrepareFluxScanData(fileContext, scanResult, preparedScans[scanIdx]))
+            {
+                scanIsPrepared[scanIdx] = 1;
+            }
+        });
+
+    std::vector<FluxScanData> result;
+    result.reserve(scanResults.size());
+    for (size_t scanIdx = 0; scanIdx < scanResults.size(); ++scanIdx)
+    {
+        if (scanIsPrepared[scanIdx])
+        {
+            result.push_back(std::move(preparedScans[scanIdx]));
+        }
+    }
+
+    return result;
+}
+
+std::vector<double> CFluxSensitivityCalculator::CalculateFluxes(
+    novac::LogContext context,
+    const std::vector<FluxScanData>& scans,
+    const std::vector<FluxSensitivityVariant>& variants,
+    const Geometry::CPlumeDataBase& plumeDataBase)
+{
+    const size_t variantNum = variants.size();
+    std::vector<double> fluxes(scans.size() * variantNum, std::numeric_limits<double>::quiet_NaN());
+
+    novac::ParallelFor(scans.size(), m_userSettings.m_maxThreadNum, [&](size_t scanIdx)
+        {
+            const FluxScanData& scan = scans[scanIdx];
+            double* scanFluxes = fluxes.data() + scanIdx * variantNum;
+
+            Geometry::PlumeHeight plumeHeightFromDataBase;
+            const bool hasPlumeHeightFromDataBase = plumeDataBase.GetPlumeHeight(scan.startTime, plumeHeightFromDataBase);
+
+            // Collect the wind and plume height of all the variants for which the flux can be calculated,
+            //  such that the fluxes of all of these can be calculated in one batch.
+            VariantBatchBuffers& batch = GetVariantBatchBuffers();
+            batch.variantIndices.clear();
+            batch.windSpeeds.clear();
+            batch.windDirections.clear();
+            batch.relativePlumeHeights.clear();
+
+            for (size_t variantIdx = 0; variantIdx < variantNum; ++variantIdx)
+            {
+                const FluxSensitivityVariant& variant = variants[variantIdx];
+
+                double plumeAltitude = variant.plumeAltitude;
+                if (std::isnan(plumeAltitude))
+                {
+                    if (!hasPlumeHeightFromDataBase)
+                    {
+                        continue;
+                    }
+                    plumeAltitude = plumeHeightFromDataBase.m_plumeAltitude;
+                }
+
+                Meteorology::WindField windField;
+                if (variant.windField == nullptr ||
+                    !variant.windField->GetWindField(scan.startTime, novac::CGPSData(scan.location.m_latitude, scan.location.m_longitude, plumeAltitude), Meteorology::InterpolationMethod::NearestNeighbour, windField))
+                {
+                    continue;
+                }
+
+                const double relativePlumeHeight = plumeAltitude - scan.location.m_altitude;
+                if (relativePlumeHeight <= 0)
+                {
+                    continue;
+                }
+
+                batch.variantIndices.push_back(variantIdx);
+                batch.windSpeeds.push_back(windField.GetWindSpeed());
+                batch.windDirections.push_back(windField.GetWindDirection());
+                batch.relativePlumeHeights.push_back(relativePlumeHeight);
+            }
+
+            const size_t batchSize = batch.variantIndices.size();
+            batch.fluxes.resize(batchSize);
+            m_fluxCalculator.CalculateFluxBatch(context, scan, batch.windSpeeds.data(), batch.windDirections.data(), batch.relativePlumeHeights.data(), batchSize, batch.fluxes.data());
+
+            for (size_t batchIdx = 0; batchIdx < batchSize; ++batchIdx)
+            {
+                scanFluxes[batch.variantIndices[batchIdx]] = batch.fluxes[batchIdx];
+            }
+        });
+
+    return fluxes;
+}
+
+bool CFluxSensitivityCalculator::WriteFluxes(
+    const std::string& fileName,
+    const std::vector<FluxScanData>& scans,
+    const std::vector<FluxSensitivityVariant>& variants,
+    const std::vector<double>& fluxes)
+{
+    FILE* f = fopen(fileName.c_str(), "w");
+    if (f == nullptr)
+    {
+        return false;
+    }
+
+    // The header, describing each of the variants
+    for (size_t variantIdx = 0; variantIdx < variants.size(); ++variantIdx)
+    {
+        const FluxSensitivityVariant& variant = variants[variantIdx];
+        if (std::isnan(variant.plumeAltitude))
+        {
+            fprintf(f, "# variant %zu: wind=%s\tplumeheight=database\n", variantIdx, variant.windFieldName.c_str());
+        }
+        else
+        {
+            fprintf(f, "# variant %zu: wind=%s\tplumeheight=%.1lf\n", variantIdx, variant.windFieldName.c_str(), variant.plumeAltitude);
+        }
+    }
+    fprintf(f, "#scandate\tscanstarttime\tserial");
+    for (size_t variantIdx = 0; variantIdx < variants.size(); ++variantIdx)
+    {
+        fprintf(f, "\tflux_%zu_[kg/s]", variantIdx);
+    }
+    fprintf(f, "\n");
+
+    for (size_t scanIdx = 0; scanIdx < scans.size(); ++scanIdx)
+    {
+        const FluxScanData& scan = scans[scanIdx];
+        fprintf(f, "%04d-%02d-%02d\t%02d:%02d:%02d\t%s",
+            scan.startTime.year, scan.startTime.month, scan.startTime.day,
+            scan.startTime.hour, scan.startTime.minute, scan.startTime.second,
+            scan.instrument.c_str());
+
+        for (size_t variantIdx = 0; variantIdx < variants.size(); ++variantIdx)
+        {
+            fprintf(f, "\t%.2lf", fluxes[scanIdx * variants.size() + variantIdx]);
+        }
+        fprintf(f, "\n");
+    }
+
+    fclose(f);
+
+    return true;
+}
+
+}
@@ -1,100 +1,76 @@
 #include <PPPLib/Flux/FluxStatistics.h>
 #include <PPPLib/File/Filesystem.h>
 #include <SpectralEvaluation/VectorUtils.h>
+#include <algorithm>
+#include <cctype>
 
 using namespace Flux;
 using namespace novac;
 
-CFluxStatistics::CMeasurementDay& CFluxStatistics::CMeasurementDay::operator =(const CFluxStatistics::CMeasurementDay& m)
+std::string CFluxStatistics::GetHeaderLine() const
 {
-    this->day = m.day;
-
-    auto p = m.fluxList.GetHeadPosition();
-    while (p != nullptr)
-    {
-        fluxList.AddTail(FluxResult(m.fluxList.GetNext(p)));
-    }
-
-    return *this;
-}
+    novac::CString str;
 
-void CFluxStatistics::CMeasurementDay::GetHeaderLine(novac::CString& str, novac::CList <novac::CString, novac::CString&>& instruments)
-{
     // the statistics of the fluxes
     str.Format("Date\tAverageFlux(kg/s)\tMedianFlux(kg/s)\tStdFlux(kg/s)\tnMeasurements");
 
-    // the statistics of the instruments
-    auto p = instruments.GetHeadPosition();
-    while (p != nullptr)
+    // the statistics of the instruments, the last seen instrument comes first
+    for (auto instrument = m_instruments.rbegin(); instrument != m_instruments.rend(); ++instrument)
     {
-        str.AppendFormat("\t#MeasFrom_%s", (const char*)instruments.GetNext(p));
+        str.AppendFormat("\t#MeasFrom_%s", instrument->c_str());
     }
     str.AppendFormat("\n");
 
-    return;
+    return str.std_str();
 }
 
-void CFluxStatistics::CMeasurementDay::GetStatistics(novac::CString& str, novac::CList <novac::CString, novac::CString&>& instruments)
+std::string CFluxStatistics::GetStatistics(const MeasurementDay& measurementDay) const
 {
-    const size_t nMeasurements = static_cast<size_t>(this->fluxList.GetCount());
-    int nMeasurementsFromThisInstrument = 0;
+    novac::CString str;
+    const std::vector<double>& data = measurementDay.fluxes;
+    const size_t nMeasurements = data.size();
 
     // Write the day
-    str.Format("%04d.%02d.%02d\t", day.year, day.month, day.day);
-
-    // copy the data into the array
-    std::vector<double> data;
-    data.reserve(nMeasurements);
-    auto p = fluxList.GetHeadPosition();
-    while (p != nullptr)
-    {
-        data.push_back(fluxList.GetNext(p).m_flux);
-    }
+    str.Format("%04d.%02d.%02d\t", measurementDay.day.year, measurementDay.day.month, measurementDay.day.day);
 
     // get the statistical data
     const double average = Average(data);
     const double std = Stdev(data);
 
-    // sort the data to get the median
-    std::vector <double> sortedData(nMeasurements, 0.0);
-    FindNLowest(data, nMeasurements, sortedData);
+    // the median, from the order statistics of the data.
+    //  Notice that for an odd number of measurements this is (and has always been) the value just above the middle one.
+    std::vector<double> orderedData = data;
     double median = 0.0;
     if (nMeasurements % 2 == 0)
     {
-        median = Average(sortedData.begin() + static_cast<int>(nMeasurements) / 2 - 1, sortedData.begin() + static_cast<int>(nMeasurements) / 2 + 1);
+        const auto upper = orderedData.begin() + static_cast<std::ptrdiff_t>(nMeasurements / 2);
+        std::nth_element(orderedData.begin(), upper, orderedData.end());
+        const double lower = *std::max_element(orderedData.begin(), upper);
+        median = (lower + *upper) / 2.0;
     }
     else
     {
-        median = sortedData[nMeasurements / 2 + 1];
+        const size_t index = std::min(nMeasurements / 2 + 1, nMeasurements - 1);
+        const auto position = orderedData.begin() + static_cast<std::ptrdiff_t>(index);
+        std::nth_element(orderedData.begin(), position, orderedData.end());
+        median = *position;
     }
 
     // write what we now know to the string
-    str.AppendFormat("%.2lf\t%.2lf\t%.2lf\t%d", average, median, std, nMeasurements);
+    str.AppendFormat("%.2lf\t%.2lf\t%.2lf\t%d", average, median, std, static_cast<int>(nMeasurements));
 
-    // go through the data and see how many points we have from each instrument
-    auto p2 = instruments.GetHeadPosition();
-    while (p2 != nullptr)
+    // the number of measurements from each instrument, in the same order as in the header
+    for (size_t instrumentIdx = m_instruments.size(); instrumentIdx > 0; --instrumentIdx)
     {
-        novac::CString& serial = instruments.GetNext(p2);
-        nMeasurementsFromThisInstrument = 0;
-        auto fluxPosition = fluxList.GetHeadPosition();
-        while (fluxPosition != nullptr)
-        {
-            const FluxResult& flux = fluxList.GetNext(fluxPosition);
-            if (Equals(flux.m_instrument, serial))
-            {
-                ++nMeasurementsFromThisInstrument;
-            }
-        }
-
+        const size_t index = instrumentIdx - 1;
+        const int nMeasurementsFromThisInstrument = (index < measurementDay.measurementsPerInstrument.size()) ? measurementDay.measurementsPerInstrument[index] : 0;
         str.AppendFormat("\t%d", nMeasurementsFromThisInstrument);
     }
     str.Append("\n");
 
-    return;
+    return str.std_str();
 }
 
-
 CFluxStatistics::CFluxStatistics(void)
 {
     this->Clear();
@@ -109,7 +85,10 @@ CFluxStatistics::~CFluxStatistics(void)
 /** Clears all information here */
 void CFluxStatistics::Clear()
 {
-    m_measurements.RemoveAll();
+    m_measurements.clear();
+    m_dayIndex.clear();
+    m_instruments.clear();
+    m_instrumentIndex.clear();
 }
 
 void CFluxStatistics::AttachFluxList(const std::list<FluxResult>& calculatedFluxes)
@@ -122,66 +101,43 @@ void CFluxStatistics::AttachFluxList(const std::list<FluxResult>& calculatedFlux
 
 void CFluxStatistics::AttachFlux(const FluxResult& result)
 {
-    FluxResult r = result; // make a local copy of the result
-    CMeasurementDay measday;
-    CDateTime resultDay = CDateTime(result.m_startTime.year, result.m_startTime.month, result.m_startTime.day, 0, 0, 0);
-
-    // find out if we know about this instrument
-    bool foundInstrument = false;
-    auto instr_p = m_instruments.GetHeadPosition();
-    while (instr_p != nullptr)
-    {
-        if (Equals(m_instruments.GetNext(instr_p), result.m_instrument))
-        {
-            foundInstrument = true;
-            break;
-        }
-    }
-    if (!foundInstrument)
+    // find out if we know about this instrument, the serials are compared ignoring case
+    std::string instrumentKey = result.m_instrument;
+    std::transform(instrumentKey.begin(), instrumentKey.end(), instrumentKey.begin(), [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+
+    auto instrument = m_instrumentIndex.find(instrumentKey);
+    if (instrument == m_instrumentIndex.end())
     {
-        m_instruments.AddHead(novac::CString(result.m_instrument));
+        instrument = m_instrumentIndex.emplace(instrumentKey, m_instruments.size()).first;
+        m_instruments.push_back(result.m_instrument);
     }
+    const size_t instrumentIdx = instrument->second;
 
-    // Loop through the list of measurementdays to find the 
-    //	right place for the result and insert it.
-    auto meas_p = m_measurements.GetHeadPosition();
-    while (meas_p != nullptr)
+    // find the day of the measurement
+    const int dayKey = result.m_startTime.year * 10000 + result.m_startTime.month * 100 + result.m_startTime.day;
+    auto day = m_dayIndex.find(dayKey);
+    if (day == m_dayIndex.end())
     {
-        CMeasurementDay& d = m_measurements.GetAt(meas_p);
-
-        if (d.day == resultDay)
-        {
-            // insert the result on this day.
-            d.fluxList.AddTail(r);
-            return;
-        }
-        else if (resultDay < d.day)
-        {
-            // insert the result at the position before this day
-            measday.day = resultDay;
-            measday.fluxList.AddTail(r);
-            m_measurements.InsertBefore(meas_p, measday);
-            return;
-        }
+        day = m_dayIndex.emplace(dayKey, m_measurements.size()).first;
 
-        // move on to the next measurement day
-        m_measurements.GetNext(meas_p);
+        MeasurementDay measurementDay;
+        measurementDay.day = CDateTime(result.m_startTime.year, result.m_startTime.month, result.m_startTime.day, 0, 0, 0);
+        m_measurements.push_back(std::move(measurementDay));
     }
+    MeasurementDay& measurementDay = m_measurements[day->second];
 
-    // we've passed the whole list without finding anything that's larger than this day
-    //	insert the result as a new measurement day in the end of the list
-    measday.day = resultDay;
-    measday.fluxList.AddTail(r);
-    m_measurements.AddTail(measday);
-
-    return;
+    measurementDay.fluxes.push_back(result.m_flux);
+    if (measurementDay.measurementsPerInstrument.size() <= instrumentIdx)
+    {
+        measurementDay.measurementsPerInstrument.resize(instrumentIdx + 1, 0);
+    }
+    ++measurementDay.measurementsPerInstrument[instrumentIdx];
 }
 
 /** Calculates statistics on the statistics we have here and writes
     the results to file. */
 void CFluxStatistics::WriteFluxStat(const novac::CString& fileName)
 {
-    novac::CString str;
     FILE* f = nullptr;
 
     // try to open the file
@@ -198,23 +154,19 @@ void CFluxStatistics::WriteFluxStat(const novac::CString& fileName)
             return;
 
         // write the header line
-        CMeasurementDay::GetHeaderLine(str, this->m_instruments);
-        fprintf(f, "%s", str.c_str());
+        fprintf(f, "%s", GetHeaderLine().c_str());
     }
 
-    // For each day in the list of measurement days, calculate the average flux
+    // For each day, in increasing order, calculate the average flux
     //	write the number of measurements made ...
-    auto p = m_measurements.GetHeadPosition();
-    while (p != nullptr)
+    std::sort(m_measurements.begin(), m_measurements.end(), [](const MeasurementDay& d1, const MeasurementDay& d2) { return d1.day < d2.day; });
+    for (size_t dayIdx = 0; dayIdx < m_measurements.size(); ++dayIdx)
     {
-        CMeasurementDay& measDay = m_measurements.GetNext(p);
-
-        measDay.GetStatistics(str, this->m_instruments);
+        m_dayIndex[m_measurements[dayIdx].day.year * 10000 + m_measurements[dayIdx].day.month * 100 + m_measurements[dayIdx].day.day] = dayIdx;
 
-        fprintf(f, "%s", str.c_str());
+        fprintf(f, "%s", GetStatistics(m_measurements[dayIdx]).c_str());
     }
 
-
     // remember to close the file
     fclose(f);
 }
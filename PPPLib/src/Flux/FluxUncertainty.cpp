@@ -0,0 +1,177 @@
+#include <PPPLib/Flux/FluxUncertainty.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+#undef min
+#undef max
+
+namespace Flux
+{
+
+const size_t CFluxUncertaintyCalculator::columnRealizations;
+
+/** The sampled values of one scan */
+struct SampleBuffers
+{
+    std::vector<double> flux;
+    std::vector<double> column;
+};
+
+/** @return the buffers of the calling thread. These are kept for as long as the thread lives,
+    such that the memory is reused for all scans sampled on the thread. */
+static SampleBuffers& GetSampleBuffers()
+{
+    thread_local SampleBuffers buffers;
+    return buffers;
+}
+
+CFluxUncertaintyCalculator::CFluxUncertaintyCalculator(CFluxCalculator& fluxCalculator, size_t numberOfSamples)
+    : m_fluxCalculator(fluxCalculator), m_numberOfSamples(numberOfSamples)
+{
+}
+
+bool CFluxUncertaintyCalculator::CalculatePercentiles(
+    novac::LogContext context,
+    const FluxScanData& scanData,
+    const Meteorology::WindField& wind,
+    const Geometry::PlumeHeight& relativePlumeHeight,
+    FluxResult& fluxResult)
+{
+    const size_t nDataPoints = scanData.column.size();
+    if (m_numberOfSamples == 0 || nDataPoints == 0)
+    {
+        return false;
+    }
+
+    SampleBuffers& samples = GetSampleBuffers();
+
+    std::mt19937_64 generator(GetSeed(scanData));
+    std::normal_distribution<double> normal(0.0, 1.0);
+
+    const double windSpeed = wind.GetWindSpeed();
+    const double windSpeedError = wind.GetWindSpeedError();
+    const double windDirection = wind.GetWindDirection();
+    const double windDirectionError = wind.GetWindDirectionError();
+    const double plumeHeight = relativePlumeHeight.m_plumeAltitude;
+    const double plumeHeightError = relativePlumeHeight.m_plumeAltitudeError;
+
+    // 1. The flux for a unit wind speed and plume height, at the nominal wind direction and at one standard deviation
+    //  on either side of it. The flux of the sampled wind directions is interpolated quadratically between these.
+    const double unitValues[3] = { 1.0, 1.0, 1.0 };
+    const double probedWindDirections[3] = { windDirection, windDirection - windDirectionError, windDirection + windDirectionError };
+    const size_t probedWindDirectionNum = (windDirectionError > 0.0) ? 3 : 1;
+    double unitFlux[3] = { 0.0, 0.0, 0.0 };
+    m_fluxCalculator.CalculateFluxBatch(context, scanData, unitValues, probedWindDirections, unitValues, probedWindDirectionNum, unitFlux);
+
+    const double nominalUnitFlux = unitFlux[0];
+    if (!std::isfinite(nominalUnitFlux))
+    {
+        return false;
+    }
+    const double directionSlope = (probedWindDirectionNum == 3) ? 0.5 * (unitFlux[2] - unitFlux[1]) : 0.0;
+    const double directionCurvature = (probedWindDirectionNum == 3) ? 0.5 * (unitFlux[2] + unitFlux[1] - 2.0 * nominalUnitFlux) : 0.0;
+
+    // 2. The uncertainty of the offset and the columns.
+    //  The offset is calculated as the average of the lowest fifth of the columns, hence its error is
+    //  approximately the average error of the columns divided by the square root of the number of columns used.
+    //  The flux is linear in the columns and the offset, hence the relative deviation of the flux due to their errors
+    //  is normally distributed around zero. Its standard deviation is estimated from a few realizations of the columns.
+    double sumOfSquaredColumnErrors = 0.0;
+    for (size_t ii = 0; ii < nDataPoints; ++ii)
+    {
+        sumOfSquaredColumnErrors += scanData.columnError[ii] * scanData.columnError[ii];
+    }
+    const double rmsColumnError = std::sqrt(sumOfSquaredColumnErrors / static_cast<double>(nDataPoints));
+    const double offsetError = rmsColumnError / std::sqrt(std::max(1.0, static_cast<double>(nDataPoints) / 5.0));
+
+    double columnRelativeError = 0.0;
+    if (rmsColumnError > 0.0 && std::abs(nominalUnitFlux) > 0.0)
+    {
+        samples.column.resize(nDataPoints);
+
+        double sumOfSquaredDeviations = 0.0;
+        for (size_t realizationIdx = 0; realizationIdx < columnRealizations; ++realizationIdx)
+        {
+            for (size_t ii = 0; ii < nDataPoints; ++ii)
+            {
+                samples.column[ii] = scanData.column[ii] + scanData.columnError[ii] * normal(generator);
+            }
+            const double offset = scanData.offset + offsetError * normal(generator);
+
+            double realizationFlux = 0.0;
+            m_fluxCalculator.CalculateFluxBatch(
+                context, scanData.scanAngle.data(), scanData.scanAngle2.data(), samples.column.data(), offset, nDataPoints,
+                unitValues, &windDirection, unitValues, 1,
+                scanData.location.m_compass, scanData.instrumentType, scanData.location.m_coneangle, scanData.location.m_tilt,
+                &realizationFlux);
+
+            const double relativeDeviation = realizationFlux / nominalUnitFlux - 1.0;
+            sumOfSquaredDeviations += relativeDeviation * relativeDeviation;
+        }
+        columnRelativeError = std::sqrt(sumOfSquaredDeviations / static_cast<double>(columnRealizations));
+    }
+
+    // 3. The samples. The flux is proportional to both the wind speed and the plume height.
+    //  The wind directions are limited to three standard deviations, to not extrapolate the flux too far.
+    samples.flux.resize(m_numberOfSamples);
+    for (size_t sampleIdx = 0; sampleIdx < m_numberOfSamples; ++sampleIdx)
+    {
+        const double sampledWindSpeed = std::max(0.0, windSpeed + windSpeedError * normal(generator));
+        const double directionDeviation = std::max(-3.0, std::min(3.0, normal(generator)));
+        const double sampledPlumeHeight = std::max(0.0, plumeHeight + plumeHeightError * normal(generator));
+        const double columnRatio = 1.0 + columnRelativeError * normal(generator);
+
+        const double sampledUnitFlux = nominalUnitFlux + directionDeviation * (directionSlope + directionDeviation * directionCurvature);
+        samples.flux[sampleIdx] = sampledWindSpeed * sampledPlumeHeight * sampledUnitFlux * columnRatio;
+    }
+
+    // 4. The percentiles of the distribution
+    fluxResult.m_fluxPercentile05 = Percentile(samples.flux, 0.05);
+    fluxResult.m_fluxPercentile50 = Percentile(samples.flux, 0.50);
+    fluxResult.m_fluxPercentile95 = Percentile(samples.flux, 0.95);
+
+    return !std::isnan(fluxResult.m_fluxPercentile50);
+}
+
+double CFluxUncertaintyCalculator::Percentile(std::vector<double>& values, double percentile)
+{
+    values.erase(std::remove_if(begin(values), end(values), [](double value) { return std::isnan(value); }), end(values));
+    if (values.empty())
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    const double position = std::round(percentile * static_cast<double>(values.size() - 1));
+    const size_t index = std::min(values.size() - 1, static_cast<size_t>(std::max(0.0, position)));
+    std::nth_element(begin(values), begin(values) + static_cast<std::ptrdiff_t>(index), end(values));
+    return values[index];
+}
+
+std::uint64_t CFluxUncertaintyCalculator::GetSeed(const FluxScanData& scanData)
+{
+    // FNV-1a of the instrument and the start time of the scan
+    std::uint64_t hash = 14695981039346656037ULL;
+    auto append = [&](std::uint64_t value)
+    {
+        hash ^= value;
+        hash *= 1099511628211ULL;
+    };
+
+    for (char c : scanData.instrument)
+    {
+        append(static_cast<unsigned char>(c));
+    }
+    append(static_cast<std::uint64_t>(scanData.startTime.year));
+    append(static_cast<std::uint64_t>(scanData.startTime.month));
+    append(static_cast<std::uint64_t>(scanData.startTime.day));
+    append(static_cast<std::uint64_t>(scanData.startTime.hour));
+    append(static_cast<std::uint64_t>(scanData.startTime.minute));
+    append(static_cast<std::uint64_t>(scanData.startTime.second));
+
+    return hash;
+}
+
+}
@@ -1,5 +1,6 @@
 #include "PPPLib/MFC/CString.h"
 #include <stdarg.h>
+#include <stdio.h>
 #include <vector>
 #include <algorithm> 
 #include <functional> 
@@ -45,82 +46,91 @@ void CString::SetData(const std::string& data)
 
 // --------------------- Formatting -----------------------
 
+/** The size of the buffer on the stack which is used for formatting the strings.
+    Only strings longer than this needs to be formatted twice. */
+static const size_t localStackBufferSize = 512;
+
+void CString::AppendFormatV(std::string& destination, const char* format, va_list args)
+{
+    // First try to write into a stack-buffer. The arguments are copied since they may be needed a second time.
+    char localStackBuffer[localStackBufferSize];
+
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+    const int length = vsnprintf(localStackBuffer, localStackBufferSize, format, argsCopy);
+    va_end(argsCopy);
+
+    if (length < 0)
+    {
+        // Invalid format, leave the destination unchanged.
+        return;
+    }
+
+    const size_t formattedLength = static_cast<size_t>(length);
+    if (formattedLength < localStackBufferSize)
+    {
+        // It fit fine so we're done.
+        destination.append(localStackBuffer, formattedLength);
+        return;
+    }
+
+    // The stack buffer was too small, but now we know the exact length to allocate.
+    //  This is not written directly into the destination since the arguments may point into it.
+    std::vector<char> heapBuffer(formattedLength + 1);
+    vsnprintf(heapBuffer.data(), heapBuffer.size(), format, args);
+    destination.append(heapBuffer.data(), formattedLength);
+}
+
 CString CString::FormatString(const char* format, ...)
 {
     CString str;
 
-    std::vector<char> localBuffer(65535);
-
     va_list args;
     va_start(args, format);
-    vsprintf(localBuffer.data(), format, args);
+    AppendFormatV(str.m_data, format, args);
     va_end(args);
 
-    str.m_data = std::string{ localBuffer.data() };
-
     return str;
 }
 
 void CString::Format(const char* format, ...)
 {
-    std::vector<char> localBuffer(65535);
+    // Formatted into a separate string since the arguments may point into this.
+    std::string formatted;
 
     va_list args;
     va_start(args, format);
-    vsprintf(localBuffer.data(), format, args);
+    AppendFormatV(formatted, format, args);
     va_end(args);
 
-    m_data = std::string{ localBuffer.data() };
+    m_data.swap(formatted);
 }
 
-#define LOCAL_STACK_BUFFER_SIZE 1024
 CString& CString::AppendFormat(const char* format, ...)
 {
-    // First try to write into a stack-buffer
-    char localStackBuffer[LOCAL_STACK_BUFFER_SIZE];
-
     va_list args;
     va_start(args, format);
-    const int bytesWritten = vsprintf(localStackBuffer, format, args);
+    AppendFormatV(m_data, format, args);
     va_end(args);
 
-    if (bytesWritten <= LOCAL_STACK_BUFFER_SIZE && bytesWritten >= 0)
-    {
-        // It fit fine so we're done.
-        m_data = this->m_data + std::string{ localStackBuffer, (size_t)bytesWritten };
-        return *this;
-    }
-    else
-    {
-        // We failed to use the stack-buffer, use a much larger heap-buffer.
-        //   point is that this should happen much more infrequently
-        std::vector<char> heapBuffer(65535);
-
-        va_start(args, format);
-        vsprintf(heapBuffer.data(), format, args);
-        va_end(args);
-
-        m_data = this->m_data + std::string{ heapBuffer.data() };
-
-        return *this;
-    }
+    return *this;
 }
 
 CString& CString::Append(const CString& other)
 {
-    this->m_data = this->m_data + other.m_data;
+    this->m_data.append(other.m_data);
     return *this;
 }
 
 CString& CString::Append(const char* other)
 {
-    this->m_data = this->m_data + std::string(other);
+    this->m_data.append(other);
     return *this;
 }
 
 CString& CString::Append(const std::string& other)
 {
-    this->m_data = this->m_data + other;
+    this->m_data.append(other);
     return *this;
 }
 
@@ -373,25 +383,21 @@ int CString::Compare(const CString& other) const
 
 void CleanString(const CString& in, CString& out)
 {
-    std::vector<char> buffer(strlen(in) + 2);
-
-    for (size_t it = 0; it < in.GetLength(); ++it)
-    {
-        buffer[it] = in.GetAt(it);
-    }
-    CleanString(buffer.data(), out);
+    CleanString(in.c_str(), out);
 }
 
 void CleanString(const char* in, CString& out)
 {
-    out.Format("");
-    for (unsigned int it = 0; it < strlen(in); ++it)
+    std::string result;
+    result.reserve(strlen(in));
+    for (const char* it = in; *it != 0; ++it)
     {
-        if ((unsigned char)in[it] >= 32)
+        if ((unsigned char)(*it) >= 32)
         {
-            out.AppendFormat("%c", in[it]);
+            result.push_back(*it);
         }
     }
+    out.SetData(result);
 }
 
 CString SimplifyString(const CString& in)
@@ -1,5 +1,9 @@
 #include <PPPLib/Meteorology/WindDataBase.h>
 #include <SpectralEvaluation/GPSData.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <math.h>
 
 namespace Meteorology
@@ -122,6 +126,49 @@ void CWindDataBase::InsertWindField(const WindField& windField)
     }
 }
 
+void CWindDataBase::Merge(const CWindDataBase& other)
+{
+    if (other.m_dataBaseName.size() > 0)
+    {
+        m_dataBaseName = other.m_dataBaseName;
+    }
+
+    // The locations are inserted in the order they were first used in 'other'
+    std::vector<int> locationIndexInThis;
+    locationIndexInThis.reserve(other.m_locations.size());
+    for (const novac::CGPSData& location : other.m_locations)
+    {
+        locationIndexInThis.push_back(InsertLocation(location));
+    }
+
+    for (const WindInTime& otherTimeFrame : other.m_dataBase)
+    {
+        auto pos = std::find_if(
+            m_dataBase.begin(),
+            m_dataBase.end(),
+            [&](const WindInTime& t) { return t.validFrom == otherTimeFrame.validFrom && t.validTo == otherTimeFrame.validTo; });
+
+        if (pos == m_dataBase.end())
+        {
+            WindInTime t;
+            t.validFrom = otherTimeFrame.validFrom;
+            t.validTo = otherTimeFrame.validTo;
+            m_dataBase.push_back(t);
+            pos = std::prev(m_dataBase.end());
+        }
+
+        for (const WindData& otherData : otherTimeFrame.windData)
+        {
+            WindData data = otherData;
+            if (otherData.location >= 0)
+            {
+                data.location = locationIndexInThis[static_cast<size_t>(otherData.location)];
+            }
+            pos->windData.push_back(data);
+        }
+    }
+}
+
 /** Inserts a wind-direction into the database */
 void CWindDataBase::InsertWindDirection(const novac::CDateTime& validFrom, const novac::CDateTime& validTo, double wd, double wd_err, MeteorologySource wd_src, const novac::CGPSData* location)
 {
@@ -228,6 +275,251 @@ int CWindDataBase::WriteToFile(const novac::CString& fileName) const
     return 0;
 }
 
+// The binary files starts with this identifier followed by the version of the format.
+// The version must be increased whenever the layout of the file is changed.
+static const char binaryFileIdentifier[4] = { 'N', 'W', 'D', 'B' };
+static const std::uint32_t binaryFileVersion = 1;
+
+namespace
+{
+/** Appends values to a buffer which is written to the binary file in one go. */
+class BinaryWriter
+{
+public:
+    template<class T>
+    void Write(const T& value)
+    {
+        const char* pt = reinterpret_cast<const char*>(&value);
+        buffer.insert(buffer.end(), pt, pt + sizeof(T));
+    }
+
+    void Write(const std::string& value)
+    {
+        Write(static_cast<std::uint32_t>(value.size()));
+        buffer.insert(buffer.end(), value.begin(), value.end());
+    }
+
+    void Write(const novac::CDateTime& time)
+    {
+        Write(static_cast<std::int32_t>(time.year));
+        Write(static_cast<std::int32_t>(time.month));
+        Write(static_cast<std::int32_t>(time.day));
+        Write(static_cast<std::int32_t>(time.hour));
+        Write(static_cast<std::int32_t>(time.minute));
+        Write(static_cast<std::int32_t>(time.second));
+    }
+
+    std::vector<char> buffer;
+};
+
+/** Reads values from the contents of a binary file. All reads fail once the end of the data has been passed. */
+class BinaryReader
+{
+public:
+    BinaryReader(const std::vector<char>& data)
+        : m_data(data)
+    {
+    }
+
+    template<class T>
+    bool Read(T& value)
+    {
+        if (m_position + sizeof(T) > m_data.size())
+        {
+            return false;
+        }
+        memcpy(&value, m_data.data() + m_position, sizeof(T));
+        m_position += sizeof(T);
+        return true;
+    }
+
+    bool Read(std::string& value)
+    {
+        std::uint32_t length = 0;
+        if (!Read(length) || m_position + length > m_data.size())
+        {
+            return false;
+        }
+        value.assign(m_data.data() + m_position, length);
+        m_position += length;
+        return true;
+    }
+
+    bool Read(novac::CDateTime& time)
+    {
+        std::int32_t fields[6];
+        for (std::int32_t& field : fields)
+        {
+            if (!Read(field))
+            {
+                return false;
+            }
+        }
+        time = novac::CDateTime(fields[0], fields[1], fields[2], fields[3], fields[4], fields[5]);
+        return true;
+    }
+
+    bool IsAtEnd() const { return m_position == m_data.size(); }
+
+private:
+    const std::vector<char>& m_data;
+    size_t m_position = 0;
+};
+}
+
+bool CWindDataBase::WriteToBinaryFile(const std::string& fileName, std::uint64_t sourceHash) const
+{
+    BinaryWriter writer;
+    writer.buffer.insert(writer.buffer.end(), std::begin(binaryFileIdentifier), std::end(binaryFileIdentifier));
+    writer.Write(binaryFileVersion);
+    writer.Write(sourceHash);
+    writer.Write(m_dataBaseName);
+
+    writer.Write(static_cast<std::uint32_t>(m_locations.size()));
+    for (const novac::CGPSData& location : m_locations)
+    {
+        writer.Write(location.m_latitude);
+        writer.Write(location.m_longitude);
+        writer.Write(location.m_altitude);
+    }
+
+    writer.Write(static_cast<std::uint32_t>(m_dataBase.size()));
+    for (const WindInTime& time : m_dataBase)
+    {
+        writer.Write(time.validFrom);
+        writer.Write(time.validTo);
+        writer.Write(static_cast<std::uint32_t>(time.windData.size()));
+        for (const WindData& data : time.windData)
+        {
+            writer.Write(static_cast<std::int32_t>(data.location));
+            writer.Write(data.ws);
+            writer.Write(data.ws_err);
+            writer.Write(static_cast<std::int32_t>(data.ws_src));
+            writer.Write(data.wd);
+            writer.Write(data.wd_err);
+            writer.Write(static_cast<std::int32_t>(data.wd_src));
+        }
+    }
+
+    std::ofstream file(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    file.write(writer.buffer.data(), static_cast<std::streamsize>(writer.buffer.size()));
+
+    return file.good();
+}
+
+static bool IsValidMeteorologySource(std::int32_t source)
+{
+    return source >= 0 && source < static_cast<std::int32_t>(MeteorologySource::NumberOfSources);
+}
+
+bool CWindDataBase::ReadFromBinaryFile(const std::string& fileName, std::uint64_t sourceHash)
+{
+    // Read the whole file with one single read
+    std::ifstream file(fileName, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    const std::streamoff fileSize = file.tellg();
+    if (fileSize <= 0)
+    {
+        return false;
+    }
+    std::vector<char> data(static_cast<size_t>(fileSize));
+    file.seekg(0, std::ios::beg);
+    if (!file.read(data.data(), static_cast<std::streamsize>(data.size())))
+    {
+        return false;
+    }
+    BinaryReader reader{ data };
+
+    char identifier[4];
+    std::uint32_t version = 0;
+    std::uint64_t storedSourceHash = 0;
+    if (!reader.Read(identifier) || memcmp(identifier, binaryFileIdentifier, sizeof(identifier)) != 0 ||
+        !reader.Read(version) || version != binaryFileVersion ||
+        !reader.Read(storedSourceHash) || storedSourceHash != sourceHash)
+    {
+        return false;
+    }
+
+    // Read everything into a new database first, such that this is left unchanged if the file is corrupt.
+    CWindDataBase result;
+    if (!reader.Read(result.m_dataBaseName))
+    {
+        return false;
+    }
+
+    std::uint32_t locationNum = 0;
+    if (!reader.Read(locationNum))
+    {
+        return false;
+    }
+    for (std::uint32_t locationIdx = 0; locationIdx < locationNum; ++locationIdx)
+    {
+        novac::CGPSData location;
+        if (!reader.Read(location.m_latitude) || !reader.Read(location.m_longitude) || !reader.Read(location.m_altitude))
+        {
+            return false;
+        }
+        result.m_locations.push_back(location);
+    }
+
+    std::uint32_t timeFrameNum = 0;
+    if (!reader.Read(timeFrameNum))
+    {
+        return false;
+    }
+    for (std::uint32_t timeFrameIdx = 0; timeFrameIdx < timeFrameNum; ++timeFrameIdx)
+    {
+        WindInTime time;
+        std::uint32_t windDataNum = 0;
+        if (!reader.Read(time.validFrom) || !reader.Read(time.validTo) || !reader.Read(windDataNum))
+        {
+            return false;
+        }
+
+        for (std::uint32_t windDataIdx = 0; windDataIdx < windDataNum; ++windDataIdx)
+        {
+            WindData windData;
+            std::int32_t location = 0;
+            std::int32_t ws_src = 0;
+            std::int32_t wd_src = 0;
+            if (!reader.Read(location) ||
+                !reader.Read(windData.ws) || !reader.Read(windData.ws_err) || !reader.Read(ws_src) ||
+                !reader.Read(windData.wd) || !reader.Read(windData.wd_err) || !reader.Read(wd_src))
+            {
+                return false;
+            }
+            if (location < -1 || location >= static_cast<std::int32_t>(locationNum) || !IsValidMeteorologySource(ws_src) || !IsValidMeteorologySource(wd_src))
+            {
+                return false;
+            }
+            windData.location = location;
+            windData.ws_src = static_cast<MeteorologySource>(ws_src);
+            windData.wd_src = static_cast<MeteorologySource>(wd_src);
+            time.windData.push_back(windData);
+        }
+
+        result.m_dataBase.push_back(std::move(time));
+    }
+
+    if (!reader.IsAtEnd())
+    {
+        return false;
+    }
+
+    m_dataBaseName = std::move(result.m_dataBaseName);
+    m_locations = std::move(result.m_locations);
+    m_dataBase = std::move(result.m_dataBase);
+
+    return true;
+}
+
 const novac::CGPSData& CWindDataBase::GetLocation(int index) const
 {
     static const novac::CGPSData nullPos = novac::CGPSData(-1, -1, -1);
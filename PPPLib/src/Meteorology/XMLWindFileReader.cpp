@@ -3,14 +3,17 @@
 #include <PPPLib/Communication/FTPServerConnection.h>
 #include <PPPLib/File/Filesystem.h>
 #include <PPPLib/MFC/CFileUtils.h>
-#include <PPPLib/MFC/CList.h>
 #include <PPPLib/Logging.h>
+#include <PPPLib/ParallelFor.h>
 #include <SpectralEvaluation/Exceptions.h>
 #include <Poco/Glob.h>
 #include <Poco/Path.h>
 #include <string.h>
+#include <algorithm>
 #include <memory>
 #include <cmath>
+#include <fstream>
+#include <iterator>
 
 #ifndef MAX_PATH
 #define MAX_PATH 260
@@ -102,12 +105,77 @@ void CXMLWindFileReader::ReadWindFile(novac::LogContext context, const novac::CS
     Close();
 }
 
+bool CXMLWindFileReader::IsWindFileOutsideOfInterval(const std::string& fileName, const CDateTime* dateFrom, const CDateTime* dateTo)
+{
+    // only files with a name that matches XXXX_YYYYMMDD.wxml contains the date
+    const novac::CString name(fileName);
+    const int rpos = name.ReverseFind('_');
+    if (rpos <= 0 || ((name.GetLength() - rpos) != 14) || !Equals(name.Right(5), ".wxml"))
+    {
+        return false;
+    }
+
+    novac::CString dateStr(name.Right(13).Left(8));
+    CDateTime dayOfFile;
+    if (!CDateTime::ParseDate(dateStr, dayOfFile))
+    {
+        return false;
+    }
+
+    // The file contains the wind for the entire day.
+    if (dateFrom != nullptr)
+    {
+        const CDateTime firstDayToInclude(dateFrom->year, dateFrom->month, dateFrom->day, 0, 0, 0);
+        if (dayOfFile < firstDayToInclude)
+        {
+            return true;
+        }
+    }
+    if (dateTo != nullptr)
+    {
+        const CDateTime lastDayToInclude(dateTo->year, dateTo->month, dateTo->day, 0, 0, 0);
+        if (dayOfFile > lastDayToInclude)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/** @return a hash (FNV-1a) of the names and the contents of the given files,
+    used to identify the cached wind database of the files. */
+static std::uint64_t HashWindFiles(const std::vector<std::string>& fileNames)
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+    auto hashBytes = [&](const char* data, size_t length)
+    {
+        for (size_t ii = 0; ii < length; ++ii)
+        {
+            hash ^= static_cast<unsigned char>(data[ii]);
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    for (const std::string& fileName : fileNames)
+    {
+        hashBytes(fileName.c_str(), fileName.size() + 1);
+
+        std::ifstream file(fileName, std::ios::in | std::ios::binary);
+        const std::vector<char> contents{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+        const std::uint64_t length = contents.size();
+        hashBytes(contents.data(), contents.size());
+        hashBytes(reinterpret_cast<const char*>(&length), sizeof(length));
+    }
+
+    return hash;
+}
+
 void CXMLWindFileReader::ReadWindDirectory(novac::LogContext context, const novac::CString& directory, Meteorology::CWindDataBase& dataBase, const CDateTime* dateFrom, const CDateTime* dateTo)
 {
-    novac::CStdioFile file;
     novac::CString localFileName, remoteFileName, userMessage, ftpDir;
     std::vector<std::string> remoteFileList; // the list of wind field files
-    novac::CList <novac::CString, novac::CString&> localFileList; // the list of files on the local computer
+    std::vector<std::string> localFileList; // the list of files on the local computer
 
     if (Equals(directory.Left(6), "ftp://"))
     {
@@ -148,18 +216,9 @@ void CXMLWindFileReader::ReadWindDirectory(novac::LogContext context, const nova
 
             // if this file has a name that matches XXXX_YYYYMMDD.wxml then use this info to see 
             //	weather we actually should download this file
-            int rpos = name.ReverseFind('_');
-            if (rpos > 0 && ((name.GetLength() - rpos) == 14))
+            if (IsWindFileOutsideOfInterval(item, &m_userSettings.m_fromDate, &m_userSettings.m_toDate))
             {
-                novac::CString dateStr(name.Right(13).Left(8));
-                CDateTime t;
-                if (CDateTime::ParseDate(dateStr, t))
-                {
-                    if (t < m_userSettings.m_fromDate || t > m_userSettings.m_toDate)
-                    {
-                        continue;
-                    }
-                }
+                continue;
             }
 
             localFileName.Format("%s%s", (const char*)m_userSettings.m_tempDirectory, (const char*)name);
@@ -179,7 +238,7 @@ void CXMLWindFileReader::ReadWindDirectory(novac::LogContext context, const nova
                 }
             }
 
-            localFileList.AddTail(localFileName);
+            localFileList.push_back(localFileName.std_str());
         }
     }
     else
@@ -198,36 +257,77 @@ void CXMLWindFileReader::ReadWindDirectory(novac::LogContext context, const nova
             throw std::invalid_argument("No wind files found");
         }
 
+        // Only read the files which can contain wind fields in the requested interval
         for (const std::string& fName : filesFound)
         {
-            localFileList.AddTail(fName);
+            if (!IsWindFileOutsideOfInterval(fName, dateFrom, dateTo))
+            {
+                localFileList.push_back(fName);
+            }
         }
+
+        userMessage.Format("%d of %d wind files are in the requested time range", static_cast<int>(localFileList.size()), static_cast<int>(filesFound.size()));
+        m_log.Information(context, userMessage.std_str());
     }
 
-    // Now we got a list of files on the local computer. Read them in!
-    auto p = localFileList.GetHeadPosition();
-    int nFilesRead = 0;
-    while (p != nullptr)
+    // If exactly these files have been read before, then the result can be read from the cache in the temp directory.
+    //  The name of the cache file contains the hash, such that the wind fields of several directories
+    //  (e.g. the alternative wind fields of the flux sensitivity mode) can be cached at the same time.
+    std::string cacheFileName;
+    std::uint64_t sourceHash = 0;
+    if (m_userSettings.m_tempDirectory.GetLength() > 0 && localFileList.size() > 0)
     {
-        localFileName.Format("%s", (const char*)localFileList.GetNext(p));
+        sourceHash = HashWindFiles(localFileList);
+        cacheFileName = Filesystem::AppendPathSeparator(m_userSettings.m_tempDirectory).std_str() +
+            novac::CString::FormatString("WindDataBase_%016llx.bin", static_cast<unsigned long long>(sourceHash)).std_str();
 
-        // make sure that this file falls in the appropriate date-range
-        if (dateFrom != nullptr)
+        Meteorology::CWindDataBase cachedDataBase;
+        if (cachedDataBase.ReadFromBinaryFile(cacheFileName, sourceHash))
         {
+            dataBase.Merge(cachedDataBase);
 
+            userMessage.Format("Read the wind field of %d wind field files from cache", static_cast<int>(localFileList.size()));
+            m_log.Information(context, userMessage.std_str());
+            return;
         }
-        if (dateTo != nullptr)
-        {
+    }
 
-        }
+    // Now we got a list of files on the local computer. Read them in, in parallel, each file into its own database.
+    std::vector<Meteorology::CWindDataBase> partialDataBases(localFileList.size());
+    std::vector<char> fileWasRead(localFileList.size(), 0);
+    novac::ParallelFor(localFileList.size(), m_userSettings.m_maxThreadNum, [&](size_t fileIdx)
+        {
+            try
+            {
+                CXMLWindFileReader reader{ m_log, m_userSettings };
+                reader.ReadWindFile(context, localFileList[fileIdx], partialDataBases[fileIdx]);
+                fileWasRead[fileIdx] = 1;
+            }
+            catch (const std::exception& e)
+            {
+                ShowMessage(e.what());
+            }
+        });
 
-        try
+    // Merge the result, in the same order as the files were found.
+    Meteorology::CWindDataBase readDataBase;
+    int nFilesRead = 0;
+    for (size_t fileIdx = 0; fileIdx < localFileList.size(); ++fileIdx)
+    {
+        if (fileWasRead[fileIdx])
         {
-            ReadWindFile(context, localFileName, dataBase);
+            readDataBase.Merge(partialDataBases[fileIdx]);
+            ++nFilesRead;
         }
-        catch (const std::exception& e)
+    }
+    dataBase.Merge(readDataBase);
+
+    // Only cache the result if all the files could be read, such that failing files are attempted again the next time.
+    if (cacheFileName.size() > 0 && nFilesRead == static_cast<int>(localFileList.size()))
+    {
+        if (!readDataBase.WriteToBinaryFile(cacheFileName, sourceHash))
         {
-            ShowMessage(e.what());
+            m_log.Information(context, "Failed to write wind field cache file: " + cacheFileName);
         }
     }
 
@@ -0,0 +1,38 @@
+#include <PPPLib/ParallelFor.h>
+#include <mutex>
+
+namespace novac
+{
+
+static std::mutex s_threadBudgetGuard;
+static unsigned long s_maxThreadNum = 0; // zero means no limit
+static size_t s_reservedThreadNum = 0;
+
+void CThreadBudget::SetMaxThreadNum(unsigned long maxThreadNum)
+{
+    std::lock_guard<std::mutex> lock(s_threadBudgetGuard);
+    s_maxThreadNum = maxThreadNum;
+}
+
+size_t CThreadBudget::Reserve(size_t threadNum)
+{
+    std::lock_guard<std::mutex> lock(s_threadBudgetGuard);
+
+    if (s_maxThreadNum > 0)
+    {
+        // The main thread is always running and is not part of what can be reserved.
+        const size_t availableThreadNum = (s_maxThreadNum - 1 > s_reservedThreadNum) ? (s_maxThreadNum - 1 - s_reservedThreadNum) : 0;
+        threadNum = std::min(threadNum, availableThreadNum);
+    }
+
+    s_reservedThreadNum += threadNum;
+    return threadNum;
+}
+
+void CThreadBudget::Release(size_t threadNum)
+{
+    std::lock_guard<std::mutex> lock(s_threadBudgetGuard);
+    s_reservedThreadNum -= std::min(threadNum, s_reservedThreadNum);
+}
+
+}
@@ -1,95 +1,198 @@
 #include <PPPLib/PostProcessingStatistics.h>
-#include <PPPLib/MFC/CCriticalSection.h>
-#include <PPPLib/MFC/CSingleLock.h>
 #include <PPPLib/File/Filesystem.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <string>
 
-novac::CCriticalSection g_processingStatCritSect; // synchronization access to the processing statistics
+namespace
+{
+/** Gives each instance of CPostProcessingStatistics, and each thread, a unique id. */
+std::atomic<std::uint64_t> s_nextStatisticsInstanceId{ 1 };
+std::atomic<std::uint64_t> s_nextStatisticsThreadId{ 1 };
 
-void CPostProcessingStatistics::InsertRejection(const novac::CString& serial, ReasonForScanRejection reason)
+/** Keeps track of the order in which the instruments are first inserted, over all threads. */
+std::atomic<std::uint64_t> s_nextInsertionOrder{ 1 };
+
+std::uint64_t GetIdOfThisThread()
+{
+    thread_local const std::uint64_t threadId = s_nextStatisticsThreadId.fetch_add(1);
+    return threadId;
+}
+
+/** The serials are compared without regard to case, hence the instruments are keyed by the lower case serial. */
+std::string GetInstrumentKey(const novac::CString& serial)
+{
+    std::string key = serial.std_str();
+    std::transform(key.begin(), key.end(), key.begin(), [](char c) { return static_cast<char>(::tolower(static_cast<unsigned char>(c))); });
+    return key;
+}
+
+/** Increments a counter which only the calling thread writes to, hence no atomic read-modify-write is necessary. */
+void Increment(std::atomic<unsigned long>& counter)
 {
-    novac::CSingleLock singleLock(&g_processingStatCritSect);
-    singleLock.Lock();
-    if (singleLock.IsLocked())
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+/** The counters of one instrument in one shard */
+struct CShardInstrumentStats
+{
+    CShardInstrumentStats(const novac::CString& instrumentSerial, std::uint64_t order)
+        : serial(instrumentSerial), insertionOrder(order)
     {
+    }
 
-        // look for the correct instrument
-        std::list <CInstrumentStats>::const_iterator pos = m_instrumentStats.begin();
-        while (pos != m_instrumentStats.end())
-        {
-            CInstrumentStats& stat = (CInstrumentStats&)*(pos++);
+    const novac::CString serial;
+    const std::uint64_t insertionOrder;
+    std::atomic<unsigned long> acceptedScans{ 0 };
+    std::atomic<unsigned long> noPlumeNum{ 0 };
+    std::atomic<unsigned long> lowCompletenessNum{ 0 };
+    std::atomic<unsigned long> darkSkySpecNum{ 0 };
+    std::atomic<unsigned long> saturatedSkySpecNum{ 0 };
+    std::atomic<unsigned long> tooLongExpTime{ 0 };
+};
+}
 
-            // this is the instrument. Insert the new data
-            if (Equals(stat.serial, serial))
-            {
-                switch (reason)
-                {
-                case ReasonForScanRejection::SkySpectrumSaturated:       ++stat.saturatedSkySpecNum; return;
-                case ReasonForScanRejection::SkySpectrumDark:             ++stat.darkSkySpecNum; return;
-                case ReasonForScanRejection::SkySpectrumTooLongExposureTime: ++stat.tooLongExpTime; return;
-                case ReasonForScanRejection::CompletenessLow:          ++stat.lowCompletenessNum; return;
-                case ReasonForScanRejection::NoPlume:                  ++stat.noPlumeNum; return;
-                };
-            }
+/** The statistics inserted by one thread. Only the owning thread writes to the counters,
+    other threads only read them when the shards are merged. */
+class CPostProcessingStatistics::CStatisticsShard
+{
+public:
+    /** Taken by the owning thread when adding a new instrument and by the thread merging the shards. */
+    std::mutex instrumentsGuard;
+    std::unordered_map<std::string, CShardInstrumentStats> instruments;
+
+    std::atomic<unsigned long> nSpectraEvaluated{ 0 };
+    std::atomic<double> timeSpentOnEvaluations{ 0.0 };
+
+    CShardInstrumentStats& GetInstrument(const novac::CString& serial)
+    {
+        const std::string key = GetInstrumentKey(serial);
+
+        // Only this thread adds instruments, hence the lookup needs no lock.
+        auto pos = instruments.find(key);
+        if (pos != instruments.end())
+        {
+            return pos->second;
         }
 
-        // If the instrument is not in the list then insert it!!
-        CInstrumentStats stat;
-        stat.serial.Format(serial);
-        switch (reason)
+        std::lock_guard<std::mutex> lock(instrumentsGuard);
+        pos = instruments.emplace(std::piecewise_construct,
+            std::forward_as_tuple(key),
+            std::forward_as_tuple(serial, s_nextInsertionOrder.fetch_add(1))).first;
+        return pos->second;
+    }
+};
+
+CPostProcessingStatistics::CPostProcessingStatistics()
+    : m_instanceId(s_nextStatisticsInstanceId.fetch_add(1))
+{
+}
+
+CPostProcessingStatistics::~CPostProcessingStatistics() = default;
+
+CPostProcessingStatistics::CStatisticsShard& CPostProcessingStatistics::GetShardOfThisThread()
+{
+    // The shard last used by this thread. The instance ids are never reused, hence this cannot refer to a destroyed instance.
+    struct CachedShard
+    {
+        std::uint64_t instanceId = 0;
+        CStatisticsShard* shard = nullptr;
+    };
+    thread_local CachedShard cachedShard;
+
+    if (cachedShard.instanceId != m_instanceId)
+    {
+        std::lock_guard<std::mutex> lock(m_shardsGuard);
+        std::unique_ptr<CStatisticsShard>& shard = m_shards[GetIdOfThisThread()];
+        if (shard == nullptr)
         {
-        case ReasonForScanRejection::SkySpectrumSaturated:       ++stat.saturatedSkySpecNum; break;
-        case ReasonForScanRejection::SkySpectrumDark:             ++stat.darkSkySpecNum; break;
-        case ReasonForScanRejection::SkySpectrumTooLongExposureTime: ++stat.tooLongExpTime; break;
-        case ReasonForScanRejection::CompletenessLow:          ++stat.lowCompletenessNum; break;
-        case ReasonForScanRejection::NoPlume:                  ++stat.noPlumeNum; break;
-        };
-        m_instrumentStats.push_back(stat);
+            shard.reset(new CStatisticsShard());
+        }
+        cachedShard.instanceId = m_instanceId;
+        cachedShard.shard = shard.get();
     }
 
-    singleLock.Unlock();
+    return *cachedShard.shard;
 }
 
-void CPostProcessingStatistics::InsertAcception(const novac::CString& serial)
+void CPostProcessingStatistics::InsertRejection(const novac::CString& serial, ReasonForScanRejection reason)
 {
+    CShardInstrumentStats& stat = GetShardOfThisThread().GetInstrument(serial);
 
-    novac::CSingleLock singleLock(&g_processingStatCritSect);
-    singleLock.Lock();
-    if (singleLock.IsLocked())
+    switch (reason)
     {
+    case ReasonForScanRejection::SkySpectrumSaturated:       Increment(stat.saturatedSkySpecNum); return;
+    case ReasonForScanRejection::SkySpectrumDark:             Increment(stat.darkSkySpecNum); return;
+    case ReasonForScanRejection::SkySpectrumTooLongExposureTime: Increment(stat.tooLongExpTime); return;
+    case ReasonForScanRejection::CompletenessLow:          Increment(stat.lowCompletenessNum); return;
+    case ReasonForScanRejection::NoPlume:                  Increment(stat.noPlumeNum); return;
+    };
+}
 
-        // look for the correct instrument
-        std::list<CInstrumentStats>::const_iterator pos = m_instrumentStats.begin();
-        while (pos != m_instrumentStats.end())
+void CPostProcessingStatistics::InsertAcception(const novac::CString& serial)
+{
+    CShardInstrumentStats& stat = GetShardOfThisThread().GetInstrument(serial);
+    Increment(stat.acceptedScans);
+}
+
+std::vector<CPostProcessingStatistics::CInstrumentStats> CPostProcessingStatistics::MergeInstrumentStats()
+{
+    std::unordered_map<std::string, CInstrumentStats> merged;
+
+    {
+        std::lock_guard<std::mutex> lock(m_shardsGuard);
+        for (const auto& shardPos : m_shards)
         {
-            CInstrumentStats& stat = (CInstrumentStats&)*(pos++);
+            CStatisticsShard& shard = *shardPos.second;
+            std::lock_guard<std::mutex> instrumentsLock(shard.instrumentsGuard);
 
-            // this is the instrument. Insert the new data
-            if (Equals(stat.serial, serial))
+            for (const auto& instrumentPos : shard.instruments)
             {
-                ++stat.acceptedScans;
-                singleLock.Unlock();
-                return;
+                const CShardInstrumentStats& stat = instrumentPos.second;
+
+                auto mergedPos = merged.find(instrumentPos.first);
+                if (mergedPos == merged.end())
+                {
+                    CInstrumentStats newStat;
+                    newStat.serial = stat.serial;
+                    newStat.insertionOrder = stat.insertionOrder;
+                    mergedPos = merged.emplace(instrumentPos.first, newStat).first;
+                }
+                CInstrumentStats& instr = mergedPos->second;
+
+                // The serial is written as it was first inserted
+                if (stat.insertionOrder < instr.insertionOrder)
+                {
+                    instr.serial = stat.serial;
+                    instr.insertionOrder = stat.insertionOrder;
+                }
+
+                instr.acceptedScans += stat.acceptedScans.load(std::memory_order_relaxed);
+                instr.noPlumeNum += stat.noPlumeNum.load(std::memory_order_relaxed);
+                instr.lowCompletenessNum += stat.lowCompletenessNum.load(std::memory_order_relaxed);
+                instr.darkSkySpecNum += stat.darkSkySpecNum.load(std::memory_order_relaxed);
+                instr.saturatedSkySpecNum += stat.saturatedSkySpecNum.load(std::memory_order_relaxed);
+                instr.tooLongExpTime += stat.tooLongExpTime.load(std::memory_order_relaxed);
             }
         }
+    }
 
-        // If the instrument is not in the list then insert it!!
-        CInstrumentStats stat;
-        stat.serial.Format(serial);
-        ++stat.acceptedScans;
-        m_instrumentStats.push_back(stat);
+    std::vector<CInstrumentStats> result;
+    result.reserve(merged.size());
+    for (const auto& pos : merged)
+    {
+        result.push_back(pos.second);
     }
+    std::sort(result.begin(), result.end(), [](const CInstrumentStats& first, const CInstrumentStats& second) { return first.insertionOrder < second.insertionOrder; });
 
-    singleLock.Unlock();
+    return result;
 }
 
 unsigned long CPostProcessingStatistics::GetRejectionNum(const novac::CString& serial, ReasonForScanRejection reason)
 {
-    // look for the correct instrument
-    std::list<CInstrumentStats>::const_iterator pos = m_instrumentStats.begin();
-    while (pos != m_instrumentStats.end())
+    for (const CInstrumentStats& stat : MergeInstrumentStats())
     {
-        CInstrumentStats& stat = (CInstrumentStats&)*(pos++);
-
         // this is the instrument. Retrieve the data
         if (Equals(stat.serial, serial))
         {
@@ -110,12 +213,8 @@ unsigned long CPostProcessingStatistics::GetRejectionNum(const novac::CString& s
 
 unsigned long CPostProcessingStatistics::GetAcceptionNum(const novac::CString& serial)
 {
-    // look for the correct instrument
-    std::list<CInstrumentStats>::const_iterator pos = m_instrumentStats.begin();
-    while (pos != m_instrumentStats.end())
+    for (const CInstrumentStats& stat : MergeInstrumentStats())
     {
-        CInstrumentStats& stat = (CInstrumentStats&)*(pos++);
-
         // this is the instrument. Retrieve the data
         if (Equals(stat.serial, serial))
         {
@@ -130,56 +229,58 @@ unsigned long CPostProcessingStatistics::GetAcceptionNum(const novac::CString& s
 
 void CPostProcessingStatistics::InsertEvaluatedSpectrum(double timeUsed)
 {
-    ++nSpectraEvaluated;
-    timeSpentOnEvaluations += timeUsed;
+    CStatisticsShard& shard = GetShardOfThisThread();
+    Increment(shard.nSpectraEvaluated);
+    shard.timeSpentOnEvaluations.store(shard.timeSpentOnEvaluations.load(std::memory_order_relaxed) + timeUsed, std::memory_order_relaxed);
 }
 
 void CPostProcessingStatistics::WriteStatToFile(const novac::CString& file)
 {
-    novac::CSingleLock singleLock(&g_processingStatCritSect);
-    singleLock.Lock();
-    if (singleLock.IsLocked())
-    {
+    const std::vector<CInstrumentStats> instrumentStats = MergeInstrumentStats();
 
-        // open the file
-        FILE* f = NULL;
-        if (Filesystem::IsExistingFile(file))
-        {
-            f = fopen(file, "a");
-        }
-        else
-        {
-            f = fopen(file, "w");
-        }
-        if (f == NULL)
-        {
-            singleLock.Unlock();
-            return;
-        }
-
-        // for each instrument processed, write the info we have on it...
-        std::list <CInstrumentStats>::const_iterator pos = m_instrumentStats.begin();
-        while (pos != m_instrumentStats.end())
+    unsigned long nSpectraEvaluated = 0;
+    double timeSpentOnEvaluations = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_shardsGuard);
+        for (const auto& shardPos : m_shards)
         {
-            CInstrumentStats& instr = (CInstrumentStats&)*(pos++);
-
-            fprintf(f, "Instrument: %s\n", (const char*)instr.serial);
-            fprintf(f, "\t#Accepted scans: %lu\n", instr.acceptedScans);
-            fprintf(f, "\t#Rejected scans:\n");
-            fprintf(f, "\t\t%lu due to too long exposure time\n", instr.tooLongExpTime);
-            fprintf(f, "\t\t%lu due to saturated sky spectrum\n", instr.saturatedSkySpecNum);
-            fprintf(f, "\t\t%lu due to too dark sky spectrum\n", instr.darkSkySpecNum);
-            fprintf(f, "\t\t%lu due to no plume seen\n", instr.noPlumeNum);
-            fprintf(f, "\t\t%lu due to too low completeness\n", instr.lowCompletenessNum);
+            nSpectraEvaluated += shardPos.second->nSpectraEvaluated.load(std::memory_order_relaxed);
+            timeSpentOnEvaluations += shardPos.second->timeSpentOnEvaluations.load(std::memory_order_relaxed);
         }
+    }
 
-        // The timings...
-        fprintf(f, "Total Number of Spectra evaluated: %lu\n", nSpectraEvaluated);
-        fprintf(f, "Total Time spent on evaluating spectra: %.2lf [s] ( %.2lf mseconds / spectrum)\n", timeSpentOnEvaluations / 1000.0, timeSpentOnEvaluations / (double)nSpectraEvaluated);
+    // open the file
+    FILE* f = NULL;
+    if (Filesystem::IsExistingFile(file))
+    {
+        f = fopen(file, "a");
+    }
+    else
+    {
+        f = fopen(file, "w");
+    }
+    if (f == NULL)
+    {
+        return;
+    }
 
-        // remember to close the file
-        fclose(f);
+    // for each instrument processed, write the info we have on it...
+    for (const CInstrumentStats& instr : instrumentStats)
+    {
+        fprintf(f, "Instrument: %s\n", (const char*)instr.serial);
+        fprintf(f, "\t#Accepted scans: %lu\n", instr.acceptedScans);
+        fprintf(f, "\t#Rejected scans:\n");
+        fprintf(f, "\t\t%lu due to too long exposure time\n", instr.tooLongExpTime);
+        fprintf(f, "\t\t%lu due to saturated sky spectrum\n", instr.saturatedSkySpecNum);
+        fprintf(f, "\t\t%lu due to too dark sky spectrum\n", instr.darkSkySpecNum);
+        fprintf(f, "\t\t%lu due to no plume seen\n", instr.noPlumeNum);
+        fprintf(f, "\t\t%lu due to too low completeness\n", instr.lowCompletenessNum);
     }
 
-    singleLock.Unlock();
+    // The timings...
+    fprintf(f, "Total Number of Spectra evaluated: %lu\n", nSpectraEvaluated);
+    fprintf(f, "Total Time spent on evaluating spectra: %.2lf [s] ( %.2lf mseconds / spectrum)\n", timeSpentOnEvaluations / 1000.0, timeSpentOnEvaluations / (double)nSpectraEvaluated);
+
+    // remember to close the file
+    fclose(f);
 }
@@ -3,11 +3,11 @@
 #include <SpectralEvaluation/File/File.h>
 #include <SpectralEvaluation/Evaluation/FitWindow.h>
 #include <SpectralEvaluation/VectorUtils.h>
-#include <PPPLib/Configuration/NovacPPPConfiguration.h>
 
 #include <PPPLib/File/Filesystem.h>
 
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 
@@ -66,60 +66,13 @@ static void ConvolveReference(novac::ILogger& logger, novac::LogContext context,
     }
 
     // Save the resulting reference, for reference...
+    //  The fit windows are read by several threads and the file is named after the instrument and specie only.
+    static std::mutex tempFileGuard;
+    std::lock_guard<std::mutex> lock(tempFileGuard);
     SaveCrossSectionFile(tempFilePath, *ref.m_data);
 }
 
 
-void PrepareEvaluation(novac::ILogger& logger, std::string tempDirectory, Configuration::CNovacPPPConfiguration& setup)
-{
-    logger.Information("--- Reading References --- ");
-
-    if (setup.m_instrument.size() == 0)
-    {
-        throw std::invalid_argument("No instruments were configured.");
-    }
-
-    novac::LogContext context;
-
-    directorySetup directories;
-    directories.tempDirectory = tempDirectory;
-    directories.executableDirectory = setup.m_executableDirectory;
-
-    // this is true if we failed to prepare the evaluation...
-    bool failure = false;
-
-    // Loop through each of the configured instruments
-    for (size_t instrumentIndex = 0; instrumentIndex < setup.m_instrument.size(); ++instrumentIndex)
-    {
-        auto instrumentContext = context.With(novac::LogContext::Device, setup.m_instrument[instrumentIndex].m_serial.std_str());
-
-        // For each instrument, loop through the fit-windows that are defined
-        const size_t numberOfFitWindows = setup.m_instrument[instrumentIndex].m_eval.NumberOfFitWindows();
-        for (size_t fitWindowIndex = 0; fitWindowIndex < numberOfFitWindows; ++fitWindowIndex)
-        {
-            novac::CFitWindow window;
-            CDateTime fromTime, toTime; //  these are not used but must be passed onto GetFitWindow...
-            if (setup.m_instrument[instrumentIndex].m_eval.GetFitWindow(fitWindowIndex, window, fromTime, toTime))
-            {
-                logger.Error(instrumentContext, "Failed to get fit window from configuration.");
-                failure = true;
-                continue;
-            }
-
-            PrepareFitWindow(logger, instrumentContext, setup.m_instrument[instrumentIndex].m_serial.std_str(), window, directories);
-
-            // If we've made it this far, then we've managed to read in all the references.
-            // Now store the data in setup
-            setup.m_instrument[instrumentIndex].m_eval.SetFitWindow(fitWindowIndex, window, fromTime, toTime);
-        }
-    }
-
-    if (failure)
-    {
-        throw std::invalid_argument("failed to setup evaluation");
-    }
-}
-
 void PrepareFitWindow(novac::ILogger& logger, novac::LogContext& instrumentContext, const std::string& instrumentSerial, novac::CFitWindow& window, const directorySetup& setup)
 {
     auto windowContext = instrumentContext.With(novac::LogContext::FitWindow, window.name);
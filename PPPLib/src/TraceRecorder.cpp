@@ -0,0 +1,212 @@
+#include <PPPLib/TraceRecorder.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace novac
+{
+
+namespace
+{
+struct TraceEvent
+{
+    const char* category;
+    const char* name;
+    std::string detail;
+
+    // The start time and duration, in microseconds. The start time is relative to the call to CTraceRecorder::Start.
+    std::int64_t start;
+    std::int64_t duration;
+};
+
+/** The events recorded by one thread. Only the owning thread adds events to the buffer. */
+struct ThreadTraceBuffer
+{
+    explicit ThreadTraceBuffer(size_t id)
+        : threadId(id)
+    {
+    }
+
+    const size_t threadId;
+    std::vector<TraceEvent> events;
+};
+
+std::atomic<bool> s_traceEnabled{ false };
+CTraceRecorder::TimePoint s_traceOrigin;
+
+// The buffers of all threads which have recorded events. The buffers are never removed,
+//  such that each thread can keep a pointer to its own buffer.
+std::mutex s_traceBuffersGuard;
+std::vector<std::unique_ptr<ThreadTraceBuffer>> s_traceBuffers;
+
+/** @return the buffer of the calling thread. The lock is only taken the first time a thread records an event. */
+ThreadTraceBuffer& GetBufferOfThisThread()
+{
+    thread_local ThreadTraceBuffer* buffer = nullptr;
+
+    if (buffer == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(s_traceBuffersGuard);
+        s_traceBuffers.push_back(std::unique_ptr<ThreadTraceBuffer>(new ThreadTraceBuffer(s_traceBuffers.size() + 1)));
+        buffer = s_traceBuffers.back().get();
+    }
+
+    return *buffer;
+}
+
+std::int64_t MicrosecondsSinceOrigin(CTraceRecorder::TimePoint time)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(time - s_traceOrigin).count();
+}
+
+/** Writes the string as a JSON string, surrounded by quotes */
+void WriteJsonString(FILE* f, const std::string& str)
+{
+    fputc('"', f);
+    for (char c : str)
+    {
+        if (c == '"' || c == '\\')
+        {
+            fputc('\\', f);
+            fputc(c, f);
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            fprintf(f, "\\u%04x", static_cast<unsigned int>(c));
+        }
+        else
+        {
+            fputc(c, f);
+        }
+    }
+    fputc('"', f);
+}
+}
+
+void CTraceRecorder::Start()
+{
+    {
+        std::lock_guard<std::mutex> lock(s_traceBuffersGuard);
+        for (auto& buffer : s_traceBuffers)
+        {
+            buffer->events.clear();
+        }
+        s_traceOrigin = std::chrono::steady_clock::now();
+    }
+    s_traceEnabled.store(true, std::memory_order_release);
+}
+
+void CTraceRecorder::Stop()
+{
+    s_traceEnabled.store(false, std::memory_order_release);
+}
+
+bool CTraceRecorder::IsEnabled()
+{
+    return s_traceEnabled.load(std::memory_order_acquire);
+}
+
+void CTraceRecorder::Record(const char* category, const char* name, const std::string& detail, TimePoint start, TimePoint stop)
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+
+    TraceEvent event;
+    event.category = category;
+    event.name = name;
+    event.detail = detail;
+    event.start = MicrosecondsSinceOrigin(start);
+    event.duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+
+    GetBufferOfThisThread().events.push_back(std::move(event));
+}
+
+size_t CTraceRecorder::EventCount()
+{
+    std::lock_guard<std::mutex> lock(s_traceBuffersGuard);
+
+    size_t count = 0;
+    for (const auto& buffer : s_traceBuffers)
+    {
+        count += buffer->events.size();
+    }
+    return count;
+}
+
+bool CTraceRecorder::WriteToFile(const std::string& fileName)
+{
+    FILE* f = fopen(fileName.c_str(), "w");
+    if (f == nullptr)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(s_traceBuffersGuard);
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool firstEvent = true;
+    for (const auto& buffer : s_traceBuffers)
+    {
+        for (const TraceEvent& event : buffer->events)
+        {
+            if (!firstEvent)
+            {
+                fprintf(f, ",\n");
+            }
+            firstEvent = false;
+
+            fprintf(f, "{\"name\":");
+            WriteJsonString(f, event.name);
+            fprintf(f, ",\"cat\":");
+            WriteJsonString(f, event.category);
+            fprintf(f, ",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":%u",
+                static_cast<long long>(event.start), static_cast<long long>(event.duration), static_cast<unsigned int>(buffer->threadId));
+            if (event.detail.size() > 0)
+            {
+                fprintf(f, ",\"args\":{\"detail\":");
+                WriteJsonString(f, event.detail);
+                fprintf(f, "}");
+            }
+            fprintf(f, "}");
+        }
+    }
+    fprintf(f, "\n]}\n");
+
+    const bool successfullyWritten = (0 == ferror(f));
+    fclose(f);
+    return successfullyWritten;
+}
+
+CTraceScope::CTraceScope(const char* category, const char* name)
+    : m_category(category), m_name(name), m_enabled(CTraceRecorder::IsEnabled())
+{
+    if (m_enabled)
+    {
+        m_start = std::chrono::steady_clock::now();
+    }
+}
+
+CTraceScope::CTraceScope(const char* category, const char* name, const std::string& detail)
+    : m_category(category), m_name(name), m_enabled(CTraceRecorder::IsEnabled())
+{
+    if (m_enabled)
+    {
+        m_detail = detail;
+        m_start = std::chrono::steady_clock::now();
+    }
+}
+
+CTraceScope::~CTraceScope()
+{
+    if (m_enabled)
+    {
+        CTraceRecorder::Record(m_category, m_name, m_detail, m_start, std::chrono::steady_clock::now());
+    }
+}
+
+}
@@ -0,0 +1,771 @@
+#include "ScanGenerator.h"
+#include <PPPLib/Configuration/NovacPPPConfiguration.h>
+#include <PPPLib/Configuration/UserConfiguration.h>
+#include <PPPLib/File/EvaluationConfigurationParser.h>
+#include <PPPLib/File/Filesystem.h>
+#include <PPPLib/File/PakFileWriter.h>
+#include <PPPLib/File/ProcessingFileReader.h>
+#include <PPPLib/File/SetupFileReader.h>
+#include <PPPLib/Meteorology/WindDataBase.h>
+#include <PPPLib/VolcanoInfo.h>
+#include <SpectralEvaluation/Evaluation/FitWindow.h>
+#include <SpectralEvaluation/GPSData.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#undef min
+#undef max
+
+extern novac::CVolcanoInfo g_volcanoes;   // <-- A list of all known volcanoes
+
+namespace ScanGenerator
+{
+
+static const double pi = 3.14159265358979323846;
+static const double degreeToRadian = pi / 180.0;
+
+/** The properties of the simulated spectrometer, a S2000 with a linear wavelength calibration */
+static const int spectrumLength = 2048;
+static const double firstWavelength = 280.0;
+static const double wavelengthStep = 0.1;
+static const int maximumIntensity = 4095;
+
+/** The number of spectra in each scan, including the sky and the dark spectra, and the angles of the scan */
+static const int scanSpectrumNum = 53;
+static const double firstScanAngle = -90.0;
+static const double lastScanAngle = 90.0;
+
+/** The exposure of the spectra in the scans and in the wind measurements */
+static const int scanCoAdds = 15;
+static const int windCoAdds = 5;
+static const int exposureTime = 200;
+
+/** The number of photo-electrons giving one count, determines the photon noise of the spectra */
+static const double electronsPerCount = 5.0;
+
+/** The time it takes to collect one spectrum in a scan, including the movement of the mirror, in seconds */
+static const int scanSpectrumSeconds = 4;
+
+/** The angular separation of the two beams of the dual-beam instruments, in radians */
+static const double beamSeparation = 0.08;
+
+/** The name of the evaluated fit window and the fit region, in pixels */
+static const char* const fitWindowName = "SO2";
+static const int fitLow = 300;
+static const int fitHigh = 450;
+
+struct SyntheticInstrument
+{
+    std::string serial;
+    Configuration::CInstrumentLocation location;
+
+    /** The position of the instrument relative to the summit, in meters to the east and to the north */
+    double east = 0.0;
+    double north = 0.0;
+
+    bool dualBeam = false;
+};
+
+/** The wind and the emission at one point in time */
+struct PlumeState
+{
+    double windSpeed = 0.0;
+    double windDirection = 0.0;
+
+    /** The vertical column at the centre of the plume, in molecules / cm2 */
+    double column = 0.0;
+};
+
+/** Models the spectra measured by the instruments: a sky spectrum with a cut-off in the UV and
+    Fraunhofer lines, absorption by SO2, the dark current and the photon noise. */
+class CSpectrumModel
+{
+public:
+    CSpectrumModel()
+        : m_sky(spectrumLength), m_crossSection(spectrumLength), m_dark(spectrumLength)
+    {
+        // The Fraunhofer lines are the same in every run, hence these do not use the seed of the settings.
+        std::mt19937 lineGenerator{ 4711 };
+        std::uniform_real_distribution<double> lineWavelength{ firstWavelength, Wavelength(spectrumLength - 1) };
+        std::uniform_real_distribution<double> lineDepth{ 0.05, 0.4 };
+        std::uniform_real_distribution<double> lineWidth{ 0.05, 0.3 };
+        std::vector<double> lineCentre(300), lineStrength(300), lineSigma(300);
+        for (size_t k = 0; k < lineCentre.size(); ++k)
+        {
+            lineCentre[k] = lineWavelength(lineGenerator);
+            lineStrength[k] = lineDepth(lineGenerator);
+            lineSigma[k] = lineWidth(lineGenerator);
+        }
+
+        double largestValue = 0.0;
+        for (int pixel = 0; pixel < spectrumLength; ++pixel)
+        {
+            const double lambda = Wavelength(pixel);
+            const size_t idx = static_cast<size_t>(pixel);
+
+            // The ozone absorption cuts the sky light below ~310 nm and the sensitivity of the spectrometer falls off in the visible.
+            double intensity = std::exp(-std::pow((lambda - 360.0) / 90.0, 2)) / (1.0 + std::exp(-(lambda - 310.0) / 3.0));
+            for (size_t k = 0; k < lineCentre.size(); ++k)
+            {
+                intensity *= 1.0 - lineStrength[k] * std::exp(-0.5 * std::pow((lambda - lineCentre[k]) / lineSigma[k], 2));
+            }
+            m_sky[idx] = intensity;
+            largestValue = std::max(largestValue, intensity);
+
+            // The SO2 bands, decreasing in strength towards longer wavelengths
+            const double bandLambda = std::max(lambda, 285.0);
+            m_crossSection[idx] = 3.0e-19 * std::exp(-(bandLambda - 290.0) / 12.0) * (0.55 + 0.45 * std::cos(2.0 * pi * (bandLambda - 300.5) / 2.1));
+
+            // The dark current of one spectrum, with a small fixed pattern
+            m_dark[idx] = 350.0 + 20.0 * std::sin(0.37 * pixel) * std::cos(0.011 * pixel);
+        }
+
+        for (double& value : m_sky)
+        {
+            value /= largestValue;
+        }
+    }
+
+    static double Wavelength(int pixel)
+    {
+        return firstWavelength + wavelengthStep * pixel;
+    }
+
+    const std::vector<double>& CrossSection() const { return m_crossSection; }
+
+    /** Creates one spectrum, as the sum of the given number of co-added spectra.
+        @param intensity The intensity of the sky light, as a fraction of the saturation level.
+        @param column The slant SO2 column in the light path, in molecules / cm2. */
+    void Create(double intensity, double column, int coAdds, std::mt19937& random, std::vector<std::int32_t>& spectrum) const
+    {
+        std::normal_distribution<double> noise{ 0.0, 1.0 };
+        const double saturation = static_cast<double>(maximumIntensity) * coAdds;
+
+        spectrum.resize(spectrumLength);
+        for (size_t idx = 0; idx < spectrum.size(); ++idx)
+        {
+            double value = coAdds * m_dark[idx] + saturation * intensity * m_sky[idx] * std::exp(-m_crossSection[idx] * column);
+            value += std::sqrt(value / electronsPerCount) * noise(random);
+            spectrum[idx] = static_cast<std::int32_t>(std::round(std::min(std::max(value, 0.0), saturation)));
+        }
+    }
+
+private:
+    /** The shape of the sky spectrum, normalized to a largest value of one */
+    std::vector<double> m_sky;
+
+    /** The absorption cross section of SO2, in cm2 / molecule */
+    std::vector<double> m_crossSection;
+
+    /** The dark current of one co-added spectrum */
+    std::vector<double> m_dark;
+};
+
+static void ValidateSettings(const GeneratorSettings& settings)
+{
+    if (settings.instrumentNum < 1 || settings.instrumentNum > 999)
+    {
+        throw std::invalid_argument("The number of instruments must be between 1 and 999");
+    }
+    if (settings.dualBeamInstrumentNum < 0 || settings.dualBeamInstrumentNum > settings.instrumentNum)
+    {
+        throw std::invalid_argument("The number of dual-beam instruments must be between 0 and the number of instruments");
+    }
+    if (settings.days < 1)
+    {
+        throw std::invalid_argument("The number of days must be at least one");
+    }
+    if (settings.firstHour < 0 || settings.lastHour > 24 || settings.firstHour >= settings.lastHour)
+    {
+        throw std::invalid_argument("The measurement hours must be within 0 to 24 and the first hour must be before the last");
+    }
+    if (settings.scanIntervalMinutes * 60 < scanSpectrumNum * scanSpectrumSeconds)
+    {
+        throw std::invalid_argument("The scan interval is shorter than the time it takes to collect one scan");
+    }
+    if (settings.windMeasurementInterval < 1 || settings.windMeasurementSpectra < 1 || settings.windMeasurementSpectra + 2 > settings.scanIntervalMinutes * 60)
+    {
+        throw std::invalid_argument("The wind measurements must have at least one spectrum and fit within the scan interval");
+    }
+    if (settings.plumeHeight <= 0.0 || settings.plumeWidth <= 0.0 || settings.so2Column < 0.0 || settings.windSpeed <= 0.0)
+    {
+        throw std::invalid_argument("The plume height, plume width and wind speed must be positive and the SO2 column must not be negative");
+    }
+    if (settings.corruptFraction < 0.0 || settings.corruptFraction > 1.0)
+    {
+        throw std::invalid_argument("The fraction of corrupt files must be between 0 and 1");
+    }
+}
+
+/** Places the instruments on an arc downwind of the summit. The compass direction of each instrument
+    is the direction away from the summit, such that the scan plane is across the plume. */
+static std::vector<SyntheticInstrument> CreateInstruments(const GeneratorSettings& settings, const novac::CGPSData& summit)
+{
+    std::vector<SyntheticInstrument> instruments;
+
+    const double downwindDirection = settings.windDirection + 180.0;
+    const double arc = (settings.instrumentNum > 1) ? 40.0 : 0.0;
+
+    for (int k = 0; k < settings.instrumentNum; ++k)
+    {
+        const double bearing = downwindDirection + arc * ((settings.instrumentNum > 1) ? (double)k / (settings.instrumentNum - 1) - 0.5 : 0.0);
+
+        char serial[16];
+        sprintf(serial, "SYN%04d", k + 1);
+
+        SyntheticInstrument instrument;
+        instrument.serial = serial;
+        instrument.dualBeam = (k < settings.dualBeamInstrumentNum);
+        instrument.east = settings.instrumentDistance * std::sin(degreeToRadian * bearing);
+        instrument.north = settings.instrumentDistance * std::cos(degreeToRadian * bearing);
+
+        const novac::CGPSData position = novac::GpsMath::CalculateDestination(summit, settings.instrumentDistance, bearing);
+
+        Configuration::CInstrumentLocation& location = instrument.location;
+        location.m_locationName.Format("Synthetic_%d", k + 1);
+        location.m_volcano = settings.volcano.c_str();
+        location.m_latitude = position.m_latitude;
+        location.m_longitude = position.m_longitude;
+        location.m_altitude = static_cast<int>(std::max(0.0, summit.m_altitude - 800.0));
+        location.m_compass = std::fmod(bearing + 360.0, 360.0);
+        location.m_coneangle = 90.0;
+        location.m_tilt = 0.0;
+        location.m_instrumentType = novac::NovacInstrumentType::Gothenburg;
+        location.m_spectrometerModel = "S2000";
+        location.m_validFrom = settings.startDate;
+        location.m_validTo = novac::CDateTime(9999, 12, 31, 23, 59, 59);
+
+        instruments.push_back(instrument);
+    }
+
+    return instruments;
+}
+
+/** Creates the wind and the emission for each hour of the generated days.
+    The wind direction and speed vary slowly around the mean values and the emission varies randomly from hour to hour. */
+static std::vector<PlumeState> CreateHourlyPlume(const GeneratorSettings& settings, std::mt19937& random)
+{
+    std::normal_distribution<double> variation{ 0.0, 1.0 };
+
+    std::vector<PlumeState> states(static_cast<size_t>(settings.days * 24));
+    for (size_t hour = 0; hour < states.size(); ++hour)
+    {
+        const double phase = 2.0 * pi * static_cast<double>(hour) / 24.0;
+        states[hour].windSpeed = std::max(1.0, settings.windSpeed * (1.0 + 0.25 * std::sin(phase)) + 0.5 * variation(random));
+        states[hour].windDirection = std::fmod(settings.windDirection + 20.0 * std::sin(phase + 1.0) + 5.0 * variation(random) + 360.0, 360.0);
+        states[hour].column = settings.so2Column * std::max(0.1, 1.0 + 0.3 * variation(random));
+    }
+    return states;
+}
+
+/** Calculates the scan angle at which the instrument sees the centre of the plume.
+    @return false if the plume does not pass through the scan plane of the instrument. */
+static bool PlumeCentreAngle(const SyntheticInstrument& instrument, const PlumeState& plume, double plumeHeightAboveInstrument, double& angle, double& crossingAngle)
+{
+    // The plume travels from the summit away from the wind direction. Positive scan angles are towards compass - 90 degrees.
+    const double plumeX = std::sin(degreeToRadian * (plume.windDirection + 180.0));
+    const double plumeY = std::cos(degreeToRadian * (plume.windDirection + 180.0));
+    const double scanX = std::sin(degreeToRadian * (instrument.location.m_compass - 90.0));
+    const double scanY = std::cos(degreeToRadian * (instrument.location.m_compass - 90.0));
+
+    // Solve: s * plume = instrument + t * scan, giving the distance 's' along the plume and 't' along the scan plane.
+    const double determinant = -plumeX * scanY + scanX * plumeY;
+    if (std::abs(determinant) < 0.05)
+    {
+        return false;
+    }
+    const double s = (-instrument.east * scanY + scanX * instrument.north) / determinant;
+    const double t = (plumeX * instrument.north - plumeY * instrument.east) / determinant;
+    if (s <= 0.0)
+    {
+        return false;
+    }
+
+    angle = std::atan2(t, plumeHeightAboveInstrument) / degreeToRadian;
+    crossingAngle = std::asin(std::min(1.0, std::abs(determinant)));
+    return std::abs(angle) < 85.0;
+}
+
+/** @return the slant SO2 column seen by the instrument in the given direction */
+static double SlantColumn(double scanAngle, const GeneratorSettings& settings, const SyntheticInstrument& instrument, const PlumeState& plume, double plumeHeightAboveInstrument)
+{
+    double centreAngle = 0.0;
+    double crossingAngle = 0.0;
+    if (!PlumeCentreAngle(instrument, plume, plumeHeightAboveInstrument, centreAngle, crossingAngle))
+    {
+        return 0.0;
+    }
+
+    // The distance between the light path and the centre of the plume, measured across the plume at the altitude of the plume.
+    const double offset = plumeHeightAboveInstrument * (std::tan(degreeToRadian * scanAngle) - std::tan(degreeToRadian * centreAngle)) * std::sin(crossingAngle);
+    const double airMassFactor = 1.0 / std::max(0.1, std::cos(degreeToRadian * scanAngle));
+
+    return plume.column * airMassFactor * std::exp(-0.5 * std::pow(offset / settings.plumeWidth, 2));
+}
+
+/** @return the intensity of the sky light, as a fraction of the saturation level, at the given time of day and scan angle */
+static double SkyIntensity(const GeneratorSettings& settings, int secondOfDay, double scanAngle)
+{
+    const double fractionOfDay = (secondOfDay / 3600.0 - settings.firstHour) / (settings.lastHour - settings.firstHour);
+    const double sun = 0.3 + 0.7 * std::sin(pi * std::min(std::max(fractionOfDay, 0.0), 1.0));
+    return 0.7 * sun * (0.7 + 0.3 * std::cos(degreeToRadian * scanAngle));
+}
+
+static novac::CDateTime AddSeconds(const novac::CDateTime& time, int seconds)
+{
+    novac::CDateTime result = time;
+    result.Increment(seconds);
+    return result;
+}
+
+static FileHandler::PakSpectrumHeader CreateHeader(const SyntheticInstrument& instrument)
+{
+    FileHandler::PakSpectrumHeader header;
+    header.instrumentName = instrument.serial;
+    header.exposureTime = exposureTime;
+    header.latitude = instrument.location.m_latitude;
+    header.longitude = instrument.location.m_longitude;
+    header.altitude = static_cast<std::int16_t>(instrument.location.m_altitude);
+    header.compassDirection = static_cast<std::int16_t>(std::round(10.0 * instrument.location.m_compass));
+    header.coneAngle = 90;
+    header.temperature = 25.0f;
+    return header;
+}
+
+static std::string PakFileName(const std::string& dataDirectory, const SyntheticInstrument& instrument, const novac::CDateTime& startTime, int channel)
+{
+    char directory[64];
+    sprintf(directory, "%04d.%02d.%02d/", (int)startTime.year, (int)startTime.month, (int)startTime.day);
+
+    char fileName[64];
+    sprintf(fileName, "_%02d%02d%02d_%02d%02d_%d.pak", (int)startTime.year % 100, (int)startTime.month, (int)startTime.day, (int)startTime.hour, (int)startTime.minute, channel);
+
+    const std::string path = dataDirectory + directory + instrument.serial + "/";
+    if (0 != Filesystem::CreateDirectoryStructure(path))
+    {
+        throw std::runtime_error("Cannot create directory: " + path);
+    }
+    return path + instrument.serial + fileName;
+}
+
+/** Writes one scan: a sky spectrum at zenith, a dark spectrum and the spectra from one horizon to the other. */
+static void WriteScan(
+    const std::string& fileName,
+    const GeneratorSettings& settings,
+    const SyntheticInstrument& instrument,
+    const PlumeState& plume,
+    const novac::CDateTime& startTime,
+    const CSpectrumModel& model,
+    std::mt19937& random,
+    GeneratorStatistics& statistics)
+{
+    FileHandler::CPakFileWriter writer;
+    if (!writer.Open(fileName))
+    {
+        throw std::runtime_error("Cannot create file: " + fileName);
+    }
+
+    const double plumeHeightAboveInstrument = g_volcanoes.GetPeakAltitude(settings.volcano.c_str()) + settings.plumeHeight - instrument.location.m_altitude;
+    const int secondOfDay = startTime.hour * 3600 + startTime.minute * 60 + startTime.second;
+
+    FileHandler::PakSpectrumHeader header = CreateHeader(instrument);
+    header.scans = scanCoAdds;
+    header.measurementCount = scanSpectrumNum;
+
+    std::vector<std::int32_t> spectrum;
+    for (int idx = 0; idx < scanSpectrumNum; ++idx)
+    {
+        double angle = 0.0;
+        if (idx == 0)
+        {
+            header.name = "sky";
+            angle = 0.0;
+        }
+        else if (idx == 1)
+        {
+            header.name = "dark";
+            angle = 180.0;
+        }
+        else
+        {
+            header.name = "scan";
+            angle = std::trunc(firstScanAngle + (lastScanAngle - firstScanAngle) * (idx - 2) / (scanSpectrumNum - 3));
+        }
+
+        if (idx == 1)
+        {
+            model.Create(0.0, 0.0, scanCoAdds, random, spectrum);
+        }
+        else
+        {
+            const double column = SlantColumn(angle, settings, instrument, plume, plumeHeightAboveInstrument);
+            model.Create(SkyIntensity(settings, secondOfDay + idx * scanSpectrumSeconds, angle), column, scanCoAdds, random, spectrum);
+        }
+
+        header.viewAngle = static_cast<std::int16_t>(angle);
+        header.measurementIndex = static_cast<std::int8_t>(idx);
+        header.SetTime(AddSeconds(startTime, idx * scanSpectrumSeconds), AddSeconds(startTime, (idx + 1) * scanSpectrumSeconds - 1));
+
+        if (!writer.Write(header, spectrum.data(), spectrum.size()))
+        {
+            throw std::runtime_error("Failed to write to file: " + fileName);
+        }
+        ++statistics.spectra;
+    }
+
+    ++statistics.scanFiles;
+}
+
+/** Writes the two files of a dual-beam wind measurement, both beams pointing at the centre of the plume.
+    The column seen by the second beam is delayed by the time it takes the wind to move the plume between the beams. */
+static void WriteWindMeasurement(
+    const std::string& masterFileName,
+    const std::string& slaveFileName,
+    const GeneratorSettings& settings,
+    const SyntheticInstrument& instrument,
+    const PlumeState& plume,
+    const novac::CDateTime& startTime,
+    const CSpectrumModel& model,
+    std::mt19937& random,
+    GeneratorStatistics& statistics)
+{
+    const double plumeHeightAboveInstrument = g_volcanoes.GetPeakAltitude(settings.volcano.c_str()) + settings.plumeHeight - instrument.location.m_altitude;
+    const int secondOfDay = startTime.hour * 3600 + startTime.minute * 60 + startTime.second;
+
+    double angle = 0.0;
+    double crossingAngle = 0.0;
+    if (!PlumeCentreAngle(instrument, plume, plumeHeightAboveInstrument, angle, crossingAngle))
+    {
+        angle = 0.0;
+    }
+    angle = std::round(std::max(-75.0, std::min(75.0, angle)));
+
+    const double beamDistance = plumeHeightAboveInstrument / std::cos(degreeToRadian * angle) * std::tan(beamSeparation);
+    const double delay = beamDistance / plume.windSpeed;
+
+    // The puffs of the plume: a smoothly varying column, sampled once per second.
+    const size_t seriesLength = static_cast<size_t>(settings.windMeasurementSpectra) + static_cast<size_t>(std::ceil(delay)) + 2;
+    std::vector<double> puffs(seriesLength);
+    std::normal_distribution<double> variation{ 0.0, 1.0 };
+    double state = 0.0;
+    for (double& value : puffs)
+    {
+        state = 0.95 * state + 0.3 * variation(random);
+        value = std::max(0.0, 1.0 + state);
+    }
+    const double centreColumn = SlantColumn(angle, settings, instrument, plume, plumeHeightAboveInstrument);
+
+    const std::string fileNames[2] = { masterFileName, slaveFileName };
+    std::vector<std::int32_t> spectrum;
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        FileHandler::CPakFileWriter writer;
+        if (!writer.Open(fileNames[channel]))
+        {
+            throw std::runtime_error("Cannot create file: " + fileNames[channel]);
+        }
+
+        FileHandler::PakSpectrumHeader header = CreateHeader(instrument);
+        header.channel = static_cast<std::uint8_t>(channel);
+        header.scans = windCoAdds;
+
+        // The measurement index and count are stored in one byte each, as in the instruments.
+        const int spectrumNum = settings.windMeasurementSpectra + 2;
+        header.measurementCount = static_cast<std::int8_t>(std::min(spectrumNum, 127));
+
+        for (int idx = 0; idx < spectrumNum; ++idx)
+        {
+            double column = 0.0;
+            if (idx == 0)
+            {
+                header.name = "sky";
+                header.viewAngle = 0;
+                column = SlantColumn(0.0, settings, instrument, plume, plumeHeightAboveInstrument);
+            }
+            else if (idx == 1)
+            {
+                header.name = "dark";
+                header.viewAngle = 180;
+            }
+            else
+            {
+                // The master (channel 0) sees the plume first, the slave sees the same column 'delay' seconds later.
+                const double time = static_cast<double>(idx - 2) + std::ceil(delay) - (channel == 0 ? 0.0 : delay);
+                const size_t index = static_cast<size_t>(std::floor(time));
+                const double fraction = time - std::floor(time);
+                column = centreColumn * ((1.0 - fraction) * puffs[index] + fraction * puffs[index + 1]);
+
+                header.name = "scan";
+                header.viewAngle = static_cast<std::int16_t>(angle);
+            }
+
+            model.Create(idx == 1 ? 0.0 : SkyIntensity(settings, secondOfDay + idx, header.viewAngle), column, windCoAdds, random, spectrum);
+
+            header.measurementIndex = static_cast<std::int8_t>(std::min(idx, 127));
+            header.SetTime(AddSeconds(startTime, idx), AddSeconds(startTime, idx));
+
+            if (!writer.Write(header, spectrum.data(), spectrum.size()))
+            {
+                throw std::runtime_error("Failed to write to file: " + fileNames[channel]);
+            }
+            ++statistics.spectra;
+        }
+    }
+
+    statistics.windMeasurementFiles += 2;
+}
+
+/** Damages the given .pak file in one of the ways seen in data from the field:
+    an empty file, a file which ends in the middle of a spectrum, a broken spectrum header or garbage in the spectrum data. */
+static void CorruptFile(const std::string& fileName, std::mt19937& random)
+{
+    std::vector<char> data;
+    {
+        std::ifstream input(fileName, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    }
+    if (data.size() < 2u * FileHandler::CPakFileWriter::headerSize)
+    {
+        return;
+    }
+
+    std::uniform_int_distribution<size_t> position{ FileHandler::CPakFileWriter::headerSize, data.size() - 1 };
+    std::uniform_int_distribution<int> byteValue{ 0, 255 };
+
+    switch (std::uniform_int_distribution<int>{ 0, 3 }(random))
+    {
+    case 0:
+        data.clear();
+        break;
+    case 1:
+        data.resize(position(random));
+        break;
+    case 2:
+    {
+        // Overwrite the identifier of a spectrum header somewhere in the file
+        const size_t start = position(random);
+        for (size_t idx = start; idx + 4 < data.size(); ++idx)
+        {
+            if (data[idx] == 'M' && data[idx + 1] == 'K' && data[idx + 2] == 'Z' && data[idx + 3] == 'Y')
+            {
+                data[idx] = 'X';
+                break;
+            }
+        }
+        data[FileHandler::CPakFileWriter::headerSize / 2] = static_cast<char>(byteValue(random));
+        break;
+    }
+    default:
+    {
+        const size_t start = position(random);
+        const size_t end = std::min(data.size(), start + 64);
+        for (size_t idx = start; idx < end; ++idx)
+        {
+            data[idx] = static_cast<char>(byteValue(random));
+        }
+        break;
+    }
+    }
+
+    std::ofstream output(fileName, std::ios::binary | std::ios::trunc);
+    output.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+static void WriteCrossSection(const std::string& fileName, const CSpectrumModel& model)
+{
+    FILE* f = fopen(fileName.c_str(), "w");
+    if (f == nullptr)
+    {
+        throw std::runtime_error("Cannot create file: " + fileName);
+    }
+    for (int pixel = 0; pixel < spectrumLength; ++pixel)
+    {
+        fprintf(f, "%.4lf %.6le\n", CSpectrumModel::Wavelength(pixel), model.CrossSection()[static_cast<size_t>(pixel)]);
+    }
+    fclose(f);
+}
+
+static void WriteConfiguration(
+    const GeneratorSettings& settings,
+    const std::vector<SyntheticInstrument>& instruments,
+    const std::vector<PlumeState>& hourlyPlume,
+    const CSpectrumModel& model,
+    const std::string& configurationDirectory,
+    const std::string& dataDirectory,
+    novac::ILogger& log)
+{
+    const std::string crossSectionFile = configurationDirectory + "SO2_Synthetic.txt";
+    WriteCrossSection(crossSectionFile, model);
+
+    // The instruments, with their locations and fit windows
+    Configuration::CNovacPPPConfiguration setup;
+    for (const SyntheticInstrument& instrument : instruments)
+    {
+        Configuration::CInstrumentConfiguration configuration;
+        configuration.m_serial = instrument.serial.c_str();
+        configuration.m_location.m_serial = instrument.serial.c_str();
+        configuration.m_location.InsertLocation(instrument.location);
+        configuration.m_eval.m_serial = instrument.serial;
+
+        for (int channel = 0; channel < (instrument.dualBeam ? 2 : 1); ++channel)
+        {
+            novac::CFitWindow window;
+            window.name = fitWindowName;
+            window.channel = channel;
+            window.specLength = spectrumLength;
+            window.interlaceStep = 1;
+            window.fitLow = fitLow;
+            window.fitHigh = fitHigh;
+            window.polyOrder = 5;
+            window.fitType = novac::FIT_TYPE::FIT_HP_DIV;
+
+            novac::CReferenceFile reference;
+            reference.m_specieName = "SO2";
+            reference.m_path = crossSectionFile;
+            reference.SetShift(novac::SHIFT_TYPE::SHIFT_FIX, 0.0);
+            reference.SetSqueeze(novac::SHIFT_TYPE::SHIFT_FIX, 1.0);
+            window.reference.push_back(reference);
+
+            configuration.m_eval.InsertFitWindow(window, settings.startDate, novac::CDateTime(9999, 12, 31, 23, 59, 59));
+        }
+
+        const std::string evaluationFile = configurationDirectory + instrument.serial + ".exml";
+        FileHandler::CEvaluationConfigurationParser evaluationWriter{ log };
+        if (RETURN_CODE::SUCCESS != evaluationWriter.WriteConfigurationFile(evaluationFile.c_str(), configuration.m_eval, configuration.m_darkCurrentCorrection, configuration.m_instrumentCalibration))
+        {
+            throw std::runtime_error("Failed to write file: " + evaluationFile);
+        }
+
+        setup.m_instrument.push_back(configuration);
+    }
+
+    const std::string setupFile = configurationDirectory + "setup.xml";
+    FileHandler::CSetupFileReader setupWriter{ log };
+    if (RETURN_CODE::SUCCESS != setupWriter.WriteSetupFile(setupFile.c_str(), setup))
+    {
+        throw std::runtime_error("Failed to write file: " + setupFile);
+    }
+
+    // The wind field, the same as was used to create the plumes
+    const novac::CGPSData summit = g_volcanoes.GetPeak(g_volcanoes.GetVolcanoIndex(settings.volcano.c_str()));
+    Meteorology::CWindDataBase windDataBase;
+    windDataBase.m_dataBaseName = settings.volcano;
+    for (size_t hour = 0; hour < hourlyPlume.size(); ++hour)
+    {
+        const novac::CDateTime validFrom = AddSeconds(settings.startDate, static_cast<int>(hour) * 3600);
+        const novac::CDateTime validTo = AddSeconds(validFrom, 3599);
+        windDataBase.InsertWindField(Meteorology::WindField(
+            hourlyPlume[hour].windSpeed, 1.0, Meteorology::MeteorologySource::User,
+            hourlyPlume[hour].windDirection, 10.0, Meteorology::MeteorologySource::User,
+            validFrom, validTo,
+            summit.m_latitude, summit.m_longitude, summit.m_altitude + settings.plumeHeight));
+    }
+
+    const std::string windFile = configurationDirectory + "wind.wxml";
+    if (0 != windDataBase.WriteToFile(windFile.c_str()))
+    {
+        throw std::runtime_error("Failed to write file: " + windFile);
+    }
+
+    // The processing settings, reading the generated data and the wind field
+    Configuration::CUserConfiguration processing;
+    processing.m_volcano = static_cast<int>(g_volcanoes.GetVolcanoIndex(settings.volcano.c_str()));
+    processing.m_LocalDirectory = dataDirectory;
+    processing.m_includeSubDirectories_Local = true;
+    processing.m_outputDirectory = (settings.outputDirectory + "output/").c_str();
+    processing.m_tempDirectory = (settings.outputDirectory + "temp/").c_str();
+    processing.m_windFieldFile = windFile.c_str();
+    processing.m_windFieldFileOption = 0;
+    processing.m_fromDate = settings.startDate;
+    processing.m_toDate = AddSeconds(settings.startDate, settings.days * 86400 - 1);
+    processing.m_fitWindowsToUse[0] = fitWindowName;
+    processing.m_nFitWindowsToUse = 1;
+    processing.m_mainFitWindow = 0;
+
+    const std::string processingFile = configurationDirectory + "processing.xml";
+    FileHandler::CProcessingFileReader processingWriter{ log };
+    if (RETURN_CODE::SUCCESS != processingWriter.WriteProcessingFile(processingFile.c_str(), processing))
+    {
+        throw std::runtime_error("Failed to write file: " + processingFile);
+    }
+}
+
+GeneratorStatistics Generate(const GeneratorSettings& settings, novac::ILogger& log)
+{
+    ValidateSettings(settings);
+
+    const unsigned int volcanoIndex = g_volcanoes.GetVolcanoIndex(settings.volcano.c_str());
+    const novac::CGPSData summit = g_volcanoes.GetPeak(volcanoIndex);
+
+    const std::string configurationDirectory = settings.outputDirectory + "configuration/";
+    const std::string dataDirectory = settings.outputDirectory + "data/";
+    if (0 != Filesystem::CreateDirectoryStructure(configurationDirectory.c_str()) || 0 != Filesystem::CreateDirectoryStructure(dataDirectory.c_str()))
+    {
+        throw std::runtime_error("Cannot create the output directories in: " + settings.outputDirectory);
+    }
+
+    std::mt19937 random{ settings.seed };
+    std::bernoulli_distribution isCorrupt{ settings.corruptFraction };
+
+    const CSpectrumModel model;
+    const std::vector<SyntheticInstrument> instruments = CreateInstruments(settings, summit);
+    const std::vector<PlumeState> hourlyPlume = CreateHourlyPlume(settings, random);
+
+    WriteConfiguration(settings, instruments, hourlyPlume, model, configurationDirectory, dataDirectory, log);
+
+    GeneratorStatistics statistics;
+    for (int day = 0; day < settings.days; ++day)
+    {
+        const novac::CDateTime startOfDay = AddSeconds(settings.startDate, day * 86400);
+
+        for (size_t instrumentIdx = 0; instrumentIdx < instruments.size(); ++instrumentIdx)
+        {
+            const SyntheticInstrument& instrument = instruments[instrumentIdx];
+            std::stringstream message;
+            message << "Generating data for " << instrument.serial << " on day " << (day + 1) << " of " << settings.days;
+            log.Information(message.str());
+
+            // Offset the instruments by a minute each, such that they do not all measure at the same time
+            int secondOfDay = settings.firstHour * 3600 + static_cast<int>(instrumentIdx % static_cast<size_t>(settings.scanIntervalMinutes)) * 60;
+            for (int measurement = 0; secondOfDay < settings.lastHour * 3600; ++measurement, secondOfDay += settings.scanIntervalMinutes * 60)
+            {
+                const novac::CDateTime startTime = AddSeconds(startOfDay, secondOfDay);
+                const PlumeState& plume = hourlyPlume[static_cast<size_t>(day * 24 + secondOfDay / 3600)];
+
+                std::vector<std::string> writtenFiles;
+                if (instrument.dualBeam && (measurement % settings.windMeasurementInterval) == settings.windMeasurementInterval - 1)
+                {
+                    writtenFiles.push_back(PakFileName(dataDirectory, instrument, startTime, 0));
+                    writtenFiles.push_back(PakFileName(dataDirectory, instrument, startTime, 1));
+                    WriteWindMeasurement(writtenFiles[0], writtenFiles[1], settings, instrument, plume, startTime, model, random, statistics);
+                }
+                else
+                {
+                    writtenFiles.push_back(PakFileName(dataDirectory, instrument, startTime, 0));
+                    WriteScan(writtenFiles[0], settings, instrument, plume, startTime, model, random, statistics);
+                }
+
+                for (const std::string& fileName : writtenFiles)
+                {
+                    if (isCorrupt(random))
+                    {
+                        CorruptFile(fileName, random);
+                        ++statistics.corruptFiles;
+                    }
+                }
+            }
+        }
+    }
+
+    return statistics;
+}
+
+}
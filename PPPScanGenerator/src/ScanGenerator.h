@@ -0,0 +1,86 @@
+#pragma once
+
+#include <SpectralEvaluation/DateTime.h>
+#include <SpectralEvaluation/Log.h>
+#include <cstddef>
+#include <string>
+
+namespace ScanGenerator
+{
+
+/** The settings for one run of the scan generator.
+    All instruments are flat scanners placed on a circle around the volcano, downwind of the summit,
+    each scanning through the plume at regular intervals during the measurement hours of each day. */
+struct GeneratorSettings
+{
+    /** The directory where the data and the configuration files are written */
+    std::string outputDirectory = "SyntheticData/";
+
+    /** The name of the volcano, must be one of the volcanoes known to the NovacPPP */
+    std::string volcano = "Ruapehu";
+
+    /** The number of instruments to generate data for */
+    int instrumentNum = 4;
+
+    /** The number of instruments, among the first ones, which also make dual-beam wind measurements */
+    int dualBeamInstrumentNum = 1;
+
+    /** The distance from the summit to the instruments, in meters */
+    double instrumentDistance = 6000.0;
+
+    /** The first day with data and the number of days to generate */
+    novac::CDateTime startDate = novac::CDateTime(2023, 1, 20, 0, 0, 0);
+    int days = 1;
+
+    /** The first and last hour (UTC) of each day during which the instruments measure */
+    int firstHour = 7;
+    int lastHour = 17;
+
+    /** The time between the start of two consecutive measurements of one instrument, in minutes */
+    int scanIntervalMinutes = 10;
+
+    /** Every n:th measurement of the dual-beam instruments is a wind measurement instead of a scan */
+    int windMeasurementInterval = 6;
+
+    /** The number of spectra in each beam of a wind measurement, one spectrum is collected each second */
+    int windMeasurementSpectra = 400;
+
+    /** The altitude of the plume above the summit, in meters */
+    double plumeHeight = 1000.0;
+
+    /** The standard deviation of the (gaussian) cross section of the plume, in meters */
+    double plumeWidth = 400.0;
+
+    /** The vertical SO2 column at the centre of the plume, in molecules / cm2 */
+    double so2Column = 5.0e17;
+
+    /** The mean wind speed (m/s) and the mean direction the wind is blowing from (degrees from north) */
+    double windSpeed = 8.0;
+    double windDirection = 0.0;
+
+    /** The fraction of the written .pak files which are corrupted afterwards, between 0 and 1 */
+    double corruptFraction = 0.0;
+
+    /** The seed of the random numbers, the same settings and seed always gives the same data */
+    unsigned int seed = 1;
+};
+
+/** A summary of the generated data */
+struct GeneratorStatistics
+{
+    size_t scanFiles = 0;
+    size_t windMeasurementFiles = 0;
+    size_t corruptFiles = 0;
+    size_t spectra = 0;
+};
+
+/** Generates the synthetic data and configuration described by the settings.
+    The output directory will contain:
+        'configuration/' with the setup.xml, processing.xml, one .exml file for each instrument,
+            the synthetic SO2 cross section and the wind field file, ready to be used by the NovacPPP,
+        'data/yyyy.mm.dd/serial/' with the .pak files of each instrument and day.
+    @throws std::invalid_argument if the settings are not valid.
+    @throws std::runtime_error if the files could not be written. */
+GeneratorStatistics Generate(const GeneratorSettings& settings, novac::ILogger& log);
+
+}
@@ -0,0 +1,158 @@
+#include "ScanGenerator.h"
+#include <PPPLib/Logging.h>
+#include <PPPLib/VolcanoInfo.h>
+#include <Poco/Path.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+novac::CVolcanoInfo g_volcanoes;   // <-- A list of all known volcanoes
+
+static void PrintUsage()
+{
+    std::cerr << "Usage: PPPScanGenerator [options]" << std::endl;
+    std::cerr << "  --output <directory>          The directory to write the data and configuration to (default SyntheticData/)" << std::endl;
+    std::cerr << "  --volcano <name>              The monitored volcano (default Ruapehu)" << std::endl;
+    std::cerr << "  --instruments <n>             The number of instruments (default 4)" << std::endl;
+    std::cerr << "  --dual-beam-instruments <n>   The number of instruments also making wind measurements (default 1)" << std::endl;
+    std::cerr << "  --distance <meters>           The distance from the summit to the instruments (default 6000)" << std::endl;
+    std::cerr << "  --start-date <yyyy.mm.dd>     The first day with data (default 2023.01.20)" << std::endl;
+    std::cerr << "  --days <n>                    The number of days with data (default 1)" << std::endl;
+    std::cerr << "  --hours <first> <last>        The hours of each day (UTC) when the instruments measure (default 7 17)" << std::endl;
+    std::cerr << "  --scan-interval <minutes>     The time between two measurements of one instrument (default 10)" << std::endl;
+    std::cerr << "  --wind-interval <n>           Every n:th measurement of a dual-beam instrument is a wind measurement (default 6)" << std::endl;
+    std::cerr << "  --wind-spectra <n>            The number of spectra in each beam of a wind measurement (default 400)" << std::endl;
+    std::cerr << "  --plume-height <meters>       The altitude of the plume above the summit (default 1000)" << std::endl;
+    std::cerr << "  --plume-width <meters>        The standard deviation of the cross section of the plume (default 400)" << std::endl;
+    std::cerr << "  --so2-column <molec/cm2>      The vertical SO2 column at the centre of the plume (default 5e17)" << std::endl;
+    std::cerr << "  --wind-speed <m/s>            The mean wind speed (default 8)" << std::endl;
+    std::cerr << "  --wind-direction <degrees>    The mean direction the wind blows from (default 0)" << std::endl;
+    std::cerr << "  --corrupt-fraction <fraction> The fraction of the .pak files which are damaged (default 0)" << std::endl;
+    std::cerr << "  --seed <n>                    The seed of the random numbers (default 1)" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    ScanGenerator::GeneratorSettings settings;
+
+    for (int argIdx = 1; argIdx < argc; ++argIdx)
+    {
+        const bool hasValue = argIdx + 1 < argc;
+        if (0 == strcmp(argv[argIdx], "--output") && hasValue)
+        {
+            settings.outputDirectory = argv[++argIdx];
+            if (settings.outputDirectory.back() != '/' && settings.outputDirectory.back() != '\\')
+            {
+                settings.outputDirectory += "/";
+            }
+        }
+        else if (0 == strcmp(argv[argIdx], "--volcano") && hasValue)
+        {
+            settings.volcano = argv[++argIdx];
+        }
+        else if (0 == strcmp(argv[argIdx], "--instruments") && hasValue)
+        {
+            settings.instrumentNum = std::atoi(argv[++argIdx]);
+        }
+        else if (0 == strcmp(argv[argIdx], "--dual-beam-instruments") && hasValue)
+        {
+            settings.dualBeamInstrumentNum = std::atoi(argv[++argIdx]);
+        }
+        else if (0 == strcmp(argv[argIdx], "--distance") && hasValue)
+        {
+            settings.instrumentDistance = std::atof(argv[++argIdx]);
+        }
+        else if (0 == strcmp(argv[argIdx], "--start-date") && hasValue)
+        {
+            int year = 0;
+            int month = 0;
+            int day = 0;
+            if (3 != sscanf(argv[++argIdx], "%4d.%2d.%2d", &year, &month, &day) || month < 1 || month > 12 || day < 1 || day > 31)
+            {
+                PrintUsage();
+                return 2;
+            }
+            settings.startDate = novac::CDateTime(year, month, day, 0, 0, 0);
+        }
+        else if (0 == strcmp(argv[argIdx], "--days") && hasValue)
+        {
+            settings.days = std::atoi(argv[++argIdx]);
+        }
+        else if (0 == strcmp(argv[argIdx], "--hours") && argIdx + 2 < argc)
+        {
+            settings.firstHour = std::atoi(argv[++argIdx]);
+            settings.lastHour = std::atoi(argv[++argIdx]);
+        }
+        else if (0 == strcmp(argv[argIdx], "--scan-interval") && hasValue)
+        {
+            settings.scanIntervalMinutes = std::atoi(argv[++argIdx]);
+        }
+        else if (0 == strcmp(argv[argIdx], "--wind-interval") && hasValue)
+        {
+            settings.windMeasurementInterval = std::atoi(argv[++argIdx]);
+        }
+        else if (0 == strcmp(argv[argIdx], "--wind-spectra") && hasValue)
+        {
+            settings.windMeasurementSpectra = std::atoi(argv[++argIdx]);
+        }
+        else if (0 == strcmp(argv[argIdx], "--plume-height") && hasValue)
+        {
+            settings.plumeHeight = std::atof(argv[++argIdx]);
+        }
+        else if (0 == strcmp(argv[argIdx], "--plume-width") && hasValue)
+        {
+            settings.plumeWidth = std::atof(argv[++argIdx]);
+        }
+        else if (0 == strcmp(argv[argIdx], "--so2-column") && hasValue)
+        {
+            settings.so2Column = std::atof(argv[++argIdx]);
+        }
+        else if (0 == strcmp(argv[argIdx], "--wind-speed") && hasValue)
+        {
+            settings.windSpeed = std::atof(argv[++argIdx]);
+        }
+        else if (0 == strcmp(argv[argIdx], "--wind-direction") && hasValue)
+        {
+            settings.windDirection = std::atof(argv[++argIdx]);
+        }
+        else if (0 == strcmp(argv[argIdx], "--corrupt-fraction") && hasValue)
+        {
+            settings.corruptFraction = std::atof(argv[++argIdx]);
+        }
+        else if (0 == strcmp(argv[argIdx], "--seed") && hasValue)
+        {
+            settings.seed = static_cast<unsigned int>(std::strtoul(argv[++argIdx], nullptr, 10));
+        }
+        else
+        {
+            PrintUsage();
+            return 2;
+        }
+    }
+
+    try
+    {
+        // The paths in the written configuration files must be valid also when the NovacPPP runs in another directory
+        settings.outputDirectory = Poco::Path(settings.outputDirectory).makeAbsolute().toString();
+
+        novac::ConsoleLog log;
+        const ScanGenerator::GeneratorStatistics statistics = ScanGenerator::Generate(settings, log);
+
+        std::cout << "Wrote " << statistics.scanFiles << " scans and " << statistics.windMeasurementFiles << " wind measurement files ("
+            << statistics.spectra << " spectra) to " << settings.outputDirectory << std::endl;
+        if (statistics.corruptFiles > 0)
+        {
+            std::cout << statistics.corruptFiles << " of the files are corrupt" << std::endl;
+        }
+    }
+    catch (std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 2;
+    }
+
+    return 0;
+}
@@ -2,7 +2,10 @@
 #include <SpectralEvaluation/File/File.h>
 #include <SpectralEvaluation/Log.h>
 #include "catch.hpp"
+#include <cstring>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 
 static std::string GetTestDataDirectory()
@@ -175,4 +178,90 @@ TEST_CASE("EvaluationLogFileHandler, valid scan file from ReEvaluation in NovacP
     REQUIRE(sut.m_scan[0].m_spec[50].m_referenceResult[0].m_columnError == Approx(5.41e+16));
     REQUIRE(sut.m_scan[0].m_spec[50].m_referenceResult[1].m_columnError == Approx(4.15e+17));
     REQUIRE(sut.m_scan[0].m_spec[50].m_referenceResult[2].m_columnError == Approx(1.99e+24));
-}
\ No newline at end of file
+}
+
+/** @return all the columns and fit results read from the given evaluation log, in the order they are stored */
+static std::vector<double> ReadAllValues(const std::string& filename)
+{
+    novac::ConsoleLog logger;
+    FileHandler::CEvaluationLogFileHandler reader(logger, filename, novac::StandardMolecule::SO2);
+
+    std::vector<double> values;
+    if (reader.ReadEvaluationLog() != RETURN_CODE::SUCCESS)
+    {
+        return values;
+    }
+
+    for (const auto& scan : reader.m_scan)
+    {
+        for (const auto& spectrum : scan.m_spec)
+        {
+            values.push_back(spectrum.m_chiSquare);
+            for (const auto& referenceResult : spectrum.m_referenceResult)
+            {
+                values.push_back(referenceResult.m_column);
+                values.push_back(referenceResult.m_columnError);
+            }
+        }
+    }
+    return values;
+}
+
+TEST_CASE("EvaluationLogFileHandler, two scan files read at the same time - same result as when read one at a time", "[ReadEvaluationLog][FileHandler][IntegrationTest]")
+{
+    const std::vector<std::string> filenames = {
+        GetTestDataDirectory() + "2002128M1/2002128M1_230120_1907_0.txt",
+        GetTestDataDirectory() + "2002128M1/2002128M1_230120_1907_0_ReEvaluation.txt" };
+    const int readsPerThread = 20;
+
+    std::vector<std::vector<double>> expectedValues;
+    for (const std::string& filename : filenames)
+    {
+        expectedValues.push_back(ReadAllValues(filename));
+        REQUIRE(expectedValues.back().size() > 100);
+    }
+
+    std::vector<int> numberOfCorrectReads(filenames.size(), 0);
+    std::vector<std::thread> threads;
+    for (size_t fileIdx = 0; fileIdx < filenames.size(); ++fileIdx)
+    {
+        threads.push_back(std::thread([&, fileIdx]()
+            {
+                for (int readIdx = 0; readIdx < readsPerThread; ++readIdx)
+                {
+                    if (ReadAllValues(filenames[fileIdx]) == expectedValues[fileIdx])
+                    {
+                        ++numberOfCorrectReads[fileIdx];
+                    }
+                }
+            }));
+    }
+
+    // Tokenizing another string with strtok at the same time must not disturb the reading of the files either.
+    int numberOfCorrectTokenizations = 0;
+    threads.push_back(std::thread([&]()
+        {
+            for (int readIdx = 0; readIdx < readsPerThread * 100; ++readIdx)
+            {
+                char text[] = "first\tsecond\tthird";
+                int numberOfTokens = 0;
+                for (char* token = strtok(text, "\t"); token != nullptr; token = strtok(nullptr, "\t"))
+                {
+                    ++numberOfTokens;
+                }
+                if (numberOfTokens == 3)
+                {
+                    ++numberOfCorrectTokenizations;
+                }
+            }
+        }));
+
+    for (std::thread& t : threads)
+    {
+        t.join();
+    }
+
+    REQUIRE(numberOfCorrectReads[0] == readsPerThread);
+    REQUIRE(numberOfCorrectReads[1] == readsPerThread);
+    REQUIRE(numberOfCorrectTokenizations == readsPerThread * 100);
+}
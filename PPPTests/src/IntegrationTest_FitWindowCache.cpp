@@ -1,4 +1,5 @@
-#include <PPPLib/PostProcessingUtils.h>
+#include <PPPLib/Evaluation/FitWindowCache.h>
+#include <PPPLib/ParallelFor.h>
 #include <SpectralEvaluation/Log.h>
 #include <SpectralEvaluation/File/File.h>
 #include <SpectralEvaluation/Evaluation/FitWindow.h>
@@ -8,6 +9,8 @@
 
 #include <stdexcept>
 #include <iostream>
+#include <set>
+#include <mutex>
 
 #include "catch.hpp"
 
@@ -23,13 +26,24 @@ static std::string GetTestDataDirectory()
 
 // Region Helper methods
 
+static novac::directorySetup GetDirectories()
+{
+    novac::directorySetup directories;
+    directories.tempDirectory = ".";
+    return directories;
+}
+
+static std::shared_ptr<const novac::CFitWindow> GetFitWindow(novac::ILogger& logger, const Configuration::CNovacPPPConfiguration& setup)
+{
+    Evaluation::CFitWindowCache sut{ logger, GetDirectories() };
+    return sut.GetFitWindow(setup, "ABC123", 0, novac::CDateTime(2020, 1, 1, 12, 0, 0));
+}
+
 // Endregion Helper methods
 
-TEST_CASE("PrepareEvaluation, reference file not found - throws exception", "[PrepareEvaluation]")
+TEST_CASE("CFitWindowCache, reference file not found - throws exception", "[CFitWindowCache]")
 {
     novac::ConsoleLog logger;
-    std::string tempDirectory = ".";
-
     Configuration::CNovacPPPConfiguration setup;
     Configuration::CInstrumentConfiguration instrument;
     instrument.m_serial = "ABC123";
@@ -48,7 +62,7 @@ TEST_CASE("PrepareEvaluation, reference file not found - throws exception", "[Pr
         setup.m_instrument.push_back(instrument);
 
         // Act & assert
-        REQUIRE_THROWS_AS(novac::PrepareEvaluation(logger, tempDirectory, setup), novac::InvalidReferenceException);
+        REQUIRE_THROWS_AS(GetFitWindow(logger, setup), novac::InvalidReferenceException);
     }
 
     SECTION("Single instrument, single fit window, second reference missing")
@@ -62,7 +76,7 @@ TEST_CASE("PrepareEvaluation, reference file not found - throws exception", "[Pr
         setup.m_instrument.push_back(instrument);
 
         // Act & assert
-        REQUIRE_THROWS_AS(novac::PrepareEvaluation(logger, tempDirectory, setup), novac::InvalidReferenceException);
+        REQUIRE_THROWS_AS(GetFitWindow(logger, setup), novac::InvalidReferenceException);
     }
 
     SECTION("Single instrument, Fraunhofer reference missing")
@@ -77,7 +91,7 @@ TEST_CASE("PrepareEvaluation, reference file not found - throws exception", "[Pr
         setup.m_instrument.push_back(instrument);
 
         // Act & assert
-        REQUIRE_THROWS_AS(novac::PrepareEvaluation(logger, tempDirectory, setup), novac::InvalidReferenceException);
+        REQUIRE_THROWS_AS(GetFitWindow(logger, setup), novac::InvalidReferenceException);
     }
 
     SECTION("Single instrument, reference is already filtered.")
@@ -93,15 +107,13 @@ TEST_CASE("PrepareEvaluation, reference file not found - throws exception", "[Pr
         setup.m_instrument.push_back(instrument);
 
         // Act & assert
-        REQUIRE_THROWS_AS(novac::PrepareEvaluation(logger, tempDirectory, setup), novac::InvalidReferenceException);
+        REQUIRE_THROWS_AS(GetFitWindow(logger, setup), novac::InvalidReferenceException);
     }
 }
 
-TEST_CASE("PrepareEvaluation, reads references", "[PrepareEvaluation][Test1]")
+TEST_CASE("CFitWindowCache, reads references", "[CFitWindowCache]")
 {
     novac::ConsoleLog logger;
-    std::string tempDirectory = ".";
-
     Configuration::CNovacPPPConfiguration setup;
     Configuration::CInstrumentConfiguration instrument;
     instrument.m_serial = "ABC123";
@@ -124,12 +136,10 @@ TEST_CASE("PrepareEvaluation, reads references", "[PrepareEvaluation][Test1]")
         setup.m_instrument.push_back(instrument);
 
         // Act
-        novac::PrepareEvaluation(logger, tempDirectory, setup);
+        const auto fitWindow = GetFitWindow(logger, setup);
 
         // Assert
-        novac::CFitWindow configuredFitWindow;
-        novac::CDateTime ignored1, ignored2;
-        setup.m_instrument[0].m_eval.GetFitWindow(0, configuredFitWindow, ignored1, ignored2);
+        const novac::CFitWindow& configuredFitWindow = *fitWindow;
 
         REQUIRE(configuredFitWindow.NumberOfReferences() == 2);
 
@@ -165,12 +175,10 @@ TEST_CASE("PrepareEvaluation, reads references", "[PrepareEvaluation][Test1]")
         setup.m_instrument.push_back(instrument);
 
         // Act
-        novac::PrepareEvaluation(logger, tempDirectory, setup);
+        const auto fitWindow = GetFitWindow(logger, setup);
 
         // Assert
-        novac::CFitWindow configuredFitWindow;
-        novac::CDateTime ignored1, ignored2;
-        setup.m_instrument[0].m_eval.GetFitWindow(0, configuredFitWindow, ignored1, ignored2);
+        const novac::CFitWindow& configuredFitWindow = *fitWindow;
 
         REQUIRE(configuredFitWindow.NumberOfReferences() == 2);
 
@@ -192,4 +200,102 @@ TEST_CASE("PrepareEvaluation, reads references", "[PrepareEvaluation][Test1]")
         REQUIRE(configuredFitWindow.fraunhoferRef.m_data->m_crossSection[380] == Approx(-0.1075877939));
         REQUIRE(configuredFitWindow.fraunhoferRef.m_data->m_waveLength[380] == Approx(302.498797860));
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("CFitWindowCache, loads, reuses and releases fit windows", "[CFitWindowCache]")
+{
+    novac::ConsoleLog logger;
+
+    Configuration::CNovacPPPConfiguration setup;
+    Configuration::CInstrumentConfiguration instrument;
+    instrument.m_serial = "ABC123";
+
+    novac::CFitWindow window;
+    window.fitType = novac::FIT_TYPE::FIT_POLY;
+    window.reference.push_back(novac::CReferenceFile{ GetTestDataDirectory() + "2002128M1/Calibrated/2002128M1_SO2_Bogumil_293K.txt" });
+    instrument.m_eval.InsertFitWindow(window, novac::CDateTime(2020, 1, 1, 0, 0, 0), novac::CDateTime(2020, 1, 2, 0, 0, 0));
+    instrument.m_eval.InsertFitWindow(window, novac::CDateTime(2020, 1, 2, 0, 0, 0), novac::CDateTime(2020, 1, 5, 0, 0, 0));
+    setup.m_instrument.push_back(instrument);
+
+    Evaluation::CFitWindowCache sut{ logger, GetDirectories() };
+    REQUIRE(sut.NumberOfLoadedFitWindows() == 0);
+
+    std::shared_ptr<const novac::CFitWindow> firstWindow = sut.GetFitWindow(setup, "ABC123", 0, novac::CDateTime(2020, 1, 1, 12, 0, 0));
+    REQUIRE(firstWindow != nullptr);
+    REQUIRE(firstWindow->reference[0].m_data != nullptr);
+    REQUIRE(sut.NumberOfLoadedFitWindows() == 1);
+
+    SECTION("Same fit window requested again - the same fit window is returned")
+    {
+        const auto secondRequest = sut.GetFitWindow(setup, "ABC123", 0, novac::CDateTime(2020, 1, 1, 18, 0, 0));
+
+        REQUIRE(secondRequest == firstWindow);
+        REQUIRE(sut.NumberOfLoadedFitWindows() == 1);
+    }
+
+    SECTION("Next fit window requested - both fit windows are kept")
+    {
+        const auto secondWindow = sut.GetFitWindow(setup, "ABC123", 0, novac::CDateTime(2020, 1, 2, 12, 0, 0));
+
+        REQUIRE(secondWindow != firstWindow);
+        REQUIRE(sut.NumberOfLoadedFitWindows() == 2);
+    }
+
+    SECTION("Scan after the release delay - the ended fit window is released but kept alive while used")
+    {
+        const auto secondWindow = sut.GetFitWindow(setup, "ABC123", 0, novac::CDateTime(2020, 1, 3, 6, 0, 0));
+
+        REQUIRE(secondWindow != firstWindow);
+        REQUIRE(sut.NumberOfLoadedFitWindows() == 1);
+        REQUIRE(firstWindow->reference[0].m_data != nullptr);
+
+        // Requested again, the released fit window is read again.
+        const auto readAgain = sut.GetFitWindow(setup, "ABC123", 0, novac::CDateTime(2020, 1, 1, 12, 0, 0));
+        REQUIRE(readAgain != firstWindow);
+    }
+
+    SECTION("Configuration of the instrument changed - the fit window is read again")
+    {
+        Configuration::CNovacPPPConfiguration modifiedSetup = setup;
+        modifiedSetup.m_instrument[0].m_evaluationRevision = 1;
+
+        const auto modifiedWindow = sut.GetFitWindow(modifiedSetup, "ABC123", 0, novac::CDateTime(2020, 1, 1, 12, 0, 0));
+
+        REQUIRE(modifiedWindow != firstWindow);
+        REQUIRE(sut.GetFitWindow(modifiedSetup, "ABC123", 0, novac::CDateTime(2020, 1, 1, 12, 0, 0)) == modifiedWindow);
+
+        // The fit window of the previous revision is still used, and is kept for the scans started before the change
+        REQUIRE(sut.NumberOfLoadedFitWindows() == 2);
+        REQUIRE(sut.GetFitWindow(setup, "ABC123", 0, novac::CDateTime(2020, 1, 1, 12, 0, 0)) == firstWindow);
+    }
+
+    SECTION("Configuration of the instrument changed - the fit window of the previous revision is released when no longer used")
+    {
+        Configuration::CNovacPPPConfiguration modifiedSetup = setup;
+        modifiedSetup.m_instrument[0].m_evaluationRevision = 1;
+        firstWindow.reset();
+
+        const auto modifiedWindow = sut.GetFitWindow(modifiedSetup, "ABC123", 0, novac::CDateTime(2020, 1, 1, 12, 0, 0));
+
+        REQUIRE(modifiedWindow != nullptr);
+        REQUIRE(sut.NumberOfLoadedFitWindows() == 1);
+    }
+
+    SECTION("Same fit window requested by several threads - all get the same fit window")
+    {
+        const auto secondWindowTime = novac::CDateTime(2020, 1, 2, 12, 0, 0);
+        std::set<const novac::CFitWindow*> windowsReturned;
+        std::mutex guard;
+
+        novac::ParallelFor(16, 8, [&](size_t)
+            {
+                const auto result = sut.GetFitWindow(setup, "ABC123", 0, secondWindowTime);
+
+                std::lock_guard<std::mutex> lock(guard);
+                windowsReturned.insert(result.get());
+            });
+
+        REQUIRE(windowsReturned.size() == 1);
+        REQUIRE(sut.NumberOfLoadedFitWindows() == 2);
+    }
+}
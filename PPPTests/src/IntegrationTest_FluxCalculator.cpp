@@ -1,11 +1,16 @@
 #include <PPPLib/Flux/FluxCalculator.h>
+#include <PPPLib/Flux/FluxSensitivity.h>
+#include <PPPLib/Flux/FluxUncertainty.h>
 #include <PPPLib/Configuration/UserConfiguration.h>
 #include <PPPLib/Configuration/NovacPPPConfiguration.h>
 #include <PPPLib/Meteorology/WindDataBase.h>
+#include <PPPLib/Geometry/PlumeDataBase.h>
 #include <PPPLib/Geometry/PlumeHeight.h>
 #include <SpectralEvaluation/File/File.h>
 #include "catch.hpp"
+#include <cmath>
 #include <iostream>
+#include <limits>
 
 
 static std::string GetTestDataDirectory()
@@ -320,3 +325,403 @@ TEST_CASE("CalculateFlux, valid scan with column values in molec/cm2 calculates
         REQUIRE(fluxResult.m_fluxQualityFlag == FluxQuality::Yellow); // result is ok
     }
 }
+
+TEST_CASE("CFluxSensitivityCalculator, valid scan calculates flux for each variant", "[CFluxSensitivityCalculator][IntegrationTest][Avantes][2002128M1_230120_1907_0_ReEvaluation]")
+{
+    // Arrange
+    Evaluation::CExtendedScanResult evaluationResult;
+    evaluationResult.m_evalLogFile.push_back(GetTestDataDirectory() + "2002128M1/2002128M1_230120_1907_0_ReEvaluation.txt");
+    evaluationResult.m_instrumentSerial = "2002128M1";
+    evaluationResult.m_startTime = novac::CDateTime(2023, 1, 20, 19, 07, 00);
+    evaluationResult.m_measurementMode = novac::MeasurementMode::Flux;
+    evaluationResult.m_scanProperties.completeness = 0.852;
+    novac::ConsoleLog logger;
+    novac::LogContext context;
+
+    Configuration::CUserConfiguration userSettings;
+    userSettings.m_completenessLimitFlux = 0.80;
+    userSettings.m_maxThreadNum = 2;
+
+    Configuration::CInstrumentLocation instrumentLocation;
+    instrumentLocation.m_spectrometerModel = "AVASPEC";
+    instrumentLocation.m_compass = 266.0;
+    instrumentLocation.m_coneangle = 60.0;
+    instrumentLocation.m_altitude = 2700;
+
+    Configuration::CInstrumentConfiguration instrumentConfiguration;
+    instrumentConfiguration.m_serial = "2002128M1";
+    instrumentConfiguration.m_location.InsertLocation(instrumentLocation);
+
+    Configuration::CNovacPPPConfiguration configuration;
+    configuration.m_instrument.push_back(instrumentConfiguration);
+
+    auto defaultSource = Meteorology::MeteorologySource::EcmwfForecast;
+    novac::CDateTime validFrom(2020, 01, 01, 00, 00, 00);
+    novac::CDateTime validTo(9999, 12, 31, 23, 59, 59);
+    Meteorology::WindField windField(10.54, defaultSource, 262.3, defaultSource, validFrom, validTo, -39.281302, 175.564254, 2700);
+    Meteorology::CWindDataBase windDataBase;
+    windDataBase.InsertWindField(windField);
+
+    Meteorology::CWindDataBase emptyWindDataBase;
+    Geometry::CPlumeDataBase emptyPlumeDataBase;
+
+    Flux::CFluxSensitivityCalculator sut(logger, configuration, userSettings);
+
+    // Act
+    std::vector<Evaluation::CExtendedScanResult> scanResults{ evaluationResult };
+    std::vector<Flux::FluxScanData> scans = sut.PrepareScans(context, scanResults);
+
+    std::vector<Flux::FluxSensitivityVariant> variants(4);
+    variants[0].windField = &windDataBase;
+    variants[0].plumeAltitude = 3500.0;
+    variants[1].windField = &windDataBase;
+    variants[1].plumeAltitude = 4300.0;
+    variants[2].windField = &emptyWindDataBase;
+    variants[2].plumeAltitude = 3500.0;
+    variants[3].windField = &windDataBase; // takes the plume altitude from the (empty) database
+    std::vector<double> fluxes = sut.CalculateFluxes(context, scans, variants, emptyPlumeDataBase);
+
+    // Assert
+    REQUIRE(scans.size() == 1);
+    REQUIRE(scans[0].instrument == "2002128M1");
+    REQUIRE(scans[0].instrumentType == novac::NovacInstrumentType::Gothenburg);
+
+    REQUIRE(fluxes.size() == 4);
+    REQUIRE(fluxes[0] == Approx(5.068).margin(0.001)); // same as calculated by CFluxCalculator
+    REQUIRE(fluxes[1] == Approx(2.0 * 5.068).margin(0.002)); // the flux scales with the height of the plume above the instrument
+    REQUIRE(std::isnan(fluxes[2])); // no wind field available
+    REQUIRE(std::isnan(fluxes[3])); // no plume altitude available
+}
+
+// Region CalculateFluxBatch
+
+static void PrepareReEvaluatedScan(novac::ILogger& logger, Configuration::CUserConfiguration& userSettings, double coneAngle, Flux::FluxScanData& scanData)
+{
+    Evaluation::CExtendedScanResult evaluationResult;
+    evaluationResult.m_evalLogFile.push_back(GetTestDataDirectory() + "2002128M1/2002128M1_230120_1907_0_ReEvaluation.txt");
+    evaluationResult.m_instrumentSerial = "2002128M1";
+    evaluationResult.m_startTime = novac::CDateTime(2023, 1, 20, 19, 07, 00);
+
+    userSettings.m_completenessLimitFlux = 0.80;
+
+    Configuration::CInstrumentLocation instrumentLocation;
+    instrumentLocation.m_spectrometerModel = "AVASPEC";
+    instrumentLocation.m_compass = 266.0;
+    instrumentLocation.m_coneangle = coneAngle;
+    instrumentLocation.m_altitude = 2700;
+
+    Configuration::CInstrumentConfiguration instrumentConfiguration;
+    instrumentConfiguration.m_serial = "2002128M1";
+    instrumentConfiguration.m_location.InsertLocation(instrumentLocation);
+
+    Configuration::CNovacPPPConfiguration configuration;
+    configuration.m_instrument.push_back(instrumentConfiguration);
+
+    Flux::CFluxCalculator sut(logger, configuration, userSettings);
+    REQUIRE(sut.PrepareFluxScanData(novac::LogContext(), evaluationResult, scanData));
+}
+
+static double CalculateFluxWithScalarKernel(Flux::CFluxCalculator& sut, const Flux::FluxScanData& scanData, double windSpeed, double windDirection, double relativePlumeHeight)
+{
+    auto source = Meteorology::MeteorologySource::User;
+    novac::CDateTime validFrom(2020, 01, 01, 00, 00, 00);
+    novac::CDateTime validTo(9999, 12, 31, 23, 59, 59);
+    Meteorology::WindField windField(windSpeed, source, windDirection, source, validFrom, validTo, -39.281302, 175.564254, 2700);
+
+    Geometry::PlumeHeight plumeHeight;
+    plumeHeight.m_plumeAltitude = relativePlumeHeight;
+
+    return sut.CalculateFlux(novac::LogContext(), scanData, windField, plumeHeight);
+}
+
+TEST_CASE("CalculateFluxBatch gives same fluxes as CalculateFlux", "[CFluxCalculator][CalculateFluxBatch][IntegrationTest][Avantes][2002128M1_230120_1907_0_ReEvaluation]")
+{
+    novac::ConsoleLog logger;
+    Configuration::CUserConfiguration userSettings;
+    Configuration::CNovacPPPConfiguration configuration;
+    Flux::CFluxCalculator sut(logger, configuration, userSettings);
+
+    // The combinations deliberately repeat some of the wind directions
+    const std::vector<double> windSpeeds{ 10.54, 10.54, 10.54, 2.0, 25.0, 7.5, 7.5, 0.5 };
+    const std::vector<double> windDirections{ 262.3, 252.3, 272.3, 262.3, 180.0, 45.0, 262.3, 359.0 };
+    const std::vector<double> plumeHeights{ 800.0, 800.0, 800.0, 1600.0, 200.0, 800.0, 3000.0, 50.0 };
+
+    SECTION("Conical scanner")
+    {
+        Flux::FluxScanData scanData;
+        PrepareReEvaluatedScan(logger, userSettings, 60.0, scanData);
+
+        std::vector<double> fluxes(windSpeeds.size());
+        sut.CalculateFluxBatch(novac::LogContext(), scanData, windSpeeds.data(), windDirections.data(), plumeHeights.data(), windSpeeds.size(), fluxes.data());
+
+        REQUIRE(fluxes[0] == Approx(5.068).margin(0.001)); // same as calculated by CalculateFlux above
+        for (size_t ii = 0; ii < windSpeeds.size(); ++ii)
+        {
+            const double expectedFlux = CalculateFluxWithScalarKernel(sut, scanData, windSpeeds[ii], windDirections[ii], plumeHeights[ii]);
+            REQUIRE(fluxes[ii] == Approx(expectedFlux).epsilon(1e-9));
+        }
+    }
+
+    SECTION("Flat scanner")
+    {
+        Flux::FluxScanData scanData;
+        PrepareReEvaluatedScan(logger, userSettings, 90.0, scanData);
+
+        std::vector<double> fluxes(windSpeeds.size());
+        sut.CalculateFluxBatch(novac::LogContext(), scanData, windSpeeds.data(), windDirections.data(), plumeHeights.data(), windSpeeds.size(), fluxes.data());
+
+        for (size_t ii = 0; ii < windSpeeds.size(); ++ii)
+        {
+            const double expectedFlux = CalculateFluxWithScalarKernel(sut, scanData, windSpeeds[ii], windDirections[ii], plumeHeights[ii]);
+            REQUIRE(fluxes[ii] == Approx(expectedFlux).epsilon(1e-9));
+        }
+    }
+
+    SECTION("Heidelberg scanner")
+    {
+        // The measured columns, with the scan angles and azimuths of a scanner moving in two angles.
+        Flux::FluxScanData scanData;
+        PrepareReEvaluatedScan(logger, userSettings, 90.0, scanData);
+        scanData.instrumentType = novac::NovacInstrumentType::Heidelberg;
+        const size_t nDataPoints = scanData.column.size();
+        for (size_t ii = 0; ii < nDataPoints; ++ii)
+        {
+            scanData.scanAngle[ii] = 10.0 + 160.0 * static_cast<double>(ii) / static_cast<double>(nDataPoints - 1);
+            scanData.scanAngle2[ii] = (ii % 2 == 0) ? 176.0 : 356.0;
+        }
+
+        std::vector<double> fluxes(windSpeeds.size());
+        sut.CalculateFluxBatch(novac::LogContext(), scanData, windSpeeds.data(), windDirections.data(), plumeHeights.data(), windSpeeds.size(), fluxes.data());
+
+        for (size_t ii = 0; ii < windSpeeds.size(); ++ii)
+        {
+            const double expectedFlux = CalculateFluxWithScalarKernel(sut, scanData, windSpeeds[ii], windDirections[ii], plumeHeights[ii]);
+            REQUIRE(std::isfinite(expectedFlux));
+            REQUIRE(fluxes[ii] == Approx(expectedFlux).epsilon(1e-9));
+        }
+    }
+
+    SECTION("Invalid wind direction gives NaN flux")
+    {
+        Flux::FluxScanData scanData;
+        PrepareReEvaluatedScan(logger, userSettings, 60.0, scanData);
+
+        const double windSpeed[2] = { 10.54, 10.54 };
+        const double windDirection[2] = { std::numeric_limits<double>::quiet_NaN(), 262.3 };
+        const double plumeHeight[2] = { 800.0, 800.0 };
+        double fluxes[2];
+        sut.CalculateFluxBatch(novac::LogContext(), scanData, windSpeed, windDirection, plumeHeight, 2, fluxes);
+
+        REQUIRE(std::isnan(fluxes[0]));
+        REQUIRE(fluxes[1] == Approx(5.068).margin(0.001));
+    }
+}
+
+TEST_CASE("CalculateFluxBatch, benchmark", "[.][CFluxCalculator][CalculateFluxBatch][Benchmark]")
+{
+    novac::ConsoleLog logger;
+    Configuration::CUserConfiguration userSettings;
+    Configuration::CNovacPPPConfiguration configuration;
+    Flux::CFluxCalculator sut(logger, configuration, userSettings);
+
+    Flux::FluxScanData scanData;
+    PrepareReEvaluatedScan(logger, userSettings, 60.0, scanData);
+
+    // A typical sensitivity study, three wind directions with ten plume heights each.
+    std::vector<double> windSpeeds;
+    std::vector<double> windDirections;
+    std::vector<double> plumeHeights;
+    for (double windDirection : { 252.3, 262.3, 272.3 })
+    {
+        for (int heightIdx = 1; heightIdx <= 10; ++heightIdx)
+        {
+            windSpeeds.push_back(10.54);
+            windDirections.push_back(windDirection);
+            plumeHeights.push_back(200.0 * heightIdx);
+        }
+    }
+    std::vector<double> fluxes(windSpeeds.size());
+
+    BENCHMARK("CalculateFlux, one combination at a time")
+    {
+        for (size_t ii = 0; ii < windSpeeds.size(); ++ii)
+        {
+            fluxes[ii] = CalculateFluxWithScalarKernel(sut, scanData, windSpeeds[ii], windDirections[ii], plumeHeights[ii]);
+        }
+        return fluxes[0];
+    };
+
+    BENCHMARK("CalculateFluxBatch")
+    {
+        sut.CalculateFluxBatch(novac::LogContext(), scanData, windSpeeds.data(), windDirections.data(), plumeHeights.data(), windSpeeds.size(), fluxes.data());
+        return fluxes[0];
+    };
+}
+
+// Endregion CalculateFluxBatch
+
+// Region CFluxUncertaintyCalculator
+
+TEST_CASE("CFluxUncertaintyCalculator::Percentile", "[CFluxUncertaintyCalculator][Percentile]")
+{
+    SECTION("Empty list gives NaN")
+    {
+        std::vector<double> values;
+        REQUIRE(std::isnan(Flux::CFluxUncertaintyCalculator::Percentile(values, 0.5)));
+    }
+
+    SECTION("Returns nearest ranked value")
+    {
+        std::vector<double> values{ 9.0, 1.0, 5.0, 3.0, 7.0 };
+        REQUIRE(Flux::CFluxUncertaintyCalculator::Percentile(values, 0.0) == 1.0);
+        REQUIRE(Flux::CFluxUncertaintyCalculator::Percentile(values, 0.5) == 5.0);
+        REQUIRE(Flux::CFluxUncertaintyCalculator::Percentile(values, 1.0) == 9.0);
+    }
+
+    SECTION("Ignores NaN values")
+    {
+        std::vector<double> values{ std::numeric_limits<double>::quiet_NaN(), 2.0, std::numeric_limits<double>::quiet_NaN(), 4.0, 6.0 };
+        REQUIRE(Flux::CFluxUncertaintyCalculator::Percentile(values, 0.5) == 4.0);
+    }
+}
+
+TEST_CASE("CalculateFlux, with uncertainty samples, calculates percentiles of flux", "[CFluxCalculator][CalculateFlux][CFluxUncertaintyCalculator][IntegrationTest][Avantes][2002128M1_230120_1907_0_ReEvaluation]")
+{
+    // Arrange
+    Evaluation::CExtendedScanResult evaluationResult;
+    evaluationResult.m_evalLogFile.push_back(GetTestDataDirectory() + "2002128M1/2002128M1_230120_1907_0_ReEvaluation.txt");
+    evaluationResult.m_instrumentSerial = "2002128M1";
+    evaluationResult.m_startTime = novac::CDateTime(2023, 1, 20, 19, 07, 00);
+    novac::ConsoleLog logger;
+    novac::LogContext context;
+
+    Configuration::CUserConfiguration userSettings;
+    userSettings.m_completenessLimitFlux = 0.80;
+
+    Configuration::CInstrumentLocation instrumentLocation;
+    instrumentLocation.m_spectrometerModel = "AVASPEC";
+    instrumentLocation.m_compass = 266.0;
+    instrumentLocation.m_coneangle = 60.0;
+    instrumentLocation.m_altitude = 2700;
+
+    Configuration::CInstrumentConfiguration instrumentConfiguration;
+    instrumentConfiguration.m_serial = "2002128M1";
+    instrumentConfiguration.m_location.InsertLocation(instrumentLocation);
+
+    Configuration::CNovacPPPConfiguration configuration;
+    configuration.m_instrument.push_back(instrumentConfiguration);
+
+    auto defaultSource = Meteorology::MeteorologySource::EcmwfForecast;
+    novac::CDateTime validFrom(2020, 01, 01, 00, 00, 00);
+    novac::CDateTime validTo(9999, 12, 31, 23, 59, 59);
+    Meteorology::WindField windField(10.54, defaultSource, 262.3, defaultSource, validFrom, validTo, -39.281302, 175.564254, 2700);
+    windField.SetWindSpeedError(2.0);
+    windField.SetWindDirectionError(10.0);
+    Meteorology::CWindDataBase windDataBase;
+    windDataBase.InsertWindField(windField);
+
+    Geometry::PlumeHeight plumeAltitude;
+    plumeAltitude.m_plumeAltitude = 3500;
+    plumeAltitude.m_plumeAltitudeError = 100.0;
+
+    SECTION("No samples configured, percentiles are not calculated")
+    {
+        userSettings.m_fluxUncertaintySamples = 0;
+        Flux::CFluxCalculator sut(logger, configuration, userSettings);
+
+        Flux::FluxResult fluxResult;
+        REQUIRE(sut.CalculateFlux(context, evaluationResult, windDataBase, plumeAltitude, fluxResult));
+
+        REQUIRE(std::isnan(fluxResult.m_fluxPercentile05));
+        REQUIRE(std::isnan(fluxResult.m_fluxPercentile50));
+        REQUIRE(std::isnan(fluxResult.m_fluxPercentile95));
+    }
+
+    SECTION("Samples configured, percentiles surround the calculated flux")
+    {
+        userSettings.m_fluxUncertaintySamples = 1000;
+        Flux::CFluxCalculator sut(logger, configuration, userSettings);
+
+        Flux::FluxResult fluxResult;
+        REQUIRE(sut.CalculateFlux(context, evaluationResult, windDataBase, plumeAltitude, fluxResult));
+
+        REQUIRE(fluxResult.m_flux == Approx(5.068).margin(0.001)); // the sampling does not change the flux itself
+        REQUIRE(fluxResult.m_fluxPercentile50 == Approx(fluxResult.m_flux).epsilon(0.05));
+        REQUIRE(fluxResult.m_fluxPercentile05 < 0.8 * fluxResult.m_flux); // the relative error in wind speed alone is 19%
+        REQUIRE(fluxResult.m_fluxPercentile95 > 1.2 * fluxResult.m_flux);
+    }
+
+    SECTION("Samples configured, percentiles are reproducible")
+    {
+        userSettings.m_fluxUncertaintySamples = 1000;
+        Flux::CFluxCalculator sut(logger, configuration, userSettings);
+
+        Flux::FluxResult fluxResult1;
+        Flux::FluxResult fluxResult2;
+        REQUIRE(sut.CalculateFlux(context, evaluationResult, windDataBase, plumeAltitude, fluxResult1));
+        REQUIRE(sut.CalculateFlux(context, evaluationResult, windDataBase, plumeAltitude, fluxResult2));
+
+        REQUIRE(fluxResult1.m_fluxPercentile05 == fluxResult2.m_fluxPercentile05);
+        REQUIRE(fluxResult1.m_fluxPercentile50 == fluxResult2.m_fluxPercentile50);
+        REQUIRE(fluxResult1.m_fluxPercentile95 == fluxResult2.m_fluxPercentile95);
+    }
+}
+
+TEST_CASE("CalculateFlux, with uncertainty samples, benchmark", "[.][CFluxCalculator][CFluxUncertaintyCalculator][Benchmark]")
+{
+    Evaluation::CExtendedScanResult evaluationResult;
+    evaluationResult.m_evalLogFile.push_back(GetTestDataDirectory() + "2002128M1/2002128M1_230120_1907_0_ReEvaluation.txt");
+    evaluationResult.m_instrumentSerial = "2002128M1";
+    evaluationResult.m_startTime = novac::CDateTime(2023, 1, 20, 19, 07, 00);
+    novac::ConsoleLog logger;
+    novac::LogContext context;
+
+    Configuration::CUserConfiguration userSettings;
+    userSettings.m_completenessLimitFlux = 0.80;
+
+    Configuration::CInstrumentLocation instrumentLocation;
+    instrumentLocation.m_spectrometerModel = "AVASPEC";
+    instrumentLocation.m_compass = 266.0;
+    instrumentLocation.m_coneangle = 60.0;
+    instrumentLocation.m_altitude = 2700;
+
+    Configuration::CInstrumentConfiguration instrumentConfiguration;
+    instrumentConfiguration.m_serial = "2002128M1";
+    instrumentConfiguration.m_location.InsertLocation(instrumentLocation);
+
+    Configuration::CNovacPPPConfiguration configuration;
+    configuration.m_instrument.push_back(instrumentConfiguration);
+
+    auto defaultSource = Meteorology::MeteorologySource::EcmwfForecast;
+    novac::CDateTime validFrom(2020, 01, 01, 00, 00, 00);
+    novac::CDateTime validTo(9999, 12, 31, 23, 59, 59);
+    Meteorology::WindField windField(10.54, defaultSource, 262.3, defaultSource, validFrom, validTo, -39.281302, 175.564254, 2700);
+    windField.SetWindSpeedError(2.0);
+    windField.SetWindDirectionError(10.0);
+    Meteorology::CWindDataBase windDataBase;
+    windDataBase.InsertWindField(windField);
+
+    Geometry::PlumeHeight plumeAltitude;
+    plumeAltitude.m_plumeAltitude = 3500;
+    plumeAltitude.m_plumeAltitudeError = 100.0;
+
+    BENCHMARK("CalculateFlux without uncertainty samples")
+    {
+        userSettings.m_fluxUncertaintySamples = 0;
+        Flux::CFluxCalculator sut(logger, configuration, userSettings);
+        Flux::FluxResult fluxResult;
+        sut.CalculateFlux(context, evaluationResult, windDataBase, plumeAltitude, fluxResult);
+        return fluxResult.m_flux;
+    };
+
+    BENCHMARK("CalculateFlux with 1000 uncertainty samples")
+    {
+        userSettings.m_fluxUncertaintySamples = 1000;
+        Flux::CFluxCalculator sut(logger, configuration, userSettings);
+        Flux::FluxResult fluxResult;
+        sut.CalculateFlux(context, evaluationResult, windDataBase, plumeAltitude, fluxResult);
+        return fluxResult.m_fluxPercentile50;
+    };
+}
+
+// Endregion CFluxUncertaintyCalculator
@@ -306,6 +306,66 @@ TEST_CASE("EvaluateScan, scan with visible plume)", "[ScanEvaluation][EvaluateSc
         REQUIRE(Approx(-1.8e17).margin(2e16) == Min(columns));
     }
 
+    SECTION("Find optimum shift with large tolerance uses result of first evaluation")
+    {
+        userSettings.m_optimalShiftTolerance = 1.0; // larger than the expected shift of ~0.08 pixels
+        userSettings.m_optimalSqueezeTolerance = 0.1;
+
+        novac::CFitWindow fitWindow;
+        fitWindow.fitType = novac::FIT_TYPE::FIT_HP_DIV;
+        fitWindow.findOptimalShift = 1;
+        SetupFitWindow(fitWindow);
+        PrepareFitWindow(logger, context, "2002128M1", fitWindow, setup);
+
+        Evaluation::CScanEvaluation sut(userSettings, logger);
+
+        // Act
+        auto result = sut.EvaluateScan(context, scan, fitWindow, spectrometerModel, darkSettings);
+
+        // Assert
+        REQUIRE(result != nullptr);
+        REQUIRE(44 == result->GetEvaluatedNum());
+
+        // The shift and squeeze are the ones from the first evaluation
+        for (size_t specIdx = 0; specIdx < result->GetEvaluatedNum(); ++specIdx)
+        {
+            REQUIRE(0.0 == result->GetShift(specIdx, 0));
+            REQUIRE(1.0 == result->GetSqueeze(specIdx, 0));
+        }
+    }
+
+    SECTION("Find optimum shift with tolerance smaller than the shift evaluates scan again")
+    {
+        userSettings.m_optimalShiftTolerance = 0.01; // smaller than the expected shift of ~0.08 pixels
+        userSettings.m_optimalSqueezeTolerance = 0.1;
+
+        novac::CFitWindow fitWindow;
+        fitWindow.fitType = novac::FIT_TYPE::FIT_HP_DIV;
+        fitWindow.findOptimalShift = 1;
+        SetupFitWindow(fitWindow);
+        PrepareFitWindow(logger, context, "2002128M1", fitWindow, setup);
+
+        const double expectedShift = 0.07769;
+
+        Evaluation::CScanEvaluation sut(userSettings, logger);
+
+        // Act
+        auto result = sut.EvaluateScan(context, scan, fitWindow, spectrometerModel, darkSettings);
+
+        // Assert
+        REQUIRE(result != nullptr);
+        REQUIRE(44 == result->GetEvaluatedNum());
+
+        // The shift and squeeze are the optimized ones
+        for (size_t specIdx = 0; specIdx < result->GetEvaluatedNum(); ++specIdx)
+        {
+            REQUIRE(Approx(expectedShift).margin(0.001) == result->GetShift(specIdx, 0));
+            REQUIRE(Approx(1.00) == result->GetSqueeze(specIdx, 0));
+        }
+
+        REQUIRE(Approx(-1.593e17).margin(1e16) == result->GetColumn(0, 0));
+    }
+
     SECTION("Find optimum shift from Fraunhofer reference")
     {
         novac::CFitWindow fitWindow;
@@ -380,6 +440,67 @@ TEST_CASE("EvaluateScan, scan with visible plume)", "[ScanEvaluation][EvaluateSc
         REQUIRE(-90.0 == result->GetScanAngle(0));
         REQUIRE(90.0 == result->GetScanAngle(50));
     }
+
+    SECTION("Spectra evaluated in parallel gives same result as serial evaluation")
+    {
+        novac::CFitWindow fitWindow;
+        fitWindow.fitType = novac::FIT_TYPE::FIT_HP_DIV;
+        SetupFitWindow(fitWindow);
+        PrepareFitWindow(logger, context, "2002128M1", fitWindow, setup);
+
+        Evaluation::CScanEvaluation serialEvaluation(userSettings, logger);
+        auto expectedResult = serialEvaluation.EvaluateScan(context, scan, fitWindow, spectrometerModel, darkSettings);
+        REQUIRE(expectedResult != nullptr);
+
+        Configuration::CUserConfiguration parallelUserSettings = userSettings;
+        parallelUserSettings.m_spectrumThreadNum = 4;
+        Evaluation::CScanEvaluation sut(parallelUserSettings, logger);
+
+        // Act
+        auto result = sut.EvaluateScan(context, scan, fitWindow, spectrometerModel, darkSettings);
+
+        // Assert
+        REQUIRE(result != nullptr);
+        REQUIRE(expectedResult->GetEvaluatedNum() == result->GetEvaluatedNum());
+        for (size_t specIdx = 0; specIdx < result->GetEvaluatedNum(); ++specIdx)
+        {
+            REQUIRE(expectedResult->GetScanAngle(specIdx) == result->GetScanAngle(specIdx));
+            REQUIRE(expectedResult->GetColumn(specIdx, 0) == result->GetColumn(specIdx, 0));
+            REQUIRE(expectedResult->GetColumnError(specIdx, 0) == result->GetColumnError(specIdx, 0));
+            REQUIRE(expectedResult->GetChiSquare(specIdx) == result->GetChiSquare(specIdx));
+            REQUIRE(expectedResult->IsOk(specIdx) == result->IsOk(specIdx));
+        }
+    }
+
+    SECTION("Find optimum shift with spectra evaluated in parallel gives same result as serial evaluation")
+    {
+        novac::CFitWindow fitWindow;
+        fitWindow.fitType = novac::FIT_TYPE::FIT_HP_DIV;
+        fitWindow.findOptimalShift = 1;
+        SetupFitWindow(fitWindow);
+        PrepareFitWindow(logger, context, "2002128M1", fitWindow, setup);
+
+        Evaluation::CScanEvaluation serialEvaluation(userSettings, logger);
+        auto expectedResult = serialEvaluation.EvaluateScan(context, scan, fitWindow, spectrometerModel, darkSettings);
+        REQUIRE(expectedResult != nullptr);
+
+        Configuration::CUserConfiguration parallelUserSettings = userSettings;
+        parallelUserSettings.m_spectrumThreadNum = 3;
+        Evaluation::CScanEvaluation sut(parallelUserSettings, logger);
+
+        // Act
+        auto result = sut.EvaluateScan(context, scan, fitWindow, spectrometerModel, darkSettings);
+
+        // Assert
+        REQUIRE(result != nullptr);
+        REQUIRE(expectedResult->GetEvaluatedNum() == result->GetEvaluatedNum());
+        for (size_t specIdx = 0; specIdx < result->GetEvaluatedNum(); ++specIdx)
+        {
+            REQUIRE(expectedResult->GetColumn(specIdx, 0) == result->GetColumn(specIdx, 0));
+            REQUIRE(expectedResult->GetShift(specIdx, 0) == result->GetShift(specIdx, 0));
+            REQUIRE(expectedResult->GetSqueeze(specIdx, 0) == result->GetSqueeze(specIdx, 0));
+        }
+    }
 }
 
 TEST_CASE("EvaluateScan, scan with visible plume and calibrated references", "[ScanEvaluation][EvaluateScan][IntegrationTest][Avantes][2002128M1_230120_1907_0]")
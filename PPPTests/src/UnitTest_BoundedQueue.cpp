@@ -0,0 +1,200 @@
+#include <PPPLib/BoundedQueue.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "catch.hpp"
+
+namespace novac
+{
+
+TEST_CASE("BoundedQueue, items are popped in the order they were pushed", "[BoundedQueue]")
+{
+    BoundedQueue<std::string> sut{ 0, 0 };
+    REQUIRE(sut.Push("first", 10));
+    REQUIRE(sut.Push("second", 20));
+    sut.Close();
+
+    std::string item;
+    size_t bytes = 0;
+
+    REQUIRE(sut.Pop(item, bytes));
+    REQUIRE(item == "first");
+    REQUIRE(bytes == 10);
+
+    REQUIRE(sut.Pop(item, bytes));
+    REQUIRE(item == "second");
+    REQUIRE(bytes == 20);
+
+    REQUIRE_FALSE(sut.Pop(item, bytes));
+}
+
+TEST_CASE("BoundedQueue, items are in flight until released", "[BoundedQueue]")
+{
+    BoundedQueue<int> sut{ 0, 0 };
+    sut.Push(1, 100);
+    sut.Push(2, 200);
+
+    int item = 0;
+    size_t bytes = 0;
+    sut.Pop(item, bytes);
+
+    REQUIRE(sut.ItemsInFlight() == 2);
+    REQUIRE(sut.BytesInFlight() == 300);
+
+    sut.Release(bytes);
+
+    REQUIRE(sut.ItemsInFlight() == 1);
+    REQUIRE(sut.BytesInFlight() == 200);
+}
+
+TEST_CASE("BoundedQueue, closed queue - push returns false", "[BoundedQueue]")
+{
+    BoundedQueue<int> sut{ 1, 0 };
+    sut.Close();
+
+    REQUIRE_FALSE(sut.Push(1, 1));
+    REQUIRE(sut.ItemsInFlight() == 0);
+}
+
+TEST_CASE("BoundedQueue, item larger than the byte limit - pushed when queue is empty", "[BoundedQueue]")
+{
+    BoundedQueue<int> sut{ 0, 100 };
+
+    REQUIRE(sut.Push(1, 1000));
+    REQUIRE(sut.BytesInFlight() == 1000);
+}
+
+TEST_CASE("BoundedQueue, producer blocks while the limits are reached", "[BoundedQueue]")
+{
+    SECTION("Item limit")
+    {
+        BoundedQueue<int> sut{ 2, 0 };
+        sut.Push(1, 1);
+        sut.Push(2, 1);
+
+        std::atomic<bool> thirdItemPushed{ false };
+        std::thread producer([&]()
+            {
+                sut.Push(3, 1);
+                thirdItemPushed = true;
+            });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        REQUIRE_FALSE(thirdItemPushed);
+
+        // Popping the item is not enough, it is still in flight.
+        int item = 0;
+        size_t bytes = 0;
+        sut.Pop(item, bytes);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        REQUIRE_FALSE(thirdItemPushed);
+
+        sut.Release(bytes);
+        producer.join();
+        REQUIRE(thirdItemPushed);
+        REQUIRE(sut.ItemsInFlight() == 2);
+    }
+
+    SECTION("Byte limit")
+    {
+        BoundedQueue<int> sut{ 0, 100 };
+        sut.Push(1, 60);
+
+        std::atomic<bool> secondItemPushed{ false };
+        std::thread producer([&]()
+            {
+                sut.Push(2, 60);
+                secondItemPushed = true;
+            });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        REQUIRE_FALSE(secondItemPushed);
+
+        int item = 0;
+        size_t bytes = 0;
+        sut.Pop(item, bytes);
+        sut.Release(bytes);
+        producer.join();
+        REQUIRE(secondItemPushed);
+        REQUIRE(sut.BytesInFlight() == 60);
+    }
+}
+
+TEST_CASE("BoundedQueue, close releases waiting producer", "[BoundedQueue]")
+{
+    BoundedQueue<int> sut{ 1, 0 };
+    sut.Push(1, 1);
+
+    bool pushResult = true;
+    std::thread producer([&]()
+        {
+            pushResult = sut.Push(2, 1);
+        });
+
+    sut.Close();
+    producer.join();
+
+    REQUIRE_FALSE(pushResult);
+    REQUIRE(sut.ItemsInFlight() == 1);
+}
+
+TEST_CASE("BoundedQueue, several producers and consumers - all items processed once", "[BoundedQueue]")
+{
+    const int itemsPerProducer = 500;
+    BoundedQueue<int> sut{ 4, 0 };
+    std::atomic<int> sumOfItems{ 0 };
+    std::atomic<int> numberOfItems{ 0 };
+    std::atomic<size_t> maximumInFlight{ 0 };
+
+    std::vector<std::thread> consumers;
+    for (int threadIdx = 0; threadIdx < 4; ++threadIdx)
+    {
+        consumers.push_back(std::thread([&]()
+            {
+                int item = 0;
+                size_t bytes = 0;
+                while (sut.Pop(item, bytes))
+                {
+                    const size_t inFlight = sut.ItemsInFlight();
+                    if (inFlight > maximumInFlight)
+                    {
+                        maximumInFlight = inFlight;
+                    }
+                    sumOfItems += item;
+                    ++numberOfItems;
+                    sut.Release(bytes);
+                }
+            }));
+    }
+
+    std::vector<std::thread> producers;
+    for (int threadIdx = 0; threadIdx < 2; ++threadIdx)
+    {
+        producers.push_back(std::thread([&]()
+            {
+                for (int ii = 1; ii <= itemsPerProducer; ++ii)
+                {
+                    sut.Push(ii, 1);
+                }
+            }));
+    }
+
+    for (std::thread& t : producers)
+    {
+        t.join();
+    }
+    sut.Close();
+    for (std::thread& t : consumers)
+    {
+        t.join();
+    }
+
+    REQUIRE(numberOfItems == 2 * itemsPerProducer);
+    REQUIRE(sumOfItems == itemsPerProducer * (itemsPerProducer + 1));
+    REQUIRE(maximumInFlight <= 4);
+    REQUIRE(sut.ItemsInFlight() == 0);
+}
+
+}
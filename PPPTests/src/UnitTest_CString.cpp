@@ -145,6 +145,63 @@ TEST_CASE("Format behaves as expected", "[CString]")
 
         REQUIRE(sut.ToStdString() == original);
     }
+
+    SECTION("Numbers")
+    {
+        CString sut;
+        sut.Format("%d\t%.2lf\t%02d:%02d\t%.2e", -17, 3.14159, 5, 7, 12345.0);
+
+        REQUIRE(sut.ToStdString() == "-17\t3.14\t05:07\t1.23e+04");
+    }
+
+    SECTION("Empty format - clears existing contents")
+    {
+        CString sut{ original };
+        sut.Format("");
+
+        REQUIRE(sut.GetLength() == 0);
+    }
+
+    SECTION("Very long string - is not truncated")
+    {
+        const std::string longString(100000, 'x');
+
+        CString sut;
+        sut.Format("<%s>", longString.c_str());
+
+        REQUIRE(sut.GetLength() == longString.size() + 2);
+        REQUIRE(sut.ToStdString() == "<" + longString + ">");
+    }
+
+    SECTION("String of the same length as the internal buffer - is not truncated")
+    {
+        for (size_t length = 500; length < 530; ++length)
+        {
+            const std::string longString(length, 'y');
+
+            CString sut;
+            sut.Format("%s", longString.c_str());
+
+            REQUIRE(sut.ToStdString() == longString);
+        }
+    }
+
+    SECTION("Formatting using the own contents")
+    {
+        CString sut{ original };
+        sut.Format("%s and %s", (const char*)sut, (const char*)sut);
+
+        REQUIRE(sut.ToStdString() == original + " and " + original);
+    }
+
+    SECTION("FormatString")
+    {
+        const std::string longString(2000, 'z');
+
+        CString sut = CString::FormatString("%s%d", longString.c_str(), 42);
+
+        REQUIRE(sut.ToStdString() == longString + "42");
+    }
 }
 
 TEST_CASE("AppendFormat behaves as expected", "[CString]")
@@ -172,6 +229,76 @@ TEST_CASE("AppendFormat behaves as expected", "[CString]")
 
         REQUIRE(sut.ToStdString() == first + second);
     }
+
+    SECTION("Many appends")
+    {
+        std::string expected;
+
+        CString sut;
+        for (int k = 0; k < 10000; ++k)
+        {
+            sut.AppendFormat("%d\t", k);
+            expected += std::to_string(k) + "\t";
+        }
+
+        REQUIRE(sut.ToStdString() == expected);
+    }
+
+    SECTION("Very long string - is not truncated")
+    {
+        const std::string longString(100000, 'x');
+
+        CString sut{ first };
+        sut.AppendFormat("%s", longString.c_str());
+
+        REQUIRE(sut.ToStdString() == first + longString);
+    }
+
+    SECTION("Appending the own contents, longer than the internal buffer")
+    {
+        const std::string longString(1000, 'x');
+
+        CString sut{ longString };
+        sut.AppendFormat("%s", (const char*)sut);
+
+        REQUIRE(sut.ToStdString() == longString + longString);
+    }
+
+    SECTION("Single characters")
+    {
+        CString sut;
+        sut.AppendFormat("%c", 'a');
+        sut.AppendFormat("%c%c", 'b', 'c');
+
+        REQUIRE(sut.ToStdString() == "abc");
+    }
+}
+
+TEST_CASE("CleanString behaves as expected", "[CString]")
+{
+    SECTION("Removes control characters")
+    {
+        CString result;
+        CleanString("Mary\thad\r\na little\x01 lamb", result);
+
+        REQUIRE(result.ToStdString() == "Maryhada little lamb");
+    }
+
+    SECTION("Empty string")
+    {
+        CString result{ "previous contents" };
+        CleanString("", result);
+
+        REQUIRE(result.GetLength() == 0);
+    }
+
+    SECTION("Same string as input and output")
+    {
+        CString sut{ "Twinkle\t twinkle" };
+        CleanString(sut, sut);
+
+        REQUIRE(sut.ToStdString() == "Twinkle twinkle");
+    }
 }
 
 TEST_CASE("Append behaves as expected", "[CString]")
@@ -341,4 +468,34 @@ TEST_CASE("Equals behaves as expected", "[CString]")
         REQUIRE(1 == Equals("APA", "apa"));
     }
 }
-}
\ No newline at end of file
+TEST_CASE("CString formatting, benchmark", "[.][CString][Benchmark]")
+{
+    BENCHMARK("Format")
+    {
+        CString str;
+        str.Format("%.0lf\t%02d:%02d:%02d\t%.2lf", 45.0, 12, 34, 56, 0.123);
+        return str.GetLength();
+    };
+
+    BENCHMARK("AppendFormat, evaluation log line")
+    {
+        CString str;
+        str.Format("%.0lf\t", 45.0);
+        str.AppendFormat("%02d:%02d:%02d\t", 12, 34, 56);
+        str.AppendFormat("%02d:%02d:%02d\t", 12, 35, 10);
+        for (int k = 0; k < 20; ++k)
+        {
+            str.AppendFormat("%.2e\t%.2e\t", 1.23e17, 4.56e15);
+        }
+        return str.GetLength();
+    };
+
+    const std::string longString(1000, 'x');
+    BENCHMARK("CleanString")
+    {
+        CString result;
+        CleanString(longString.c_str(), result);
+        return result.GetLength();
+    };
+}
+}
@@ -179,6 +179,39 @@ TEST_CASE("MaxThreadNum overrides default", "[CommandLineParser][Configuration]"
     REQUIRE(userSettings.m_maxThreadNum == 73);
 }
 
+TEST_CASE("MaxScansInFlight and MaxMegabytesInFlight override default", "[CommandLineParser][Configuration]")
+{
+    // Arrange
+    std::string setExePath;
+    std::vector<std::string>arguments = { "--MaxScansInFlight=12", "--MaxMegabytesInFlight=0" };
+    Configuration::CUserConfiguration userSettings;
+    novac::CVolcanoInfo volcanoes;
+    novac::ConsoleLog logger;
+
+    // Act
+    CommandLineParser::ParseCommandLineOptions(arguments, userSettings, volcanoes, setExePath, logger);
+
+    // Assert
+    REQUIRE(userSettings.m_maxScansInFlight == 12);
+    REQUIRE(userSettings.m_maxMegabytesInFlight == 0);
+}
+
+TEST_CASE("ConfigurationReloadInterval overrides default", "[CommandLineParser][Configuration]")
+{
+    // Arrange
+    std::string setExePath;
+    std::vector<std::string>arguments = { "--ConfigurationReloadInterval=60" };
+    Configuration::CUserConfiguration userSettings;
+    novac::CVolcanoInfo volcanoes;
+    novac::ConsoleLog logger;
+
+    // Act
+    CommandLineParser::ParseCommandLineOptions(arguments, userSettings, volcanoes, setExePath, logger);
+
+    // Assert
+    REQUIRE(userSettings.m_configurationReloadInterval == 60);
+}
+
 TEST_CASE("IncludeSubDirs_Local overrides default", "[CommandLineParser][Configuration]")
 {
     // Arrange
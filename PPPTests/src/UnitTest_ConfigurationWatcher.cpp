@@ -0,0 +1,171 @@
+#include <PPPLib/Configuration/ConfigurationWatcher.h>
+#include <PPPLib/File/EvaluationConfigurationParser.h>
+#include <PPPLib/File/Filesystem.h>
+#include <PPPLib/File/SetupFileReader.h>
+#include <Poco/File.h>
+#include <Poco/Timestamp.h>
+#include <cmath>
+#include <cstdio>
+#include "catch.hpp"
+
+namespace novac
+{
+static std::string GetConfigurationDirectory()
+{
+#ifdef _MSC_VER
+    return std::string("../testData/ConfigurationWatcher/");
+#else
+    return std::string("testData/ConfigurationWatcher/");
+#endif // _MSC_VER
+}
+
+/** Sets the modification time of the file explicitly, such that the modification is seen
+    even if the file system has a coarse resolution of the modification times. */
+static void SetModificationTime(const std::string& fileName, int secondsSinceEpoch)
+{
+    Poco::File(fileName).setLastModified(Poco::Timestamp::fromEpochTime(secondsSinceEpoch));
+}
+
+static Configuration::CInstrumentConfiguration CreateInstrument(const std::string& serial, double latitude)
+{
+    Configuration::CInstrumentConfiguration instrument;
+    instrument.m_serial = serial;
+
+    Configuration::CInstrumentLocation location;
+    location.m_locationName = "Location of " + serial;
+    location.m_volcano = "Masaya";
+    location.m_latitude = latitude;
+    location.m_longitude = -86.1;
+    location.m_validFrom = novac::CDateTime(2005, 01, 01, 0, 0, 0);
+    location.m_validTo = novac::CDateTime(2030, 12, 31, 23, 59, 59);
+    instrument.m_location.InsertLocation(location);
+
+    return instrument;
+}
+
+static void WriteEvaluationFile(const std::string& serial, int fitLow, int modificationTime)
+{
+    Configuration::CEvaluationConfiguration evaluationSettings;
+    evaluationSettings.m_serial = serial;
+
+    novac::CFitWindow window;
+    window.fitLow = fitLow;
+    window.fitHigh = 460;
+    window.fitType = novac::FIT_TYPE::FIT_POLY;
+    window.name = "SO2";
+    window.polyOrder = 3;
+    window.reference.push_back(novac::CReferenceFile{ "C:/SO2_reference.txt" });
+    evaluationSettings.InsertFitWindow(window, novac::CDateTime(2005, 01, 01, 0, 0, 0), novac::CDateTime(2030, 12, 31, 23, 59, 59));
+
+    novac::ConsoleLog logger;
+    FileHandler::CEvaluationConfigurationParser writer{ logger };
+    const std::string fileName = GetConfigurationDirectory() + serial + ".exml";
+    (void)writer.WriteConfigurationFile(fileName, evaluationSettings, Configuration::CDarkCorrectionConfiguration(), Configuration::CInstrumentCalibrationConfiguration());
+    SetModificationTime(fileName, modificationTime);
+}
+
+static Configuration::CNovacPPPConfiguration WriteAndReadConfiguration()
+{
+    Filesystem::CreateDirectoryStructure(GetConfigurationDirectory());
+
+    Configuration::CNovacPPPConfiguration setup;
+    setup.m_instrument.push_back(CreateInstrument("I2J8549", 11.98));
+    setup.m_instrument.push_back(CreateInstrument("D2J2200", 12.01));
+
+    novac::ConsoleLog logger;
+    FileHandler::CSetupFileReader setupWriter{ logger };
+    (void)setupWriter.WriteSetupFile(GetConfigurationDirectory() + "setup.xml", setup);
+    SetModificationTime(GetConfigurationDirectory() + "setup.xml", 1000000);
+
+    WriteEvaluationFile("I2J8549", 310, 1000000);
+    WriteEvaluationFile("D2J2200", 320, 1000000);
+
+    // Read the configuration back in, as done when the processing starts.
+    Configuration::CNovacPPPConfiguration result;
+    setupWriter.ReadSetupFile(GetConfigurationDirectory() + "setup.xml", result);
+    FileHandler::CEvaluationConfigurationParser evaluationReader{ logger };
+    for (auto& instrument : result.m_instrument)
+    {
+        (void)evaluationReader.ReadConfigurationFile(GetConfigurationDirectory() + instrument.m_serial.std_str() + ".exml", instrument.m_eval, instrument.m_darkCurrentCorrection, instrument.m_instrumentCalibration);
+    }
+
+    return result;
+}
+
+TEST_CASE("CConfigurationWatcher, files not modified - keeps the configuration", "[ConfigurationWatcher][Configuration]")
+{
+    novac::ConsoleLog logger;
+    Configuration::CConfigurationWatcher sut{ logger, GetConfigurationDirectory(), WriteAndReadConfiguration() };
+    const auto initialConfiguration = sut.Current();
+
+    REQUIRE(false == sut.ReloadIfModified());
+    REQUIRE(initialConfiguration == sut.Current());
+    REQUIRE(2 == initialConfiguration->NumberOfInstruments());
+}
+
+TEST_CASE("CConfigurationWatcher, evaluation file modified - only the modified instrument is read again", "[ConfigurationWatcher][Configuration]")
+{
+    novac::ConsoleLog logger;
+    Configuration::CConfigurationWatcher sut{ logger, GetConfigurationDirectory(), WriteAndReadConfiguration() };
+    const auto initialConfiguration = sut.Current();
+
+    WriteEvaluationFile("D2J2200", 330, 1000100);
+
+    REQUIRE(true == sut.ReloadIfModified());
+    const auto newConfiguration = sut.Current();
+    REQUIRE(initialConfiguration != newConfiguration);
+
+    // The modified instrument has the new settings and a new revision
+    REQUIRE(330 == newConfiguration->GetInstrument("D2J2200")->m_eval.GetFitWindow(0).window.fitLow);
+    REQUIRE(newConfiguration->GetInstrument("D2J2200")->m_evaluationRevision > initialConfiguration->GetInstrument("D2J2200")->m_evaluationRevision);
+
+    // The other instrument is unchanged
+    REQUIRE(310 == newConfiguration->GetInstrument("I2J8549")->m_eval.GetFitWindow(0).window.fitLow);
+    REQUIRE(newConfiguration->GetInstrument("I2J8549")->m_evaluationRevision == initialConfiguration->GetInstrument("I2J8549")->m_evaluationRevision);
+
+    // The previous snapshot is not changed
+    REQUIRE(320 == initialConfiguration->GetInstrument("D2J2200")->m_eval.GetFitWindow(0).window.fitLow);
+
+    SECTION("Not read again until modified again")
+    {
+        REQUIRE(false == sut.ReloadIfModified());
+        REQUIRE(newConfiguration == sut.Current());
+    }
+}
+
+TEST_CASE("CConfigurationWatcher, setup file modified - instrument locations are updated", "[ConfigurationWatcher][Configuration]")
+{
+    novac::ConsoleLog logger;
+    Configuration::CConfigurationWatcher sut{ logger, GetConfigurationDirectory(), WriteAndReadConfiguration() };
+
+    Configuration::CNovacPPPConfiguration correctedSetup;
+    correctedSetup.m_instrument.push_back(CreateInstrument("I2J8549", 11.5));
+    correctedSetup.m_instrument.push_back(CreateInstrument("D2J2200", 12.01));
+    FileHandler::CSetupFileReader setupWriter{ logger };
+    (void)setupWriter.WriteSetupFile(GetConfigurationDirectory() + "setup.xml", correctedSetup);
+    SetModificationTime(GetConfigurationDirectory() + "setup.xml", 1000100);
+
+    REQUIRE(true == sut.ReloadIfModified());
+    const auto newConfiguration = sut.Current();
+
+    REQUIRE(2 == newConfiguration->NumberOfInstruments());
+    REQUIRE(std::abs(newConfiguration->GetInstrumentLocation("I2J8549", novac::CDateTime(2020, 1, 1, 12, 0, 0)).m_latitude - 11.5) < 1e-5);
+
+    // The evaluation settings are kept, and not read again
+    REQUIRE(310 == newConfiguration->GetInstrument("I2J8549")->m_eval.GetFitWindow(0).window.fitLow);
+    REQUIRE(0 == newConfiguration->GetInstrument("I2J8549")->m_evaluationRevision);
+}
+
+TEST_CASE("CConfigurationWatcher, modified evaluation file cannot be read - keeps the configuration", "[ConfigurationWatcher][Configuration]")
+{
+    novac::ConsoleLog logger;
+    Configuration::CConfigurationWatcher sut{ logger, GetConfigurationDirectory(), WriteAndReadConfiguration() };
+    const auto initialConfiguration = sut.Current();
+
+    std::remove((GetConfigurationDirectory() + "D2J2200.exml").c_str());
+
+    REQUIRE(false == sut.ReloadIfModified());
+    REQUIRE(initialConfiguration == sut.Current());
+}
+
+}
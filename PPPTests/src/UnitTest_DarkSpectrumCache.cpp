@@ -0,0 +1,160 @@
+#include <PPPLib/Evaluation/DarkSpectrumCache.h>
+#include <vector>
+#include "catch.hpp"
+
+namespace Evaluation
+{
+
+// Region Helper methods
+
+static novac::CSpectrum CreateSpectrum(double exposureTime, long numSpectra, int scanIndex, double baseValue)
+{
+    novac::CSpectrum spectrum;
+    spectrum.m_length = 512;
+    spectrum.m_info.m_exposureTime = static_cast<long>(exposureTime);
+    spectrum.m_info.m_numSpec = numSpectra;
+    spectrum.m_info.m_scanIndex = static_cast<short>(scanIndex);
+    for (int pixelIdx = 0; pixelIdx < spectrum.m_length; ++pixelIdx)
+    {
+        spectrum.m_data[pixelIdx] = numSpectra * (baseValue + 0.25 * pixelIdx);
+    }
+    return spectrum;
+}
+
+/** Creates a dark spectrum which only depends on the exposure time and the number of co-adds of the spectrum,
+    in the same way as the dark spectra stored in a scan. */
+static bool GetFakeDark(const novac::CSpectrum& spec, novac::CSpectrum& dark)
+{
+    dark = CreateSpectrum(spec.m_info.m_exposureTime, spec.NumSpectra(), 1, 100.0 + 0.5 * spec.m_info.m_exposureTime);
+    return true;
+}
+
+/** Removes the dark spectrum from the given spectrum the same way as done before the dark spectra were cached */
+static void RemoveDarkWithoutCache(novac::CSpectrum& spectrum, bool averagedSpectra)
+{
+    novac::CSpectrum dark;
+    GetFakeDark(spectrum, dark);
+
+    if (spectrum.NumSpectra() > 0 && !averagedSpectra)
+    {
+        spectrum.Div(spectrum.NumSpectra());
+    }
+    if (dark.NumSpectra() > 0 && !averagedSpectra)
+    {
+        dark.Div(dark.NumSpectra());
+    }
+    spectrum.Sub(dark);
+}
+
+/** The spectra of a scan, with a few different exposure times and number of co-adds */
+static std::vector<novac::CSpectrum> CreateScan()
+{
+    std::vector<novac::CSpectrum> scan;
+    for (int scanIndex = 2; scanIndex < 40; ++scanIndex)
+    {
+        const double exposureTime = (scanIndex < 20) ? 250.0 : 500.0;
+        const long numSpectra = (scanIndex % 3 == 0) ? 10 : 15;
+        scan.push_back(CreateSpectrum(exposureTime, numSpectra, scanIndex, 1000.0 + scanIndex));
+    }
+    return scan;
+}
+
+// Endregion Helper methods
+
+TEST_CASE("CDarkSpectrumCache, spectra of scan - same result as retrieving the dark for every spectrum", "[DarkSpectrumCache][Evaluation]")
+{
+    bool averagedSpectra = false;
+
+    SECTION("Spectrometer adding the readouts")
+    {
+        averagedSpectra = false;
+    }
+
+    SECTION("Spectrometer averaging the readouts")
+    {
+        averagedSpectra = true;
+    }
+
+    CDarkSpectrumCache sut{ averagedSpectra, 1 };
+    int numberOfGetDarkCalls = 0;
+
+    for (const novac::CSpectrum& measuredSpectrum : CreateScan())
+    {
+        novac::CSpectrum expectedSpectrum = measuredSpectrum;
+        RemoveDarkWithoutCache(expectedSpectrum, averagedSpectra);
+
+        novac::CSpectrum spectrum = measuredSpectrum;
+        const novac::CSpectrum* dark = sut.GetNormalizedDark(spectrum, [&](novac::CSpectrum& retrievedDark)
+            {
+                ++numberOfGetDarkCalls;
+                return GetFakeDark(spectrum, retrievedDark);
+            });
+        REQUIRE(dark != nullptr);
+        RemoveNormalizedDark(spectrum, *dark, averagedSpectra);
+
+        REQUIRE(spectrum.m_length == expectedSpectrum.m_length);
+        for (int pixelIdx = 0; pixelIdx < spectrum.m_length; ++pixelIdx)
+        {
+            REQUIRE(spectrum.m_data[pixelIdx] == Approx(expectedSpectrum.m_data[pixelIdx]));
+        }
+    }
+
+    // Two exposure times times two numbers of co-adds
+    REQUIRE(numberOfGetDarkCalls == 4);
+    REQUIRE(sut.NumberOfDarkSpectra() == 4);
+}
+
+TEST_CASE("CDarkSpectrumCache, dark cannot be retrieved - returns nullptr", "[DarkSpectrumCache][Evaluation]")
+{
+    CDarkSpectrumCache sut{ false, 1 };
+    const novac::CSpectrum spectrum = CreateSpectrum(250.0, 15, 2, 1000.0);
+
+    const novac::CSpectrum* dark = sut.GetNormalizedDark(spectrum, [](novac::CSpectrum&) { return false; });
+
+    REQUIRE(dark == nullptr);
+    REQUIRE(sut.NumberOfDarkSpectra() == 0);
+    REQUIRE(sut.LastDarkScanIndex() == 1);
+}
+
+TEST_CASE("CDarkSpectrumCache, LastDarkScanIndex - is the scan index of the last returned dark", "[DarkSpectrumCache][Evaluation]")
+{
+    CDarkSpectrumCache sut{ false, 1 };
+    const novac::CSpectrum spectrum = CreateSpectrum(250.0, 15, 2, 1000.0);
+
+    sut.GetNormalizedDark(spectrum, [](novac::CSpectrum& retrievedDark)
+        {
+            retrievedDark = CreateSpectrum(250.0, 15, 5, 100.0);
+            return true;
+        });
+    REQUIRE(sut.LastDarkScanIndex() == 5);
+
+    // A cached dark also updates the index
+    CDarkSpectrumCache otherSut{ false, 7 };
+    otherSut.GetNormalizedDark(spectrum, [](novac::CSpectrum& retrievedDark)
+        {
+            retrievedDark = CreateSpectrum(250.0, 15, 3, 100.0);
+            return true;
+        });
+    otherSut.GetNormalizedDark(spectrum, [](novac::CSpectrum&) { return false; });
+    REQUIRE(otherSut.LastDarkScanIndex() == 3);
+}
+
+TEST_CASE("RemoveNormalizedDark, spectra of different length - same result as Div and Sub", "[DarkSpectrumCache][Evaluation]")
+{
+    novac::CSpectrum spectrum = CreateSpectrum(250.0, 15, 2, 1000.0);
+    novac::CSpectrum dark = CreateSpectrum(250.0, 15, 1, 100.0);
+    dark.m_length = 256;
+
+    novac::CSpectrum expectedSpectrum = spectrum;
+    expectedSpectrum.Div(15.0);
+    expectedSpectrum.Sub(dark);
+
+    RemoveNormalizedDark(spectrum, dark, false);
+
+    for (int pixelIdx = 0; pixelIdx < spectrum.m_length; ++pixelIdx)
+    {
+        REQUIRE(spectrum.m_data[pixelIdx] == Approx(expectedSpectrum.m_data[pixelIdx]));
+    }
+}
+
+}
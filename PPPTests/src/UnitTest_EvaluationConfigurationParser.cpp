@@ -1,5 +1,7 @@
 #include <PPPLib/File/EvaluationConfigurationParser.h>
 #include "catch.hpp"
+#include <thread>
+#include <vector>
 
 namespace novac
 {
@@ -189,6 +191,53 @@ TEST_CASE("ReadConfigurationFile gives expected configuration", "[EvaluationConf
     }
 }
 
+TEST_CASE("ReadConfigurationFile in several threads at the same time gives expected configuration", "[EvaluationConfigurationParser][File]")
+{
+    const size_t numberOfThreads = 8;
+    std::vector<RETURN_CODE> returnCodes(numberOfThreads, RETURN_CODE::FAIL);
+    std::vector<Configuration::CEvaluationConfiguration> resultingEvaluationSettings(numberOfThreads);
+
+    // Each thread uses its own parser. Notice that the asserts are done in the main thread since Catch is not thread safe.
+    std::vector<std::thread> threads;
+    for (size_t threadIdx = 0; threadIdx < numberOfThreads; ++threadIdx)
+    {
+        threads.push_back(std::thread([&, threadIdx]()
+            {
+                novac::ConsoleLog logger;
+                Configuration::CDarkCorrectionConfiguration resultingDarkSettings;
+                Configuration::CInstrumentCalibrationConfiguration resultingCalibrationSettings;
+                FileHandler::CEvaluationConfigurationParser sut{ logger };
+
+                returnCodes[threadIdx] = sut.ReadConfigurationFile(
+                    GetEvaluationConfigurationFile(),
+                    resultingEvaluationSettings[threadIdx],
+                    resultingDarkSettings,
+                    resultingCalibrationSettings);
+            }));
+    }
+    for (std::thread& t : threads)
+    {
+        t.join();
+    }
+
+    for (size_t threadIdx = 0; threadIdx < numberOfThreads; ++threadIdx)
+    {
+        REQUIRE(returnCodes[threadIdx] == RETURN_CODE::SUCCESS);
+        REQUIRE("I2J8552" == resultingEvaluationSettings[threadIdx].m_serial);
+        REQUIRE(3 == resultingEvaluationSettings[threadIdx].NumberOfFitWindows());
+
+        novac::CFitWindow window;
+        novac::CDateTime validFrom;
+        novac::CDateTime validTo;
+        REQUIRE(0 == resultingEvaluationSettings[threadIdx].GetFitWindow(1, window, validFrom, validTo));
+        REQUIRE(validFrom == novac::CDateTime(2017, 2, 20, 5, 49, 1));
+        REQUIRE(validTo == novac::CDateTime(2017, 2, 20, 9, 53, 24));
+        REQUIRE(window.reference[0].m_path == "D:/NovacPostProcessingProgram/TestRun_2021_12/OutputFeb2017UTC/2017.02.20/I2J8552/I2J8552_SO2_Bogumil_293K_170220_0749.txt");
+        REQUIRE(window.fitLow == 394);
+        REQUIRE(window.fitHigh == 597);
+    }
+}
+
 TEST_CASE("WriteConfigurationFile gives a file which can be read back in again", "[EvaluationConfigurationParser][File]")
 {
     novac::ConsoleLog logger;
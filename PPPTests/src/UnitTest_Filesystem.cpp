@@ -0,0 +1,155 @@
+#include "catch.hpp"
+#include <PPPLib/File/Filesystem.h>
+#include <Poco/File.h>
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+
+namespace Filesystem
+{
+static std::string GetTestDataDirectory()
+{
+#ifdef _MSC_VER
+    return std::string("../testData/");
+#else
+    return std::string("testData/");
+#endif // _MSC_VER 
+}
+
+TEST_CASE("IsDateDirectoryOutsideOfInterval", "[Filesystem]")
+{
+    FileSearchCriterion criteria;
+    criteria.directoryStartTime = novac::CDateTime(2017, 2, 16, 12, 0, 0);
+    criteria.directoryEndTime = novac::CDateTime(2017, 2, 18, 6, 0, 0);
+
+    SECTION("Directory with day inside of interval is not outside.")
+    {
+        REQUIRE(false == IsDateDirectoryOutsideOfInterval("2017.02.17", criteria));
+    }
+
+    SECTION("Directory with day partially inside of interval is not outside.")
+    {
+        REQUIRE(false == IsDateDirectoryOutsideOfInterval("2017.02.16", criteria));
+        REQUIRE(false == IsDateDirectoryOutsideOfInterval("2017.02.18", criteria));
+    }
+
+    SECTION("Directory with day before or after interval is outside.")
+    {
+        REQUIRE(IsDateDirectoryOutsideOfInterval("2017.02.15", criteria));
+        REQUIRE(IsDateDirectoryOutsideOfInterval("2017.02.19", criteria));
+        REQUIRE(IsDateDirectoryOutsideOfInterval("2016.02.17", criteria));
+    }
+
+    SECTION("Directory not named after a date is never outside.")
+    {
+        REQUIRE(false == IsDateDirectoryOutsideOfInterval("I2J8549", criteria));
+        REQUIRE(false == IsDateDirectoryOutsideOfInterval("2016.02.17_old", criteria));
+        REQUIRE(false == IsDateDirectoryOutsideOfInterval("2016.13.17", criteria));
+        REQUIRE(false == IsDateDirectoryOutsideOfInterval("", criteria));
+    }
+
+    SECTION("No interval set, directory is never outside.")
+    {
+        FileSearchCriterion noInterval;
+        REQUIRE(false == IsDateDirectoryOutsideOfInterval("2016.02.17", noInterval));
+    }
+}
+
+TEST_CASE("SearchDirectoryForFilesInParallel finds same files as SearchDirectoryForFiles", "[Filesystem][IntegrationTest]")
+{
+    FileSearchCriterion criteria;
+    criteria.fileExtension = ".pak";
+
+    std::vector<std::string> expectedFiles;
+    SearchDirectoryForFiles(GetTestDataDirectory(), true, expectedFiles, &criteria);
+    std::sort(begin(expectedFiles), end(expectedFiles));
+    REQUIRE(expectedFiles.size() >= 3);
+
+    SECTION("Single thread")
+    {
+        std::vector<std::string> foundFiles;
+        const size_t numberOfFilesFound = SearchDirectoryForFilesInParallel(GetTestDataDirectory(), true, &criteria, 1,
+            [&](std::vector<std::string>& files)
+            {
+                foundFiles.insert(foundFiles.end(), files.begin(), files.end());
+            });
+        std::sort(begin(foundFiles), end(foundFiles));
+
+        REQUIRE(numberOfFilesFound == expectedFiles.size());
+        REQUIRE(foundFiles == expectedFiles);
+    }
+
+    SECTION("Multiple threads")
+    {
+        std::mutex guard;
+        std::vector<std::string> foundFiles;
+        const size_t numberOfFilesFound = SearchDirectoryForFilesInParallel(GetTestDataDirectory(), true, &criteria, 4,
+            [&](std::vector<std::string>& files)
+            {
+                std::lock_guard<std::mutex> lock(guard);
+                foundFiles.insert(foundFiles.end(), files.begin(), files.end());
+            });
+        std::sort(begin(foundFiles), end(foundFiles));
+
+        REQUIRE(numberOfFilesFound == expectedFiles.size());
+        REQUIRE(foundFiles == expectedFiles);
+    }
+
+    SECTION("Sub directories not included")
+    {
+        std::vector<std::string> expectedFilesInRoot;
+        SearchDirectoryForFiles(GetTestDataDirectory(), false, expectedFilesInRoot, &criteria);
+
+        std::vector<std::string> foundFiles;
+        SearchDirectoryForFilesInParallel(GetTestDataDirectory(), false, &criteria, 4,
+            [&](std::vector<std::string>& files)
+            {
+                foundFiles.insert(foundFiles.end(), files.begin(), files.end());
+            });
+
+        REQUIRE(foundFiles.size() == expectedFilesInRoot.size());
+    }
+}
+
+TEST_CASE("SearchDirectoryForFilesInParallel, callback throws - exception is passed on to the caller", "[Filesystem][IntegrationTest]")
+{
+    FileSearchCriterion criteria;
+    criteria.fileExtension = ".pak";
+
+    for (unsigned int threadNum : { 1U, 4U })
+    {
+        INFO("threadNum: " << threadNum);
+        REQUIRE_THROWS_AS(
+            SearchDirectoryForFilesInParallel(GetTestDataDirectory(), true, &criteria, threadNum,
+                [&](std::vector<std::string>&)
+                {
+                    throw std::runtime_error("could not queue the files");
+                }),
+            std::runtime_error);
+    }
+}
+TEST_CASE("SearchDirectoryForFilesInParallel, directory named as a matching file - directory is searched", "[Filesystem][IntegrationTest]")
+{
+    const std::string rootDirectory = GetTestDataDirectory() + "UnitTest_Filesystem";
+    const std::string directoryNamedAsFile = rootDirectory + "/2002128M1_230120_1907_0.pak";
+    const std::string fileInDirectory = directoryNamedAsFile + "/2002128M1_230120_1908_0.pak";
+    Poco::File(directoryNamedAsFile).createDirectories();
+    FILE* f = fopen(fileInDirectory.c_str(), "w");
+    REQUIRE(f != nullptr);
+    fclose(f);
+
+    FileSearchCriterion criteria;
+    criteria.fileExtension = ".pak";
+
+    std::vector<std::string> foundFiles;
+    SearchDirectoryForFilesInParallel(rootDirectory, true, &criteria, 1,
+        [&](std::vector<std::string>& files)
+        {
+            foundFiles.insert(foundFiles.end(), files.begin(), files.end());
+        });
+    Poco::File(rootDirectory).remove(true);
+
+    REQUIRE(foundFiles == std::vector<std::string>{ fileInDirectory });
+}
+}
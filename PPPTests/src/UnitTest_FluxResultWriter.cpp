@@ -0,0 +1,170 @@
+#include <PPPLib/Flux/FluxResultWriter.h>
+#include <PPPLib/File/BufferedFileWriter.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "catch.hpp"
+
+namespace Flux
+{
+static std::string GetTestDataDirectory()
+{
+#ifdef _MSC_VER
+    return std::string("../testData/");
+#else
+    return std::string("testData/");
+#endif // _MSC_VER
+}
+
+/** @return the directory to write the flux logs to, without the trailing path separator */
+static std::string GetOutputDirectory()
+{
+    const std::string directory = GetTestDataDirectory();
+    return directory.substr(0, directory.size() - 1);
+}
+
+static std::vector<std::string> ReadAllLines(const std::string& fileName)
+{
+    std::vector<std::string> lines;
+    std::ifstream file(fileName);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+static FluxResult CreateFluxResult(const std::string& instrument, double flux)
+{
+    FluxResult result;
+    result.m_instrument = instrument;
+    result.m_startTime = novac::CDateTime(2017, 3, 1, 12, 30, 0);
+    result.m_stopTime = novac::CDateTime(2017, 3, 1, 12, 45, 0);
+    result.m_flux = flux;
+    return result;
+}
+
+TEST_CASE("CFluxResultWriter, writes each flux to each configured output", "[CFluxResultWriter][Flux]")
+{
+    novac::ConsoleLog log;
+    FluxResultOutputs outputs;
+    outputs.xml = false;
+    outputs.txt = true;
+    outputs.csv = true;
+
+    CFluxResultWriter sut(log, GetOutputDirectory(), outputs);
+    const std::string txtFile = sut.GetFileName("FluxLog.txt");
+    const std::string csvFile = sut.GetFileName("FluxLog.csv");
+
+    sut.Open(novac::LogContext(), novac::CDateTime(2017, 3, 2, 0, 0, 0));
+    sut.Write(CreateFluxResult("I2J8552", 12.5));
+    sut.Write(CreateFluxResult("D2J2124", 3.25));
+    sut.Close();
+
+    const std::vector<std::string> txtLines = ReadAllLines(txtFile);
+    const std::vector<std::string> csvLines = ReadAllLines(csvFile);
+    std::remove(txtFile.c_str());
+    std::remove(csvFile.c_str());
+
+    SECTION("Txt file has the header and one line per flux")
+    {
+        REQUIRE(txtLines.size() == 6);
+        REQUIRE(txtLines[4].substr(0, 50) == "2017.03.01T12:30:00\t2017.03.01T12:45:00\tI2J8552\tgo");
+        REQUIRE(txtLines[5].find("\tD2J2124\tgothenburg\t3.25\tg\t") != std::string::npos);
+    }
+
+    SECTION("Csv file has one header line and one line per flux")
+    {
+        REQUIRE(csvLines.size() == 3);
+        REQUIRE(csvLines[0].substr(0, 39) == "StartTime,StopTime,Serial,InstrumentTyp");
+        REQUIRE(csvLines[1].substr(0, 68) == "2017-03-01T12:30:00Z,2017-03-01T12:45:00Z,I2J8552,gothenburg,12.5,g,");
+    }
+
+    SECTION("Csv file has empty fields for missing values")
+    {
+        // the percentiles of the flux have not been estimated
+        REQUIRE(csvLines[2].find(",3.25,g,0,0,,,,") != std::string::npos);
+    }
+}
+
+TEST_CASE("CFluxResultWriter, percentiles of the flux are only written to the txt file when estimated", "[CFluxResultWriter][Flux]")
+{
+    novac::ConsoleLog log;
+    FluxResultOutputs outputs;
+    outputs.xml = false;
+    outputs.txt = true;
+
+    SECTION("Percentiles not estimated - no percentile columns")
+    {
+        CFluxResultWriter sut(log, GetOutputDirectory(), outputs);
+        const std::string txtFile = sut.GetFileName("FluxLog.txt");
+
+        sut.Open(novac::LogContext(), novac::CDateTime(2017, 3, 2, 0, 0, 0));
+        sut.Write(CreateFluxResult("I2J8552", 12.5));
+        sut.Close();
+
+        const std::vector<std::string> txtLines = ReadAllLines(txtFile);
+        std::remove(txtFile.c_str());
+
+        REQUIRE(txtLines.size() == 5);
+        REQUIRE(txtLines[3].find("FluxP50_kgs") == std::string::npos);
+        REQUIRE(txtLines[3].substr(txtLines[3].size() - 11) == "\tScanOffset");
+        REQUIRE(txtLines[4].find("nan") == std::string::npos);
+    }
+
+    SECTION("Percentiles estimated - written as the last columns")
+    {
+        outputs.fluxPercentiles = true;
+        CFluxResultWriter sut(log, GetOutputDirectory(), outputs);
+        const std::string txtFile = sut.GetFileName("FluxLog.txt");
+
+        FluxResult fluxResult = CreateFluxResult("I2J8552", 12.5);
+        fluxResult.m_fluxPercentile05 = 8.25;
+        fluxResult.m_fluxPercentile50 = 12.0;
+        fluxResult.m_fluxPercentile95 = 17.5;
+
+        sut.Open(novac::LogContext(), novac::CDateTime(2017, 3, 2, 0, 0, 0));
+        sut.Write(fluxResult);
+        sut.Close();
+
+        const std::vector<std::string> txtLines = ReadAllLines(txtFile);
+        std::remove(txtFile.c_str());
+
+        REQUIRE(txtLines.size() == 5);
+        REQUIRE(txtLines[3].substr(txtLines[3].size() - 36) == "\tFluxP05_kgs\tFluxP50_kgs\tFluxP95_kgs");
+        REQUIRE(txtLines[4].substr(txtLines[4].size() - 17) == "\t8.25\t12.00\t17.50");
+    }
+}
+
+TEST_CASE("CBufferedFileWriter, writes all text to the file", "[CBufferedFileWriter][File]")
+{
+    const std::string fileName = GetTestDataDirectory() + "UnitTest_BufferedFileWriter.txt";
+
+    // A buffer which is much smaller than the text written
+    FileHandler::CBufferedFileWriter sut(16);
+    REQUIRE(sut.Open(fileName, false));
+
+    std::string expectedText;
+    for (int ii = 0; ii < 100; ++ii)
+    {
+        sut.Printf("%d\t%.2lf\t", ii, ii * 0.5);
+        sut.Write("a somewhat longer text than the buffer\n");
+
+        char line[64];
+        snprintf(line, sizeof(line), "%d\t%.2lf\t", ii, ii * 0.5);
+        expectedText += line;
+        expectedText += "a somewhat longer text than the buffer\n";
+    }
+    sut.Close();
+
+    std::ifstream file(fileName);
+    const std::string writtenText((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::remove(fileName.c_str());
+
+    REQUIRE(writtenText == expectedText);
+}
+}
@@ -0,0 +1,90 @@
+#include <PPPLib/Flux/FluxStatistics.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "catch.hpp"
+
+namespace Flux
+{
+static FluxResult CreateFluxResult(const std::string& instrument, int year, int month, int day, double flux)
+{
+    FluxResult result;
+    result.m_instrument = instrument;
+    result.m_startTime = novac::CDateTime(year, month, day, 12, 0, 0);
+    result.m_flux = flux;
+    return result;
+}
+
+static std::vector<std::string> ReadLines(const std::string& fileName)
+{
+    std::vector<std::string> lines;
+    std::ifstream file(fileName);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+TEST_CASE("CFluxStatistics, WriteFluxStat writes the statistics of each day", "[CFluxStatistics][Flux]")
+{
+    const std::string fileName = "UnitTest_FluxStatistics.txt";
+    std::remove(fileName.c_str());
+
+    CFluxStatistics sut;
+    sut.AttachFlux(CreateFluxResult("I2J8552", 2017, 3, 2, 4.0));
+    sut.AttachFlux(CreateFluxResult("D2J2124", 2017, 3, 1, 1.0));
+    sut.AttachFlux(CreateFluxResult("i2j8552", 2017, 3, 1, 3.0));
+    sut.AttachFlux(CreateFluxResult("D2J2124", 2017, 3, 1, 2.0));
+    sut.AttachFlux(CreateFluxResult("D2J2124", 2017, 3, 2, 2.0));
+
+    sut.WriteFluxStat(fileName.c_str());
+
+    const std::vector<std::string> lines = ReadLines(fileName);
+    std::remove(fileName.c_str());
+
+    REQUIRE(lines.size() == 3);
+
+    SECTION("Header lists each instrument once, the last seen instrument first")
+    {
+        REQUIRE(lines[0] == "Date\tAverageFlux(kg/s)\tMedianFlux(kg/s)\tStdFlux(kg/s)\tnMeasurements\t#MeasFrom_D2J2124\t#MeasFrom_I2J8552");
+    }
+
+    SECTION("Days are written in increasing order")
+    {
+        REQUIRE(lines[1].substr(0, 10) == "2017.03.01");
+        REQUIRE(lines[2].substr(0, 10) == "2017.03.02");
+    }
+
+    SECTION("Median and number of measurements from each instrument")
+    {
+        // odd number of measurements, the value above the middle one is used as median
+        REQUIRE(lines[1].find("\t3.00\t") != std::string::npos);
+        REQUIRE(lines[1].substr(lines[1].size() - 6) == "\t3\t2\t1");
+
+        // even number of measurements, the median is the average of the two middle ones
+        REQUIRE(lines[2].find("\t3.00\t3.00\t") != std::string::npos);
+        REQUIRE(lines[2].substr(lines[2].size() - 6) == "\t2\t1\t1");
+    }
+}
+
+TEST_CASE("CFluxStatistics, Clear removes all measurements", "[CFluxStatistics][Flux]")
+{
+    const std::string fileName = "UnitTest_FluxStatistics_Cleared.txt";
+    std::remove(fileName.c_str());
+
+    CFluxStatistics sut;
+    sut.AttachFlux(CreateFluxResult("I2J8552", 2017, 3, 2, 4.0));
+    sut.Clear();
+
+    sut.WriteFluxStat(fileName.c_str());
+
+    const std::vector<std::string> lines = ReadLines(fileName);
+    std::remove(fileName.c_str());
+
+    REQUIRE(lines.size() == 1);
+    REQUIRE(lines[0] == "Date\tAverageFlux(kg/s)\tMedianFlux(kg/s)\tStdFlux(kg/s)\tnMeasurements");
+}
+}
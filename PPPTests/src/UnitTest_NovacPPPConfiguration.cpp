@@ -180,6 +180,34 @@ TEST_CASE("CNovacPPPConfiguration GetFitWindow returns expected value", "[CNovac
             REQUIRE(strstr(ex.message.c_str(), "does not have a configured fit-window on 2022.05.07") != nullptr);
         }
     }
+
+    SECTION("One instrument configured with two consecutive fit windows - Returns index of the fit window valid at the time")
+    {
+        novac::CFitWindow laterFitWindow = configuredFitWindow;
+        laterFitWindow.fitLow = 470;
+
+        Configuration::CEvaluationConfiguration configuredInstrumentEvaluation;
+        configuredInstrumentEvaluation.m_serial = instrumentSerial;
+        configuredInstrumentEvaluation.InsertFitWindow(configuredFitWindow, fitWindowValidFrom, CDateTime(2022, 05, 10, 0, 0, 0));
+        configuredInstrumentEvaluation.InsertFitWindow(laterFitWindow, CDateTime(2022, 05, 10, 0, 0, 1), fitWindowValidTo);
+
+        Configuration::CInstrumentConfiguration configuredInstrument;
+        configuredInstrument.m_serial = instrumentSerial;
+        configuredInstrument.m_eval = configuredInstrumentEvaluation;
+
+        Configuration::CNovacPPPConfiguration sut;
+        sut.m_instrument.push_back(configuredInstrument);
+
+        // Act
+        const size_t firstIndex = sut.GetFitWindowIndex(instrumentSerial, 0, CDateTime(2022, 05, 06, 15, 16, 17));
+        const size_t secondIndex = sut.GetFitWindowIndex(instrumentSerial, 0, CDateTime(2022, 05, 11, 15, 16, 17));
+
+        // Assert
+        REQUIRE(firstIndex != secondIndex);
+        REQUIRE(sut.m_instrument[0].m_eval.GetFitWindow(firstIndex).window.fitLow == 464);
+        REQUIRE(sut.m_instrument[0].m_eval.GetFitWindow(secondIndex).window.fitLow == 470);
+        REQUIRE(sut.GetFitWindow(instrumentSerial, 0, CDateTime(2022, 05, 11, 15, 16, 17)).fitLow == 470);
+    }
 }
 
 TEST_CASE("CNovacPPPConfiguration GetDarkCorrection returns expected value", "[CNovacPPPConfiguration][Configuration]")
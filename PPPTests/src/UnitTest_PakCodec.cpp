@@ -0,0 +1,335 @@
+#include "catch.hpp"
+#include <PPPLib/File/PakCodec.h>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace FileHandler
+{
+
+static std::string GetTestDataDirectory()
+{
+#ifdef _MSC_VER
+    return std::string("../testData/");
+#else
+    return std::string("testData/");
+#endif // _MSC_VER
+}
+
+/** The original compression and decompression of the spectra in the .pak files, which work one bit at a time.
+    These are kept here as a reference for the format. Decompress is also used by the tests of the CPakFileWriter. */
+namespace Reference
+{
+static const int headsiz = 12;
+
+static int BitsPrec(std::int32_t i)
+{
+    int j = 1;
+    if (!i) return 0;
+    if (i < 0)
+    {
+        if (i == -1) return 1;
+        while (i != -1)
+        {
+            j++;
+            i = (i >> 1);
+        }
+    }
+    else
+    {
+        while (i)
+        {
+            j++;
+            i = (i >> 1);
+        }
+    }
+    return j;
+}
+
+static void WriteBits(int a, int curr, const std::int32_t* inpek, std::vector<std::uint8_t>& utpek, long bitnr)
+{
+    const unsigned short utlng = 0x80;
+
+    long utwrd = (a << 5) | (curr & 0x1f);
+    long kk = 1L << (headsiz - 1);
+    for (int j = 0; j < headsiz; j++)
+    {
+        if (utwrd & kk) utpek[static_cast<size_t>(bitnr >> 3)] |= static_cast<std::uint8_t>(utlng >> (bitnr & 7));
+        bitnr++;
+        kk = kk >> 1;
+    }
+
+    for (int jj = 0; jj < a; jj++)
+    {
+        kk = (1L << (curr - 1));
+        utwrd = *inpek++;
+        for (int j = 0; j < curr; j++)
+        {
+            if (utwrd & kk) utpek[static_cast<size_t>(bitnr >> 3)] |= static_cast<std::uint8_t>(utlng >> (bitnr & 7));
+            bitnr++;
+            kk = kk >> 1;
+        }
+    }
+}
+
+/** @param in the differences between consecutive values, followed by one zero */
+static std::vector<std::uint8_t> Compress(const std::vector<std::int32_t>& in, long size)
+{
+    std::vector<std::uint8_t> ut(static_cast<size_t>(size) * 4 + 8, 0);
+    const std::int32_t* strt = in.data();
+    long kvar = size;
+    long bitnr = 0;
+    do
+    {
+        int len[33] = {};
+        const std::int32_t* incpy = strt;
+        int i = BitsPrec(*incpy++);
+        int curr = i;
+        int a = 0;
+        do
+        {
+            a++;
+            for (int j = 0; j < curr; j++)
+            {
+                if (i > j) len[j] = 0;
+                else
+                {
+                    len[j]++;
+                    if (len[j] * (curr - j) > headsiz * 2)
+                    {
+                        a -= len[j];
+                        goto Fixat;
+                    }
+                }
+            }
+            i = BitsPrec(*incpy++);
+            if (i > curr)
+            {
+                if (a * (i - curr) > headsiz) goto Fixat;
+
+                while (curr != i)
+                {
+                    len[curr] = a;
+                    curr++;
+                }
+            }
+        } while (a < kvar && a < 127);
+    Fixat:
+        WriteBits(a, curr, strt, ut, bitnr);
+        kvar -= a;
+        strt += a;
+        bitnr += a * curr + headsiz;
+    } while (kvar > 0);
+
+    ut.resize(static_cast<size_t>((bitnr + 7) >> 3));
+    return ut;
+}
+
+std::vector<std::int32_t> Decompress(const std::uint8_t* inpek, long kvar)
+{
+    std::vector<std::int32_t> ut;
+    long bit = 0;
+    while (kvar > 0)
+    {
+        int len = 0;
+        for (int j = 0; j < 7; j++)
+        {
+            len += len;
+            len |= inpek[(bit >> 3)] >> (7 - (bit & 0x7)) & 1;
+            bit++;
+        }
+        int curr = 0;
+        for (int j = 0; j < 5; j++)
+        {
+            curr += curr;
+            curr |= inpek[(bit >> 3)] >> (7 - (bit & 0x7)) & 1;
+            bit++;
+        }
+        if (curr)
+        {
+            for (int jj = 0; jj < len; jj++)
+            {
+                std::int32_t a = inpek[(bit >> 3)] >> (7 - (bit & 0x7)) & 1;
+                if (a) a = -1;
+                bit++;
+                for (int j = 1; j < curr; j++)
+                {
+                    a = static_cast<std::int32_t>(static_cast<std::uint32_t>(a) << 1);
+                    a |= inpek[(bit >> 3)] >> (7 - (bit & 0x7)) & 1;
+                    bit++;
+                }
+                ut.push_back(a);
+            }
+        }
+        else for (int jj = 0; jj < len; jj++) ut.push_back(0);
+        kvar -= len;
+    }
+    for (size_t jj = 1; jj < ut.size(); jj++)
+    {
+        ut[jj] += ut[jj - 1];
+    }
+    return ut;
+}
+
+static std::vector<std::uint8_t> CompressValues(const std::vector<std::int32_t>& values)
+{
+    std::vector<std::int32_t> differences(values.size() + 1, 0);
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        differences[ii] = values[ii] - (ii > 0 ? values[ii - 1] : 0);
+    }
+    return Compress(differences, static_cast<long>(values.size()));
+}
+}
+
+/** The compressed spectrum data of a .pak file */
+struct CompressedSpectrum
+{
+    size_t pixels = 0;
+    std::vector<std::uint8_t> data;
+};
+
+/** Reads the compressed data of all spectra in the given .pak file */
+static std::vector<CompressedSpectrum> ReadPakFile(const std::string& fileName)
+{
+    std::vector<CompressedSpectrum> result;
+
+    FILE* f = fopen(fileName.c_str(), "rb");
+    REQUIRE(f != nullptr);
+
+    std::vector<std::uint8_t> header(44);
+    while (fread(header.data(), 1, header.size(), f) == header.size())
+    {
+        // The header starts with 'MKZY' followed by the size of the header and the size of the compressed data.
+        REQUIRE(header[0] == 'M');
+        const size_t headerSize = header[4] | (header[5] << 8);
+        const size_t dataSize = header[8] | (header[9] << 8);
+
+        CompressedSpectrum spectrum;
+        spectrum.pixels = header[42] | (header[43] << 8);
+        spectrum.data.resize(dataSize);
+
+        REQUIRE(0 == fseek(f, static_cast<long>(headerSize - header.size()), SEEK_CUR));
+        REQUIRE(dataSize == fread(spectrum.data.data(), 1, dataSize, f));
+
+        result.push_back(spectrum);
+    }
+
+    fclose(f);
+    return result;
+}
+
+TEST_CASE("CompressSpectrumData, measured spectra - same data as in the file", "[PakCodec][File]")
+{
+    const auto spectra = ReadPakFile(GetTestDataDirectory() + "2002128M1/2002128M1_230120_1907_0.pak");
+    REQUIRE(spectra.size() == 53);
+
+    for (const CompressedSpectrum& spectrum : spectra)
+    {
+        REQUIRE(spectrum.pixels == 2048);
+
+        const std::vector<std::int32_t> values = Reference::Decompress(spectrum.data.data(), static_cast<long>(spectrum.pixels));
+
+        // Act
+        std::vector<std::uint8_t> compressed;
+        CompressSpectrumData(values.data(), values.size(), compressed);
+
+        // Assert, identical to the data in the file
+        REQUIRE(compressed == spectrum.data);
+    }
+}
+
+TEST_CASE("CompressSpectrumData, random data - same data as the original compression", "[PakCodec][File]")
+{
+    std::mt19937 generator(2024);
+    std::uniform_int_distribution<size_t> lengthDistribution(1, 3000);
+
+    // Each kind of data is described by the largest difference between consecutive values and the fraction of the differences which are zero.
+    const std::vector<std::pair<std::int32_t, double>> kindsOfData = {
+        { 0, 1.0 },
+        { 3, 0.0 },
+        { 200, 0.0 },
+        { 200, 0.5 },
+        { 70000, 0.1 },
+        { pakMaximumDifference, 0.0 },
+        { pakMaximumDifference, 0.9 }
+    };
+
+    for (const auto& kindOfData : kindsOfData)
+    {
+        std::uniform_int_distribution<std::int32_t> differenceDistribution(-kindOfData.first, kindOfData.first);
+        std::bernoulli_distribution isZero(kindOfData.second);
+
+        for (int repetition = 0; repetition < 20; ++repetition)
+        {
+            std::vector<std::int32_t> values(lengthDistribution(generator));
+            std::int64_t value = 0;
+            for (std::int32_t& v : values)
+            {
+                std::int64_t difference = isZero(generator) ? 0 : differenceDistribution(generator);
+                if (value + difference > pakMaximumDifference || value + difference < -pakMaximumDifference)
+                {
+                    difference = -difference; // keep the next difference within range as well
+                }
+                value += difference;
+                v = static_cast<std::int32_t>(value);
+            }
+
+            // Act
+            std::vector<std::uint8_t> compressed;
+            CompressSpectrumData(values.data(), values.size(), compressed);
+
+            // Assert
+            REQUIRE(compressed == Reference::CompressValues(values));
+            REQUIRE(Reference::Decompress(compressed.data(), static_cast<long>(values.size())) == values);
+        }
+    }
+}
+
+TEST_CASE("CompressSpectrumData, special cases", "[PakCodec][File]")
+{
+    SECTION("Empty spectrum - gives no data")
+    {
+        std::vector<std::uint8_t> compressed = { 1, 2, 3 };
+        CompressSpectrumData(nullptr, 0, compressed);
+        REQUIRE(compressed.empty());
+    }
+
+    SECTION("Single value")
+    {
+        const std::vector<std::int32_t> values = { -17 };
+        std::vector<std::uint8_t> compressed;
+        CompressSpectrumData(values.data(), values.size(), compressed);
+
+        REQUIRE(compressed == Reference::CompressValues(values));
+        REQUIRE(Reference::Decompress(compressed.data(), static_cast<long>(values.size())) == values);
+    }
+
+    SECTION("Difference too large - throws invalid_argument")
+    {
+        const std::vector<std::int32_t> values = { 0, pakMaximumDifference, -pakMaximumDifference };
+        std::vector<std::uint8_t> compressed;
+        REQUIRE_THROWS_AS(CompressSpectrumData(values.data(), values.size(), compressed), std::invalid_argument);
+    }
+}
+
+TEST_CASE("CompressSpectrumData, benchmark", "[.][PakCodec][Benchmark]")
+{
+    const auto spectra = ReadPakFile(GetTestDataDirectory() + "2002128M1/2002128M1_230120_1907_0.pak");
+    const auto values = Reference::Decompress(spectra.front().data.data(), static_cast<long>(spectra.front().pixels));
+
+    BENCHMARK("Compress, word at a time")
+    {
+        std::vector<std::uint8_t> compressed;
+        CompressSpectrumData(values.data(), values.size(), compressed);
+        return compressed;
+    };
+
+    BENCHMARK("Compress, bit at a time")
+    {
+        return Reference::CompressValues(values);
+    };
+}
+
+}
@@ -0,0 +1,176 @@
+#include <PPPLib/File/PakFileWriter.h>
+#include <PPPLib/File/PakCodec.h>
+#include <SpectralEvaluation/File/ScanFileHandler.h>
+#include <SpectralEvaluation/Log.h>
+#include <SpectralEvaluation/Spectra/Spectrum.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "catch.hpp"
+
+namespace FileHandler
+{
+namespace Reference
+{
+extern std::vector<std::int32_t> Decompress(const std::uint8_t* inpek, long kvar);
+}
+
+static std::string GetTestDataDirectory()
+{
+#ifdef _MSC_VER
+    return std::string("../testData/");
+#else
+    return std::string("testData/");
+#endif // _MSC_VER
+}
+
+static std::vector<std::uint8_t> ReadAllBytes(const std::string& fileName)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    return std::vector<std::uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+/** The header of the first spectrum of the scan 2002128M1_230120_1907_0.pak */
+static PakSpectrumHeader CreateMeasuredHeader()
+{
+    PakSpectrumHeader header;
+    header.name = "sky";
+    header.instrumentName = "2002128M1";
+    header.viewAngle = 0;
+    header.scans = 15;
+    header.exposureTime = -484;
+    header.date = 200123;
+    header.startTime = 19074887;
+    header.stopTime = 19075615;
+    header.latitude = -39.27752833333333;
+    header.longitude = 175.60873166666667;
+    header.altitude = 1755;
+    header.measurementIndex = 0;
+    header.measurementCount = 53;
+    header.compassDirection = 2660;
+    header.temperature = 27.453943252563477f;
+    header.coneAngle = 60;
+    const std::uint16_t adc[8] = { 1438, 14706, 14704, 37702, 14700, 14699, 14704, 14707 };
+    std::copy(std::begin(adc), std::end(adc), std::begin(header.adc));
+    return header;
+}
+
+TEST_CASE("CPakFileWriter, writes the same data as the instrument", "[CPakFileWriter][File]")
+{
+    // The first spectrum of a measured scan
+    const std::vector<std::uint8_t> measuredFile = ReadAllBytes(GetTestDataDirectory() + "2002128M1/2002128M1_230120_1907_0.pak");
+    const size_t measuredDataSize = measuredFile[8] | (measuredFile[9] << 8);
+    REQUIRE(measuredFile.size() > CPakFileWriter::headerSize + measuredDataSize);
+
+    const std::vector<std::int32_t> values = Reference::Decompress(measuredFile.data() + CPakFileWriter::headerSize, 2048);
+    REQUIRE(values.size() == 2048);
+
+    const PakSpectrumHeader header = CreateMeasuredHeader();
+
+    // Act
+    const std::string fileName = "UnitTest_PakFileWriter.pak";
+    {
+        CPakFileWriter sut;
+        REQUIRE(sut.Open(fileName));
+        REQUIRE(sut.Write(header, values.data(), values.size()));
+        REQUIRE(sut.Write(header, values.data(), values.size()));
+    }
+    const std::vector<std::uint8_t> writtenFile = ReadAllBytes(fileName);
+    std::remove(fileName.c_str());
+
+    // Assert
+    const std::ptrdiff_t headerSize = CPakFileWriter::headerSize;
+    const std::ptrdiff_t spectrumSize = headerSize + static_cast<std::ptrdiff_t>(measuredDataSize);
+    REQUIRE(writtenFile.size() == 2 * static_cast<size_t>(spectrumSize));
+
+    SECTION("Header identical")
+    {
+        for (size_t ii = 0; ii < CPakFileWriter::headerSize; ++ii)
+        {
+            INFO("Byte " << ii);
+            REQUIRE(writtenFile[ii] == measuredFile[ii]);
+        }
+    }
+
+    SECTION("Compressed data identical")
+    {
+        REQUIRE(std::equal(writtenFile.begin() + headerSize, writtenFile.begin() + spectrumSize, measuredFile.begin() + headerSize));
+    }
+
+    SECTION("Second spectrum identical to the first")
+    {
+        REQUIRE(std::equal(writtenFile.begin(), writtenFile.begin() + spectrumSize, writtenFile.begin() + spectrumSize));
+    }
+}
+
+TEST_CASE("CPakFileWriter, written scan read back - same spectra and no checksum mismatch", "[CPakFileWriter][File]")
+{
+    // Large pixel values, such that the sum of the pixels does not fit in 16 bits
+    std::vector<std::int32_t> values(2048);
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        values[ii] = 600000 + static_cast<std::int32_t>((ii * 7919) % 50000);
+    }
+
+    const std::string fileName = "UnitTest_PakFileWriter_RoundTrip.pak";
+    {
+        CPakFileWriter sut;
+        REQUIRE(sut.Open(fileName));
+
+        PakSpectrumHeader header = CreateMeasuredHeader();
+        for (const char* name : { "sky", "dark", "scan", "scan", "scan" })
+        {
+            header.name = name;
+            REQUIRE(sut.Write(header, values.data(), values.size()));
+            ++header.measurementIndex;
+        }
+    }
+
+    novac::ConsoleLog logger;
+    novac::CScanFileHandler scan(logger);
+    const bool fileIsRead = scan.CheckScanFile(novac::LogContext(), fileName);
+    REQUIRE(scan.m_lastError != novac::FileError::ChecksumMismatch);
+    REQUIRE(fileIsRead);
+
+    novac::CSpectrum sky;
+    REQUIRE(0 == scan.GetSky(sky));
+    REQUIRE(sky.m_length == static_cast<int>(values.size()));
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        REQUIRE(sky.m_data[ii] == Approx(values[ii]));
+    }
+
+    int numberOfSpectraRead = 0;
+    novac::CSpectrum spectrum;
+    while (scan.GetNextSpectrum(novac::LogContext(), spectrum))
+    {
+        ++numberOfSpectraRead;
+        REQUIRE(spectrum.m_length == static_cast<int>(values.size()));
+    }
+    std::remove(fileName.c_str());
+
+    REQUIRE(scan.m_lastError != novac::FileError::ChecksumMismatch);
+    REQUIRE(numberOfSpectraRead >= 3);
+}
+
+TEST_CASE("PakSpectrumHeader SetTime, stores date and times as in the instrument", "[CPakFileWriter][File]")
+{
+    PakSpectrumHeader sut;
+    sut.SetTime(novac::CDateTime(2023, 1, 20, 19, 7, 48), novac::CDateTime(2023, 1, 20, 19, 7, 56));
+
+    REQUIRE(sut.date == 200123);
+    REQUIRE(sut.startTime == 19074800);
+    REQUIRE(sut.stopTime == 19075600);
+}
+
+TEST_CASE("CPakFileWriter, file not open - returns false", "[CPakFileWriter][File]")
+{
+    const std::vector<std::int32_t> values(10, 100);
+    CPakFileWriter sut;
+    REQUIRE_FALSE(sut.Write(PakSpectrumHeader(), values.data(), values.size()));
+}
+
+}
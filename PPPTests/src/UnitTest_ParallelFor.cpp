@@ -0,0 +1,198 @@
+#include <PPPLib/ParallelFor.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "catch.hpp"
+
+namespace novac
+{
+
+TEST_CASE("ParallelFor, calls the function once for every index", "[ParallelFor]")
+{
+    std::vector<std::atomic<int>> callCount(1000);
+    for (auto& count : callCount)
+    {
+        count = 0;
+    }
+
+    ParallelFor(callCount.size(), 4, [&](size_t idx) { ++callCount[idx]; });
+
+    for (const auto& count : callCount)
+    {
+        REQUIRE(count == 1);
+    }
+}
+
+TEST_CASE("ParallelFor, no indices - function is not called", "[ParallelFor]")
+{
+    int callCount = 0;
+    ParallelFor(0, 4, [&](size_t) { ++callCount; });
+    REQUIRE(callCount == 0);
+}
+
+TEST_CASE("ParallelFor, function throws - exception of the lowest failing index is rethrown", "[ParallelFor]")
+{
+    std::atomic<int> callCount{ 0 };
+
+    try
+    {
+        ParallelFor(100, 4, [&](size_t idx)
+            {
+                ++callCount;
+                if (idx == 10 || idx == 11)
+                {
+                    throw std::invalid_argument("failure at " + std::to_string(idx));
+                }
+            });
+        FAIL("No exception thrown");
+    }
+    catch (const std::invalid_argument& ex)
+    {
+        REQUIRE(std::string(ex.what()) == "failure at 10");
+    }
+
+    // No further indices are started once a failure has occurred, except the ones already taken by the other threads.
+    REQUIRE(callCount >= 11);
+    REQUIRE(callCount < 100);
+}
+
+TEST_CASE("ParallelFor, function throws - all indices below the failing index are processed", "[ParallelFor]")
+{
+    for (int repetition = 0; repetition < 20; ++repetition)
+    {
+        std::vector<std::atomic<int>> callCount(1000);
+        for (auto& count : callCount)
+        {
+            count = 0;
+        }
+
+        REQUIRE_THROWS_AS(ParallelFor(callCount.size(), 8, [&](size_t idx)
+            {
+                ++callCount[idx];
+                if (idx == 500)
+                {
+                    throw std::invalid_argument("failure");
+                }
+            }),
+            std::invalid_argument);
+
+        for (size_t idx = 0; idx <= 500; ++idx)
+        {
+            INFO("Index: " << idx);
+            REQUIRE(callCount[idx] == 1);
+        }
+    }
+}
+
+TEST_CASE("ParallelFor, budget used up - runs on the calling thread only", "[ParallelFor]")
+{
+    CThreadBudget::SetMaxThreadNum(4);
+
+    std::set<std::thread::id> threadsUsed;
+    std::mutex guard;
+    auto recordThread = [&](size_t)
+    {
+        std::lock_guard<std::mutex> lock(guard);
+        threadsUsed.insert(std::this_thread::get_id());
+    };
+
+    SECTION("Outer section reserves all threads")
+    {
+        CThreadReservation outerSection(3);
+        REQUIRE(outerSection.ThreadNum() == 3);
+
+        ParallelFor(100, 4, recordThread);
+
+        REQUIRE(threadsUsed.size() == 1);
+        REQUIRE(threadsUsed.count(std::this_thread::get_id()) == 1);
+    }
+
+    SECTION("Threads are given back when the section is done")
+    {
+        {
+            CThreadReservation outerSection(3);
+        }
+
+        CThreadReservation section(10);
+        REQUIRE(section.ThreadNum() == 3);
+    }
+
+    CThreadBudget::SetMaxThreadNum(0);
+}
+
+
+TEST_CASE("ParallelFor, budget limits the number of concurrent threads", "[ParallelFor]")
+{
+    CThreadBudget::SetMaxThreadNum(3);
+
+    std::atomic<int> runningThreads{ 0 };
+    std::atomic<int> maxRunningThreads{ 0 };
+    ParallelFor(50, 8, [&](size_t)
+        {
+            const int running = ++runningThreads;
+            int previousMax = maxRunningThreads;
+            while (running > previousMax && !maxRunningThreads.compare_exchange_weak(previousMax, running))
+            {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            --runningThreads;
+        });
+
+    CThreadBudget::SetMaxThreadNum(0);
+
+    REQUIRE(maxRunningThreads <= 3);
+}
+
+TEST_CASE("ParallelFor, called from threads reserving the budget - nested sections run on the calling thread", "[ParallelFor]")
+{
+    // Mimics the evaluation threads, which reserve the budget before starting and run parallel sections themselves.
+    const unsigned long maxThreadNum = 4;
+    CThreadBudget::SetMaxThreadNum(maxThreadNum);
+
+    std::atomic<bool> nestedSectionUsedOtherThread{ false };
+    std::atomic<int> nestedCallCount{ 0 };
+    size_t outerThreadNum = 0;
+    {
+        CThreadReservation outerThreads(maxThreadNum);
+        outerThreadNum = outerThreads.ThreadNum();
+
+        std::vector<std::thread> threads;
+        for (size_t threadIdx = 0; threadIdx < outerThreads.ThreadNum(); ++threadIdx)
+        {
+            threads.push_back(std::thread([&]()
+                {
+                    const std::thread::id callingThread = std::this_thread::get_id();
+                    ParallelFor(20, maxThreadNum, [&](size_t)
+                        {
+                            ++nestedCallCount;
+                            if (std::this_thread::get_id() != callingThread)
+                            {
+                                nestedSectionUsedOtherThread = true;
+                            }
+                        });
+                }));
+        }
+        for (std::thread& t : threads)
+        {
+            t.join();
+        }
+    }
+
+    // The threads are given back once the outer section is done
+    CThreadReservation section(maxThreadNum);
+    const size_t threadsAvailableAfterwards = section.ThreadNum();
+
+    CThreadBudget::SetMaxThreadNum(0);
+
+    REQUIRE(outerThreadNum == maxThreadNum - 1);
+    REQUIRE(nestedCallCount == 60);
+    REQUIRE_FALSE(nestedSectionUsedOtherThread);
+    REQUIRE(threadsAvailableAfterwards == maxThreadNum - 1);
+}
+
+}
@@ -0,0 +1,119 @@
+#include <PPPLib/PostProcessingStatistics.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include "catch.hpp"
+
+namespace novac
+{
+
+static std::string ReadAllText(const std::string& fileName)
+{
+    std::ifstream file(fileName);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+TEST_CASE("CPostProcessingStatistics, unknown instrument - returns zero", "[CPostProcessingStatistics]")
+{
+    CPostProcessingStatistics sut;
+
+    REQUIRE(sut.GetAcceptionNum("I2J8549") == 0);
+    REQUIRE(sut.GetRejectionNum("I2J8549", ReasonForScanRejection::NoPlume) == 0);
+}
+
+TEST_CASE("CPostProcessingStatistics, counts scans per instrument and reason", "[CPostProcessingStatistics]")
+{
+    CPostProcessingStatistics sut;
+
+    sut.InsertAcception("I2J8549");
+    sut.InsertAcception("I2J8549");
+    sut.InsertRejection("I2J8549", ReasonForScanRejection::NoPlume);
+    sut.InsertRejection("D2J2200", ReasonForScanRejection::CompletenessLow);
+    sut.InsertRejection("D2J2200", ReasonForScanRejection::CompletenessLow);
+    sut.InsertRejection("D2J2200", ReasonForScanRejection::SkySpectrumDark);
+
+    REQUIRE(sut.GetAcceptionNum("I2J8549") == 2);
+    REQUIRE(sut.GetRejectionNum("I2J8549", ReasonForScanRejection::NoPlume) == 1);
+    REQUIRE(sut.GetRejectionNum("I2J8549", ReasonForScanRejection::CompletenessLow) == 0);
+    REQUIRE(sut.GetAcceptionNum("D2J2200") == 0);
+    REQUIRE(sut.GetRejectionNum("D2J2200", ReasonForScanRejection::CompletenessLow) == 2);
+    REQUIRE(sut.GetRejectionNum("D2J2200", ReasonForScanRejection::SkySpectrumDark) == 1);
+
+    SECTION("The serials are compared without regard to case")
+    {
+        sut.InsertAcception("i2j8549");
+        REQUIRE(sut.GetAcceptionNum("I2J8549") == 3);
+    }
+}
+
+TEST_CASE("CPostProcessingStatistics, scans inserted on several threads - all are counted", "[CPostProcessingStatistics]")
+{
+    const unsigned long scansPerThread = 1000;
+    CPostProcessingStatistics sut;
+
+    std::vector<std::thread> threads;
+    for (int threadIdx = 0; threadIdx < 4; ++threadIdx)
+    {
+        threads.push_back(std::thread([&]()
+            {
+                for (unsigned long ii = 0; ii < scansPerThread; ++ii)
+                {
+                    sut.InsertAcception("I2J8549");
+                    sut.InsertRejection("D2J2200", ReasonForScanRejection::SkySpectrumSaturated);
+                    sut.InsertEvaluatedSpectrum(1.0);
+                }
+            }));
+    }
+    for (std::thread& t : threads)
+    {
+        t.join();
+    }
+
+    REQUIRE(sut.GetAcceptionNum("I2J8549") == 4 * scansPerThread);
+    REQUIRE(sut.GetRejectionNum("D2J2200", ReasonForScanRejection::SkySpectrumSaturated) == 4 * scansPerThread);
+}
+
+TEST_CASE("CPostProcessingStatistics WriteStatToFile, writes instruments in the order they were first inserted", "[CPostProcessingStatistics]")
+{
+    CPostProcessingStatistics sut;
+    sut.InsertRejection("D2J2200", ReasonForScanRejection::SkySpectrumTooLongExposureTime);
+    std::thread([&]()
+        {
+            sut.InsertAcception("I2J8549");
+            sut.InsertAcception("d2j2200");
+            sut.InsertEvaluatedSpectrum(30.0);
+        }).join();
+    sut.InsertEvaluatedSpectrum(10.0);
+
+    const std::string fileName = "UnitTest_PostProcessingStatistics.txt";
+    std::remove(fileName.c_str());
+    sut.WriteStatToFile(fileName.c_str());
+    const std::string writtenFile = ReadAllText(fileName);
+    std::remove(fileName.c_str());
+
+    const std::string expectedFile =
+        "Instrument: D2J2200\n"
+        "\t#Accepted scans: 1\n"
+        "\t#Rejected scans:\n"
+        "\t\t1 due to too long exposure time\n"
+        "\t\t0 due to saturated sky spectrum\n"
+        "\t\t0 due to too dark sky spectrum\n"
+        "\t\t0 due to no plume seen\n"
+        "\t\t0 due to too low completeness\n"
+        "Instrument: I2J8549\n"
+        "\t#Accepted scans: 1\n"
+        "\t#Rejected scans:\n"
+        "\t\t0 due to too long exposure time\n"
+        "\t\t0 due to saturated sky spectrum\n"
+        "\t\t0 due to too dark sky spectrum\n"
+        "\t\t0 due to no plume seen\n"
+        "\t\t0 due to too low completeness\n"
+        "Total Number of Spectra evaluated: 2\n"
+        "Total Time spent on evaluating spectra: 0.04 [s] ( 20.00 mseconds / spectrum)\n";
+    REQUIRE(writtenFile == expectedFile);
+}
+
+}
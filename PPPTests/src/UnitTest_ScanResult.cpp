@@ -0,0 +1,75 @@
+#include "catch.hpp"
+#include <PPPLib/Evaluation/ScanResult.h>
+#include <utility>
+
+namespace Evaluation
+{
+static novac::CSpectrumInfo CreateSpectrumInfo(double latitude, double longitude, double altitude, const std::string& serial)
+{
+    novac::CSpectrumInfo info;
+    info.m_gps.m_latitude = latitude;
+    info.m_gps.m_longitude = longitude;
+    info.m_gps.m_altitude = altitude;
+    info.m_device = serial;
+    return info;
+}
+
+TEST_CASE("CScanResult position and serial", "[CScanResult]")
+{
+    novac::CEvaluationResult evaluationResult;
+
+    SECTION("No spectra - returns zero and empty serial")
+    {
+        CScanResult sut;
+
+        REQUIRE(sut.GetLatitude() == 0.0);
+        REQUIRE(sut.GetLongitude() == 0.0);
+        REQUIRE(sut.GetAltitude() == 0.0);
+        REQUIRE(sut.GetSerial() == "");
+    }
+
+    SECTION("First spectrum without position - returns position of first spectrum with a position")
+    {
+        CScanResult sut;
+        sut.AppendResult(evaluationResult, CreateSpectrumInfo(0.0, 0.0, 0.0, ""));
+        sut.AppendResult(evaluationResult, CreateSpectrumInfo(-39.2, 175.5, 1633.0, "I2J5678"));
+        sut.AppendResult(evaluationResult, CreateSpectrumInfo(-40.0, 176.0, 1000.0, "D2J2124"));
+
+        REQUIRE(sut.GetLatitude() == Approx(-39.2));
+        REQUIRE(sut.GetLongitude() == Approx(175.5));
+        REQUIRE(sut.GetAltitude() == Approx(1633.0));
+        REQUIRE(sut.GetSerial() == "I2J5678");
+    }
+
+    SECTION("Spectrum with position removed - returns position of the next spectrum")
+    {
+        CScanResult sut;
+        sut.AppendResult(evaluationResult, CreateSpectrumInfo(-39.2, 175.5, 1633.0, "I2J5678"));
+        sut.AppendResult(evaluationResult, CreateSpectrumInfo(-40.0, 176.0, 1000.0, "D2J2124"));
+
+        sut.RemoveResult(0);
+
+        REQUIRE(sut.GetEvaluatedNum() == 1);
+        REQUIRE(sut.GetLatitude() == Approx(-40.0));
+        REQUIRE(sut.GetLongitude() == Approx(176.0));
+        REQUIRE(sut.GetAltitude() == Approx(1000.0));
+        REQUIRE(sut.GetSerial() == "D2J2124");
+    }
+
+    SECTION("Copied and moved results keep the position and serial")
+    {
+        CScanResult original;
+        original.AppendResult(evaluationResult, CreateSpectrumInfo(-39.2, 175.5, 1633.0, "I2J5678"));
+
+        CScanResult copy{ original };
+        CScanResult moved{ std::move(original) };
+
+        REQUIRE(copy.GetEvaluatedNum() == 1);
+        REQUIRE(copy.GetLatitude() == Approx(-39.2));
+        REQUIRE(copy.GetSerial() == "I2J5678");
+        REQUIRE(moved.GetEvaluatedNum() == 1);
+        REQUIRE(moved.GetLatitude() == Approx(-39.2));
+        REQUIRE(moved.GetSerial() == "I2J5678");
+    }
+}
+}
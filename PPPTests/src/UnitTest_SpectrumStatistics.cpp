@@ -0,0 +1,151 @@
+#include "catch.hpp"
+#include <PPPLib/Evaluation/SpectrumStatistics.h>
+#include <SpectralEvaluation/File/ScanFileHandler.h>
+#include <SpectralEvaluation/Log.h>
+#include <vector>
+
+extern void VerifyScanCanBeRead(novac::CScanFileHandler& scan, const std::string filename);
+
+namespace Evaluation
+{
+static std::string GetTestDataDirectory()
+{
+#ifdef _MSC_VER
+    return std::string("../testData/");
+#else
+    return std::string("testData/");
+#endif // _MSC_VER 
+}
+
+TEST_CASE("CalculateSpectrumStatistics", "[SpectrumStatistics]")
+{
+    std::vector<double> data = { 1.0, 2.0, 3.0, 9.0, 5.0, 4.0, 7.0, 6.0, 100.0, 200.0 };
+
+    SECTION("Fit region inside of spectrum, returns expected intensities.")
+    {
+        const auto result = CalculateSpectrumStatistics(data.data(), static_cast<int>(data.size()), 4, 7, 10.0);
+
+        REQUIRE(result.peakIntensity == 9.0); // the last two pixels are excluded
+        REQUIRE(result.fitIntensity == 7.0); // pixels 4, 5 and 6
+        REQUIRE(result.maximumSaturationRatioInFitRegion == Approx(0.7));
+    }
+
+    SECTION("Fit region contains the peak, returns expected intensities.")
+    {
+        const auto result = CalculateSpectrumStatistics(data.data(), static_cast<int>(data.size()), 2, 6, 10.0);
+
+        REQUIRE(result.peakIntensity == 9.0);
+        REQUIRE(result.fitIntensity == 9.0);
+    }
+
+    SECTION("Fit region extends into the last two pixels, fit intensity includes these.")
+    {
+        const auto result = CalculateSpectrumStatistics(data.data(), static_cast<int>(data.size()), 5, 10, 400.0);
+
+        REQUIRE(result.peakIntensity == 9.0);
+        REQUIRE(result.fitIntensity == 200.0);
+        REQUIRE(result.maximumSaturationRatioInFitRegion == Approx(0.5));
+    }
+
+    SECTION("Fit region outside of spectrum, fit intensity is zero.")
+    {
+        const auto result = CalculateSpectrumStatistics(data.data(), static_cast<int>(data.size()), 20, 30, 10.0);
+
+        REQUIRE(result.peakIntensity == 9.0);
+        REQUIRE(result.fitIntensity == 0.0);
+        REQUIRE(result.maximumSaturationRatioInFitRegion == 0.0);
+    }
+
+    SECTION("No dynamic range given, saturation ratio is zero.")
+    {
+        const auto result = CalculateSpectrumStatistics(data.data(), static_cast<int>(data.size()), 4, 7, 0.0);
+
+        REQUIRE(result.fitIntensity == 7.0);
+        REQUIRE(result.maximumSaturationRatioInFitRegion == 0.0);
+    }
+
+    SECTION("Empty data, returns zeros.")
+    {
+        const auto result = CalculateSpectrumStatistics(nullptr, 0, 4, 7, 10.0);
+
+        REQUIRE(result.peakIntensity == 0.0);
+        REQUIRE(result.fitIntensity == 0.0);
+        REQUIRE(result.maximumSaturationRatioInFitRegion == 0.0);
+    }
+}
+
+TEST_CASE("CalculateSpectrumStatistics, measured sky spectrum gives same intensities as MaxValue", "[SpectrumStatistics][IntegrationTest]")
+{
+    const std::string filename = GetTestDataDirectory() + "2002128M1/2002128M1_230120_0148_0.pak";
+    novac::ConsoleLog logger;
+    novac::CScanFileHandler scan(logger);
+    ::VerifyScanCanBeRead(scan, filename);
+    const novac::SpectrometerModel model = novac::CSpectrometerDatabase::SpectrometerModel_AVASPEC();
+
+    novac::CSpectrum sky;
+    scan.GetSky(sky);
+
+    const auto result = CalculateSpectrumStatistics(sky, model, 464, 630);
+
+    REQUIRE(result.peakIntensity == Approx(sky.MaxValue(0, sky.m_length - 2)));
+    REQUIRE(result.fitIntensity == Approx(sky.MaxValue(464, 630)));
+}
+
+TEST_CASE("CalculateSpectrumStatistics, measured sky spectrum gives same saturation ratio as GetMaximumSaturationRatioOfSpectrum", "[SpectrumStatistics][IntegrationTest]")
+{
+    const std::string filename = GetTestDataDirectory() + "2002128M1/2002128M1_230120_0148_0.pak";
+    novac::ConsoleLog logger;
+    novac::CScanFileHandler scan(logger);
+    ::VerifyScanCanBeRead(scan, filename);
+
+    novac::CSpectrum sky;
+    scan.GetSky(sky);
+    REQUIRE(sky.NumSpectra() > 1);
+
+    novac::SpectrometerModel model = novac::CSpectrometerDatabase::SpectrometerModel_AVASPEC();
+
+    SECTION("Spectrometer adding the readouts")
+    {
+        model.averagesSpectra = false;
+
+        const auto result = CalculateSpectrumStatistics(sky, model, 464, 630);
+
+        REQUIRE(result.maximumSaturationRatioInFitRegion == Approx(novac::GetMaximumSaturationRatioOfSpectrum(sky, model, 464, 630)));
+    }
+
+    SECTION("Spectrometer averaging the readouts")
+    {
+        model.averagesSpectra = true;
+
+        const auto result = CalculateSpectrumStatistics(sky, model, 464, 630);
+
+        REQUIRE(result.maximumSaturationRatioInFitRegion == Approx(novac::GetMaximumSaturationRatioOfSpectrum(sky, model, 464, 630)));
+    }
+}
+
+TEST_CASE("CalculateSpectrumStatistics, benchmark", "[.][SpectrumStatistics][Benchmark]")
+{
+    const std::string filename = GetTestDataDirectory() + "2002128M1/2002128M1_230120_0148_0.pak";
+    novac::ConsoleLog logger;
+    novac::CScanFileHandler scan(logger);
+    ::VerifyScanCanBeRead(scan, filename);
+    const novac::SpectrometerModel model = novac::CSpectrometerDatabase::SpectrometerModel_AVASPEC();
+
+    novac::CSpectrum sky;
+    scan.GetSky(sky);
+
+    BENCHMARK("Separate passes over the spectrum")
+    {
+        const double peakIntensity = sky.MaxValue(0, sky.m_length - 2);
+        const double fitIntensity = sky.MaxValue(464, 630);
+        const double saturationRatio = novac::GetMaximumSaturationRatioOfSpectrum(sky, model, 464, 630);
+        return peakIntensity + fitIntensity + saturationRatio;
+    };
+
+    BENCHMARK("CalculateSpectrumStatistics")
+    {
+        const auto result = CalculateSpectrumStatistics(sky, model, 464, 630);
+        return result.peakIntensity + result.fitIntensity + result.maximumSaturationRatioInFitRegion;
+    };
+}
+}
@@ -0,0 +1,112 @@
+#include <PPPLib/TraceRecorder.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include "catch.hpp"
+
+namespace novac
+{
+
+static std::string ReadAllText(const std::string& fileName)
+{
+    std::ifstream file(fileName);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static size_t CountOccurrences(const std::string& str, const std::string& part)
+{
+    size_t count = 0;
+    for (size_t pos = str.find(part); pos != std::string::npos; pos = str.find(part, pos + 1))
+    {
+        ++count;
+    }
+    return count;
+}
+
+TEST_CASE("CTraceRecorder, not started - records no events", "[CTraceRecorder]")
+{
+    CTraceRecorder::Start();
+    CTraceRecorder::Stop();
+
+    {
+        CTraceScope scope("test", "NotRecorded");
+    }
+
+    REQUIRE(CTraceRecorder::EventCount() == 0);
+}
+
+TEST_CASE("CTraceRecorder, started - records one event per scope", "[CTraceRecorder]")
+{
+    CTraceRecorder::Start();
+
+    {
+        CTraceScope outer("test", "Outer");
+        CTraceScope inner("test", "Inner", "some detail");
+    }
+
+    CTraceRecorder::Stop();
+    REQUIRE(CTraceRecorder::EventCount() == 2);
+
+    SECTION("Start clears the previous events")
+    {
+        CTraceRecorder::Start();
+        CTraceRecorder::Stop();
+        REQUIRE(CTraceRecorder::EventCount() == 0);
+    }
+}
+
+TEST_CASE("CTraceRecorder, events recorded on several threads", "[CTraceRecorder]")
+{
+    const int eventsPerThread = 1000;
+    CTraceRecorder::Start();
+
+    std::vector<std::thread> threads;
+    for (int threadIdx = 0; threadIdx < 4; ++threadIdx)
+    {
+        threads.push_back(std::thread([&]()
+            {
+                for (int ii = 0; ii < eventsPerThread; ++ii)
+                {
+                    CTraceScope scope("test", "Work");
+                }
+            }));
+    }
+    for (std::thread& t : threads)
+    {
+        t.join();
+    }
+
+    CTraceRecorder::Stop();
+    REQUIRE(CTraceRecorder::EventCount() == 4 * eventsPerThread);
+}
+
+TEST_CASE("CTraceRecorder WriteToFile, writes trace event json", "[CTraceRecorder]")
+{
+    CTraceRecorder::Start();
+    {
+        CTraceScope scope("evaluation", "EvaluateScan", "C:\\Data\\\"scan\".pak");
+    }
+    std::thread([]()
+        {
+            CTraceScope scope("flux", "CalculateFlux");
+        }).join();
+    CTraceRecorder::Stop();
+
+    const std::string fileName = "UnitTest_TraceRecorder.json";
+    REQUIRE(CTraceRecorder::WriteToFile(fileName));
+    const std::string writtenFile = ReadAllText(fileName);
+    std::remove(fileName.c_str());
+
+    REQUIRE(writtenFile.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[") == 0);
+    REQUIRE(CountOccurrences(writtenFile, "\"ph\":\"X\"") == 2);
+    REQUIRE(writtenFile.find("\"name\":\"EvaluateScan\",\"cat\":\"evaluation\"") != std::string::npos);
+    REQUIRE(writtenFile.find("\"name\":\"CalculateFlux\",\"cat\":\"flux\"") != std::string::npos);
+
+    // The detail is escaped
+    REQUIRE(writtenFile.find("\"args\":{\"detail\":\"C:\\\\Data\\\\\\\"scan\\\".pak\"}") != std::string::npos);
+}
+
+}
@@ -0,0 +1,169 @@
+#include <PPPLib/File/XMLFileReader.h>
+#include <PPPLib/File/ProcessingFileReader.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "catch.hpp"
+
+namespace novac
+{
+static std::string GetTestDataDirectory()
+{
+#ifdef _MSC_VER
+    return std::string("../testData/");
+#else
+    return std::string("testData/");
+#endif // _MSC_VER
+}
+
+static std::string GetTemporaryFile()
+{
+    return GetTestDataDirectory() + std::string("UnitTest_XMLFileReader.xml");
+}
+
+// Region Helper methods
+
+/** Exposes the tokens of the CXMLFileReader */
+class CTokenReader : public FileHandler::CXMLFileReader
+{
+public:
+    CTokenReader(novac::ILogger& log)
+        : CXMLFileReader(log)
+    {
+    }
+
+    std::vector<std::string> ReadAllTokens(const std::string& fileName)
+    {
+        std::vector<std::string> tokens;
+        if (Open(fileName))
+        {
+            while (nullptr != (szToken = NextToken()))
+            {
+                tokens.push_back(szToken);
+            }
+            Close();
+        }
+        return tokens;
+    }
+
+    /** Reads the value of the first element with the given name in the file */
+    std::string ReadStringItem(const std::string& fileName, const std::string& label)
+    {
+        std::string value;
+        if (Open(fileName))
+        {
+            while (nullptr != (szToken = NextToken()))
+            {
+                if (label == szToken)
+                {
+                    Parse_StringItem(ENDTAG(label), value);
+                    break;
+                }
+            }
+            Close();
+        }
+        return value;
+    }
+};
+
+static std::string ReadFile(const std::string& fileName)
+{
+    std::ifstream file(fileName, std::ios::in | std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+static void WriteFile(const std::string& fileName, const std::string& contents)
+{
+    std::ofstream file(fileName, std::ios::out | std::ios::binary);
+    file << contents;
+}
+
+/** @return the given text with all line endings converted to CR LF */
+static std::string ToCrLf(const std::string& text)
+{
+    std::string result;
+    result.reserve(text.size() + text.size() / 16);
+    for (char c : text)
+    {
+        if (c == '\n')
+        {
+            result += "\r\n";
+        }
+        else if (c != '\r')
+        {
+            result += c;
+        }
+    }
+    return result;
+}
+
+// Endregion Helper methods
+
+TEST_CASE("CXMLFileReader, file with CR LF line endings - gives the same tokens as with LF line endings", "[XMLFileReader][File]")
+{
+    novac::ConsoleLog logger;
+    CTokenReader sut{ logger };
+
+    // The inputs of the tests of the readers derived from CXMLFileReader
+    for (const char* inputFile : { "setup.xml", "processing.xml", "I2J8552.exml", "wind_ruapehu.wxml" })
+    {
+        const std::string originalFile = GetTestDataDirectory() + inputFile;
+        const std::vector<std::string> expectedTokens = sut.ReadAllTokens(originalFile);
+
+        WriteFile(GetTemporaryFile(), ToCrLf(ReadFile(originalFile)));
+        const std::vector<std::string> tokens = sut.ReadAllTokens(GetTemporaryFile());
+        std::remove(GetTemporaryFile().c_str());
+
+        INFO(inputFile);
+        REQUIRE(expectedTokens.size() > 10);
+        REQUIRE(tokens == expectedTokens);
+    }
+}
+
+TEST_CASE("CXMLFileReader, processing file with CR LF line endings - gives the same configuration", "[XMLFileReader][File]")
+{
+    novac::ConsoleLog logger;
+    FileHandler::CProcessingFileReader sut{ logger };
+
+    Configuration::CUserConfiguration expectedConfiguration;
+    sut.ReadProcessingFile(GetTestDataDirectory() + "processing.xml", expectedConfiguration);
+
+    WriteFile(GetTemporaryFile(), ToCrLf(ReadFile(GetTestDataDirectory() + "processing.xml")));
+    Configuration::CUserConfiguration resultingConfiguration;
+    sut.ReadProcessingFile(GetTemporaryFile(), resultingConfiguration);
+    std::remove(GetTemporaryFile().c_str());
+
+    const bool isSameConfiguration = (resultingConfiguration == expectedConfiguration);
+    REQUIRE(isSameConfiguration);
+    REQUIRE(4 == resultingConfiguration.m_maxThreadNum);
+    REQUIRE(novac::CDateTime(2017, 1, 29, 12, 50, 51) == resultingConfiguration.m_fromDate);
+}
+
+TEST_CASE("CXMLFileReader, line longer than 4095 characters - is read entirely", "[XMLFileReader][File]")
+{
+    novac::ConsoleLog logger;
+    CTokenReader sut{ logger };
+
+    const std::string longValue(5000, 'A');
+
+    SECTION("LF line endings")
+    {
+        WriteFile(GetTemporaryFile(), "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n<Test>\n\t<Name>" + longValue + "</Name>\n\t<Next>1</Next>\n</Test>\n");
+    }
+
+    SECTION("CR LF line endings")
+    {
+        WriteFile(GetTemporaryFile(), "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\r\n<Test>\r\n\t<Name>" + longValue + "</Name>\r\n\t<Next>1</Next>\r\n</Test>\r\n");
+    }
+
+    const std::string value = sut.ReadStringItem(GetTemporaryFile(), "Name");
+    const std::string nextValue = sut.ReadStringItem(GetTemporaryFile(), "Next");
+    std::remove(GetTemporaryFile().c_str());
+
+    REQUIRE(value == longValue);
+    REQUIRE(nextValue == "1");
+}
+
+}
@@ -1,6 +1,13 @@
 #include <PPPLib/Meteorology/XMLWindFileReader.h>
 #include <PPPLib/Configuration/UserConfiguration.h>
+#include <PPPLib/File/Filesystem.h>
+#include <Poco/File.h>
 #include "catch.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
 
 namespace novac
 {
@@ -96,4 +103,194 @@ TEST_CASE("ReadWindFile gives expected wind profile", "[XMLWindFileReader][File]
         REQUIRE(Approx(windField.GetWindDirection()) == 0.0); // Default wind direction
     }
 }
+
+TEST_CASE("ReadWindDirectory gives expected wind profile", "[XMLWindFileReader][File]")
+{
+    novac::ConsoleLog logger;
+    novac::LogContext context;
+    Configuration::CUserConfiguration userConfiguration;
+    userConfiguration.m_maxThreadNum = 4;
+    Meteorology::CWindDataBase resultingDatabase;
+    FileHandler::CXMLWindFileReader sut{ logger, userConfiguration };
+    const novac::CDateTime dateFrom{ 2023, 1, 19, 0, 0, 0 };
+    const novac::CDateTime dateTo{ 2023, 1, 20, 0, 0, 0 };
+
+    sut.ReadWindDirectory(context, GetTestDataDirectory(), resultingDatabase, &dateFrom, &dateTo);
+
+    // The only wind file in the directory does not have the date in the name and is read in as is.
+    REQUIRE(resultingDatabase.m_dataBaseName == "Ruapehu");
+    REQUIRE(2 == resultingDatabase.GetDataBaseSize());
+
+    auto windField = Meteorology::WindField{};
+    bool exists = resultingDatabase.GetWindField(novac::CDateTime{ 2023, 1, 20, 1, 0, 0 }, novac::CGPSData{ -39.281302 , 175.564254 , 2700.0 }, Meteorology::InterpolationMethod::Exact, windField);
+    REQUIRE(exists);
+    REQUIRE(Approx(windField.GetWindSpeed()) == 7.56);
+    REQUIRE(Approx(windField.GetWindDirection()) == 278.4);
+}
+
+TEST_CASE("WriteToBinaryFile then ReadFromBinaryFile gives same wind profile", "[WindDataBase][File]")
+{
+    novac::ConsoleLog logger;
+    novac::LogContext context;
+    Configuration::CUserConfiguration userConfiguration;
+    Meteorology::CWindDataBase originalDatabase;
+    FileHandler::CXMLWindFileReader reader{ logger, userConfiguration };
+    reader.ReadWindFile(context, GetWindFieldFile(), originalDatabase);
+    const std::string binaryFile = "WindDataBase_test.bin";
+    const std::uint64_t sourceHash = 1234;
+
+    REQUIRE(originalDatabase.WriteToBinaryFile(binaryFile, sourceHash));
+
+    SECTION("Same source hash, database is read")
+    {
+        Meteorology::CWindDataBase sut;
+        REQUIRE(sut.ReadFromBinaryFile(binaryFile, sourceHash));
+
+        REQUIRE(sut.m_dataBaseName == "Ruapehu");
+        REQUIRE(2 == sut.GetDataBaseSize());
+
+        auto windField = Meteorology::WindField{};
+        bool exists = sut.GetWindField(novac::CDateTime{ 2023, 1, 19, 22, 0, 0 }, novac::CGPSData{ -39.281302 , 175.564254 , 2700.0 }, Meteorology::InterpolationMethod::Exact, windField);
+        REQUIRE(exists);
+        REQUIRE(Approx(windField.GetWindSpeed()) == 5.13);
+        REQUIRE(Approx(windField.GetWindDirection()) == 277.3);
+        REQUIRE(windField.GetWindSpeedSource() == Meteorology::MeteorologySource::EcmwfForecast);
+    }
+
+    SECTION("Different source hash, database is not read")
+    {
+        Meteorology::CWindDataBase sut;
+        REQUIRE_FALSE(sut.ReadFromBinaryFile(binaryFile, sourceHash + 1));
+        REQUIRE(0 == sut.GetDataBaseSize());
+    }
+
+    SECTION("File does not exist, database is not read")
+    {
+        Meteorology::CWindDataBase sut;
+        REQUIRE_FALSE(sut.ReadFromBinaryFile("NonExistingWindDataBase.bin", sourceHash));
+        REQUIRE(0 == sut.GetDataBaseSize());
+    }
+
+    std::remove(binaryFile.c_str());
+}
+
+/** Remembers the messages logged, to see if the wind field was read from the cache. */
+class RecordingLog : public novac::ILogger
+{
+public:
+    std::vector<std::string> messages;
+
+    virtual void Debug(const std::string& message) override { messages.push_back(message); }
+    virtual void Debug(const novac::LogContext&, const std::string& message) override { messages.push_back(message); }
+    virtual void Information(const std::string& message) override { messages.push_back(message); }
+    virtual void Information(const novac::LogContext&, const std::string& message) override { messages.push_back(message); }
+    virtual void Error(const std::string& message) override { messages.push_back(message); }
+    virtual void Error(const novac::LogContext&, const std::string& message) override { messages.push_back(message); }
+
+    bool WasReadFromCache() const
+    {
+        for (const std::string& message : messages)
+        {
+            if (message.find("from cache") != std::string::npos)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+/** Creates a directory with a copy of the test wind field file, with the volcano renamed to the given name. */
+static std::string CreateWindDirectory(const std::string& volcanoName)
+{
+    const std::string directory = GetTestDataDirectory() + "WindCache/" + volcanoName + "/";
+    Filesystem::CreateDirectoryStructure(directory);
+
+    std::ifstream original(GetWindFieldFile());
+    std::string contents{ std::istreambuf_iterator<char>(original), std::istreambuf_iterator<char>() };
+    const std::string originalName = "volcano=\"Ruapehu\"";
+    contents.replace(contents.find(originalName), originalName.size(), "volcano=\"" + volcanoName + "\"");
+
+    std::ofstream copy(directory + "wind_" + volcanoName + ".wxml");
+    copy << contents;
+
+    return directory;
+}
+
+TEST_CASE("ReadWindDirectory, two directories read after each other - both are read from cache the second time", "[XMLWindFileReader][File]")
+{
+    const std::string tempDirectory = GetTestDataDirectory() + "WindCache/temp/";
+    if (Poco::File(tempDirectory).exists())
+    {
+        Poco::File(tempDirectory).remove(true);
+    }
+    const std::string firstDirectory = CreateWindDirectory("Ruapehu");
+    const std::string secondDirectory = CreateWindDirectory("Tongariro");
+
+    Configuration::CUserConfiguration userConfiguration;
+    userConfiguration.m_tempDirectory = tempDirectory;
+    novac::LogContext context;
+
+    auto readWindDirectory = [&](const std::string& directory, Meteorology::CWindDataBase& dataBase)
+    {
+        RecordingLog logger;
+        FileHandler::CXMLWindFileReader sut{ logger, userConfiguration };
+        sut.ReadWindDirectory(context, directory, dataBase, nullptr, nullptr);
+        return logger.WasReadFromCache();
+    };
+
+    // The first time, the files are read
+    {
+        Meteorology::CWindDataBase first, second;
+        REQUIRE(false == readWindDirectory(firstDirectory, first));
+        REQUIRE(false == readWindDirectory(secondDirectory, second));
+        REQUIRE(first.m_dataBaseName == "Ruapehu");
+        REQUIRE(second.m_dataBaseName == "Tongariro");
+    }
+
+    // The second time, both are read from the cache
+    {
+        Meteorology::CWindDataBase first, second;
+        REQUIRE(true == readWindDirectory(firstDirectory, first));
+        REQUIRE(true == readWindDirectory(secondDirectory, second));
+
+        REQUIRE(first.m_dataBaseName == "Ruapehu");
+        REQUIRE(2 == first.GetDataBaseSize());
+        REQUIRE(second.m_dataBaseName == "Tongariro");
+        REQUIRE(2 == second.GetDataBaseSize());
+    }
+}
+
+TEST_CASE("IsWindFileOutsideOfInterval", "[XMLWindFileReader][File]")
+{
+    const novac::CDateTime dateFrom{ 2023, 1, 19, 12, 0, 0 };
+    const novac::CDateTime dateTo{ 2023, 1, 21, 6, 0, 0 };
+
+    SECTION("File without date in the name is not outside")
+    {
+        REQUIRE(false == FileHandler::CXMLWindFileReader::IsWindFileOutsideOfInterval("wind_ruapehu.wxml", &dateFrom, &dateTo));
+    }
+
+    SECTION("File with date inside of interval is not outside")
+    {
+        REQUIRE(false == FileHandler::CXMLWindFileReader::IsWindFileOutsideOfInterval("/wind/Ruapehu_20230120.wxml", &dateFrom, &dateTo));
+    }
+
+    SECTION("Files with the first and last day of the interval are not outside")
+    {
+        REQUIRE(false == FileHandler::CXMLWindFileReader::IsWindFileOutsideOfInterval("/wind/Ruapehu_20230119.wxml", &dateFrom, &dateTo));
+        REQUIRE(false == FileHandler::CXMLWindFileReader::IsWindFileOutsideOfInterval("/wind/Ruapehu_20230121.wxml", &dateFrom, &dateTo));
+    }
+
+    SECTION("Files with date before or after interval are outside")
+    {
+        REQUIRE(true == FileHandler::CXMLWindFileReader::IsWindFileOutsideOfInterval("/wind/Ruapehu_20230118.wxml", &dateFrom, &dateTo));
+        REQUIRE(true == FileHandler::CXMLWindFileReader::IsWindFileOutsideOfInterval("/wind/Ruapehu_20230122.wxml", &dateFrom, &dateTo));
+    }
+
+    SECTION("No interval given, file is not outside")
+    {
+        REQUIRE(false == FileHandler::CXMLWindFileReader::IsWindFileOutsideOfInterval("/wind/Ruapehu_20230118.wxml", nullptr, nullptr));
+    }
+}
 }